@@ -39,6 +39,31 @@ namespace BiometricEvaluation {
  * entries in the manifest for one key.  The last entry for the key is 
  * considered accurate.  If the last offset for a key is 
  * ARCHIVE_RECORD_REMOVED, the information is treated as unavailable.
+ *
+ * The manifest is accompanied by a binary index that is rewritten when a
+ * store opened read/write is synchronized or destroyed. The index holds
+ * the final entry for each key, a table of keys sorted for lookup, and a
+ * bitmap of removed records. When the index covers the entire manifest,
+ * it is used in place of parsing the manifest: read-only stores map the
+ * index and search it directly, so opening them does not depend on the
+ * number of records. Otherwise the text manifest is read, and the index
+ * is rebuilt the next time the store is opened read/write.
+ *
+ * When opened read-only, the archive file is mapped into memory where
+ * the platform allows. read() then copies from the mapping without
+ * seeking the archive stream, so one object may be read from several
+ * threads at once, and readView() returns records without copying.
+ *
+ * The archive may be split into segments: once setSegmentSize() is
+ * given a size, records are appended to a new archive file whenever the
+ * current one would grow past that size. getArchiveName() names the
+ * segment currently appended to. Segments let compact() reclaim the
+ * space of removed and replaced records while the store remains open
+ * and readable: live records are copied out of older segments a few at
+ * a time, each old segment is deleted as soon as it is empty, and the
+ * manifest is finally replaced by one without stale entries. Stores
+ * opened read-only keep every segment mapped, so they continue to read
+ * records while another process compacts the store.
  */
 		class ArchiveRecordStore : public RecordStore {
 		public:	
@@ -46,6 +71,8 @@ namespace BiometricEvaluation {
 			static const std::string MANIFEST_FILE_NAME;
 			/** Name of the archive file on disk */
 			static const std::string ARCHIVE_FILE_NAME;
+			/** Name of the binary manifest index on disk */
+			static const std::string MANIFEST_INDEX_FILE_NAME;
 
 			/**
 			 * Create a new ArchiveRecordStore, read/write mode.
@@ -100,6 +127,11 @@ namespace BiometricEvaluation {
                         using RecordStore::replace;
 
 			void sync() const override;
+			void setCommitPolicy(
+			    const CommitPolicy &policy) override;
+			void setKeyFilter(
+			    bool enabled) override;
+			bool getKeyFilter() const override;
 
 			void insert(
 			    const std::string &key,
@@ -114,9 +146,53 @@ namespace BiometricEvaluation {
 			Memory::uint8Array read(
 			    const std::string &key) const override;
 
+			/**
+			 * @brief
+			 * Read several complete records from a store.
+			 * @details
+			 * Records are read in the order they are stored in
+			 * the archive, with records stored near each other
+			 * combined into a single read.
+			 *
+			 * @see RecordStore::read(const std::vector<
+			 * std::string>&)
+			 */
+			std::vector<Memory::uint8Array> read(
+			    const std::vector<std::string> &keys)
+			    const override;
+
+			Memory::uint8Array readPrefix(
+			    const std::string &key,
+			    uint64_t size) const override;
+
+			/**
+			 * @brief
+			 * Obtain a record without copying it.
+			 *
+			 * @param[in] key
+			 *	The key of the record to be read.
+			 * @return
+			 *	A view of the record's data within the mapped
+			 *	archive, valid until this object is destroyed.
+			 *	Use RecordView::copy() to keep the data longer.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for the key does not exist.
+			 * @throw Error::StrategyError
+			 *	The store was not opened read-only, the archive
+			 *	could not be mapped, or the archive is
+			 *	truncated.
+			 */
+			RecordStore::RecordView readView(
+			    const std::string &key) const;
+
 			uint64_t length(
 			    const std::string &key) const override;
 
+			std::vector<uint64_t> length(
+			    const std::vector<std::string> &keys)
+			    const override;
+
 			void flush(
 			    const std::string &key) const override;
 
@@ -190,13 +266,227 @@ namespace BiometricEvaluation {
 			 */
 			static void vacuum(
 			    const std::string &pathname);
+
+			/**
+			 * @brief
+			 * Append every record of another ArchiveRecordStore.
+			 * @details
+			 * The other store's archive segments are copied to
+			 * the end of this store's archive in large blocks, and
+			 * its manifest entries are rewritten with the new
+			 * offsets, so no record is read individually.
+			 *
+			 * @param[in] source
+			 *	The ArchiveRecordStore to append. It must not
+			 *	need vacuuming, since removed records would be
+			 *	copied as well.
+			 * @throw Error::ObjectExists
+			 *	A key in source already exists in this store.
+			 *	Nothing is appended.
+			 * @throw Error::StrategyError
+			 *	This store was opened read-only, source needs
+			 *	vacuuming, or an error occurred when using the
+			 *	underlying storage system.
+			 * @return
+			 *	Number of bytes appended to the archive.
+			 */
+			uint64_t appendRecordStore(
+			    const ArchiveRecordStore &source);
+
+			/** Default bytes of record data moved by compact() */
+			static const uint64_t DEFAULT_COMPACT_BYTES =
+			    64 * 1024 * 1024;
+
+			/**
+			 * @brief
+			 * Reclaim some of the space used by removed and
+			 * replaced records, without closing the store.
+			 * @details
+			 * A pass begins by starting a new segment. Live
+			 * records are then moved out of older segments into
+			 * the new one, in archive order, and each older
+			 * segment is deleted once emptied. Moved records and
+			 * their manifest entries are forced to stable storage
+			 * before a segment is deleted. When no older segment
+			 * remains, the manifest is replaced with one holding
+			 * only current entries: the new manifest and its
+			 * index are written to temporary files, synchronized,
+			 * and renamed into place. Call compact()
+			 * repeatedly, between other operations, until it
+			 * returns true. At most the live data of a single
+			 * segment is stored twice at any time, so
+			 * setSegmentSize() also bounds the extra disk used.
+			 *
+			 * @param[in] maxBytes
+			 *	Bytes of record data to move before returning.
+			 *	At least one record is moved per call.
+			 *
+			 * @return
+			 *	true if no removed or replaced record data
+			 *	remains (needsVacuum() returns false unless
+			 *	records were removed during the pass), false
+			 *	if compact() should be called again.
+			 *
+			 * @throw Error::StrategyError
+			 *	This store was opened read-only, or an error
+			 *	occurred when using the underlying storage
+			 *	system.
+			 */
+			bool compact(
+			    uint64_t maxBytes = DEFAULT_COMPACT_BYTES);
+
+			/**
+			 * @brief
+			 * Set the size at which a new archive segment is
+			 * begun.
+			 *
+			 * @param[in] size
+			 *	Size of archive segments in bytes, or 0 to
+			 *	append to a single segment. Records larger than
+			 *	size are stored alone in a segment.
+			 *
+			 * @throw Error::StrategyError
+			 *	This store was opened read-only.
+			 */
+			void setSegmentSize(
+			    uint64_t size);
+
+			/**
+			 * @return
+			 * Size at which a new archive segment is begun, or 0
+			 * if records are appended to a single segment.
+			 */
+			uint64_t getSegmentSize() const;
+
+			/** Default bytes of records buffered by write-behind */
+			static const uint64_t DEFAULT_WRITE_BEHIND_SIZE =
+			    64 * 1024 * 1024;
+
+			/**
+			 * @brief
+			 * Write inserted records from a background thread.
+			 * @details
+			 * insert() copies the record and its manifest entry
+			 * into memory and returns, and a background thread
+			 * appends them to the archive and manifest in large
+			 * writes. insert() only waits when size bytes are
+			 * already waiting to be written. sync(), flush(),
+			 * and reading a record that has not yet been written
+			 * wait for everything buffered to be written. An
+			 * error writing in the background is thrown by the
+			 * next insert(), remove(), sync() or flush(), and by
+			 * every such call after it. Nothing more is written
+			 * to the archive or manifest once an error occurs,
+			 * and the count of records is not committed. Records
+			 * not written are missing when the store is next
+			 * opened, and the count is recovered from the
+			 * manifest. Call sync() before destroying the store
+			 * to learn whether every record was written. The
+			 * setting is not kept with the store.
+			 *
+			 * @param[in] size
+			 *	Bytes of records to buffer, or 0 to write
+			 *	records from the calling thread.
+			 *
+			 * @throw Error::NotImplemented
+			 *	Write-behind is not supported on this platform.
+			 * @throw Error::StrategyError
+			 *	This store was opened read-only, or records
+			 *	already buffered could not be written.
+			 */
+			void setWriteBehind(
+			    uint64_t size = DEFAULT_WRITE_BEHIND_SIZE);
+
+			/**
+			 * @return
+			 * Bytes of records buffered by write-behind, or 0 if
+			 * records are written from the calling thread.
+			 */
+			uint64_t getWriteBehind() const;
+
+			/** Default bytes read at a time by scan() */
+			static const uint64_t DEFAULT_SCAN_CHUNK_SIZE =
+			    16 * 1024 * 1024;
+
+			/**
+			 * @brief
+			 * Visit every record, reading the archive in large
+			 * chunks that bypass the page cache.
+			 * @details
+			 * Each segment is read from start to end in chunks of
+			 * chunkSize bytes, opened for direct I/O where the
+			 * platform and file system allow. Otherwise, the
+			 * cache is told to drop each chunk once it has been
+			 * visited. A full pass of a large store then runs near
+			 * the speed of the device and does not evict the data
+			 * of other processes from the cache. Records are
+			 * visited in archive order, not insertion order.
+			 *
+			 * @param[in] visitor
+			 *	Called with the key and data of each record. The
+			 *	data is only valid until visitor returns, and
+			 *	visitor must not modify this store.
+			 * @param[in] chunkSize
+			 *	Bytes read at a time, rounded up to a multiple
+			 *	of the block size. Larger records are read
+			 *	whole.
+			 *
+			 * @return
+			 *	Number of records visited.
+			 *
+			 * @throw Error::NotImplemented
+			 *	Scanning is not supported on this platform.
+			 * @throw Error::StrategyError
+			 *	chunkSize is 0, or the archive could not be
+			 *	read or is truncated.
+			 * @note
+			 *	An exception thrown by visitor ends the scan and
+			 *	is rethrown.
+			 */
+			uint64_t scan(
+			    const std::function<void(const std::string &key,
+			    const RecordStore::RecordView &record)> &visitor,
+			    uint64_t chunkSize = DEFAULT_SCAN_CHUNK_SIZE) const;
 	
+			/** Where the data of one record is stored */
+			struct Extent
+			{
+				/** Path to the archive segment */
+				std::string file;
+				/** Offset of the data in file */
+				uint64_t offset;
+				/** Length of the data */
+				uint64_t size;
+			};
+			using Extent = struct Extent;
+
+			/**
+			 * @brief
+			 * Locate the records that sequence() returns next.
+			 * @details
+			 * The cursor is not moved. Records are not laid out
+			 * in sequence order once the archive is segmented
+			 * or compacted, so callers reading ahead, such as
+			 * RecordStorePrefetcher, use this to find the
+			 * segments and offsets about to be read.
+			 *
+			 * @param[in] bytes
+			 *	Locate records until their sizes total at least
+			 *	this many bytes, or no records remain.
+			 *
+			 * @return
+			 *	Location of each record, in sequence order.
+			 *	Empty records are left out.
+			 */
+			std::vector<Extent> getSequenceExtents(
+			    uint64_t bytes) const;
+
 			/**
 			 * Obtain the name of the file storing the data for 
 			 * this store.
 			 *
 			 * @return
-			 *	Path to archive file.
+			 *	Path to the archive segment appended to.
 			 */
 			std::string getArchiveName() const;
 	
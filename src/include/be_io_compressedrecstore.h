@@ -12,6 +12,8 @@
 #define __BE_IO_COMPRESSEDRECSTORE_H__
 
 #include <memory>
+#include <vector>
+
 #include <be_io_compressor.h>
 #include <be_io_recordstore.h>
 
@@ -22,6 +24,13 @@ namespace BiometricEvaluation
 		/**
 		 * @brief
 		 * Sibling-implemented IO::RecordStore with Compression.
+		 * @details
+		 * Each record is stored compressed, behind a small header
+		 * holding its uncompressed size and a checksum, so
+		 * length() and read() need a single lookup in the backing
+		 * store, and length() reads only the header. Stores
+		 * created before record headers, which keep sizes in a
+		 * second backing store, can still be opened and modified.
 		 */
 		class CompressedRecordStore : public RecordStore
 		{
@@ -107,15 +116,20 @@ namespace BiometricEvaluation
 			 */
 
 			/*
-                         * We need the base class insert() and replace() as well
-			 * otherwise, they are hidden by the declarations below.
+                         * We need the base class insert(), replace(), read()
+			 * and length() as well otherwise, they are hidden by
+			 * the declarations below.
                          */
                         using RecordStore::insert;
                         using RecordStore::replace;
+                        using RecordStore::read;
+                        using RecordStore::length;
 
 			uint64_t
 			getSpaceUsed() const override;
 			void sync() const override;
+			void setCommitPolicy(
+			    const CommitPolicy &policy) override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -165,6 +179,67 @@ namespace BiometricEvaluation
 			    const std::string &pathname)
 			    override;
 
+			/**
+			 * @brief
+			 * Compress records with a dictionary.
+			 * @details
+			 * The dictionary is saved with the RecordStore and
+			 * is loaded whenever the RecordStore is opened.
+			 * Because every record must be decompressed with
+			 * the dictionary it was compressed with, the
+			 * dictionary can only be set while the RecordStore
+			 * is empty.
+			 *
+			 * @param[in] dictionary
+			 *	Dictionary for the RecordStore's Compressor,
+			 *	likely from trainDictionary().
+			 *
+			 * @throw Error::NotImplemented
+			 *	Compressor does not support dictionaries.
+			 * @throw Error::StrategyError
+			 *	RecordStore is not empty, is read-only, or
+			 *	the dictionary could not be saved.
+			 */
+			void
+			setDictionary(
+			    const Memory::uint8Array &dictionary);
+
+			/**
+			 * @brief
+			 * Obtain the dictionary records are compressed with.
+			 *
+			 * @return
+			 *	Dictionary, or an empty buffer when no
+			 *	dictionary is used.
+			 */
+			Memory::uint8Array
+			getDictionary()
+			    const;
+
+			/**
+			 * @brief
+			 * Train and set a dictionary for compressing
+			 * records.
+			 * @details
+			 * Dictionaries mostly benefit small records that
+			 * resemble each other, like biometric templates.
+			 *
+			 * @param[in] samples
+			 *	Typical records that will be inserted.
+			 * @param[in] maxSize
+			 *	Largest size of the dictionary.
+			 *
+			 * @throw Error::NotImplemented
+			 *	Compressor does not support dictionaries.
+			 * @throw Error::StrategyError
+			 *	RecordStore is not empty, is read-only, or
+			 *	error training or saving the dictionary.
+			 */
+			void
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxSize = Compressor::DEFAULT_DICTIONARY_SIZE);
+
 			/**
 			 * @brief
 			 * Copy constructor (disabled).
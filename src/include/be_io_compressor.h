@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <be_error_exception.h>
 #include <be_framework_enumeration.h>
@@ -34,8 +35,13 @@ namespace BiometricEvaluation
 		public:
 			/** Kinds of Compressors (for factory) */
 			enum class Kind {
-				GZIP
+				GZIP,
+				ZSTD,
+				LZ4
 			};
+
+			/** Default upper bound of a trained dictionary */
+			static const uint64_t DEFAULT_DICTIONARY_SIZE = 64 * 1024;
 					
 			/**
 			 * @brief
@@ -269,6 +275,36 @@ namespace BiometricEvaluation
 			    const uint64_t compressedDataSize,
 			    const std::string &outputFile) const = 0;
 
+			/**
+			 * @brief
+			 * Decompress a compressed buffer into a buffer
+			 * of known size.
+			 * @details
+			 * Avoids growing and copying an output buffer when
+			 * the decompressed size was recorded elsewhere.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 * @param compressedDataSize
+			 *	Size of compressedData.
+			 * @param uncompressedData
+			 *	Buffer to hold the decompressed data.
+			 * @param uncompressedDataSize
+			 *	Exact size of the decompressed data.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit, or
+			 *	decompressed data is not
+			 *	uncompressedDataSize bytes.
+			 */
+			virtual void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
 			/**
 			 * @brief
 			 * Decompress a file.
@@ -371,6 +407,64 @@ namespace BiometricEvaluation
 			removeOption(
 			    const std::string &optionName);
 
+			/**
+			 * @brief
+			 * Use a dictionary when compressing and
+			 * decompressing.
+			 * @details
+			 * A dictionary primes the compressor with data
+			 * resembling what will be compressed, which mostly
+			 * benefits small buffers. Data must be decompressed
+			 * with the same dictionary it was compressed with.
+			 *
+			 * @param dictionary
+			 *	Dictionary, likely from trainDictionary(), or
+			 *	an empty buffer to use no dictionary.
+			 *
+			 * @throw Error::NotImplemented
+			 *	Compressor does not support dictionaries.
+			 * @throw Error::StrategyError
+			 *	dictionary could not be loaded.
+			 */
+			virtual void
+			setDictionary(
+			    const Memory::uint8Array &dictionary);
+
+			/**
+			 * @brief
+			 * Obtain the dictionary in use.
+			 *
+			 * @return
+			 *	Dictionary passed to setDictionary(), or an
+			 *	empty buffer if no dictionary is in use.
+			 */
+			virtual Memory::uint8Array
+			getDictionary()
+			    const;
+
+			/**
+			 * @brief
+			 * Build a dictionary from sample data.
+			 *
+			 * @param samples
+			 *	Typical uncompressed buffers.
+			 * @param maxSize
+			 *	Largest size of the dictionary.
+			 *
+			 * @return
+			 *	Dictionary for setDictionary().
+			 *
+			 * @throw Error::NotImplemented
+			 *	Compressor does not support dictionaries.
+			 * @throw Error::StrategyError
+			 *	Error building dictionary.
+			 */
+			virtual Memory::uint8Array
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxSize = DEFAULT_DICTIONARY_SIZE)
+			    const;
+
 			/** Destructor */
 			virtual ~Compressor();
 			
@@ -385,6 +479,9 @@ namespace BiometricEvaluation
 			 *
 			 * @throw Error::ObjectDoesNotExist
 			 *	Invalid compressor type.
+			 * @throw Error::NotImplemented
+			 *	Library was built without support for
+			 *	compressorKind.
 			 */
 			static std::shared_ptr<Compressor>
 			createCompressor(
@@ -84,6 +84,21 @@ namespace BiometricEvaluation {
 			read(
 			    const std::string &key) const override;
 
+			/**
+			 * @brief
+			 * Read several complete records from a store.
+			 * @details
+			 * Records are read in key order, the order of the
+			 * underlying B-tree, through a single cursor.
+			 *
+			 * @see RecordStore::read(const std::vector<
+			 * std::string>&)
+			 */
+			std::vector<Memory::uint8Array>
+			read(
+			    const std::vector<std::string> &keys)
+			    const override;
+
 			void insert(
 			    const std::string &key,
 			    const void *const data,
@@ -97,6 +112,10 @@ namespace BiometricEvaluation {
 			uint64_t length(
 			    const std::string &key) const override;
 
+			std::vector<uint64_t> length(
+			    const std::vector<std::string> &keys)
+			    const override;
+
 			void flush(
 			    const std::string &key) const override;
 
@@ -119,6 +138,8 @@ namespace BiometricEvaluation {
 
 			uint64_t getSpaceUsed() const override;
 			void sync() const override;
+			void setCommitPolicy(
+			    const CommitPolicy &policy) override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -76,11 +76,14 @@ namespace BiometricEvaluation {
 			 */
 
 			/*
-                         * We need the base class insert() and replace() as well
-			 * otherwise, they are hidden by the declarations below.
+                         * We need the base class insert(), replace(), read()
+			 * and length() as well otherwise, they are hidden by
+			 * the declarations below.
                          */
                         using RecordStore::insert;
                         using RecordStore::replace;
+                        using RecordStore::read;
+                        using RecordStore::length;
 
 			void insert(
 			    const std::string &key,
@@ -95,6 +98,10 @@ namespace BiometricEvaluation {
 			Memory::uint8Array read(
 			    const std::string &key) const override;
 
+			Memory::uint8Array readPrefix(
+			    const std::string &key,
+			    uint64_t size) const override;
+
 			void replace(
 			    const std::string &key,
 			    const void *const data,
@@ -123,8 +130,28 @@ namespace BiometricEvaluation {
 			    const std::string &pathname)
 			    override;
 
+			/**
+			 * @brief
+			 * Obtain an independent, read-only handle to this
+			 * RecordStore.
+			 * @details
+			 * The handle shares this object's list of keys, as
+			 * of this call, rather than reading the directory
+			 * of record files again.
+			 *
+			 * @see RecordStore::openReader()
+			 */
+			std::shared_ptr<RecordStore>
+			openReader()
+			    const override;
+
 			uint64_t getSpaceUsed() const override;
 			void sync() const override;
+			void setCommitPolicy(
+			    const CommitPolicy &policy) override;
+			void setKeyFilter(
+			    bool enabled) override;
+			bool getKeyFilter() const override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -139,6 +166,10 @@ namespace BiometricEvaluation {
 		private:
 			class Impl;
 			std::unique_ptr<FileRecordStore::Impl> pimpl;
+
+			/** Wrap an implementation (used by openReader()) */
+			FileRecordStore(
+			    std::unique_ptr<FileRecordStore::Impl> &&impl);
 		};
 	}
 }
@@ -114,6 +114,14 @@ namespace BiometricEvaluation
 			    const Memory::uint8Array &compressedData,
 			    const std::string &outputFile) const;
 
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
 			~GZip();
 		
 			/**
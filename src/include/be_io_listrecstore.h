@@ -68,11 +68,14 @@ namespace BiometricEvaluation
 			 */
 
 			/*
-                         * We need the base class insert() and replace() as well
-			 * otherwise, they are hidden by the declarations below.
+                         * We need the base class insert(), replace(), read()
+			 * and length() as well otherwise, they are hidden by
+			 * the declarations below.
                          */
                         using RecordStore::insert;
                         using RecordStore::replace;
+                        using RecordStore::read;
+                        using RecordStore::length;
 
 			void
 			insert(
@@ -0,0 +1,219 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_LZ4__
+#define __BE_IO_LZ4__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_compressor.h>
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * An IO::Compressor for LZ4 compression.
+		 * @details
+		 * Each buffer is compressed as a single LZ4 block, preceded
+		 * by its uncompressed size as a 32-bit little-endian
+		 * integer. This is not the LZ4 frame format, so compressed
+		 * files cannot be read by the lz4 command-line tool.
+		 * Buffers of 2 GiB or more cannot be compressed.
+		 *
+		 * @note
+		 * Only available when the library is built with LZ4.
+		 */
+		class LZ4 : public Compressor
+		{
+		public:
+			/*
+			 * LZ4 compressor property keys.
+			 */
+			/**
+			 * Trade compression ratio for speed. 1 is the
+			 * default; each increase is roughly 3% faster.
+			 */
+			static const std::string ACCELERATION;
+
+			/** Largest dictionary LZ4 can make use of */
+			static const uint64_t MAX_DICTIONARY_SIZE = 64 * 1024;
+
+			LZ4();
+
+			Memory::uint8Array
+			compress(
+			    const uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
+			Memory::uint8Array
+			compress(
+			    const Memory::uint8Array &uncompressedData)
+			    const;
+
+			void
+			compress(
+			    const uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize,
+			    const std::string &outputFile) const;
+
+			void
+			compress(
+			    const Memory::uint8Array &uncompressedData,
+			    const std::string &outputFile) const;
+
+			Memory::uint8Array
+			compress(
+			    const std::string &inputFile)
+			    const;
+
+			void
+			compress(
+			    const std::string &inputFile,
+			    const std::string &outputFile) const;
+
+			Memory::uint8Array
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize)
+			    const;
+
+			Memory::uint8Array
+			decompress(
+			    const Memory::uint8Array &compressedData)
+			    const;
+
+			Memory::uint8Array
+			decompress(
+			    const std::string &input)
+			    const;
+
+			void
+			decompress(
+			    const std::string &inputFile,
+			    const std::string &outputFile) const;
+
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    const uint64_t compressedDataSize,
+			    const std::string &outputFile) const;
+
+			void
+			decompress(
+			    const Memory::uint8Array &compressedData,
+			    const std::string &outputFile) const;
+
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
+			/**
+			 * @brief
+			 * Use a dictionary when compressing and
+			 * decompressing.
+			 * @details
+			 * Only the last MAX_DICTIONARY_SIZE bytes of
+			 * dictionary are used.
+			 *
+			 * @param dictionary
+			 *	Any data resembling that to be compressed,
+			 *	or an empty buffer to use no dictionary.
+			 */
+			void
+			setDictionary(
+			    const Memory::uint8Array &dictionary);
+
+			Memory::uint8Array
+			getDictionary()
+			    const;
+
+			/**
+			 * @brief
+			 * Build an LZ4 dictionary.
+			 * @details
+			 * LZ4 dictionaries are plain data that matches
+			 * may refer to. Samples are cut into segments,
+			 * and the segments whose content appears in the
+			 * most other samples are chosen, each piece of
+			 * content only once. The best segments are placed
+			 * last, since LZ4 finds matches most cheaply near
+			 * the end of the dictionary.
+			 *
+			 * @param samples
+			 *	Typical uncompressed buffers.
+			 * @param maxSize
+			 *	Largest size of the dictionary, no more than
+			 *	MAX_DICTIONARY_SIZE.
+			 *
+			 * @return
+			 *	Dictionary for setDictionary().
+			 *
+			 * @throw Error::StrategyError
+			 *	Samples share no content that fits within
+			 *	maxSize.
+			 */
+			Memory::uint8Array
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxSize = DEFAULT_DICTIONARY_SIZE)
+			    const;
+
+			~LZ4();
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be copied.
+			 *
+			 * @param other
+			 *	LZ4 to copy.
+			 */
+			LZ4(
+			    const LZ4 &other) = delete;
+
+    			/**
+			 * @brief
+			 * Assignment overload (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be assigned.
+			 *
+			 * @param other
+			 *	LZ4 to assign.
+			 *
+			 * @return
+			 *	lhs LZ4.
+			 */
+			LZ4&
+			operator=(
+			    const LZ4& other) = delete;
+
+		private:
+			class Impl;
+			/** Dictionary and a stream primed with it */
+			std::unique_ptr<Impl> pimpl;
+		};
+	}
+}
+
+#endif /* __BE_IO_LZ4__ */
@@ -10,6 +10,7 @@
 #ifndef __BE_IO_RECORDSTORE_H__
 #define __BE_IO_RECORDSTORE_H__
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
@@ -72,6 +73,81 @@ namespace BiometricEvaluation {
 			};
 			using Record = struct Record;
 
+			/**
+			 * @brief
+			 * A non-owning view of a record's data.
+			 * @details
+			 * The data belongs to the RecordStore that returned
+			 * the view, and remains valid only while that
+			 * RecordStore object exists and is not modified.
+			 */
+			struct RecordView {
+				/**
+				 * Default constructor.
+				 */
+				RecordView();
+
+				/**
+				 * @brief
+				 * Create a RecordView of existing data.
+				 * @param[in] data
+				 * The record's data (value).
+				 * @param[in] size
+				 * The size of data, in bytes.
+				 */
+				RecordView(
+				    const uint8_t *data,
+				    uint64_t size);
+
+				/**
+				 * @brief
+				 * Obtain an owning copy of the data.
+				 * @return
+				 * A copy of the data, which remains valid
+				 * after the RecordStore is closed.
+				 */
+				Memory::uint8Array
+				copy()
+				    const;
+
+				const uint8_t *data;
+				uint64_t size;
+			};
+			using RecordView = struct RecordView;
+
+			/** Throughput of mergeRecordStores() */
+			struct MergeStatistics {
+				/** Number of records merged */
+				uint64_t records{0};
+				/** Number of bytes of record data merged */
+				uint64_t bytes{0};
+				/** Elapsed time, in seconds */
+				double seconds{0};
+			};
+			using MergeStatistics = struct MergeStatistics;
+
+			/**
+			 * @brief
+			 * When changes to the number of records are
+			 * committed to the control file.
+			 * @details
+			 * The policy is only checked when a record is
+			 * inserted or removed; there is no timer, so an idle
+			 * store does not commit until its next change.
+			 * Changes are always committed by sync() and when
+			 * the RecordStore is destroyed. By default, changes
+			 * are only committed then.
+			 */
+			struct CommitPolicy {
+				/** Commit after this many changes, 0 for any */
+				uint64_t changes{0};
+				/** Commit on the first change made once the
+				    oldest uncommitted change is this old, 0
+				    for any age */
+				std::chrono::milliseconds delay{0};
+			};
+			using CommitPolicy = struct CommitPolicy;
+
 			using iterator = IO::RecordStoreIterator;
 
 			/** Possible types of RecordStore */
@@ -89,6 +165,8 @@ namespace BiometricEvaluation {
 				Compressed,
 				/** ListRecordStore */
 				List,
+				/** ShardedRecordStore */
+				Sharded,
 
 				/** "Default" RecordStore kind */
 				Default = BerkeleyDB
@@ -178,6 +256,64 @@ namespace BiometricEvaluation {
 			 */
 			virtual void sync() const = 0;
 
+			/**
+			 * @brief
+			 * Set when changes to the number of records are
+			 * committed to the control file.
+			 * @details
+			 * Until changes are committed, the control file
+			 * records that its count may be stale. A store
+			 * opened in that state, such as after a crash,
+			 * obtains its count from the backing storage.
+			 * Committing more often shortens the time in which
+			 * a crash leaves the count stale; committing less
+			 * often makes inserting and removing records
+			 * cheaper. Stores that do not keep a count in the
+			 * control file ignore the policy.
+			 *
+			 * @param[in] policy
+			 *	The commit policy.
+			 */
+			virtual void
+			setCommitPolicy(
+			    const CommitPolicy &policy);
+
+			/**
+			 * @brief
+			 * Enable or disable the key filter.
+			 * @details
+			 * A key filter is a Bloom filter of the keys in the
+			 * store, kept in memory and saved with the store.
+			 * It lets insert(), read(), length(), and
+			 * containsKey() find that a key is not present
+			 * without searching the backing storage. The filter
+			 * is built when enabled, and rebuilt when the store
+			 * is opened if the saved filter is out of date. The
+			 * setting is kept with the store.
+			 *
+			 * @param[in] enabled
+			 *	Whether to keep a key filter.
+			 *
+			 * @throw Error::NotImplemented
+			 *	This kind of RecordStore does not support a
+			 *	key filter.
+			 * @throw Error::StrategyError
+			 *	The RecordStore is opened read-only, or
+			 *	an error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual void
+			setKeyFilter(
+			    bool enabled);
+
+			/**
+			 * @return
+			 *	Whether the RecordStore keeps a key filter.
+			 */
+			virtual bool
+			getKeyFilter()
+			    const;
+
 			/**
 			 * Insert a record into the store.
 			 *
@@ -258,6 +394,57 @@ namespace BiometricEvaluation {
 			read(
 			    const std::string &key) const = 0;
 
+			/**
+			 * @brief
+			 * Read several complete records from a store.
+			 * @details
+			 * RecordStores may reorder and combine the reads to
+			 * suit the underlying storage. This implementation
+			 * calls read() for each key.
+			 *
+			 * @param[in] keys
+			 *	The keys of the records to be read. Keys may
+			 *	be repeated.
+			 * @return
+			 *	The records associated with keys, in the same
+			 *	order as keys.
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for one of the keys does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual std::vector<Memory::uint8Array>
+			read(
+			    const std::vector<std::string> &keys) const;
+
+			/**
+			 * @brief
+			 * Read the beginning of a record from a store.
+			 * @details
+			 * RecordStores may read less of the underlying
+			 * storage than read() would. This implementation
+			 * calls read() and truncates the record.
+			 *
+			 * @param[in] key
+			 *	The key of the record to be read.
+			 * @param[in] size
+			 *	The most bytes to read.
+			 * @return
+			 *	The first size bytes of the record associated
+			 *	with key, or the entire record if it is
+			 *	shorter.
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for the key does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual Memory::uint8Array
+			readPrefix(
+			    const std::string &key,
+			    uint64_t size) const;
+
 			/**
 			 * Replace a complete record in a RecordStore.
 			 *
@@ -315,6 +502,25 @@ namespace BiometricEvaluation {
 			virtual uint64_t length(
 			    const std::string &key) const = 0;
 
+			/**
+			 * @brief
+			 * Return the lengths of several records.
+			 * @details
+			 * This implementation calls length() for each key.
+			 *
+			 * @param[in] keys
+			 *	The keys of the records. Keys may be repeated.
+			 * @return
+			 *	The record lengths, in the same order as keys.
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for one of the keys does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual std::vector<uint64_t> length(
+			    const std::vector<std::string> &keys) const;
+
 			/**
 			 * Commit the record's data to storage.
 			 * @param[in] key
@@ -436,6 +642,29 @@ namespace BiometricEvaluation {
 			end()
 			    noexcept;
 
+			/**
+			 * @brief
+			 * Obtain an independent, read-only handle to this
+			 * RecordStore.
+			 * @details
+			 * This RecordStore is synchronized, then opened again
+			 * read-only. The new handle has its own cursor and its
+			 * own handles on the underlying storage, so each
+			 * thread of a pool may read from and sequence through
+			 * its own handle without locking. Records inserted
+			 * through this object afterward may not be visible to
+			 * the handle.
+			 *
+			 * @return
+			 *	A read-only object representing this store.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual std::shared_ptr<RecordStore>
+			openReader()
+			    const;
+
 			/**
 			 * @brief
 			 * Determine if a location appears to be a RecordStore.
@@ -512,7 +741,8 @@ namespace BiometricEvaluation {
 
 			/**
 			 * Remove a RecordStore by deleting all persistant
-			 * data associated with the store.
+			 * data associated with the store, including the
+			 * shards of a ShardedRecordStore.
 			 *
 			 * @param[in] pathname
 			 *	The name of the existing RecordStore.
@@ -529,6 +759,14 @@ namespace BiometricEvaluation {
 			 * @brief
 			 * Create a new RecordStore that contains the contents
 			 * of several other RecordStores.
+			 * @details
+			 * Records are copied in the order of pathnames. While
+			 * one RecordStore is copied, the next are read ahead
+			 * on other threads, a bounded amount at a time.
+			 * ArchiveRecordStores that do not need vacuuming are
+			 * appended to a new ArchiveRecordStore wholesale, and
+			 * records are inserted into a new SQLiteRecordStore in
+			 * batches.
 			 *
 			 * @param[in] mergePathname
 			 *	The path name of the new RecordStore that
@@ -545,13 +783,17 @@ namespace BiometricEvaluation {
 			 *	A function to be called during long operations
 			 *	to determine whether to interrupt and return.
 			 *
+			 * @return
+			 *	The amount of data merged, and the time taken.
+			 *
 			 * @throw Error::ObjectExists
-			 *	A RecordStore at mergePathname already exists.
+			 *	A RecordStore at mergePathname already exists,
+			 *	or a key appears in more than one RecordStore.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
 			 *	storage system.
 			 */
-			static void mergeRecordStores(
+			static MergeStatistics mergeRecordStores(
 			    const std::string &mergePathname,
 			    const std::string &description,
 			    const IO::RecordStore::Kind &kind,
@@ -0,0 +1,235 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef BE_IO_RECORDSTOREPREFETCHER_H_
+#define BE_IO_RECORDSTOREPREFETCHER_H_
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+
+#include <be_io_recordstore.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * Sequence a RecordStore on a background thread.
+		 *
+		 * @details
+		 * Records are read ahead, in sequence order, into a bounded
+		 * queue limited both by number of records and by bytes of
+		 * record data, so that the consumer of the records does not
+		 * wait on storage while it works on the previous record.
+		 * Where the RecordStore can locate the records it sequences
+		 * next (ArchiveRecordStore), the operating system is also
+		 * advised to read them ahead of the background thread.
+		 *
+		 * The RecordStore is sequenced from the start when the
+		 * RecordStorePrefetcher is constructed, and must not be
+		 * used by any other thread until the RecordStorePrefetcher
+		 * is destroyed. Use RecordStore::openReader() to obtain a
+		 * RecordStore that is not shared.
+		 *
+		 * @code
+		 * IO::RecordStorePrefetcher prefetcher(rs->openReader());
+		 * for (const auto &record : prefetcher)
+		 *	process(record.key, record.data);
+		 * @endcode
+		 */
+		class RecordStorePrefetcher
+		{
+		public:
+			class Iterator;
+			using iterator = Iterator;
+
+			/** Default maximum number of records read ahead */
+			static const uint64_t DEFAULT_DEPTH = 1024;
+			/** Default maximum bytes of record data read ahead */
+			static const uint64_t DEFAULT_BYTES = 64 * 1024 * 1024;
+
+			/**
+			 * @brief
+			 * Begin reading ahead.
+			 *
+			 * @param[in] recordStore
+			 *	RecordStore to sequence.
+			 * @param[in] depth
+			 *	Maximum number of records read ahead.
+			 * @param[in] bytes
+			 *	Maximum bytes of record data read ahead. A
+			 *	single record larger than bytes is still
+			 *	read ahead when the queue is empty.
+			 *
+			 * @throw Error::ParameterError
+			 *	recordStore is nullptr, or depth or bytes is 0.
+			 */
+			RecordStorePrefetcher(
+			    const std::shared_ptr<RecordStore> &recordStore,
+			    uint64_t depth = DEFAULT_DEPTH,
+			    uint64_t bytes = DEFAULT_BYTES);
+
+			/** Stop reading ahead, discarding queued records. */
+			~RecordStorePrefetcher();
+
+			/** @return The RecordStore being sequenced. */
+			std::shared_ptr<RecordStore>
+			getRecordStore()
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the next record in sequence.
+			 *
+			 * @param[out] record
+			 *	The next record.
+			 *
+			 * @return
+			 *	false when all records have been returned.
+			 *
+			 * @throw Error::Exception
+			 *	Error encountered while reading ahead, rethrown
+			 *	once all records read before it have been
+			 *	returned.
+			 */
+			bool
+			next(
+			    RecordStore::Record &record);
+
+			/**
+			 * @return
+			 * Iterator to the next record in sequence.
+			 *
+			 * @note
+			 * Records are consumed when iterated, so only one
+			 * pass may be made over a RecordStorePrefetcher.
+			 */
+			iterator
+			begin();
+
+			/** @return Iterator past the last record. */
+			iterator
+			end();
+
+			/* Prevent copying of RecordStorePrefetcher objects */
+			RecordStorePrefetcher(
+			    const RecordStorePrefetcher&) = delete;
+			RecordStorePrefetcher& operator=(
+			    const RecordStorePrefetcher&) = delete;
+
+		private:
+			class Impl;
+			/** Pointer to implementation */
+			std::unique_ptr<Impl> pimpl;
+		};
+
+		/**
+		 * @brief
+		 * Input iterator over the records of a
+		 * RecordStorePrefetcher.
+		 */
+		class RecordStorePrefetcher::Iterator
+		{
+		public:
+			/*
+			 * Satisfy std::iterator_traits<> expectations.
+			 */
+
+			/** Type of iterator */
+			using iterator_category = std::input_iterator_tag;
+			/** Type when dereferencing iterators */
+			using value_type = RecordStore::Record;
+			/** Type used to measure distance between iterators */
+			using difference_type = std::ptrdiff_t;
+			/** Pointer to the type iterated over */
+			using pointer = value_type*;
+			/** Reference to the type iterated over */
+			using reference = value_type&;
+
+			/**
+			 * @brief
+			 * Default constructor.
+			 * @details
+			 * Creates "end" iterator.
+			 */
+			Iterator() = default;
+
+			/**
+			 * @brief
+			 * Constructor.
+			 *
+			 * @param prefetcher
+			 * RecordStorePrefetcher that will be iterated over,
+			 * or nullptr for the "end" iterator.
+			 *
+			 * @note
+			 * Iterator does not retain any ownership of
+			 * prefetcher.
+			 */
+			Iterator(
+			    RecordStorePrefetcher *prefetcher);
+
+			/** @return Reference to a Record. */
+			reference
+			operator*();
+
+			/** @return A dereferenced Record. */
+			pointer
+			operator->();
+
+			/** @return Self after advancing. */
+			Iterator&
+			operator++();
+
+			/**
+			 * @brief
+			 * Equivalence operator.
+			 *
+			 * @param rhs
+			 * Reference to Iterator being compared.
+			 *
+			 * @return
+			 * Whether or not this is equivalent to rhs.
+			 */
+			bool
+			operator==(
+			    const Iterator &rhs)
+			    const;
+
+			/**
+			 * @brief
+			 * Non-equivalence operator.
+			 *
+			 * @param rhs
+			 * Reference to Iterator being compared.
+			 *
+			 * @return
+			 * Whether or not this is not equivalent to rhs.
+			 */
+			inline bool
+			operator!=(
+			    const Iterator &rhs)
+			    const
+			{
+				return (!(*this == rhs));
+			}
+
+		private:
+			/** Unowned pointer, nullptr once at the end */
+			RecordStorePrefetcher *_prefetcher{nullptr};
+			/** Current record returned when dereferencing */
+			value_type _currentRecord{};
+		};
+	}
+}
+
+#endif /* BE_IO_RECORDSTOREPREFETCHER_H_ */
@@ -32,6 +32,12 @@ namespace BiometricEvaluation
 		 * @details
 		 * A RecordStoreUnion object is not copyable due to the
 		 * fact that most RecordStore objects are not copyable.
+		 *
+		 * By default, operations visit each member RecordStore in
+		 * turn. After setLookupThreads(), they visit member
+		 * RecordStores concurrently, so an operation takes about
+		 * as long as the slowest member RecordStore instead of the
+		 * sum of all member RecordStores.
 		 */
 		class RecordStoreUnion
 		{
@@ -216,6 +222,68 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    const;
 
+			/**
+			 * @brief
+			 * Read a key from whichever member RecordStore
+			 * produces it first.
+			 * @details
+			 * When looking up keys concurrently, lookups in
+			 * other member RecordStores that have not yet
+			 * started are cancelled once the key is found,
+			 * and those already started are waited for, so
+			 * no member RecordStore is in use once this
+			 * returns. Otherwise, member RecordStores are
+			 * searched in name order.
+			 *
+			 * @param key
+			 * The key to read.
+			 *
+			 * @return
+			 * Pair of RecordStore name and the data read from
+			 * said RecordStore.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * key does not exist in any member RecordStores.
+			 * @throw Error::StrategyError
+			 * key was not found, and a member RecordStore
+			 * threw an exception other than ObjectDoesNotExist.
+			 */
+			std::pair<const std::string,
+			BiometricEvaluation::Memory::uint8Array>
+			readFirst(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Look up keys in member RecordStores concurrently.
+			 * @details
+			 * Lookups run on a pool of threads that is shared
+			 * by every RecordStoreUnion using the same number
+			 * of threads, and that persists while any of them
+			 * exist. Results are still returned in name order.
+			 *
+			 * @param threadCount
+			 * Number of threads in the pool, or 0 to visit
+			 * each member RecordStore in turn on the calling
+			 * thread (the default).
+			 *
+			 * @throw Error::StrategyError
+			 * Could not start threads.
+			 */
+			void
+			setLookupThreads(
+			    uint32_t threadCount);
+
+			/**
+			 * @return
+			 * Number of threads used to look up keys
+			 * concurrently, or 0 if lookups are serial.
+			 */
+			uint32_t
+			getLookupThreads()
+			    const;
+
 			/* Prevent copying of RecordStoreUnion objects */
 			RecordStoreUnion(const RecordStoreUnion&) = delete;
 			RecordStoreUnion& operator=(const RecordStoreUnion&)
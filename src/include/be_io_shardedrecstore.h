@@ -0,0 +1,333 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_SHARDEDRECSTORE_H__
+#define __BE_IO_SHARDEDRECSTORE_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_io_recordstore.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * A RecordStore whose records are spread over several
+		 * other RecordStores.
+		 * @details
+		 * Each record is kept in one of a fixed number of shards,
+		 * RecordStores of any single kind, chosen by a hash of the
+		 * record's key. Shards may be kept within the
+		 * ShardedRecordStore's directory or placed elsewhere, such
+		 * as on separate disks, so that storage and locking are
+		 * not confined to a single file system.
+		 *
+		 * insert(), replace(), remove(), read(), length(),
+		 * containsKey() and flush() may be called from several
+		 * threads at once; calls for keys kept in different shards
+		 * proceed in parallel. Reads of several keys at once, and
+		 * sync(), are carried out on all shards concurrently.
+		 *
+		 * Records are sequenced one shard after another. When
+		 * sequencing with data from the start, all shards are
+		 * read ahead at once, a bounded amount at a time, and
+		 * only the records present when sequencing began are
+		 * returned. Sequencing is not thread-safe.
+		 *
+		 * The number of records is the sum of the shards' counts,
+		 * and is not kept in the ShardedRecordStore's own control
+		 * file.
+		 */
+		class ShardedRecordStore : public RecordStore
+		{
+		public:
+			/** Shards in a ShardedRecordStore made by
+			    RecordStore::createRecordStore() */
+			static const uint32_t DEFAULT_SHARD_COUNT = 4;
+
+			/**
+			 * Create a new ShardedRecordStore whose shards are
+			 * kept within its own directory, read/write mode.
+			 *
+			 * @param[in] pathname
+			 * 	The directory where the store is to be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardCount
+			 *	The number of shards.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	The store already exists.
+			 * @throw Error::ParameterError
+			 *	shardCount is 0, or shardKind cannot be
+			 *	used as a shard.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			ShardedRecordStore(
+			    const std::string &pathname,
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    uint32_t shardCount);
+
+			/**
+			 * Create a new ShardedRecordStore with shards at
+			 * the given locations, read/write mode.
+			 *
+			 * @param[in] pathname
+			 * 	The directory where the store is to be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardPathnames
+			 *	The directory where each shard is to be
+			 *	created, likely on different file systems.
+			 *	Relative path names are made absolute.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	The store or one of the shards already exists.
+			 * @throw Error::ParameterError
+			 *	shardPathnames is empty, or shardKind cannot
+			 *	be used as a shard.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			ShardedRecordStore(
+			    const std::string &pathname,
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    const std::vector<std::string> &shardPathnames);
+
+			/**
+			 * Open an existing ShardedRecordStore.
+			 *
+			 * @param[in] pathname
+			 *	The path name of the store.
+			 * @param[in] mode
+			 *	Open mode, read-only or read-write.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	The store does not exist.
+			 * @throw Error::StrategyError
+			 *	A shard could not be opened, or an error
+			 *	occurred when accessing the underlying file
+			 *	system.
+			 */
+			ShardedRecordStore(
+			    const std::string &pathname,
+			    IO::Mode mode = IO::Mode::ReadOnly);
+
+			/*
+			 * Destructor.
+			 */
+			~ShardedRecordStore();
+
+			/*
+			 * Implementation of the RecordStore interface.
+			 */
+
+			/*
+			 * We need the base class insert(), replace(), read()
+			 * and length() as well otherwise, they are hidden by
+			 * the declarations below.
+			 */
+			using RecordStore::insert;
+			using RecordStore::replace;
+			using RecordStore::read;
+			using RecordStore::length;
+
+			uint64_t
+			getSpaceUsed() const override;
+			void sync() const override;
+			void setCommitPolicy(
+			    const CommitPolicy &policy) override;
+			unsigned int getCount() const override;
+			std::string getPathname() const override;
+			std::string getDescription() const override;
+			void changeDescription(
+			    const std::string &description) override;
+
+			void
+			insert(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size)
+			    override;
+
+			void
+			replace(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size)
+			    override;
+
+			void
+			remove(
+			    const std::string &key) override;
+
+			Memory::uint8Array
+			read(
+			    const std::string &key) const override;
+
+			/**
+			 * @brief
+			 * Read several complete records from a store.
+			 * @details
+			 * Keys are grouped by shard, and the shards are
+			 * read concurrently.
+			 *
+			 * @param[in] keys
+			 *	The keys of the records to be read. Keys may
+			 *	be repeated.
+			 * @return
+			 *	The records associated with keys, in the same
+			 *	order as keys.
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for one of the keys does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			std::vector<Memory::uint8Array>
+			read(
+			    const std::vector<std::string> &keys)
+			    const override;
+
+			Memory::uint8Array
+			readPrefix(
+			    const std::string &key,
+			    uint64_t size) const override;
+
+			uint64_t
+			length(
+			    const std::string &key) const override;
+
+			/**
+			 * @brief
+			 * Obtain the lengths of several records.
+			 * @details
+			 * Keys are grouped by shard, and the shards are
+			 * queried concurrently.
+			 *
+			 * @param[in] keys
+			 *	The keys of the records. Keys may be
+			 *	repeated.
+			 * @return
+			 *	The lengths of the records associated with
+			 *	keys, in the same order as keys.
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for one of the keys does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			std::vector<uint64_t>
+			length(
+			    const std::vector<std::string> &keys)
+			    const override;
+
+			void
+			flush(
+			    const std::string &key) const override;
+
+			RecordStore::Record
+			sequence(
+			    int cursor = BE_RECSTORE_SEQ_NEXT)
+			    override;
+
+			std::string
+			sequenceKey(
+			    int cursor = BE_RECSTORE_SEQ_NEXT)
+			    override;
+
+			void
+			setCursorAtKey(
+			    const std::string &key)
+			    override;
+
+			/**
+			 * @brief
+			 * Move the RecordStore.
+			 * @details
+			 * Shards kept within the RecordStore's directory
+			 * move with it; shards kept elsewhere do not.
+			 *
+			 * @param[in] pathname
+			 *	The new path name of the RecordStore.
+			 *
+			 * @throw Error::ObjectExists
+			 *	Something exists at pathname.
+			 * @throw Error::StrategyError
+			 *	RecordStore is read-only, or an error
+			 *	occurred when using the underlying storage
+			 *	system.
+			 */
+			void
+			move(
+			    const std::string &pathname)
+			    override;
+
+			/** @return Number of shards. */
+			uint32_t
+			getShardCount()
+			    const;
+
+			/** @return Path name of each shard, in shard order. */
+			std::vector<std::string>
+			getShardPathnames()
+			    const;
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because this object could represent a
+			 * file on disk.
+			 *
+			 * @param rhs
+			 *	ShardedRecordStore object to copy.
+			 */
+			ShardedRecordStore(
+			    const ShardedRecordStore &rhs) = delete;
+
+			/**
+			 * @brief
+			 * Assignment operator (disabled).
+			 * @details
+			 * Disabled because this object could represent a
+			 * file on disk.
+			 *
+			 * @param rhs
+			 *	ShardedRecordStore object to assign.
+			 *
+			 * @return
+			 * 	ShardedRecordStore object, now containing
+			 *	the contents of rhs.
+			 */
+			ShardedRecordStore&
+			operator=(
+			    const ShardedRecordStore &rhs) = delete;
+
+		private:
+			class Impl;
+			std::unique_ptr<ShardedRecordStore::Impl> pimpl;
+		};
+	}
+}
+#endif	/* __BE_IO_SHARDEDRECSTORE_H__ */
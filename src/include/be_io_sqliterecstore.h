@@ -11,6 +11,8 @@
 #ifndef __BE_IO_SQLITERECORDSTORE_H__
 #define __BE_IO_SQLITERECORDSTORE_H__
 
+#include <vector>
+
 #include <be_io_recordstore.h>
 
 namespace BiometricEvaluation
@@ -25,6 +27,15 @@ namespace BiometricEvaluation
 		class SQLiteRecordStore : public RecordStore
 		{
 		public:
+			/** Journaling and synchronization of the database */
+			enum class JournalProfile
+			{
+				/** Rollback journal, synchronous FULL */
+				Default,
+				/** Write-ahead log, synchronous NORMAL */
+				WriteAheadLog
+			};
+
 			SQLiteRecordStore(
 			    const std::string &pathname,
 			    const std::string &description);
@@ -45,7 +56,24 @@ namespace BiometricEvaluation
 			    const std::string &pathname)
 			    override;
 
+			/**
+			 * @brief
+			 * Obtain an independent, read-only handle to this
+			 * RecordStore.
+			 * @details
+			 * Handles from openReader() share one SQLite page
+			 * cache, so a page read through one handle is not
+			 * read from the database file again by another.
+			 *
+			 * @see RecordStore::openReader()
+			 */
+			std::shared_ptr<RecordStore>
+			openReader()
+			    const override;
+
 			void sync() const override;
+			void setCommitPolicy(
+			    const CommitPolicy &policy) override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -65,6 +93,53 @@ namespace BiometricEvaluation
 			    const uint64_t size)
 			    override;
 
+			/**
+			 * @brief
+			 * Insert many records in a single transaction.
+			 * @details
+			 * Either all records are inserted, or none are.
+			 * Batches avoid the cost of committing, and
+			 * synchronizing the database, once per record.
+			 *
+			 * @param[in] records
+			 *	Records to insert.
+			 *
+			 * @throw Error::ObjectExists
+			 *	A key already exists in the store, or is
+			 *	repeated within records.
+			 * @throw Error::StrategyError
+			 *	The RecordStore was opened read-only, a key is
+			 *	invalid, or an error occurred when using the
+			 *	underlying database.
+			 */
+			void
+			insertBatch(
+			    const std::vector<RecordStore::Record> &records);
+
+			/**
+			 * @brief
+			 * Change how the database journals and synchronizes
+			 * transactions.
+			 * @details
+			 * The write-ahead log speeds up inserts considerably
+			 * and allows readers while writing, at the risk of
+			 * losing the most recent transactions (but not of
+			 * corruption) on power loss. The journal mode
+			 * persists in the database; the synchronous setting
+			 * lasts while this object is open.
+			 *
+			 * @param[in] profile
+			 *	Journaling profile to use.
+			 *
+			 * @throw Error::StrategyError
+			 *	The RecordStore was opened read-only, or an
+			 *	error occurred when using the underlying
+			 *	database.
+			 */
+			void
+			setJournalProfile(
+			    JournalProfile profile);
+
 			void 
 			remove(
 			    const std::string &key)
@@ -74,9 +149,44 @@ namespace BiometricEvaluation
 			read(
 			    const std::string &key) const override;
 
+			/**
+			 * @brief
+			 * Read several complete records from a store.
+			 * @details
+			 * Records are read in rowid order, with runs of
+			 * consecutive rows read by a single query.
+			 *
+			 * @see RecordStore::read(const std::vector<
+			 * std::string>&)
+			 */
+			std::vector<Memory::uint8Array>
+			read(
+			    const std::vector<std::string> &keys)
+			    const override;
+
+			/**
+			 * @brief
+			 * Read the beginning of a record from a store.
+			 * @details
+			 * Only the pages holding the beginning of the
+			 * record are read.
+			 *
+			 * @see RecordStore::readPrefix()
+			 */
+			Memory::uint8Array
+			readPrefix(
+			    const std::string &key,
+			    uint64_t size)
+			    const override;
+
 			uint64_t
 			length(
 			    const std::string &key) const override;
+
+			std::vector<uint64_t>
+			length(
+			    const std::vector<std::string> &keys)
+			    const override;
 			    
 			void
 			flush(
@@ -108,6 +218,10 @@ namespace BiometricEvaluation
 		private:
 			class Impl;
 			std::unique_ptr<SQLiteRecordStore::Impl> pimpl;
+
+			/** Wrap an implementation (used by openReader()) */
+			SQLiteRecordStore(
+			    std::unique_ptr<SQLiteRecordStore::Impl> &&impl);
 		};
 	}
 }
@@ -0,0 +1,193 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_ZSTD__
+#define __BE_IO_ZSTD__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_compressor.h>
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * An IO::Compressor for Zstandard compression.
+		 * @details
+		 * Each buffer is compressed as a single Zstandard frame
+		 * that records the uncompressed size, so buffers are
+		 * decompressed in one step. Compression and decompression
+		 * contexts, and any dictionary, are prepared once and
+		 * reused.
+		 *
+		 * @note
+		 * Only available when the library is built with Zstandard.
+		 */
+		class Zstd : public Compressor
+		{
+		public:
+			/*
+			 * Zstandard compressor property keys.
+			 */
+			/** How thorough the compression should be */
+			static const std::string COMPRESSION_LEVEL;
+
+			Zstd();
+
+			Memory::uint8Array
+			compress(
+			    const uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
+			Memory::uint8Array
+			compress(
+			    const Memory::uint8Array &uncompressedData)
+			    const;
+
+			void
+			compress(
+			    const uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize,
+			    const std::string &outputFile) const;
+
+			void
+			compress(
+			    const Memory::uint8Array &uncompressedData,
+			    const std::string &outputFile) const;
+
+			Memory::uint8Array
+			compress(
+			    const std::string &inputFile)
+			    const;
+
+			void
+			compress(
+			    const std::string &inputFile,
+			    const std::string &outputFile) const;
+
+			Memory::uint8Array
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize)
+			    const;
+
+			Memory::uint8Array
+			decompress(
+			    const Memory::uint8Array &compressedData)
+			    const;
+
+			Memory::uint8Array
+			decompress(
+			    const std::string &input)
+			    const;
+
+			void
+			decompress(
+			    const std::string &inputFile,
+			    const std::string &outputFile) const;
+
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    const uint64_t compressedDataSize,
+			    const std::string &outputFile) const;
+
+			void
+			decompress(
+			    const Memory::uint8Array &compressedData,
+			    const std::string &outputFile) const;
+
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
+			void
+			setDictionary(
+			    const Memory::uint8Array &dictionary);
+
+			Memory::uint8Array
+			getDictionary()
+			    const;
+
+			/**
+			 * @brief
+			 * Train a Zstandard dictionary.
+			 *
+			 * @param samples
+			 *	Typical uncompressed buffers. Zstandard needs
+			 *	many samples, totalling roughly 100 times
+			 *	maxSize, to train a useful dictionary.
+			 * @param maxSize
+			 *	Largest size of the dictionary.
+			 *
+			 * @return
+			 *	Dictionary for setDictionary().
+			 *
+			 * @throw Error::StrategyError
+			 *	Too few samples, or error in training.
+			 */
+			Memory::uint8Array
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxSize = DEFAULT_DICTIONARY_SIZE)
+			    const;
+
+			~Zstd();
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be copied.
+			 *
+			 * @param other
+			 *	Zstd to copy.
+			 */
+			Zstd(
+			    const Zstd &other) = delete;
+
+    			/**
+			 * @brief
+			 * Assignment overload (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be assigned.
+			 *
+			 * @param other
+			 *	Zstd to assign.
+			 *
+			 * @return
+			 *	lhs Zstd.
+			 */
+			Zstd&
+			operator=(
+			    const Zstd& other) = delete;
+
+		private:
+			class Impl;
+			/** Zstandard contexts and dictionary */
+			std::unique_ptr<Impl> pimpl;
+		};
+	}
+}
+
+#endif /* __BE_IO_ZSTD__ */
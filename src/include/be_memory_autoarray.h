@@ -267,6 +267,65 @@ namespace BiometricEvaluation
 				resize(
 				    size_type new_size,
 				    bool free = false);
+
+				/**
+				 * @brief
+				 * Obtain the number of elements allocated.
+				 *
+				 * @return
+				 *	Number of elements that may be accessed
+				 *	after resize() without reallocating.
+				 */
+				size_type
+				capacity()
+				    const;
+
+				/**
+				 * @brief
+				 * Allocate storage for a number of elements
+				 * without changing size().
+				 *
+				 * @param[in] new_capacity
+				 *	Number of elements the AutoArray should
+				 *	have allocated. Storage is never made
+				 *	smaller.
+				 *
+				 * @throw Error::MemoryError
+				 *	Problem allocating memory.
+				 */
+				void
+				reserve(
+				    size_type new_capacity);
+
+				/**
+				 * @brief
+				 * Deep-copy the contents of a buffer onto the
+				 * end of this AutoArray.
+				 * @details
+				 * When more storage is needed, capacity() is at
+				 * least doubled, so building an AutoArray with
+				 * many calls to append() copies each element a
+				 * constant number of times on average.
+				 *
+				 * @param[in] buffer
+				 *	An allocated buffer whose contents
+				 *	will be deep-copied into this object.
+				 * @param[in] size
+				 *	The number of elements from buffer
+				 *	that will be deep-copied.
+				 *
+				 * @throw Error::MemoryError
+				 *	Problem allocating memory.
+				 *
+				 * @warning
+				 * size must be less than or equal to the size
+				 * of buffer, and buffer must not be part of this
+				 * AutoArray.
+				 */
+				void
+				append(
+				    const T *buffer,
+				    size_type size);
 				    
 				/**
 				 * @brief
@@ -530,6 +589,57 @@ BiometricEvaluation::Memory::AutoArray<T>::resize(
 	_size = _capacity = new_size;
 }
 
+template<class T>
+typename BiometricEvaluation::Memory::AutoArray<T>::size_type
+BiometricEvaluation::Memory::AutoArray<T>::capacity()
+    const
+{
+	return (_capacity);
+}
+
+template<class T>
+void
+BiometricEvaluation::Memory::AutoArray<T>::reserve(
+    size_type new_capacity)
+{
+	if (new_capacity <= _capacity)
+		return;
+
+	T* new_data = new (std::nothrow) T[new_capacity];
+	if (new_data == nullptr)
+		throw Error::MemoryError("Could not allocate data");
+	std::copy(&_data[0], &_data[_size], new_data);
+
+	if (_data != nullptr)
+		delete [] _data;
+	_data = new_data;
+	_capacity = new_capacity;
+}
+
+template<class T>
+void
+BiometricEvaluation::Memory::AutoArray<T>::append(
+    const T *buffer,
+    size_type size)
+{
+	if (size == 0)
+		return;
+	if (size > (std::numeric_limits<size_type>::max() - _size))
+		throw Error::MemoryError("Could not allocate data");
+
+	/* Grow geometrically, so repeated appends are amortized O(1) */
+	const size_type new_size = _size + size;
+	if (new_size > _capacity) {
+		size_type new_capacity = new_size;
+		if (_capacity <= (std::numeric_limits<size_type>::max() / 2))
+			new_capacity = std::max(new_size, _capacity * 2);
+		this->reserve(new_capacity);
+	}
+
+	std::copy(&buffer[0], &buffer[size], &_data[_size]);
+	_size = new_size;
+}
+
 template<class T>
 void
 BiometricEvaluation::Memory::AutoArray<T>::copy(
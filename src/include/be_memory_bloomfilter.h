@@ -0,0 +1,173 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_MEMORY_BLOOMFILTER__
+#define __BE_MEMORY_BLOOMFILTER__
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace BiometricEvaluation
+{
+	namespace Memory
+	{
+		/**
+		 * @brief
+		 * A set of strings that answers membership queries
+		 * approximately, in little memory.
+		 * @details
+		 * mayContain() is always true for a string that was
+		 * inserted. For other strings it is false, except with a
+		 * probability near the false positive rate the filter
+		 * was sized for, as long as no more strings than the
+		 * capacity were inserted. Strings cannot be removed.
+		 *
+		 * Strings are hashed the same way on every host, so a
+		 * filter may be saved from getBits() and restored.
+		 */
+		class BloomFilter
+		{
+			public:
+				/** False positive rate used when none is given */
+				static constexpr double
+				    DEFAULT_FALSE_POSITIVE_RATE = 0.01;
+
+				/**
+				 * @brief
+				 * Create an empty filter.
+				 *
+				 * @param capacity
+				 * Number of strings the filter is sized for.
+				 * @param falsePositiveRate
+				 * Rate of false positives when capacity
+				 * strings have been inserted.
+				 *
+				 * @throw Error::ParameterError
+				 * capacity is 0, or falsePositiveRate is not
+				 * between 0 and 1.
+				 */
+				BloomFilter(
+				    uint64_t capacity,
+				    double falsePositiveRate =
+				    DEFAULT_FALSE_POSITIVE_RATE);
+
+				/**
+				 * @brief
+				 * Restore a filter.
+				 *
+				 * @param capacity
+				 * Value of getCapacity() for the saved filter.
+				 * @param size
+				 * Value of getSize() for the saved filter.
+				 * @param hashCount
+				 * Value of getHashCount() for the saved filter.
+				 * @param bits
+				 * Value of getBits() for the saved filter.
+				 *
+				 * @throw Error::ParameterError
+				 * hashCount or bits is empty.
+				 */
+				BloomFilter(
+				    uint64_t capacity,
+				    uint64_t size,
+				    uint32_t hashCount,
+				    std::vector<uint64_t> bits);
+
+				/**
+				 * @brief
+				 * Add a string to the filter.
+				 *
+				 * @param key
+				 * String to add.
+				 */
+				void
+				insert(
+				    std::string_view key);
+
+				/**
+				 * @brief
+				 * Test whether a string may have been added.
+				 *
+				 * @param key
+				 * String to look for.
+				 *
+				 * @return
+				 * false if key was never inserted, true if
+				 * it probably was.
+				 */
+				bool
+				mayContain(
+				    std::string_view key)
+				    const;
+
+				/**
+				 * @return
+				 * Number of strings the filter is sized for.
+				 */
+				uint64_t
+				getCapacity()
+				    const;
+
+				/**
+				 * @return
+				 * Number of calls made to insert().
+				 */
+				uint64_t
+				getSize()
+				    const;
+
+				/**
+				 * @return
+				 * Number of bits set for each string.
+				 */
+				uint32_t
+				getHashCount()
+				    const;
+
+				/**
+				 * @return
+				 * The bits of the filter.
+				 */
+				const std::vector<uint64_t> &
+				getBits()
+				    const;
+
+			private:
+				/** Number of strings the filter is sized for */
+				uint64_t _capacity;
+				/** Number of strings inserted */
+				uint64_t _size;
+				/** Number of bits set for each string */
+				uint32_t _hashCount;
+				/** The bits, in 64-bit words */
+				std::vector<uint64_t> _bits;
+
+				/**
+				 * @brief
+				 * Hash a string, independently of the host.
+				 *
+				 * @param key
+				 * String to hash.
+				 * @param h1
+				 * First hash of key.
+				 * @param h2
+				 * Second hash of key, odd.
+				 */
+				static void
+				hash(
+				    std::string_view key,
+				    uint64_t &h1,
+				    uint64_t &h2);
+		};
+	}
+}
+
+#endif /* __BE_MEMORY_BLOOMFILTER__ */
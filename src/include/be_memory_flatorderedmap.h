@@ -0,0 +1,863 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_MEMORY_FLATORDEREDMAP_H__
+#define __BE_MEMORY_FLATORDEREDMAP_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace BiometricEvaluation
+{
+	namespace Memory
+	{
+		/**
+		 * @brief
+		 * Default hash function for FlatOrderedMap keys.
+		 * @details
+		 * std::string keys are hashed as std::string_view, so that
+		 * maps keyed by std::string may be searched with a
+		 * std::string_view or a C string without a copy.
+		 */
+		template<class Key>
+		struct FlatOrderedMapHash : public std::hash<Key> {};
+
+		/** Hash std::string keys as std::string_view. */
+		template<>
+		struct FlatOrderedMapHash<std::string> :
+		    public std::hash<std::string_view> {};
+
+		/**
+		 * @brief
+		 * Iterator for FlatOrderedMaps.
+		 * @details
+		 * Iterators refer to a position in insertion order, so
+		 * they remain valid when elements are added to the map.
+		 * They are invalidated by erase() and clear().
+		 */
+		template<class Map, class Value>
+		class FlatOrderedMapIterator
+		{
+		public:
+			/*
+			 * Satisfy std::iterator_traits<> expectations.
+			 */
+
+			/** Type of iterator */
+			using iterator_category =
+			    std::bidirectional_iterator_tag;
+			/** Type when dereferencing iterators */
+			using value_type = std::remove_const_t<Value>;
+			/** Type used to measure distance between iterators */
+			using difference_type = std::ptrdiff_t;
+			/** Pointer to the type iterated over */
+			using pointer = Value*;
+			/** Reference to the type iterated over */
+			using reference = Value&;
+
+			friend typename std::remove_const<Map>::type;
+			template<class, class>
+			friend class FlatOrderedMapIterator;
+
+			/** Constructor */
+			FlatOrderedMapIterator() = default;
+
+			/** Iterator to const iterator converter */
+			template<class OtherMap, class OtherValue,
+			    class = std::enable_if_t<
+			    std::is_convertible_v<OtherValue*, Value*>>>
+			FlatOrderedMapIterator(
+			    const FlatOrderedMapIterator<OtherMap, OtherValue>
+			    &iterator) :
+			    _map(iterator._map),
+			    _position(iterator._position)
+			{
+
+			}
+
+			/**
+			 * @return
+			 *	Reference to the current iterated pair.
+			 */
+			reference
+			operator*()
+			    const
+			{
+				return (_map->_elements[_position]);
+			}
+
+			/**
+			 * @return
+			 *	Pointer to the current iterated pair.
+			 */
+			pointer
+			operator->()
+			    const
+			{
+				return (&(_map->_elements[_position]));
+			}
+
+			/** Move to the next pair */
+			FlatOrderedMapIterator&
+			operator++()
+			{
+				++_position;
+				return (*this);
+			}
+
+			/** Move to the next pair */
+			FlatOrderedMapIterator
+			operator++(
+			    int)
+			{
+				FlatOrderedMapIterator previousIterator(*this);
+				++(*this);
+				return (previousIterator);
+			}
+
+			/** Move to the previous pair */
+			FlatOrderedMapIterator&
+			operator--()
+			{
+				--_position;
+				return (*this);
+			}
+
+			/** Move to the previous pair */
+			FlatOrderedMapIterator
+			operator--(
+			    int)
+			{
+				FlatOrderedMapIterator previousIterator(*this);
+				--(*this);
+				return (previousIterator);
+			}
+
+			/**
+			 * @brief
+			 * Test for iterator equality.
+			 *
+			 * @param rhs
+			 *	Object on the right-hand side of the expression.
+			 *
+			 * @return
+			 *	Whether or not this iterator is equivalent to
+			 *	rhs.
+			 */
+			template<class OtherMap, class OtherValue>
+			bool
+			operator==(
+			    const FlatOrderedMapIterator<OtherMap, OtherValue>
+			    &rhs)
+			    const
+			{
+				return ((_map == rhs._map) &&
+				    (_position == rhs._position));
+			}
+
+			/**
+			 * @brief
+			 * Test for iterator inequality.
+			 *
+			 * @param rhs
+			 *	Object on the right-hand side of the expression.
+			 *
+			 * @return
+			 *	Whether or not this iterator is not equivalent
+			 *	to rhs.
+			 */
+			template<class OtherMap, class OtherValue>
+			bool
+			operator!=(
+			    const FlatOrderedMapIterator<OtherMap, OtherValue>
+			    &rhs)
+			    const
+			{
+				return (!(this->operator==(rhs)));
+			}
+
+		private:
+			/**
+			 * @brief
+			 * Constructor.
+			 *
+			 * @param map
+			 *	The FlatOrderedMap being iterated over.
+			 * @param position
+			 *	Position in insertion order.
+			 */
+			FlatOrderedMapIterator(
+			    Map *map,
+			    std::size_t position) :
+			    _map(map),
+			    _position(position)
+			{
+
+			}
+
+			/** The FlatOrderedMap being iterated over */
+			Map *_map{nullptr};
+			/** Position in insertion order */
+			std::size_t _position{0};
+		};
+
+		/**
+		 * @brief
+		 * A map where insertion order is preserved and elements
+		 * are unique, stored contiguously.
+		 * @details
+		 * Elements are kept in a vector in insertion order, and
+		 * found through an open-addressed index of their positions.
+		 * Lookups do not allocate and, with the default hash and
+		 * key comparison, accept any type comparable to Key, such
+		 * as a std::string_view for a std::string Key.
+		 *
+		 * Unlike OrderedMap, the key of a dereferenced iterator
+		 * is not const. It must not be modified.
+		 *
+		 * @note
+		 * At most 2^32 - 2 elements may be stored.
+		 */
+		template<class Key, class T,
+		    class Hash = FlatOrderedMapHash<Key>,
+		    class KeyEqual = std::equal_to<>>
+		class FlatOrderedMap
+		{
+		public:
+			using key_type = Key;
+			using mapped_type = T;
+			using value_type = std::pair<Key, T>;
+			using size_type = std::size_t;
+			using hasher = Hash;
+			using key_equal = KeyEqual;
+			using iterator = FlatOrderedMapIterator<
+			    FlatOrderedMap, value_type>;
+			using const_iterator = FlatOrderedMapIterator<
+			    const FlatOrderedMap, const value_type>;
+
+			friend iterator;
+			friend const_iterator;
+
+			/** Constructor. */
+			FlatOrderedMap() = default;
+
+			/**
+			 * @brief
+			 * Insert an element at the end of the collection.
+			 *
+			 * @param value
+			 *	Value to insert.
+			 *
+			 * @return
+			 *	Iterator to the element with value's key, and
+			 *	whether or not value was inserted.
+			 *
+			 * @throw std::length_error
+			 *	Map is full.
+			 *
+			 * @note
+			 *	Complexity: Average case: O(1), worst case
+			 *	O(size()).
+			 */
+			std::pair<iterator, bool>
+			insert(
+			    const value_type &value)
+			{
+				return (this->emplace_key(value.first,
+				    value.second));
+			}
+
+			/**
+			 * @brief
+			 * Insert an element at the end of the collection.
+			 *
+			 * @param value
+			 *	Value to insert.
+			 *
+			 * @return
+			 *	Whether or not the object was inserted.
+			 *
+			 * @throw std::length_error
+			 *	Map is full.
+			 */
+			bool
+			push_back(
+			    const value_type &value)
+			{
+				return (this->insert(value).second);
+			}
+
+			/**
+			 * @brief
+			 * Subscripting operator.
+			 *
+			 * @param key
+			 *	Key used to index into the map.
+			 *
+			 * @return
+			 *	Value for key, which is a new value inserted
+			 *	at the end of the collection if key was not
+			 *	present.
+			 *
+			 * @throw std::length_error
+			 *	Map is full.
+			 */
+			T&
+			operator[](
+			    const Key &key)
+			{
+				return (this->emplace_key(key).first->second);
+			}
+
+			/**
+			 * @brief
+			 * Remove an element from the collection.
+			 *
+			 * @param pos
+			 *	Iterator to the element to remove.
+			 *
+			 * @return
+			 *	Iterator to the element after pos.
+			 *
+			 * @note
+			 *	Complexity is O(size()), as later elements
+			 *	move to keep insertion order.
+			 */
+			iterator
+			erase(
+			    const_iterator pos)
+			{
+				this->erase_element(pos._position);
+				return (iterator(this, pos._position));
+			}
+
+			/**
+			 * @brief
+			 * Remove an element from the collection.
+			 *
+			 * @param pos
+			 *	Iterator to the element to remove.
+			 *
+			 * @return
+			 *	Iterator to the element after pos.
+			 *
+			 * @note
+			 *	Complexity is O(size()).
+			 */
+			iterator
+			erase(
+			    iterator pos)
+			{
+				return (this->erase(const_iterator(pos)));
+			}
+
+			/**
+			 * @brief
+			 * Remove an element from the collection.
+			 *
+			 * @param key
+			 *	Key of the element to remove.
+			 *
+			 * @return
+			 *	Number of elements removed.
+			 *
+			 * @note
+			 *	Complexity is O(size()).
+			 */
+			template<class K>
+			size_type
+			erase(
+			    const K &key)
+			{
+				const size_type slot = this->find_slot(key);
+				if (slot == NO_SLOT)
+					return (0);
+				this->erase_element(_slots[slot].element);
+				return (1);
+			}
+
+			/**
+			 * @brief
+			 * Remove every element from the collection.
+			 *
+			 * @note
+			 *	Complexity: O(size()).
+			 */
+			void
+			clear()
+			{
+				_elements.clear();
+				std::fill(_slots.begin(), _slots.end(),
+				    Slot{EMPTY_SLOT, 0});
+			}
+
+			/**
+			 * @brief
+			 * Allocate space for a number of elements.
+			 *
+			 * @param count
+			 *	Number of elements the map should hold
+			 *	without growing.
+			 *
+			 * @throw std::length_error
+			 *	count is more than the map can hold.
+			 */
+			void
+			reserve(
+			    size_type count)
+			{
+				if (count > MAX_ELEMENTS)
+					throw std::length_error("FlatOrderedMap"
+					    " is full");
+				_elements.reserve(count);
+				if (count > max_load(_slots.size()))
+					this->rehash(slots_for(count));
+			}
+
+			/**
+			 * @return
+			 *	Iterator at the first element of the collection.
+			 */
+			iterator
+			begin()
+			{
+				return (iterator(this, 0));
+			}
+
+			/**
+			 * @return
+			 *	Iterator at the first element of the collection.
+			 */
+			const_iterator
+			begin()
+			    const
+			{
+				return (const_iterator(this, 0));
+			}
+
+			/**
+			 * @return
+			 *	Iterator at the first element of the collection.
+			 */
+			const_iterator
+			cbegin()
+			    const
+			{
+				return (const_iterator(this, 0));
+			}
+
+			/**
+			 * @return
+			 *	Iterator beyond the last element of the
+			 *	collection.
+			 */
+			iterator
+			end()
+			{
+				return (iterator(this, _elements.size()));
+			}
+
+			/**
+			 * @return
+			 *	Iterator beyond the last element of the
+			 *	collection.
+			 */
+			const_iterator
+			end()
+			    const
+			{
+				return (const_iterator(this,
+				    _elements.size()));
+			}
+
+			/**
+			 * @return
+			 *	Iterator beyond the last element of the
+			 *	collection.
+			 */
+			const_iterator
+			cend()
+			    const
+			{
+				return (const_iterator(this,
+				    _elements.size()));
+			}
+
+			/**
+			 * @return
+			 *	Number of elements in the collection.
+			 */
+			size_type
+			size()
+			    const
+			{
+				return (_elements.size());
+			}
+
+			/**
+			 * @return
+			 *	Whether or not the collection is empty.
+			 */
+			bool
+			empty()
+			    const
+			{
+				return (_elements.empty());
+			}
+
+			/**
+			 * @brief
+			 * Determine if a value exists in the container.
+			 *
+			 * @param key
+			 *	Key to search the container for.
+			 *
+			 * @return
+			 *	Whether or not key exists in this container.
+			 *
+			 * @note
+			 *	Complexity: Average case: O(1).
+			 */
+			template<class K>
+			bool
+			keyExists(
+			    const K &key)
+			    const
+			{
+				return (this->find_slot(key) != NO_SLOT);
+			}
+
+			/**
+			 * @brief
+			 * Obtain an iterator to a particular key.
+			 *
+			 * @param key
+			 *	Key to search the container for.
+			 *
+			 * @return
+			 *	Iterator to the element with key, or end().
+			 *
+			 * @note
+			 *	Complexity: Average case: O(1).
+			 */
+			template<class K>
+			iterator
+			find(
+			    const K &key)
+			{
+				const size_type slot = this->find_slot(key);
+				if (slot == NO_SLOT)
+					return (this->end());
+				return (iterator(this, _slots[slot].element));
+			}
+
+			/**
+			 * @brief
+			 * Obtain an iterator to a particular key.
+			 *
+			 * @param key
+			 *	Key to search the container for.
+			 *
+			 * @return
+			 *	Iterator to the element with key, or end().
+			 *
+			 * @note
+			 *	Complexity: Average case: O(1).
+			 */
+			template<class K>
+			const_iterator
+			find(
+			    const K &key)
+			    const
+			{
+				const size_type slot = this->find_slot(key);
+				if (slot == NO_SLOT)
+					return (this->cend());
+				return (const_iterator(this,
+				    _slots[slot].element));
+			}
+
+			/** @return Function that hashes keys. */
+			hasher
+			hash_function()
+			    const
+			{
+				return (_hash);
+			}
+
+			/** @return Function that compares keys for equality. */
+			key_equal
+			key_eq()
+			    const
+			{
+				return (_equal);
+			}
+
+		private:
+			/** Position in _elements of an index entry */
+			struct Slot
+			{
+				/** Position in _elements, or EMPTY_SLOT */
+				uint32_t element;
+				/** Folded hash of the element's key */
+				uint32_t hash;
+			};
+
+			/** Slot::element value of an unused slot */
+			static constexpr uint32_t EMPTY_SLOT =
+			    std::numeric_limits<uint32_t>::max();
+			/** Most elements that may be stored */
+			static constexpr size_type MAX_ELEMENTS = EMPTY_SLOT - 1;
+			/** Return value for a key that was not found */
+			static constexpr size_type NO_SLOT =
+			    std::numeric_limits<size_type>::max();
+			/** Fewest slots allocated */
+			static constexpr size_type MIN_SLOTS = 16;
+
+			/**
+			 * @return
+			 *	Most elements indexed by slotCount slots
+			 *	before growing (three quarters).
+			 */
+			static size_type
+			max_load(
+			    size_type slotCount)
+			{
+				return (slotCount - (slotCount / 4));
+			}
+
+			/**
+			 * @return
+			 *	Power of two number of slots that can index
+			 *	count elements.
+			 */
+			static size_type
+			slots_for(
+			    size_type count)
+			{
+				size_type slotCount = MIN_SLOTS;
+				while (max_load(slotCount) < count)
+					slotCount *= 2;
+				return (slotCount);
+			}
+
+			/**
+			 * @return
+			 *	32-bit fold of the hash of key.
+			 */
+			template<class K>
+			uint32_t
+			hash_key(
+			    const K &key)
+			    const
+			{
+				const uint64_t hash = static_cast<uint64_t>(
+				    _hash(key));
+				return (static_cast<uint32_t>(hash ^
+				    (hash >> 32)));
+			}
+
+			/**
+			 * @return
+			 *	First slot probed for a folded hash.
+			 * @note
+			 *	Hashes are mixed because std::hash is the
+			 *	identity for integers on some platforms.
+			 */
+			size_type
+			home_slot(
+			    uint32_t hash)
+			    const
+			{
+				const uint64_t mixed = hash *
+				    UINT64_C(0x9E3779B97F4A7C15);
+				return (static_cast<size_type>(mixed ^
+				    (mixed >> 32)) & (_slots.size() - 1));
+			}
+
+			/**
+			 * @return
+			 *	Slot indexing the element with key, or NO_SLOT.
+			 */
+			template<class K>
+			size_type
+			find_slot(
+			    const K &key)
+			    const
+			{
+				if (_elements.empty())
+					return (NO_SLOT);
+				return (this->find_slot(key,
+				    this->hash_key(key)));
+			}
+
+			/**
+			 * @return
+			 *	Slot indexing the element with key, whose
+			 *	folded hash is hash, or NO_SLOT.
+			 */
+			template<class K>
+			size_type
+			find_slot(
+			    const K &key,
+			    uint32_t hash)
+			    const
+			{
+				if (_elements.empty())
+					return (NO_SLOT);
+
+				const size_type mask = _slots.size() - 1;
+				for (size_type slot = this->home_slot(hash);;
+				    slot = (slot + 1) & mask) {
+					const Slot &s = _slots[slot];
+					if (s.element == EMPTY_SLOT)
+						return (NO_SLOT);
+					if ((s.hash == hash) && _equal(
+					    _elements[s.element].first, key))
+						return (slot);
+				}
+			}
+
+			/**
+			 * @brief
+			 * Record an element in the first free slot after
+			 * its home slot.
+			 */
+			void
+			place(
+			    uint32_t element,
+			    uint32_t hash)
+			{
+				const size_type mask = _slots.size() - 1;
+				size_type slot = this->home_slot(hash);
+				while (_slots[slot].element != EMPTY_SLOT)
+					slot = (slot + 1) & mask;
+				_slots[slot] = Slot{element, hash};
+			}
+
+			/**
+			 * @brief
+			 * Rebuild the index with a new number of slots.
+			 * @note
+			 *	Keys are not hashed again.
+			 */
+			void
+			rehash(
+			    size_type slotCount)
+			{
+				std::vector<Slot> previous(slotCount,
+				    Slot{EMPTY_SLOT, 0});
+				previous.swap(_slots);
+				for (const Slot &s : previous)
+					if (s.element != EMPTY_SLOT)
+						this->place(s.element, s.hash);
+			}
+
+			/**
+			 * @brief
+			 * Find key, or insert it at the end of the
+			 * collection with a value built from args.
+			 */
+			template<class K, class... Args>
+			std::pair<iterator, bool>
+			emplace_key(
+			    const K &key,
+			    Args&&... args)
+			{
+				const uint32_t hash = this->hash_key(key);
+				const size_type found = this->find_slot(key,
+				    hash);
+				if (found != NO_SLOT)
+					return (std::make_pair(iterator(this,
+					    _slots[found].element), false));
+
+				if (_elements.size() >= MAX_ELEMENTS)
+					throw std::length_error("FlatOrderedMap"
+					    " is full");
+				if ((_elements.size() + 1) >
+				    max_load(_slots.size()))
+					this->rehash(slots_for(
+					    _elements.size() + 1));
+
+				_elements.emplace_back(std::piecewise_construct,
+				    std::forward_as_tuple(key),
+				    std::forward_as_tuple(
+				    std::forward<Args>(args)...));
+				this->place(static_cast<uint32_t>(
+				    _elements.size() - 1), hash);
+				return (std::make_pair(iterator(this,
+				    _elements.size() - 1), true));
+			}
+
+			/**
+			 * @brief
+			 * Remove the element at a position in insertion
+			 * order.
+			 */
+			void
+			erase_element(
+			    size_type element)
+			{
+				const size_type mask = _slots.size() - 1;
+				size_type hole = this->home_slot(this->hash_key(
+				    _elements[element].first));
+				while (_slots[hole].element != element)
+					hole = (hole + 1) & mask;
+
+				/*
+				 * Shift later slots of the probe sequence back,
+				 * so that lookups need no tombstones.
+				 */
+				for (size_type slot = (hole + 1) & mask;
+				    _slots[slot].element != EMPTY_SLOT;
+				    slot = (slot + 1) & mask) {
+					const size_type home = this->home_slot(
+					    _slots[slot].hash);
+					if (((slot - home) & mask) >=
+					    ((slot - hole) & mask)) {
+						_slots[hole] = _slots[slot];
+						hole = slot;
+					}
+				}
+				_slots[hole].element = EMPTY_SLOT;
+
+				_elements.erase(_elements.begin() + element);
+				if (element == _elements.size())
+					return;
+				for (Slot &s : _slots)
+					if ((s.element != EMPTY_SLOT) &&
+					    (s.element > element))
+						s.element--;
+			}
+
+			/** Elements, in insertion order */
+			std::vector<value_type> _elements{};
+			/** Open-addressed index into _elements */
+			std::vector<Slot> _slots{};
+			/** Hashes keys */
+			Hash _hash{};
+			/** Compares keys */
+			KeyEqual _equal{};
+		};
+	}
+}
+
+#endif /* __BE_MEMORY_FLATORDEREDMAP_H__ */
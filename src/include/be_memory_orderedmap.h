@@ -334,6 +334,16 @@ namespace BiometricEvaluation
 			void
 			erase(
 			    const Key &key);
+
+			/**
+			 * @brief
+			 * Remove every element from the collection.
+			 *
+			 * @note
+			 *	Complexity: O(size()).
+			 */
+			void
+			clear();
 			
 			/**
 			 * @return
@@ -505,6 +515,14 @@ BiometricEvaluation::Memory::OrderedMap<Key, T>::erase(
 	_elements->erase(_elements->find(key));
 }
 
+template<class Key, class T>
+void
+BiometricEvaluation::Memory::OrderedMap<Key, T>::clear()
+{
+	_ordering->clear();
+	_elements->clear();
+}
+
 template<class Key, class T>
 typename BiometricEvaluation::Memory::OrderedMap<Key, T>::iterator
 BiometricEvaluation::Memory::OrderedMap<Key, T>::begin()
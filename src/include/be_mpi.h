@@ -10,6 +10,7 @@
 #ifndef _BE_MPI_H
 #define _BE_MPI_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -150,6 +151,42 @@ namespace BiometricEvaluation {
 
 		/** Storage type for MessageTag. */
 		using msgtag_t = std::underlying_type<MessageTag>::type;
+
+		/** How a Distributor sizes the work packages it creates. */
+		enum class ChunkPolicy : int32_t
+		{
+			/** Every package holds the configured chunk size. */
+			Static = 0,
+			/**
+			 * @brief
+			 * Guided self-scheduling.
+			 * @details
+			 * Each package holds the work remaining divided
+			 * by the number of workers, bounded by the
+			 * configured chunk size and the minimum chunk
+			 * size. Packages are large while much work
+			 * remains, and shrink toward the end so that
+			 * workers finish at about the same time.
+			 */
+			Guided = 1
+		};
+
+		/**
+		 * @brief
+		 * The message preceding the raw data of a work package.
+		 * @details
+		 * Carrying the data size along with the element count lets
+		 * the receiving task post its receive directly into a
+		 * buffer of the correct size, without probing for the data
+		 * message first. Sent as two MPI_UINT64_T.
+		 */
+		struct WorkPackageHeader
+		{
+			/** Size of the raw package data, in octets. */
+			uint64_t size;
+			/** Number of application-defined elements. */
+			uint64_t numElements;
+		};
 	}
 }
 
@@ -165,5 +202,9 @@ BE_FRAMEWORK_ENUMERATION_DECLARATIONS(
     BiometricEvaluation::MPI::MessageTag,
     BE_MPI_MessageTag_EnumToStringMap);
 
+BE_FRAMEWORK_ENUMERATION_DECLARATIONS(
+    BiometricEvaluation::MPI::ChunkPolicy,
+    BE_MPI_ChunkPolicy_EnumToStringMap);
+
 #endif /* _BE_MPI_H */
 
@@ -156,18 +156,13 @@ namespace BiometricEvaluation {
 			* Distribute work to other tasks.
 			* @details Uses MPI messages to distribute work packages
 			* to Receiver objects that are part of the same MPI
-			* job.
+			* job. When the Pipeline Depth resource is greater
+			* than one, work packages are created ahead of the
+			* requests for them, and the package data is sent
+			* without waiting for each transfer to complete.
 			*/
 			void distributeWork();
 
-			/**
-			* @brief
-			* Send a single work package to a task.
-			*/
-			void sendWorkPackage(
-			    MPI::WorkPackage &workPackage,
-			    int MPITask);
-
 			/**
 			 * @brief
 			 * Shut down all MPI processing.
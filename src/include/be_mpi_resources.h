@@ -10,10 +10,13 @@
 #ifndef _BE_MPI_RESOURCES_H
 #define _BE_MPI_RESOURCES_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <be_mpi.h>
+
 namespace BiometricEvaluation {
 	namespace MPI {
 		/**
@@ -73,6 +76,60 @@ namespace BiometricEvaluation {
 			 */
 			static const std::string CHECKPOINTPATHPROPERTY;
 
+			/**
+			 * @brief
+			 * The property string "Pipeline Depth"; optional.
+			 * @details
+			 * The number of work packages each Receiver keeps
+			 * requested ahead of its workers, and that the
+			 * Distributor creates ahead of requests. The default
+			 * of 1 disables pipelining: a package is requested
+			 * only once the previous one has been handed to a
+			 * worker.
+			 */
+			static const std::string PIPELINEDEPTHPROPERTY;
+
+			/**
+			 * @brief
+			 * The default value of the "Pipeline Depth" property.
+			 */
+			static const int DEFAULT_PIPELINE_DEPTH = 1;
+
+			/**
+			 * @brief
+			 * The property string "Worker Message Buffer Size";
+			 * optional.
+			 * @details
+			 * The size, in octets, of the memory shared between
+			 * a Receiver and each of its workers for passing
+			 * work packages. Work packages that do not fit are
+			 * passed through a pipe, as are all work packages
+			 * when the size is 0, the default.
+			 * @see Process::ForkManager::setSharedMemorySize()
+			 */
+			static const std::string
+			    WORKERMESSAGEBUFFERSIZEPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string "Chunk Policy"; optional.
+			 * @details
+			 * How the Distributor sizes work packages, one of
+			 * the strings for MPI::ChunkPolicy: "Static", the
+			 * default, or "Guided".
+			 */
+			static const std::string CHUNKPOLICYPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string "Minimum Chunk Size"; optional.
+			 * @details
+			 * The smallest work package created by the Guided
+			 * chunk policy, other than the last. The default
+			 * is 1.
+			 */
+			static const std::string MINIMUMCHUNKSIZEPROPERTY;
+
 			/**
 			 * @brief
 			 * Obtain the list of required properties.
@@ -101,6 +158,8 @@ namespace BiometricEvaluation {
 			 * The resources file could not be read.
 			 * @throw Error::ObjectDoesNotExist
 			 * A required property does not exist.
+			 * @throw Error::ParameterError
+			 * An optional property has an invalid value.
 			 * @throw Error::Exception
 			 * Some other error occurred.
 			 */
@@ -138,6 +197,65 @@ namespace BiometricEvaluation {
 			 */
 			std::string getCheckpointPath() const;
 
+			/**
+			 * @brief
+			 * Obtain the work package pipeline depth.
+			 * @return
+			 * The Pipeline Depth, DEFAULT_PIPELINE_DEPTH when
+			 * not present in the Properties file.
+			 */
+			int getPipelineDepth() const;
+
+			/**
+			 * @brief
+			 * Obtain the size of the memory shared with each
+			 * worker for passing work packages.
+			 * @return
+			 * The Worker Message Buffer Size, 0 when not present
+			 * in the Properties file.
+			 */
+			uint64_t getWorkerMessageBufferSize() const;
+
+			/**
+			 * @brief
+			 * Obtain the work package chunk policy.
+			 * @return
+			 * The Chunk Policy, ChunkPolicy::Static when not
+			 * present in the Properties file.
+			 */
+			ChunkPolicy getChunkPolicy() const;
+
+			/**
+			 * @brief
+			 * Obtain the smallest chunk size for the Guided
+			 * chunk policy.
+			 * @return
+			 * The Minimum Chunk Size, 1 when not present in the
+			 * Properties file.
+			 */
+			uint64_t getMinimumChunkSize() const;
+
+			/**
+			 * @brief
+			 * Obtain the number of elements for the next work
+			 * package under the chunk policy.
+			 * @details
+			 * Under the Guided policy, the remaining elements
+			 * are divided among all workers of all Receiver
+			 * tasks.
+			 * @param[in] chunkSize
+			 * The configured chunk size, the largest number of
+			 * elements in a work package.
+			 * @param[in] remaining
+			 * The number of elements not yet distributed.
+			 * @return
+			 * The number of elements to place in the next work
+			 * package, never more than remaining.
+			 */
+			uint64_t getNextChunkSize(
+			    uint64_t chunkSize,
+			    uint64_t remaining) const;
+
 			~Resources();
 
 			int getRank() const;
@@ -151,6 +269,10 @@ namespace BiometricEvaluation {
 			int _workersPerNode;
 			std::string _logsheetURL;
 			std::string _checkpointPath;
+			int _pipelineDepth;
+			uint64_t _workerMessageBufferSize;
+			ChunkPolicy _chunkPolicy;
+			uint64_t _minimumChunkSize;
 		};
 	}
 }
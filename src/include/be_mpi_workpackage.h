@@ -38,6 +38,22 @@ namespace BiometricEvaluation {
 			 * package.
 			 */
 			WorkPackage(const Memory::uint8Array &data);
+
+			/**
+			 * @brief
+			 * Construct a work package taking ownership of
+			 * some data.
+			 * @param[in] data
+			 * The data that will be managed by this work
+			 * package, moved without copying.
+			 */
+			WorkPackage(Memory::uint8Array &&data);
+
+			WorkPackage(const WorkPackage &other) = default;
+			WorkPackage(WorkPackage &&other) = default;
+			WorkPackage &operator=(const WorkPackage &other) =
+			    default;
+			WorkPackage &operator=(WorkPackage &&other) = default;
 			~WorkPackage();
 
 			/**
@@ -54,6 +70,25 @@ namespace BiometricEvaluation {
 			 */
 			void setData(const Memory::uint8Array &data);
 
+			/**
+		 	 * @brief
+			 * Set the package data, taking ownership of it.
+			 * @param[in] data
+			 * The data moved into the work package.
+			 */
+			void setData(Memory::uint8Array &&data);
+
+			/**
+		 	 * @brief
+			 * Remove the raw package data without copying.
+			 * @details
+			 * The work package is left without data, but keeps
+			 * its number of elements.
+			 * @return
+			 * The package data.
+			 */
+			Memory::uint8Array releaseData();
+
 			/**
 		 	 * @brief
 			 * Obtain the size of the package data.
@@ -86,7 +121,7 @@ namespace BiometricEvaluation {
 		protected:
 		private:
 			Memory::uint8Array _data;
-			uint64_t _numElements;
+			uint64_t _numElements{0};
 		};
 	}
 }
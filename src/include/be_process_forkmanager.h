@@ -137,6 +137,43 @@ namespace BiometricEvaluation
 			stopWorker(
 			    std::shared_ptr<WorkerController> workerController);
 
+			/**
+			 * @brief
+			 * Set the size of the message buffer shared with
+			 * each Worker.
+			 * @details
+			 * When nonzero, Workers subsequently started with
+			 * communication enabled receive messages from the
+			 * Manager through a buffer of this size in memory
+			 * shared with the Worker process. Only the length
+			 * of each message is written to the pipe, avoiding
+			 * copying large messages through the kernel in pipe
+			 * buffer sized pieces. Messages larger than the free
+			 * space in the buffer are sent through the pipe.
+			 * Messages from Worker to Manager always use the
+			 * pipe.
+			 *
+			 * @param[in] size
+			 *	Size, in octets, of the buffer for each Worker,
+			 *	or 0 (the default) to send all messages
+			 *	through the pipe.
+			 */
+			void
+			setSharedMemorySize(
+			    uint64_t size);
+
+			/**
+			 * @brief
+			 * Obtain the size of the message buffer shared with
+			 * each Worker.
+			 *
+			 * @return
+			 *	Size, in octets, of the buffer for each Worker.
+			 */
+			uint64_t
+			getSharedMemorySize()
+			    const;
+
 			/**
 			 * @brief
 			 * Send a POSIX signal to all workers.
@@ -350,6 +387,9 @@ namespace BiometricEvaluation
 			std::map<
 			    std::shared_ptr<ForkWorkerController>, Status>
 			    _wcStatus;
+
+			/** Size of the message buffer shared with Workers */
+			uint64_t _sharedMemorySize;
 		};
 		
 		
@@ -471,6 +511,9 @@ namespace BiometricEvaluation
 
 			/** PID of the process represented by _worker */
     			pid_t _pid;
+
+			/** Size of the message buffer shared with _worker */
+			uint64_t _sharedMemorySize;
 			
 			/**
 			 * A static pointer to "this", as there can only ever
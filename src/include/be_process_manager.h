@@ -11,6 +11,7 @@
 #ifndef __BE_PROCESS_MANAGER_H__
 #define __BE_PROCESS_MANAGER_H__
 
+#include <chrono>
 #include <vector>
 
 #include <be_error_exception.h>
@@ -200,6 +201,30 @@ namespace BiometricEvaluation
 			    int *nextFD = nullptr,
 			    int numSeconds = -1)
 			    const;
+
+			/**
+			 * @brief
+			 * Wait for a message from a Worker, with a timeout
+			 * finer than a second.
+			 *
+			 * @param[out] sender
+			 *	Reference to a shared pointer of the 
+			 *	WorkerController that sent the message.
+			 * @param[in,out] nextFD
+			 *	Location to store a pipe that has data to read.
+			 * @param[in] timeout
+			 *	Time to wait for a message, or < 0 to block.
+			 *
+			 * @return
+			 *	true if there is a Worker sending a message
+			 *	false otherwise or if an error occurred.
+			 */
+			virtual bool
+			waitForMessage(
+			    std::shared_ptr<WorkerController> &sender,
+			    int *nextFD,
+			    const std::chrono::microseconds &timeout)
+			    const;
 			
 			/**
 			 * @brief
@@ -228,6 +253,33 @@ namespace BiometricEvaluation
 			    Memory::uint8Array &message,
 			    int numSeconds = -1) const;
 
+			/**
+			 * @brief
+			 * Obtain a message from a Worker, with a timeout
+			 * finer than a second.
+			 *
+			 * @param[out] sender
+			 *	Reference to a shared pointer of the 
+			 *	WorkerController that sent the message.
+			 * @param[out] message
+			 *	Reference to a buffer to hold the message.
+			 * @param[in] timeout
+			 *	Time to wait for a message, or < 0 to block.
+			 *
+			 * @return
+			 *	true if there is a message, false otherwise.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	(Unexpected) widowed pipe.
+			 * @throw Error::StrategyError
+			 *	Error receiving message.
+			 */
+			virtual bool
+			getNextMessage(
+			    std::shared_ptr<WorkerController> &sender,
+			    Memory::uint8Array &message,
+			    const std::chrono::microseconds &timeout) const;
+
 			/**
 			 * @brief
 			 * Send one message to all Workers.
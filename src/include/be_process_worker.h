@@ -237,16 +237,49 @@ namespace BiometricEvaluation
 			receiveMessageFromManager(
 			    Memory::uint8Array &message);
 
+			/**
+			 * @brief
+			 * Send a message to this Worker from the Manager.
+			 * @details
+			 * When a shared memory message buffer has been
+			 * created and has room for the message, the message
+			 * contents are placed there and only the message
+			 * length is written to the pipe. Otherwise, the
+			 * message contents are written to the pipe.
+			 *
+			 * @param[in] message
+			 *	Message to send.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	Widowed pipe.
+			 * @throw Error::StrategyError
+			 *	Communications not enabled.
+			 *
+			 * @note
+			 * Behavior is undefined if called by a non-Manager.
+			 */
+			void
+			_sendMessageToWorker(
+			    const Memory::uint8Array &message);
+
 			/**
 			 * @brief
 			 * Perform general communication initialization from
 			 * Constructor.
 			 *
+			 * @param[in] sharedMemorySize
+			 *	Size, in octets, of a message buffer shared
+			 *	with the Worker process, used to pass messages
+			 *	from Manager to Worker without copying them
+			 *	through a pipe. 0 to pass all messages through
+			 *	the pipe.
+			 *
 			 * @throw Error::StrategyError
 			 *	Error in initialization.
 			 */
 			void
-			_initCommunication();
+			_initCommunication(
+			    uint64_t sharedMemorySize = 0);
 
 			/**
 			 * @brief
@@ -292,6 +325,9 @@ namespace BiometricEvaluation
 			    const;
 
 		private:		
+			/** Control block of the shared memory message buffer */
+			struct MessageRing;
+
 			/** Whether or not the Manager has requested a stop. */
 			volatile bool _stopRequested;
 			
@@ -304,6 +340,10 @@ namespace BiometricEvaluation
 			int _pipeToChild[2];
 			/** Pipes to receive from self */
 			int _pipeFromChild[2];
+			/** Shared memory carrying messages to self */
+			MessageRing *_messageRing;
+			/** Size of the data area of _messageRing */
+			uint64_t _messageRingSize;
 		};
 	}
 }
@@ -14,6 +14,8 @@ const std::string BiometricEvaluation::IO::ArchiveRecordStore::
     MANIFEST_FILE_NAME{"manifest"};
 const std::string BiometricEvaluation::IO::ArchiveRecordStore::
     ARCHIVE_FILE_NAME{"archive"};
+const std::string BiometricEvaluation::IO::ArchiveRecordStore::
+    MANIFEST_INDEX_FILE_NAME{"manifest.idx"};
 
 BiometricEvaluation::IO::ArchiveRecordStore::ArchiveRecordStore(
     const std::string &pathname,
@@ -58,6 +60,27 @@ BiometricEvaluation::IO::ArchiveRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::ArchiveRecordStore::setCommitPolicy(
+    const CommitPolicy &policy)
+{
+	this->pimpl->setCommitPolicy(policy);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::setKeyFilter(
+    bool enabled)
+{
+	this->pimpl->setKeyFilter(enabled);
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::getKeyFilter()
+    const
+{
+	return (this->pimpl->getKeyFilter());
+}
+
 void
 BiometricEvaluation::IO::ArchiveRecordStore::insert( 
     const std::string &key,
@@ -82,6 +105,31 @@ BiometricEvaluation::IO::ArchiveRecordStore::read(
 	return (this->pimpl->read(key));
 }
 
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::ArchiveRecordStore::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->read(keys));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ArchiveRecordStore::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	return (this->pimpl->readPrefix(key, size));
+}
+
+BiometricEvaluation::IO::RecordStore::RecordView
+BiometricEvaluation::IO::ArchiveRecordStore::readView(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->readView(key));
+}
+
 uint64_t
 BiometricEvaluation::IO::ArchiveRecordStore::length(
     const std::string &key)
@@ -90,6 +138,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::length(
 	return (this->pimpl->length(key));
 }
 
+std::vector<uint64_t>
+BiometricEvaluation::IO::ArchiveRecordStore::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->length(keys));
+}
+
 void
 BiometricEvaluation::IO::ArchiveRecordStore::flush(
     const std::string &key)
@@ -167,6 +223,66 @@ BiometricEvaluation::IO::ArchiveRecordStore::vacuum(
 	return (IO::ArchiveRecordStore::Impl::vacuum(pathname));
 }
 
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::appendRecordStore(
+    const ArchiveRecordStore &source)
+{
+	return (this->pimpl->appendRecordStore(*source.pimpl));
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::compact(
+    uint64_t maxBytes)
+{
+	return (this->pimpl->compact(maxBytes));
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::setSegmentSize(
+    uint64_t size)
+{
+	this->pimpl->setSegmentSize(size);
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::getSegmentSize()
+    const
+{
+	return (this->pimpl->getSegmentSize());
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::setWriteBehind(
+    uint64_t size)
+{
+	this->pimpl->setWriteBehind(size);
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::getWriteBehind()
+    const
+{
+	return (this->pimpl->getWriteBehind());
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::scan(
+    const std::function<void(const std::string &key,
+    const RecordStore::RecordView &record)> &visitor,
+    uint64_t chunkSize)
+    const
+{
+	return (this->pimpl->scan(visitor, chunkSize));
+}
+
+std::vector<BiometricEvaluation::IO::ArchiveRecordStore::Extent>
+BiometricEvaluation::IO::ArchiveRecordStore::getSequenceExtents(
+    uint64_t bytes)
+    const
+{
+	return (this->pimpl->getSequenceExtents(bytes));
+}
+
 std::string
 BiometricEvaluation::IO::ArchiveRecordStore::getArchiveName() const
 {
@@ -10,14 +10,24 @@
 
 #include "be_io_archiverecstore_impl.h"
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 #include <algorithm>
 #include <cerrno>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <numeric>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <be_error.h>
 #include <be_io_utility.h>
@@ -28,12 +38,38 @@
 
 namespace BE = BiometricEvaluation;
 
+/* Property holding the size at which archive segments are rolled */
+static const std::string SEGMENT_SIZE_KEY{"Segment_Size"};
+
+/*
+ * Force the contents of a file, or the entries of a directory, to stable
+ * storage. Flushing a stream only reaches the operating system's cache.
+ */
+static void
+syncPath(
+    const std::string &path)
+{
+#ifndef _WIN32
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw BE::Error::StrategyError("Could not open " + path +
+		    " (" + BE::Error::errorStr() + ")");
+	const int rv = ::fsync(fd);
+	const std::string errorStr{BE::Error::errorStr()};
+	::close(fd);
+	if (rv != 0)
+		throw BE::Error::StrategyError("Could not sync " + path +
+		    " (" + errorStr + ")");
+#endif /* _WIN32 */
+}
+
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
     const std::string &pathname,
     const std::string &description) :
     RecordStore::Impl(pathname, description, RecordStore::Kind::Archive)
 {
 	_dirty = false;
+	_indexStale = true;
 
 	try {
 		this->open_streams();
@@ -50,8 +86,43 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
 	_dirty = false;
 
 	try {
+		const std::vector<uint64_t> segments = this->find_segments();
+		if (!segments.empty())
+			_activeSegment = segments.back();
+		try {
+			_segmentSize = this->getProperties()->
+			    getPropertyAsInteger(SEGMENT_SIZE_KEY);
+		} catch (const Error::ObjectDoesNotExist &) {
+			_segmentSize = 0;
+		}
+
 		this->open_streams();
-		read_manifest();
+
+		/*
+		 * Nothing can be appended to a read-only archive, so map it.
+		 * Segments are mapped before the manifest is read, so none
+		 * that the manifest refers to can be deleted in between.
+		 */
+		if (mode == Mode::ReadOnly)
+			this->map_archive();
+
+		/*
+		 * Read-only stores search a current index in place. Others
+		 * load it into _entries, or upgrade from the text manifest.
+		 */
+		if (this->map_index()) {
+			if (mode != Mode::ReadOnly) {
+				this->load_index();
+				this->unmap_index();
+			}
+		} else {
+			read_manifest();
+			_indexStale = true;
+		}
+
+		if (this->isCountStale())
+			this->recoverCount(this->count_live_entries());
+		this->openKeyFilter();
 	} catch (const Error::ConversionError &e) {
 		throw Error::StrategyError(e.what());
 	} catch (const Error::FileError &e) {
@@ -61,6 +132,26 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
 
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::~Impl()
 {
+	/* The count is only current if every record reached the archive */
+	bool written{true};
+	try {
+		this->drain_writes();
+	} catch (const Error::Exception &) {
+		/* Records not written are missing when next opened */
+		written = false;
+	}
+	this->stop_write_behind();
+
+	this->unmap_archive();
+	this->unmap_index();
+	/* An index would list the records that were not written */
+	try {
+		if ((this->getMode() != Mode::ReadOnly) && _indexStale &&
+		    written)
+			this->write_index();
+	} catch (const Error::Exception &) {
+		/* The manifest remains authoritative without an index */
+	}
 	try {
 		close_streams();
 	} catch (const Error::StrategyError &) {
@@ -69,7 +160,17 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::~Impl()
 		 * close the file streams here, the OS will take care of that
 		 * detail on our behalf.
 		 */
+		written = false;
+	}
+
+	/* Stamped once the manifest is closed */
+	try {
+		this->saveKeyFilter();
+	} catch (const Error::Exception &) {
+		/* The filter is rebuilt when next opened */
 	}
+	if (written)
+		this->commitOnClose();
 }
 
 void
@@ -106,13 +207,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::open_streams()
 			throw Error::FileError("Could not open manifest");
 	}
 
-	if (stat(canonicalName(ARCHIVE_FILE_NAME).c_str(), &sb)) {
+	const std::string archiveName{this->getArchiveName()};
+	if (stat(archiveName.c_str(), &sb)) {
 		if (this->getMode() == Mode::ReadOnly)
-			throw Error::FileError(canonicalName(ARCHIVE_FILE_NAME) +
+			throw Error::FileError(archiveName +
 			    " does not exist and obejct is read-only");
 		else {
 			_archivefp.open(
-			    canonicalName(ARCHIVE_FILE_NAME).c_str(),
+			    archiveName.c_str(),
 			    std::fstream::in | std::fstream::out |
 			    std::fstream::binary | std::fstream::trunc);
 			if (!_archivefp || (_archivefp.is_open() == false))
@@ -122,11 +224,11 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::open_streams()
 	} else if (_archivefp.is_open() == false) {
 		if (this->getMode() == Mode::ReadOnly)
 			_archivefp.open(
-			    canonicalName(ARCHIVE_FILE_NAME).c_str(),
+			    archiveName.c_str(),
 			    std::fstream::in | std::fstream::binary);
 		else
 			_archivefp.open(
-			    canonicalName(ARCHIVE_FILE_NAME).c_str(),
+			    archiveName.c_str(),
 			    std::fstream::in | std::fstream::out |
 			    std::fstream::app | std::fstream::ate |
 			    std::fstream::binary);
@@ -138,6 +240,250 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::open_streams()
 	_manifestfp.clear();
 }
 
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::map_archive()
+{
+	for (const auto segment : this->find_segments()) {
+		Segment &mapping = _segments[segment];
+#ifndef _WIN32
+		int fd = ::open(this->segment_name(segment).c_str(), O_RDONLY);
+		if (fd != -1) {
+			struct stat sb;
+			if ((fstat(fd, &sb) == 0) && (sb.st_size != 0)) {
+				void *map = mmap(nullptr, sb.st_size, PROT_READ,
+				    MAP_SHARED, fd, 0);
+				if (map != MAP_FAILED) {
+					mapping.map =
+					    static_cast<const uint8_t *>(map);
+					mapping.mapSize = sb.st_size;
+				}
+			}
+			::close(fd);
+		}
+#endif /* _WIN32 */
+
+		/* An open stream also outlives deletion of the segment */
+		if (mapping.map == nullptr)
+			mapping.fp = std::make_unique<std::ifstream>(
+			    this->segment_name(segment),
+			    std::ios_base::in | std::ios_base::binary);
+	}
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::unmap_archive()
+{
+#ifndef _WIN32
+	for (const auto &segment : _segments)
+		if (segment.second.map != nullptr)
+			munmap(const_cast<uint8_t *>(segment.second.map),
+			    segment.second.mapSize);
+#endif /* _WIN32 */
+	_segments.clear();
+}
+
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::segment_name(
+    uint64_t segment)
+    const
+{
+	if (segment == 0)
+		return (canonicalName(ARCHIVE_FILE_NAME));
+	return (canonicalName(ARCHIVE_FILE_NAME + '.' +
+	    std::to_string(segment)));
+}
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::find_segments()
+    const
+{
+	const std::string directory{this->getPathname()};
+	DIR *dir = opendir(directory.c_str());
+	if (dir == nullptr)
+		throw Error::StrategyError("Cannot open store directory (" +
+		    Error::errorStr() + ")");
+
+	const std::string prefix{ARCHIVE_FILE_NAME + '.'};
+	std::vector<uint64_t> segments{};
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != nullptr) {
+		const std::string name{entry->d_name};
+		if (name == ARCHIVE_FILE_NAME) {
+			segments.push_back(0);
+			continue;
+		}
+		if ((name.size() <= prefix.size()) ||
+		    (name.compare(0, prefix.size(), prefix) != 0) ||
+		    (name.find_first_not_of("0123456789", prefix.size()) !=
+		    std::string::npos))
+			continue;
+		segments.push_back(std::stoull(name.substr(prefix.size())));
+	}
+	if (closedir(dir))
+		throw Error::StrategyError("Could not close " + directory +
+		    " (" + Error::errorStr() + ")");
+
+	std::sort(segments.begin(), segments.end());
+	return (segments);
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::offset_segment(
+    long offset)
+{
+	return (static_cast<uint64_t>(offset) >> SEGMENT_SHIFT);
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::offset_position(
+    long offset)
+{
+	return (static_cast<uint64_t>(offset) &
+	    ((uint64_t{1} << SEGMENT_SHIFT) - 1));
+}
+
+const uint8_t *
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::mapped_data(
+    const ManifestEntry &entry)
+    const
+{
+	const auto segment = _segments.find(offset_segment(entry.offset));
+	if ((segment == _segments.end()) || (segment->second.map == nullptr))
+		return (nullptr);
+
+	const uint64_t position = offset_position(entry.offset);
+	if ((position + entry.size) > segment->second.mapSize)
+		throw Error::StrategyError("Archive is truncated");
+	return (segment->second.map + position);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_data(
+    long offset,
+    uint64_t size,
+    uint8_t *data)
+    const
+{
+	if (size == 0)
+		return;
+
+	/* Copy straight from a mapping, leaving the streams untouched */
+	const uint8_t *mapped = this->mapped_data({offset, size});
+	if (mapped != nullptr) {
+		std::memcpy(data, mapped, size);
+		return;
+	}
+
+	/* Only the active segment may have data yet to be written */
+	const uint64_t segment = offset_segment(offset);
+	if (segment == _activeSegment)
+		this->drain_writes();
+	const auto found = _segments.find(segment);
+	std::istream *fp;
+	if ((found != _segments.end()) && (found->second.fp != nullptr)) {
+		fp = found->second.fp.get();
+	} else if (segment == _activeSegment) {
+		if (_archivefp.is_open() == false) {
+			try {
+				this->open_streams();
+			} catch (const Error::FileError &e) {
+				throw Error::StrategyError(e.what());
+			}
+		}
+		fp = &_archivefp;
+	} else {
+		auto segmentfp = std::make_unique<std::ifstream>(
+		    this->segment_name(segment),
+		    std::ios_base::in | std::ios_base::binary);
+		if (!(*segmentfp))
+			throw Error::StrategyError("Could not open archive "
+			    "segment " + std::to_string(segment));
+		fp = segmentfp.get();
+		_segments[segment].fp = std::move(segmentfp);
+	}
+
+	fp->clear();
+	fp->seekg(offset_position(offset), std::ios_base::beg);
+	if (!(*fp))
+		throw Error::StrategyError("Archive cannot seek");
+	fp->read(reinterpret_cast<char *>(data), size);
+	if (!(*fp))
+		throw Error::StrategyError("Archive cannot read");
+}
+
+long
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::append_position(
+    uint64_t size)
+{
+	this->drain_writes();
+	if (_archivefp.is_open() == false) {
+		try {
+			this->open_streams();
+		} catch (const Error::FileError &e) {
+			throw Error::StrategyError(e.what());
+		}
+	}
+	_archivefp.clear();
+	_archivefp.seekp(0, std::ios_base::end);
+	const long position = _archivefp.tellp();
+	if (!_archivefp || (position < 0))
+		throw Error::StrategyError("Could not get archive position");
+
+	if (this->needs_roll(position, size)) {
+		this->roll_segment();
+		return (static_cast<long>(_activeSegment << SEGMENT_SHIFT));
+	}
+
+	return (static_cast<long>((_activeSegment << SEGMENT_SHIFT) +
+	    position));
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::needs_roll(
+    uint64_t position,
+    uint64_t size)
+    const
+{
+	/* Positions must also fit below the segment number in offsets */
+	return ((position != 0) && ((((_segmentSize != 0) &&
+	    ((position + size) > _segmentSize))) ||
+	    ((position + size) > (uint64_t{1} << SEGMENT_SHIFT))));
+}
+
+long
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::append_data(
+    const void *data,
+    uint64_t size)
+{
+	if (_writer.joinable())
+		return (this->stage_data(data, size));
+
+	const long offset = this->append_position(size);
+	_archivefp.write(static_cast<const char *>(data), size);
+	if (!_archivefp)
+		throw Error::StrategyError("Could not write to archive file");
+	return (offset);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::roll_segment()
+{
+	if (_archivefp.is_open()) {
+		_archivefp.clear();
+		_archivefp.close();
+		if (!_archivefp)
+			throw Error::StrategyError("Could not close archive");
+	}
+	_archivefp.clear();
+
+	_activeSegment++;
+	try {
+		this->open_streams();
+	} catch (const Error::FileError &e) {
+		throw Error::StrategyError(e.what());
+	}
+}
+
 void
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::close_streams()
 {
@@ -173,10 +519,24 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::getSpaceUsed()
 		throw Error::StrategyError("Could not get size of manifest file: " + e.whatString());
 	}
 
-	try {
-		total += BE::IO::Utility::getFileSize(canonicalName(ARCHIVE_FILE_NAME));
-	}catch (const BE::Error::Exception& ) {
-		throw Error::StrategyError("Could not find archive file");
+	for (const auto segment : this->find_segments()) {
+		try {
+			total += BE::IO::Utility::getFileSize(
+			    this->segment_name(segment));
+		} catch (const BE::Error::Exception& ) {
+			throw Error::StrategyError("Could not find archive "
+			    "file");
+		}
+	}
+
+	const std::string indexName{canonicalName(MANIFEST_INDEX_FILE_NAME)};
+	if (IO::Utility::fileExists(indexName)) {
+		try {
+			total += BE::IO::Utility::getFileSize(indexName);
+		} catch (const BE::Error::Exception &e) {
+			throw Error::StrategyError("Could not get size of "
+			    "manifest index: " + e.whatString());
+		}
 	}
 
 	return (total);
@@ -189,7 +549,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::sync()
 	if (getMode() == Mode::ReadOnly)
 		return;
 
-	RecordStore::Impl::sync();
+	this->drain_writes();
 	if (_manifestfp.is_open()) {
 		_manifestfp.clear();
 		_manifestfp.sync();
@@ -203,6 +563,33 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::sync()
 		if (!_archivefp)
 			throw Error::StrategyError("Could not sync archive");
 	}
+
+	if ((this->getMode() != Mode::ReadOnly) && _indexStale)
+		this->write_index();
+
+	/* The count is committed once the manifest is written */
+	RecordStore::Impl::sync();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::flushChanges()
+    const
+{
+	/* Records and their manifest entries are buffered by the streams */
+	this->drain_writes();
+	if (_archivefp.is_open()) {
+		_archivefp.clear();
+		_archivefp.flush();
+		if (!_archivefp)
+			throw Error::StrategyError("Could not flush archive");
+	}
+
+	if (_manifestfp.is_open()) {
+		_manifestfp.clear();
+		_manifestfp.flush();
+		if (!_manifestfp)
+			throw Error::StrategyError("Could not flush manifest");
+	}
 }
 
 uint64_t
@@ -212,13 +599,24 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::length(
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
-	const std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(key);
-	if ((entry.get() == nullptr) ||
-	    (entry->second.offset == OFFSET_RECORD_REMOVED))
+	ManifestEntry entry;
+	if (!this->keyMayExist(key) || !this->find_entry(key, entry) ||
+	    (entry.offset == OFFSET_RECORD_REMOVED))
 		throw Error::ObjectDoesNotExist(key);
 
-	return ((entry->second).size);
+	return (entry.size);
+}
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	std::vector<uint64_t> lengths{};
+	lengths.reserve(keys.size());
+	for (const auto &key : keys)
+		lengths.push_back(this->live_entry(key).size);
+	return (lengths);
 }
 
 void
@@ -272,42 +670,599 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_manifest()
 	}
 }
 
-BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
-    const std::string &key)
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::index_offset(
+    IndexSection section,
+    uint64_t entryCount)
+{
+	uint64_t offset = sizeof(IndexHeader);
+	if (section == IndexSection::Entries)
+		return (offset);
+	offset += entryCount * sizeof(IndexEntry);
+	if (section == IndexSection::Sorted)
+		return (offset);
+	offset += entryCount * sizeof(uint64_t);
+	if (section == IndexSection::Tombstones)
+		return (offset);
+	return (offset + (((entryCount + 63) / 64) * sizeof(uint64_t)));
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::map_index()
+{
+#ifndef _WIN32
+	struct stat sb;
+	if (stat(this->getManifestName().c_str(), &sb) != 0)
+		return (false);
+	const uint64_t manifestSize = sb.st_size;
+	const uint64_t manifestInode = sb.st_ino;
+	uint64_t manifestStamp;
+	try {
+		manifestStamp = RecordStore::Impl::fileStamp(
+		    this->getManifestName());
+	} catch (const Error::Exception &) {
+		return (false);
+	}
+
+	int fd = ::open(canonicalName(MANIFEST_INDEX_FILE_NAME).c_str(),
+	    O_RDONLY);
+	if (fd == -1)
+		return (false);
+	if ((fstat(fd, &sb) != 0) ||
+	    (static_cast<uint64_t>(sb.st_size) < sizeof(IndexHeader))) {
+		::close(fd);
+		return (false);
+	}
+	void *map = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED)
+		return (false);
+	const uint64_t indexSize = sb.st_size;
+
+	/* Only use an index written by this host for the current manifest */
+	const IndexHeader *header = static_cast<const IndexHeader *>(map);
+	const uint64_t maxEntries = indexSize / (sizeof(IndexEntry) +
+	    sizeof(uint64_t));
+	if ((std::memcmp(header->magic, INDEX_MAGIC,
+	    sizeof(header->magic)) != 0) ||
+	    (header->version != INDEX_VERSION) ||
+	    (header->byteOrder != INDEX_BYTE_ORDER) ||
+	    (header->manifestSize != manifestSize) ||
+	    (header->manifestStamp != manifestStamp) ||
+	    (header->manifestInode != manifestInode) ||
+	    (header->entryCount > maxEntries) ||
+	    (header->keySize > indexSize) ||
+	    (index_offset(IndexSection::Keys, header->entryCount) +
+	    header->keySize != indexSize)) {
+		munmap(map, indexSize);
+		return (false);
+	}
+
+	_index = static_cast<const uint8_t *>(map);
+	_indexSize = indexSize;
+	_dirty = (header->dirty != 0);
+	return (true);
+#else
+	return (false);
+#endif /* _WIN32 */
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::unmap_index()
+{
+#ifndef _WIN32
+	if (_index != nullptr)
+		munmap(const_cast<uint8_t *>(_index), _indexSize);
+#endif /* _WIN32 */
+	_index = nullptr;
+	_indexSize = 0;
+	_indexCursor = 0;
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::load_index()
+{
+	const IndexHeader *header =
+	    reinterpret_cast<const IndexHeader *>(_index);
+	_entries.reserve(header->entryCount);
+	for (uint64_t i = 0; i < header->entryCount; i++)
+		efficient_insert(_entries, this->index_key(i),
+		    this->index_entry(i));
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_index()
+    const
+{
+	/* The index must not claim more of the manifest than is on disk */
+	this->drain_writes();
+	if (_manifestfp.is_open()) {
+		_manifestfp.clear();
+		_manifestfp.flush();
+		if (!_manifestfp)
+			throw Error::StrategyError("Could not flush manifest");
+	}
+
+	IndexHeader header{};
+	std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+	header.version = INDEX_VERSION;
+	header.byteOrder = INDEX_BYTE_ORDER;
+	try {
+		header.manifestSize = IO::Utility::getFileSize(
+		    this->getManifestName());
+		header.manifestStamp = RecordStore::Impl::fileStamp(
+		    this->getManifestName());
+	} catch (const Error::Exception &e) {
+		throw Error::StrategyError("Could not get size of manifest "
+		    "file: " + e.whatString());
+	}
+#ifndef _WIN32
+	struct stat sb;
+	if (stat(this->getManifestName().c_str(), &sb) != 0)
+		throw Error::StrategyError("Could not stat manifest file (" +
+		    Error::errorStr() + ")");
+	header.manifestInode = sb.st_ino;
+#endif /* _WIN32 */
+	header.entryCount = _entries.size();
+	header.dirty = (_dirty ? 1 : 0);
+
+	std::vector<IndexEntry> entries;
+	entries.reserve(header.entryCount);
+	std::vector<uint64_t> tombstones((header.entryCount + 63) / 64, 0);
+	std::string keys;
+	for (const auto &e : _entries) {
+		if (e.second.offset == OFFSET_RECORD_REMOVED) {
+			tombstones[entries.size() / 64] |=
+			    (uint64_t{1} << (entries.size() % 64));
+			header.removedCount++;
+		}
+		entries.push_back({keys.size(), e.first.size(),
+		    e.second.offset, e.second.size});
+		keys.append(e.first);
+	}
+	header.keySize = keys.size();
+
+	std::vector<uint64_t> sorted(header.entryCount);
+	std::iota(sorted.begin(), sorted.end(), 0);
+	std::sort(sorted.begin(), sorted.end(),
+	    [&](const uint64_t lhs, const uint64_t rhs) {
+		return (std::string_view(keys).substr(entries[lhs].keyOffset,
+		    entries[lhs].keyLength) <
+		    std::string_view(keys).substr(entries[rhs].keyOffset,
+		    entries[rhs].keyLength));
+	});
+
+	/* Replace the index atomically, so readers never see a partial one */
+	const std::string indexName{canonicalName(MANIFEST_INDEX_FILE_NAME)};
+	const std::string tempName{indexName + ".tmp"};
+	std::ofstream indexfp(tempName, std::ios_base::out |
+	    std::ios_base::binary | std::ios_base::trunc);
+	indexfp.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	indexfp.write(reinterpret_cast<const char *>(entries.data()),
+	    entries.size() * sizeof(IndexEntry));
+	indexfp.write(reinterpret_cast<const char *>(sorted.data()),
+	    sorted.size() * sizeof(uint64_t));
+	indexfp.write(reinterpret_cast<const char *>(tombstones.data()),
+	    tombstones.size() * sizeof(uint64_t));
+	indexfp.write(keys.data(), keys.size());
+	indexfp.close();
+	if (!indexfp) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not write manifest index");
+	}
+	try {
+		syncPath(tempName);
+	} catch (const Error::StrategyError &) {
+		std::remove(tempName.c_str());
+		throw;
+	}
+	if (std::rename(tempName.c_str(), indexName.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not replace manifest "
+		    "index (" + Error::errorStr() + ")");
+	}
+	syncPath(this->getPathname());
+
+	_indexStale = false;
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::index_find(
+    const std::string &key,
+    uint64_t &position)
+    const
+{
+	const IndexHeader *header =
+	    reinterpret_cast<const IndexHeader *>(_index);
+	const uint64_t *sorted = reinterpret_cast<const uint64_t *>(_index +
+	    index_offset(IndexSection::Sorted,
+	    header->entryCount));
+	const uint64_t *last = sorted + header->entryCount;
+
+	const uint64_t *found = std::lower_bound(sorted, last, key,
+	    [&](const uint64_t lhs, const std::string &rhs) {
+		return (this->index_key(lhs) < rhs);
+	});
+	if ((found == last) || (this->index_key(*found) != key))
+		return (false);
+
+	position = *found;
+	return (true);
+}
+
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::ManifestEntry
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::index_entry(
+    uint64_t position)
+    const
+{
+	const IndexHeader *header =
+	    reinterpret_cast<const IndexHeader *>(_index);
+	if (position >= header->entryCount)
+		throw Error::StrategyError("Manifest index is corrupt");
+	const IndexEntry *indexEntry = reinterpret_cast<const IndexEntry *>(
+	    _index + index_offset(IndexSection::Entries, 0)) + position;
+	const uint64_t *tombstones = reinterpret_cast<const uint64_t *>(
+	    _index + index_offset(IndexSection::Tombstones,
+	    header->entryCount));
+
+	ManifestEntry entry;
+	entry.size = indexEntry->size;
+	if (tombstones[position / 64] & (uint64_t{1} << (position % 64)))
+		entry.offset = OFFSET_RECORD_REMOVED;
+	else
+		entry.offset = static_cast<long>(indexEntry->offset);
+	return (entry);
+}
+
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::index_key(
+    uint64_t position)
+    const
+{
+	const IndexHeader *header =
+	    reinterpret_cast<const IndexHeader *>(_index);
+	if (position >= header->entryCount)
+		throw Error::StrategyError("Manifest index is corrupt");
+	const IndexEntry *indexEntry = reinterpret_cast<const IndexEntry *>(
+	    _index + index_offset(IndexSection::Entries, 0)) + position;
+	if ((indexEntry->keyOffset > header->keySize) ||
+	    (indexEntry->keyLength > header->keySize - indexEntry->keyOffset))
+		throw Error::StrategyError("Manifest index is corrupt");
+
+	const char *keys = reinterpret_cast<const char *>(_index +
+	    index_offset(IndexSection::Keys, header->entryCount));
+	return (std::string(keys + indexEntry->keyOffset,
+	    indexEntry->keyLength));
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::find_entry(
+    const std::string &key,
+    ManifestEntry &entry)
+    const
+{
+	if (_index != nullptr) {
+		uint64_t position;
+		if (!this->index_find(key, position))
+			return (false);
+		entry = this->index_entry(position);
+		return (true);
+	}
+
+	const auto found = _entries.find(key);
+	if (found == _entries.cend())
+		return (false);
+	entry = found->second;
+	return (true);
+}
+
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::ManifestEntry
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::live_entry(
+    const std::string &key)
+    const
+{
+	if (!validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	/* Check for existance */
+	ManifestEntry entry;
+	if (!this->keyMayExist(key) || !this->find_entry(key, entry))
+		throw Error::ObjectDoesNotExist(key);
+
+	/* Check for "removal" */
+	if (entry.offset == OFFSET_RECORD_REMOVED)
+		throw Error::ObjectDoesNotExist(key + " was removed");
+
+	return (entry);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
+    const std::string &key)
+    const
+{
+	const ManifestEntry entry = this->live_entry(key);
+
+	Memory::uint8Array data(entry.size);
+	this->read_data(entry.offset, entry.size, data);
+	return (data);
+}
+
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	/* Find every record before reading any */
+	std::vector<ManifestEntry> entries{};
+	entries.reserve(keys.size());
+	for (const auto &key : keys)
+		entries.push_back(this->live_entry(key));
+
+	/* Visit records in archive order */
+	std::vector<size_t> order(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+	    [&](const size_t lhs, const size_t rhs) {
+		return (entries[lhs].offset < entries[rhs].offset);
+	});
+
+	std::vector<Memory::uint8Array> records(keys.size());
+
+	/*
+	 * Records stored near each other are read together into extent,
+	 * trading a little unrequested data for fewer seeks and reads.
+	 * Records in mapped segments are simply copied.
+	 */
+	Memory::uint8Array extent{};
+	size_t first = 0;
+	while (first < order.size()) {
+		const ManifestEntry &entry = entries[order[first]];
+		const uint8_t *mapped = this->mapped_data(entry);
+		if (mapped != nullptr) {
+			records[order[first]].resize(entry.size);
+			if (entry.size != 0)
+				std::memcpy(records[order[first]], mapped,
+				    entry.size);
+			first++;
+			continue;
+		}
+
+		const uint64_t start = entry.offset;
+		uint64_t end = start + entry.size;
+		size_t last = first + 1;
+		for (; last < order.size(); last++) {
+			const ManifestEntry &next = entries[order[last]];
+			const uint64_t nextEnd = std::max<uint64_t>(end,
+			    next.offset + next.size);
+			if ((offset_segment(next.offset) !=
+			    offset_segment(entry.offset)) ||
+			    (static_cast<uint64_t>(next.offset) >
+			    (end + READ_COALESCE_GAP)) ||
+			    ((nextEnd - start) > READ_COALESCE_MAX))
+				break;
+			end = nextEnd;
+		}
+
+		/* A lone record is read straight into place */
+		const bool single = ((last - first) == 1);
+		Memory::uint8Array &buffer = (single ?
+		    records[order[first]] : extent);
+		buffer.resize(end - start);
+		this->read_data(start, end - start, buffer);
+
+		if (!single) {
+			for (size_t j = first; j < last; j++) {
+				const ManifestEntry &entry =
+				    entries[order[j]];
+				records[order[j]].resize(entry.size);
+				if (entry.size != 0)
+					std::memcpy(records[order[j]],
+					    extent + (entry.offset - start),
+					    entry.size);
+			}
+		}
+		first = last;
+	}
+
+	return (records);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	const ManifestEntry entry = this->live_entry(key);
+
+	Memory::uint8Array data(std::min(size, entry.size));
+	this->read_data(entry.offset, data.size(), data);
+	return (data);
+}
+
+BiometricEvaluation::IO::RecordStore::RecordView
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::readView(
+    const std::string &key)
+    const
+{
+	const ManifestEntry entry = this->live_entry(key);
+	if (entry.size == 0)
+		return (RecordStore::RecordView());
+	const uint8_t *data = this->mapped_data(entry);
+	if (data == nullptr)
+		throw Error::StrategyError("Archive is not mapped");
+
+	return (RecordStore::RecordView(data, entry.size));
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::scan(
+    const std::function<void(const std::string &,
+    const RecordStore::RecordView &)> &visitor,
+    uint64_t chunkSize)
     const
 {
-	if (!validateKeyString(key))
-		throw Error::StrategyError("Invalid key format");
+#ifdef _WIN32
+	throw Error::NotImplemented("Scanning on this platform");
+#else
+	if (chunkSize == 0)
+		throw Error::StrategyError("Invalid scan chunk size");
+	chunkSize = ((chunkSize + SCAN_ALIGNMENT - 1) / SCAN_ALIGNMENT) *
+	    SCAN_ALIGNMENT;
+
+	/* Data appended through this handle must be on disk */
+	this->drain_writes();
+	if (_archivefp.is_open()) {
+		_archivefp.clear();
+		_archivefp.flush();
+		if (!_archivefp)
+			throw Error::StrategyError("Could not flush archive");
+	}
 
-	/* Check for existance */
-	std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(key);
-	if (entry.get() == nullptr)
-		throw Error::ObjectDoesNotExist(key);
-	
-	/* Check for "removal" */
-	if (entry->second.offset == OFFSET_RECORD_REMOVED)
-		throw Error::ObjectDoesNotExist(key + " was removed");
+	auto entries = this->live_entries();
+	std::stable_sort(entries.begin(), entries.end(),
+	    [](const std::pair<std::string, ManifestEntry> &lhs,
+	    const std::pair<std::string, ManifestEntry> &rhs) {
+		return (lhs.second.offset < rhs.second.offset);
+	});
+
+	size_t first{0};
+	while (first < entries.size()) {
+		const uint64_t segment = offset_segment(
+		    entries[first].second.offset);
+		size_t last{first + 1};
+		while ((last < entries.size()) &&
+		    (offset_segment(entries[last].second.offset) == segment))
+			last++;
+		this->scan_segment(entries, first, last, chunkSize, visitor);
+		first = last;
+	}
 
-	if (_archivefp.is_open() == false) {
-		try {
-			this->open_streams();
-		} catch (const Error::FileError &e) {
-			throw Error::StrategyError(e.what());
+	return (entries.size());
+#endif /* _WIN32 */
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::scan_segment(
+    const std::vector<std::pair<std::string, ManifestEntry>> &entries,
+    size_t first,
+    size_t last,
+    uint64_t chunkSize,
+    const std::function<void(const std::string &,
+    const RecordStore::RecordView &)> &visitor)
+    const
+{
+#ifndef _WIN32
+	const uint64_t segment{offset_segment(entries[first].second.offset)};
+	const std::string name{this->segment_name(segment)};
+	bool direct{false};
+	int fd{-1};
+#ifdef O_DIRECT
+	fd = ::open(name.c_str(), O_RDONLY | O_DIRECT);
+	direct = (fd != -1);
+#endif /* O_DIRECT */
+	if (fd == -1)
+		fd = ::open(name.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw Error::StrategyError("Could not open archive segment " +
+		    std::to_string(segment) + " (" + Error::errorStr() + ")");
+#if defined(POSIX_FADV_SEQUENTIAL)
+	if (!direct)
+		(void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#elif defined(F_NOCACHE)
+	if (!direct)
+		(void)fcntl(fd, F_NOCACHE, 1);
+#endif
+
+	/* Direct I/O reads into memory aligned like the file positions */
+	std::unique_ptr<uint8_t, decltype(&std::free)> buffer{nullptr,
+	    &std::free};
+	uint64_t bufferSize{0};
+	try {
+		auto entry = entries.cbegin() + first;
+		const auto end = entries.cbegin() + last;
+		while (entry != end) {
+			const uint64_t position = offset_position(
+			    entry->second.offset);
+			const uint64_t start = position -
+			    (position % SCAN_ALIGNMENT);
+			const uint64_t needed = position + entry->second.size -
+			    start;
+			const uint64_t length = std::max(chunkSize,
+			    ((needed + SCAN_ALIGNMENT - 1) / SCAN_ALIGNMENT) *
+			    SCAN_ALIGNMENT);
+			if (length > bufferSize) {
+				void *memory{nullptr};
+				if (posix_memalign(&memory, SCAN_ALIGNMENT,
+				    length) != 0)
+					throw Error::StrategyError("Could not "
+					    "allocate scan buffer");
+				buffer.reset(static_cast<uint8_t *>(memory));
+				bufferSize = length;
+			}
+
+			/* Short only at the end of the segment */
+			uint64_t got{0};
+			while (got < length) {
+				const ssize_t rv = pread(fd, buffer.get() + got,
+				    length - got, start + got);
+				if (rv == 0)
+					break;
+				if (rv > 0) {
+					got += rv;
+					continue;
+				}
+				if (errno == EINTR)
+					continue;
+#ifdef O_DIRECT
+				/* Some file systems refuse direct I/O late */
+				if (direct && (errno == EINVAL) &&
+				    (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) &
+				    ~O_DIRECT) != -1)) {
+					direct = false;
+					continue;
+				}
+#endif /* O_DIRECT */
+				throw Error::StrategyError("Could not read "
+				    "archive segment " +
+				    std::to_string(segment) + " (" +
+				    Error::errorStr() + ")");
+			}
+			if (got < needed)
+				throw Error::StrategyError("Archive is "
+				    "truncated");
+
+			/* Visit every record wholly within the chunk */
+			for (; (entry != end) &&
+			    ((offset_position(entry->second.offset) +
+			    entry->second.size) <= (start + got)); ++entry) {
+				if (entry->second.size == 0)
+					visitor(entry->first,
+					    RecordStore::RecordView());
+				else
+					visitor(entry->first,
+					    RecordStore::RecordView(
+					    buffer.get() + (offset_position(
+					    entry->second.offset) - start),
+					    entry->second.size));
+			}
+
+#ifdef POSIX_FADV_DONTNEED
+			if (!direct)
+				(void)posix_fadvise(fd, start, got,
+				    POSIX_FADV_DONTNEED);
+#endif
 		}
+	} catch (...) {
+		::close(fd);
+		throw;
 	}
-	_archivefp.clear();
-	_archivefp.seekg(entry->second.offset, std::ios_base::beg);
-	if (!_archivefp)
-		throw Error::StrategyError("Archive cannot seek");
-
-	Memory::uint8Array data(entry->second.size);
-	_archivefp.read((char *)&data[0], entry->second.size);
-	if (!_archivefp)
-		throw Error::StrategyError("Archive cannot read");
 
-	return (data);
+	if (::close(fd) != 0)
+		throw Error::StrategyError("Could not close archive segment " +
+		    std::to_string(segment) + " (" + Error::errorStr() + ")");
+#endif /* _WIN32 */
 }
 
 void
@@ -320,27 +1275,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::insert(
 		throw Error::StrategyError("RecordStore was opened read-only");
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	this->check_write_error();
 	
-	if (this->keyExists(key))
+	if (this->keyMayExist(key) && this->keyExists(key))
 		throw Error::ObjectExists(key);
 
-	long offset = -1;
-
 	/* Write data chunk */
-	if (_archivefp.is_open() == false) {
-		try {
-			this->open_streams();
-		} catch (const Error::FileError &e) {
-			throw Error::StrategyError(e.what());
-		}
-	}
-	_archivefp.clear();
-	offset = _archivefp.tellp();
-	if (!_archivefp)
-		throw Error::StrategyError("Could not get archive position");
-	_archivefp.write(static_cast<const char *>(data), size);
-	if (!_archivefp)
-		throw Error::StrategyError("Could not write to archive file");
+	this->beginChange();
+	const long offset = this->append_data(data, size);
 
 	/* Write to manifest */
 	ManifestEntry entry;
@@ -359,20 +1301,28 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_manifest_entry(
     const std::string &key,
     ManifestEntry entry)
 {
-	if (_archivefp.is_open() == false) {
-		try {
-			this->open_streams();
-		} catch (const Error::FileError &e) {
-			throw Error::StrategyError(e.what());
+	if (_writer.joinable()) {
+		_writeBatch.manifest.append(key + ' ' +
+		    std::to_string(entry.size) + ' ' +
+		    std::to_string(entry.offset) + '\n');
+	} else {
+		if (_archivefp.is_open() == false) {
+			try {
+				this->open_streams();
+			} catch (const Error::FileError &e) {
+				throw Error::StrategyError(e.what());
+			}
 		}
+		_manifestfp.clear();
+		_manifestfp << key << " " << entry.size << " " <<
+		    entry.offset << '\n';
+		if (!_manifestfp)
+			throw Error::StrategyError("Couldn't write manifest "
+			    "entry for " + key);
 	}
-	_manifestfp.clear();
-	_manifestfp << key << " " << entry.size << " " << entry.offset << '\n';
-	if (!_manifestfp)
-		throw Error::StrategyError("Couldn't write manifest entry "
-		    "for " + key);
 
 	efficient_insert(_entries, key, entry);
+	_indexStale = true;
 }
 
 void
@@ -383,17 +1333,23 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::remove(
 		throw Error::StrategyError("RecordStore was opened read-only");
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	this->check_write_error();
 
-	if (this->keyExists(key) == false)
+	if (!this->keyMayExist(key) || (this->keyExists(key) == false))
 		throw Error::ObjectDoesNotExist(key);
 
 	/* At this point, the key is known to exist */
-	std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(key);
-	if (entry.get() == nullptr)
+	const auto entry = _entries.find(key);
+	if (entry == _entries.end())
 		throw Error::ObjectDoesNotExist(key);
+	this->beginChange();
+	/* Data outside the segments being compacted remains afterward */
+	if (_compacting && (std::find(_compactSegments.cbegin(),
+	    _compactSegments.cend(), offset_segment(entry->second.offset)) ==
+	    _compactSegments.cend()))
+		_compactRemoved.insert(key);
+
 	entry->second.offset = OFFSET_RECORD_REMOVED;
-	_entries[key] = entry->second;
 	    
 	try {
 		write_manifest_entry(key, entry->second);
@@ -421,6 +1377,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::flush(
 		throw Error::ObjectDoesNotExist(key);
 
 	/* Flush the streams, not necessarily for the key passed */
+	this->drain_writes();
 	if (_manifestfp.is_open()) {
 		_manifestfp.clear();
 		_manifestfp.flush();
@@ -446,6 +1403,9 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sequence(
 	    	throw Error::StrategyError("Invalid cursor position as "
 		    "argument");
 
+	if (_index != nullptr)
+		return (this->i_sequence_index(returnData, cursor));
+
 	if (_entries.begin() == _entries.end())
 		throw Error::ObjectDoesNotExist("Empty RecordStore");
 
@@ -486,6 +1446,41 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sequence(
 	return (record);
 }
 
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sequence_index(
+    bool returnData,
+    int cursor)
+{
+	const IndexHeader *header =
+	    reinterpret_cast<const IndexHeader *>(_index);
+	if (header->entryCount == 0)
+		throw Error::ObjectDoesNotExist("Empty RecordStore");
+
+	if ((getCursor() == BE_RECSTORE_SEQ_START) ||
+	    (cursor == BE_RECSTORE_SEQ_START)) {
+		_indexCursor = 0;
+	} else {
+		if (_indexCursor >= header->entryCount)
+			throw Error::ObjectDoesNotExist("No record at "
+			    "position");
+		_indexCursor++;
+	}
+	/* If client hasn't vacuumed, skip removed items */
+	while ((_indexCursor < header->entryCount) &&
+	    (this->index_entry(_indexCursor).offset == OFFSET_RECORD_REMOVED))
+		_indexCursor++;
+
+	if (_indexCursor >= header->entryCount)	/* Client needs to start over */
+		throw Error::ObjectDoesNotExist("No record at position");
+
+	setCursor(BE_RECSTORE_SEQ_NEXT);
+	BE::IO::RecordStore::Record record;
+	record.key = this->index_key(_indexCursor);
+	if (returnData)
+		record.data = this->read(record.key);
+	return (record);
+}
+
 BiometricEvaluation::IO::RecordStore::Record
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::sequence(
     int cursor)
@@ -508,6 +1503,23 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	if (_index != nullptr) {
+		uint64_t position;
+		if (!this->index_find(key, position))
+			throw Error::ObjectDoesNotExist(key);
+		if (this->index_entry(position).offset ==
+		    OFFSET_RECORD_REMOVED)
+			throw Error::ObjectDoesNotExist(key + " was removed");
+
+		/* As below, stop short of key so sequence() returns it */
+		if (position == 0) {
+			_indexCursor = 0;
+			this->setCursor(BE_RECSTORE_SEQ_START);
+		} else
+			_indexCursor = position - 1;
+		return;
+	}
+
 	/* Check for existance */
 	ManifestMap::iterator lb = _entries.find(key);
 	if (lb == _entries.end())
@@ -532,7 +1544,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::setCursorAtKey(
 
 void
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::efficient_insert(
-    ManifestMap &m,
+    ManifestMap &/* m */,
     const ManifestMap::key_type &k,
     const ManifestMap::mapped_type &v)
 {
@@ -549,6 +1561,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::vacuum(
 	if (!oldRS->needsVacuum())
 		return;
 	std::string description = oldRS->getDescription();
+	const bool keyFilter = oldRS->getKeyFilter();
 	oldRS.reset(nullptr);
 
 	std::vector<std::string> paths{pathname};
@@ -565,6 +1578,8 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::vacuum(
 	/* Delete the original RecordStore, then change the name of temp RS */
 	auto newRS = IO::RecordStore::Impl::openRecordStore(
 	    newName, Mode::ReadWrite);
+	if (keyFilter)
+		newRS->setKeyFilter(true);
 	try {
 		RecordStore::Impl::removeRecordStore(pathname);
 		newRS->move(pathname);
@@ -576,6 +1591,588 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::vacuum(
 	}
 }
 
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::appendRecordStore(
+    const Impl &source)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+	if (source._dirty)
+		throw Error::StrategyError(source.getPathname() + " needs "
+		    "vacuuming");
+
+	/* Check every key first, so a collision appends nothing */
+	const auto entries = source.live_entries();
+	for (const auto &entry : entries)
+		if (this->keyMayExist(entry.first) &&
+		    this->keyExists(entry.first))
+			throw Error::ObjectExists(entry.first);
+
+	/* Copy each segment in large blocks, noting where it lands */
+	std::map<uint64_t, long> bases{};
+	uint64_t appended{0};
+	for (const auto segment : source.find_segments()) {
+		const auto mapping = source._segments.find(segment);
+		uint64_t segmentSize;
+		if ((mapping != source._segments.end()) &&
+		    (mapping->second.map != nullptr)) {
+			segmentSize = mapping->second.mapSize;
+			bases[segment] = this->append_position(segmentSize);
+			_archivefp.write(reinterpret_cast<const char *>(
+			    mapping->second.map), segmentSize);
+		} else {
+			const std::string segmentName{
+			    source.segment_name(segment)};
+			try {
+				segmentSize = IO::Utility::getFileSize(
+				    segmentName);
+			} catch (const Error::Exception &e) {
+				throw Error::StrategyError("Could not get "
+				    "size of " + segmentName + ": " +
+				    e.whatString());
+			}
+			bases[segment] = this->append_position(segmentSize);
+
+			std::ifstream sourcefp(segmentName,
+			    std::ios_base::in | std::ios_base::binary);
+			if (!sourcefp)
+				throw Error::StrategyError("Could not open " +
+				    segmentName);
+			static const std::streamsize BLOCKSIZE = 1 << 20;
+			Memory::uint8Array block(BLOCKSIZE);
+			while (sourcefp) {
+				sourcefp.read(reinterpret_cast<char *>(
+				    &block[0]), BLOCKSIZE);
+				if (sourcefp.gcount() > 0)
+					_archivefp.write(reinterpret_cast<
+					    const char *>(&block[0]),
+					    sourcefp.gcount());
+				if (!_archivefp)
+					break;
+			}
+			if (sourcefp.bad())
+				throw Error::StrategyError("Could not read " +
+				    segmentName);
+		}
+		if (!_archivefp)
+			throw Error::StrategyError("Could not write to "
+			    "archive file");
+		appended += segmentSize;
+	}
+
+	this->beginChange();
+	for (const auto &entry : entries) {
+		const auto base = bases.find(offset_segment(
+		    entry.second.offset));
+		if (base == bases.end())
+			throw Error::StrategyError("Archive segment of " +
+			    entry.first + " is missing");
+		ManifestEntry rebased = entry.second;
+		rebased.offset = base->second + offset_position(
+		    entry.second.offset);
+		write_manifest_entry(entry.first, rebased);
+		RecordStore::Impl::insert(entry.first, nullptr, rebased.size);
+	}
+
+	return (appended);
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::compact(
+    uint64_t maxBytes)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+
+	if (!_compacting) {
+		if (!_dirty)
+			return (true);
+
+		/* Leave every existing record in a segment to be emptied */
+		if (this->append_position(0) !=
+		    static_cast<long>(_activeSegment << SEGMENT_SHIFT))
+			this->roll_segment();
+		_compactTarget = _activeSegment;
+		_compactSegments.clear();
+		for (const auto segment : this->find_segments())
+			if (segment < _activeSegment)
+				_compactSegments.push_back(segment);
+
+		/* Move records in archive order, one segment at a time */
+		_compactEntries = this->live_entries();
+		std::sort(_compactEntries.begin(), _compactEntries.end(),
+		    [](const std::pair<std::string, ManifestEntry> &lhs,
+		    const std::pair<std::string, ManifestEntry> &rhs) {
+			return (lhs.second.offset < rhs.second.offset);
+		});
+		_compactNext = 0;
+		_compactRemoved.clear();
+		_compacting = true;
+	}
+
+	uint64_t moved{0};
+	while (true) {
+		/* Delete segments that have been emptied */
+		const uint64_t nextSegment = (_compactNext <
+		    _compactEntries.size()) ? offset_segment(
+		    _compactEntries[_compactNext].second.offset) :
+		    std::numeric_limits<uint64_t>::max();
+		if (!_compactSegments.empty() &&
+		    (_compactSegments.front() < nextSegment)) {
+			/*
+			 * Relocated records and their manifest entries must
+			 * reach stable storage before the only other copy
+			 * of the records is removed.
+			 */
+			this->drain_writes();
+			_archivefp.clear();
+			_archivefp.flush();
+			_manifestfp.clear();
+			_manifestfp.flush();
+			if (!_archivefp || !_manifestfp)
+				throw Error::StrategyError("Could not flush "
+				    "relocated records");
+			for (uint64_t segment = _compactTarget;
+			    segment <= _activeSegment; segment++)
+				if (IO::Utility::fileExists(
+				    this->segment_name(segment)))
+					syncPath(this->segment_name(segment));
+			syncPath(this->getManifestName());
+
+			/* Only the active segment changes from here on */
+			_compactTarget = _activeSegment;
+		}
+		bool removed{false};
+		while (!_compactSegments.empty() &&
+		    (_compactSegments.front() < nextSegment)) {
+			const uint64_t segment = _compactSegments.front();
+			const auto mapping = _segments.find(segment);
+			if (mapping != _segments.end())
+				_segments.erase(mapping);
+			if ((std::remove(this->segment_name(segment).c_str())
+			    != 0) && (errno != ENOENT))
+				throw Error::StrategyError("Could not remove "
+				    "archive segment " +
+				    std::to_string(segment) + " (" +
+				    Error::errorStr() + ")");
+			_compactSegments.pop_front();
+			removed = true;
+		}
+		if (removed)
+			syncPath(this->getPathname());
+		if (_compactNext == _compactEntries.size())
+			break;
+		if ((moved != 0) && (moved >= maxBytes))
+			return (false);
+
+		/* Skip records removed or replaced since the pass began */
+		const auto &original = _compactEntries[_compactNext++];
+		ManifestEntry current;
+		if (!this->find_entry(original.first, current) ||
+		    (current.offset != original.second.offset))
+			continue;
+
+		Memory::uint8Array data(current.size);
+		this->read_data(current.offset, current.size, data);
+		current.offset = this->append_data(data, current.size);
+		this->write_manifest_entry(original.first, current);
+		moved += current.size;
+	}
+
+	this->finish_compaction();
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::finish_compaction()
+{
+	/*
+	 * Keep a removal only where its data outlives the pass, so that
+	 * the store still needs vacuuming when reopened.
+	 */
+	std::vector<std::pair<std::string, ManifestEntry>> entries{};
+	entries.reserve(_entries.size() + _compactRemoved.size());
+	const bool sequencing = (getCursor() != BE_RECSTORE_SEQ_START);
+	std::string cursorKey{};
+	bool cursorFound{false};
+	for (auto it = _entries.cbegin(); it != _entries.cend(); ++it) {
+		if (_compactRemoved.find(it->first) != _compactRemoved.cend())
+			entries.emplace_back(it->first, ManifestEntry{
+			    OFFSET_RECORD_REMOVED, it->second.size});
+		if (it->second.offset != OFFSET_RECORD_REMOVED) {
+			entries.emplace_back(it->first, it->second);
+			/* sequence() continues after the last record kept */
+			if (!cursorFound)
+				cursorKey = it->first;
+		}
+		if (sequencing && (it == _cursorPos))
+			cursorFound = true;
+	}
+	this->rewrite_manifest(entries);
+
+	_entries.clear();
+	_entries.reserve(entries.size());
+	for (const auto &entry : entries)
+		efficient_insert(_entries, entry.first, entry.second);
+	if (sequencing) {
+		if (!cursorFound)
+			_cursorPos = _entries.end();
+		else if (cursorKey.empty())
+			setCursor(BE_RECSTORE_SEQ_START);
+		else
+			_cursorPos = _entries.find(cursorKey);
+	}
+
+	_dirty = !_compactRemoved.empty();
+	_indexStale = true;
+	_compactEntries.clear();
+	_compactEntries.shrink_to_fit();
+	_compactRemoved.clear();
+	_compactNext = 0;
+	_compacting = false;
+
+	/* Leave the new manifest and its index on stable storage together */
+	this->write_index();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::rewrite_manifest(
+    const std::vector<std::pair<std::string, ManifestEntry>> &entries)
+{
+	this->drain_writes();
+	const std::string manifestName{this->getManifestName()};
+	const std::string tempName{manifestName + ".tmp"};
+	std::ofstream manifestfp(tempName, std::ios_base::out |
+	    std::ios_base::trunc);
+	for (const auto &entry : entries)
+		manifestfp << entry.first << " " << entry.second.size << " " <<
+		    entry.second.offset << '\n';
+	manifestfp.close();
+	if (!manifestfp) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not write manifest");
+	}
+	try {
+		syncPath(tempName);
+	} catch (const Error::StrategyError &) {
+		std::remove(tempName.c_str());
+		throw;
+	}
+
+	/* The index describes the old manifest, so must go first */
+	std::remove(canonicalName(MANIFEST_INDEX_FILE_NAME).c_str());
+	_manifestfp.clear();
+	_manifestfp.close();
+	_manifestfp.clear();
+	if (std::rename(tempName.c_str(), manifestName.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not replace manifest (" +
+		    Error::errorStr() + ")");
+	}
+	syncPath(this->getPathname());
+
+	try {
+		this->open_streams();
+	} catch (const Error::FileError &e) {
+		throw Error::StrategyError(e.what());
+	}
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::setSegmentSize(
+    uint64_t size)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	props->setPropertyFromInteger(SEGMENT_SIZE_KEY, size);
+	this->setProperties(props);
+	_segmentSize = size;
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::getSegmentSize()
+    const
+{
+	return (_segmentSize);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::setWriteBehind(
+    uint64_t size)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+
+	if (size == 0) {
+		this->drain_writes();
+		this->stop_write_behind();
+		_writeBehindSize = 0;
+		return;
+	}
+
+#ifdef _WIN32
+	throw Error::NotImplemented("Write-behind");
+#else
+	/* The writer appends after anything the streams have buffered */
+	if (!_writer.joinable()) {
+		this->flushChanges();
+		_writer = std::thread(&Impl::write_behind, this);
+	}
+	_writeBehindSize = size;
+#endif /* _WIN32 */
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::getWriteBehind()
+    const
+{
+	return (_writeBehindSize);
+}
+
+long
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::stage_data(
+    const void *data,
+    uint64_t size)
+{
+	/*
+	 * Once everything is written, the end of the archive is found
+	 * from the stream as usual, rolling the segment if needed.
+	 */
+	long offset;
+	if (!_stagedEnd || this->needs_roll(offset_position(*_stagedEnd),
+	    size))
+		offset = this->append_position(size);
+	else
+		offset = *_stagedEnd;
+
+	const uint64_t batchSize = _writeBehindSize / WRITE_BEHIND_BATCHES;
+	if (_writeBatch.data.empty()) {
+		_writeBatch.archiveName = this->segment_name(
+		    offset_segment(offset));
+		_writeBatch.position = offset_position(offset);
+		_writeBatch.data.reserve(std::max(batchSize, size));
+	}
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	_writeBatch.data.insert(_writeBatch.data.end(), bytes, bytes + size);
+	_stagedEnd = offset + static_cast<long>(size);
+
+	if ((_writeBatch.data.size() + _writeBatch.manifest.size()) >=
+	    batchSize)
+		this->submit_batch();
+	return (offset);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::submit_batch()
+    const
+{
+	const uint64_t bytes = _writeBatch.data.size() +
+	    _writeBatch.manifest.size();
+	if (bytes == 0)
+		return;
+	_writeBatch.manifestName = this->getManifestName();
+
+	std::unique_lock<std::mutex> lock(_writeMutex);
+	_writeDone.wait(lock, [&]() {
+		return ((_writeError != nullptr) || (_writeQueuedBytes == 0) ||
+		    ((_writeQueuedBytes + bytes) <= _writeBehindSize));
+	});
+	if (_writeError != nullptr)
+		std::rethrow_exception(_writeError);
+
+	_writeQueue.push_back(std::move(_writeBatch));
+	_writeQueuedBytes += bytes;
+	_writeBatch = WriteBatch{};
+	lock.unlock();
+	_writeQueued.notify_one();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::check_write_error()
+    const
+{
+	std::lock_guard<std::mutex> lock(_writeMutex);
+	if (_writeError != nullptr)
+		std::rethrow_exception(_writeError);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::drain_writes()
+    const
+{
+	if (!_writer.joinable()) {
+		this->check_write_error();
+		return;
+	}
+
+	this->submit_batch();
+	std::unique_lock<std::mutex> lock(_writeMutex);
+	_writeDone.wait(lock, [&]() {
+		return (_writeQueue.empty() && !_writing);
+	});
+	_stagedEnd.reset();
+	if (_writeError != nullptr)
+		std::rethrow_exception(_writeError);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_behind()
+{
+	std::unique_lock<std::mutex> lock(_writeMutex);
+	while (true) {
+		_writeQueued.wait(lock, [&]() {
+			return (!_writeQueue.empty() || _writerStop);
+		});
+		if (_writeQueue.empty())
+			break;
+
+		const WriteBatch batch = std::move(_writeQueue.front());
+		_writeQueue.pop_front();
+		_writing = true;
+
+		/* Nothing is written after a failure, leaving no gaps */
+		const bool failed = (_writeError != nullptr);
+		lock.unlock();
+		std::exception_ptr error{};
+		if (!failed) {
+			try {
+				write_batch(batch);
+			} catch (const Error::Exception &) {
+				error = std::current_exception();
+			}
+		}
+		lock.lock();
+
+		if (error != nullptr)
+			_writeError = error;
+		_writeQueuedBytes -= (batch.data.size() +
+		    batch.manifest.size());
+		_writing = false;
+		_writeDone.notify_all();
+	}
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::stop_write_behind()
+{
+	if (!_writer.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		_writerStop = true;
+	}
+	_writeQueued.notify_one();
+	_writer.join();
+	_writerStop = false;
+	_writeBatch = WriteBatch{};
+	_stagedEnd.reset();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_batch(
+    const WriteBatch &batch)
+{
+#ifndef _WIN32
+	if (!batch.data.empty()) {
+		const int fd = ::open(batch.archiveName.c_str(),
+		    O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+		if (fd == -1)
+			throw Error::StrategyError("Could not open " +
+			    batch.archiveName + " (" + Error::errorStr() + ")");
+		uint64_t written{0};
+		while (written < batch.data.size()) {
+			const ssize_t rv = ::pwrite(fd,
+			    batch.data.data() + written,
+			    batch.data.size() - written,
+			    static_cast<off_t>(batch.position + written));
+			if (rv == -1) {
+				if (errno == EINTR)
+					continue;
+				const std::string errorStr{Error::errorStr()};
+				::close(fd);
+				throw Error::StrategyError("Could not write "
+				    "to archive file (" + errorStr + ")");
+			}
+			written += static_cast<uint64_t>(rv);
+		}
+		if (::close(fd) != 0)
+			throw Error::StrategyError("Could not close " +
+			    batch.archiveName + " (" + Error::errorStr() + ")");
+	}
+
+	/* Manifest lines follow the data they refer to */
+	if (!batch.manifest.empty()) {
+		const int fd = ::open(batch.manifestName.c_str(),
+		    O_WRONLY | O_APPEND);
+		if (fd == -1)
+			throw Error::StrategyError("Could not open manifest "
+			    "(" + Error::errorStr() + ")");
+		uint64_t written{0};
+		while (written < batch.manifest.size()) {
+			const ssize_t rv = ::write(fd,
+			    batch.manifest.data() + written,
+			    batch.manifest.size() - written);
+			if (rv == -1) {
+				if (errno == EINTR)
+					continue;
+				const std::string errorStr{Error::errorStr()};
+				::close(fd);
+				throw Error::StrategyError("Couldn't write "
+				    "manifest entries (" + errorStr + ")");
+			}
+			written += static_cast<uint64_t>(rv);
+		}
+		if (::close(fd) != 0)
+			throw Error::StrategyError("Could not close manifest "
+			    "(" + Error::errorStr() + ")");
+	}
+#endif /* _WIN32 */
+}
+
+std::vector<std::pair<std::string,
+    BiometricEvaluation::IO::ArchiveRecordStore::Impl::ManifestEntry>>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::live_entries()
+    const
+{
+	std::vector<std::pair<std::string, ManifestEntry>> entries{};
+	if (_index != nullptr) {
+		const IndexHeader *header =
+		    reinterpret_cast<const IndexHeader *>(_index);
+		entries.reserve(header->entryCount - header->removedCount);
+		for (uint64_t i = 0; i < header->entryCount; i++) {
+			const ManifestEntry entry = this->index_entry(i);
+			if (entry.offset != OFFSET_RECORD_REMOVED)
+				entries.emplace_back(this->index_key(i), entry);
+		}
+	} else {
+		entries.reserve(_entries.size());
+		for (const auto &entry : _entries)
+			if (entry.second.offset != OFFSET_RECORD_REMOVED)
+				entries.emplace_back(entry.first, entry.second);
+	}
+	return (entries);
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::count_live_entries()
+    const
+{
+	if (_index != nullptr) {
+		const IndexHeader *header =
+		    reinterpret_cast<const IndexHeader *>(_index);
+		return (header->entryCount - header->removedCount);
+	}
+
+	uint64_t count{0};
+	for (const auto &entry : _entries)
+		if (entry.second.offset != OFFSET_RECORD_REMOVED)
+			count++;
+	return (count);
+}
+
 void
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::move(
     const std::string &pathname)
@@ -583,7 +2180,9 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::move(
 	if (this->getMode() == Mode::ReadOnly)
 		throw Error::StrategyError("RecordStore was opened read-only");
 	
+	this->drain_writes();
 	this->close_streams();
+	this->unmap_archive();
 	RecordStore::Impl::move(pathname);
 }
 
@@ -609,16 +2208,48 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::keyExists(
     const ManifestMap::key_type &k)
 {
 	/* O(1) */
-	if (!_dirty)
-		return (_entries.keyExists(k));
-	if (_entries.keyExists(k) == false)
+	const auto entry = _entries.find(k);
+	if (entry == _entries.end())
 		return (false);
-	
-	/* Check if key was removed -- O(1) */
-	std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(k);
-	return ((entry.get() != nullptr) &&
-	    (entry->second.offset != OFFSET_RECORD_REMOVED));
+
+	/* Check if key was removed */
+	return (!_dirty || (entry->second.offset != OFFSET_RECORD_REMOVED));
+}
+
+std::vector<BiometricEvaluation::IO::ArchiveRecordStore::Extent>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::getSequenceExtents(
+    uint64_t bytes)
+    const
+{
+	std::vector<Extent> extents{};
+	uint64_t located = 0;
+	const auto locate = [&](const ManifestEntry &entry) {
+		if ((entry.offset == OFFSET_RECORD_REMOVED) || (entry.size == 0))
+			return;
+		extents.push_back({this->segment_name(offset_segment(
+		    entry.offset)), offset_position(entry.offset), entry.size});
+		located += entry.size;
+	};
+
+	/* Start where i_sequence() would, without moving the cursor */
+	const bool fromStart = (getCursor() == BE_RECSTORE_SEQ_START);
+	if (_index != nullptr) {
+		const uint64_t entryCount = reinterpret_cast<const IndexHeader *>(
+		    _index)->entryCount;
+		for (uint64_t position = (fromStart ? 0 : _indexCursor + 1);
+		    (position < entryCount) && (located < bytes); position++)
+			locate(this->index_entry(position));
+	} else {
+		ManifestMap::const_iterator it = _entries.begin();
+		if (!fromStart) {
+			it = _cursorPos;
+			if (it != _entries.end())
+				it++;
+		}
+		for (; (it != _entries.end()) && (located < bytes); it++)
+			locate(it->second);
+	}
+	return (extents);
 }
 
 std::string
@@ -630,6 +2261,23 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::getManifestName() const
 std::string
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::getArchiveName() const
 {
-	return (canonicalName(ARCHIVE_FILE_NAME));
+	return (this->segment_name(_activeSegment));
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::visitKeys(
+    const std::function<void(const std::string &)> &visitor)
+    const
+{
+	for (const auto &entry : this->live_entries())
+		visitor(entry.first);
 }
 
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::keyFilterStamp()
+    const
+{
+	/* Every insert(), remove(), and compaction changes the manifest */
+	return (RecordStore::Impl::fileStamp(canonicalName(
+	    MANIFEST_FILE_NAME)));
+}
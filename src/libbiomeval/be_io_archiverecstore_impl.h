@@ -11,14 +11,26 @@
 #ifndef __BE_ARCHIVERECSTORE_IMPL_H__
 #define __BE_ARCHIVERECSTORE_IMPL_H__
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <be_io_archiverecstore.h>
 #include "be_io_recordstore_impl.h"
 
-#include <be_memory_orderedmap.h>
+#include <be_memory_flatorderedmap.h>
 
 namespace BiometricEvaluation {
 
@@ -84,9 +96,22 @@ namespace BiometricEvaluation {
 			Memory::uint8Array read(
 			    const std::string &key) const;
 
+			std::vector<Memory::uint8Array> read(
+			    const std::vector<std::string> &keys) const;
+
+			Memory::uint8Array readPrefix(
+			    const std::string &key,
+			    uint64_t size) const;
+
+			RecordStore::RecordView readView(
+			    const std::string &key) const;
+
 			uint64_t length(
 			    const std::string &key) const;
 
+			std::vector<uint64_t> length(
+			    const std::vector<std::string> &keys) const;
+
 			void flush(
 			    const std::string &key) const;
 
@@ -149,13 +174,60 @@ namespace BiometricEvaluation {
 			 */
 			static void vacuum(
 			    const std::string &pathname);
-	
+
+			/**
+			 * Append every record of another ArchiveRecordStore
+			 * by copying its archive file.
+			 *
+			 * @param[in] source
+			 *	The store to append, which must not need
+			 *	vacuuming.
+			 * @throw Error::ObjectExists
+			 *	A key in source already exists in this store.
+			 * @throw Error::StrategyError
+			 *	This store was opened read-only, source needs
+			 *	vacuuming, or an error occurred when using the
+			 *	underlying storage system.
+			 * @return
+			 *	Number of bytes appended to the archive.
+			 */
+			uint64_t appendRecordStore(
+			    const Impl &source);
+
+			/** @see ArchiveRecordStore::compact */
+			bool compact(
+			    uint64_t maxBytes);
+
+			/** @see ArchiveRecordStore::setSegmentSize */
+			void setSegmentSize(
+			    uint64_t size);
+
+			/** @see ArchiveRecordStore::getSegmentSize */
+			uint64_t getSegmentSize() const;
+
+			/** @see ArchiveRecordStore::setWriteBehind */
+			void setWriteBehind(
+			    uint64_t size);
+
+			/** @see ArchiveRecordStore::getWriteBehind */
+			uint64_t getWriteBehind() const;
+
+			/** @see ArchiveRecordStore::scan */
+			uint64_t scan(
+			    const std::function<void(const std::string &,
+			    const RecordStore::RecordView &)> &visitor,
+			    uint64_t chunkSize) const;
+
+			/** @see ArchiveRecordStore::getSequenceExtents */
+			std::vector<Extent> getSequenceExtents(
+			    uint64_t bytes) const;
+
 			/**
 			 * Obtain the name of the file storing the data for 
 			 * this store.
 			 *
 			 * @return
-			 *	Path to archive file.
+			 *	Path to the archive segment appended to.
 			 */
 			std::string getArchiveName() const;
 	
@@ -175,6 +247,20 @@ namespace BiometricEvaluation {
 			Impl(const ArchiveRecordStore&) = delete;
 			Impl& operator=(const Impl&) = delete;
 
+		protected:
+			void flushChanges() const override;
+
+			void
+			visitKeys(
+			    const std::function<void(const std::string &)>
+			    &visitor)
+			    const override;
+
+			/** @return Stamp of the manifest */
+			uint64_t
+			keyFilterStamp()
+			    const override;
+
 		private:
 			/** Info about a single archive element */
 			struct ManifestEntry
@@ -191,12 +277,219 @@ namespace BiometricEvaluation {
 
 			/** Convenience alias for storing the manifest */
 			using ManifestMap =
-			    Memory::OrderedMap<std::string, ManifestEntry>;
+			    Memory::FlatOrderedMap<std::string, ManifestEntry>;
+
+			/** Header of the binary manifest index */
+			struct IndexHeader
+			{
+				/** INDEX_MAGIC */
+				char magic[8];
+				/** INDEX_VERSION */
+				uint32_t version;
+				/** INDEX_BYTE_ORDER, as written by the host */
+				uint32_t byteOrder;
+				/** Length of the manifest the index covers */
+				uint64_t manifestSize;
+				/**
+				 * RecordStore::Impl::fileStamp() of the
+				 * manifest the index covers.
+				 */
+				uint64_t manifestStamp;
+				/** Inode of the manifest the index covers */
+				uint64_t manifestInode;
+				/** Number of IndexEntry, one per key */
+				uint64_t entryCount;
+				/** Number of removed entries */
+				uint64_t removedCount;
+				/**
+				 * Nonzero if the archive holds data of
+				 * removed or replaced records.
+				 */
+				uint64_t dirty;
+				/** Length of the key area */
+				uint64_t keySize;
+			};
+			using IndexHeader = struct IndexHeader;
+
+			/**
+			 * A single key in the binary manifest index.
+			 * @note
+			 * The index is laid out as the IndexHeader, entryCount
+			 * IndexEntry in sequence order, entryCount positions
+			 * into that table sorted by key, a tombstone bitmap
+			 * of removed entries, and finally the key area.
+			 */
+			struct IndexEntry
+			{
+				/** Offset of the key within the key area */
+				uint64_t keyOffset;
+				/** Length of the key */
+				uint64_t keyLength;
+				/** Offset of the data within the archive */
+				int64_t offset;
+				/** Length of the data */
+				uint64_t size;
+			};
+			using IndexEntry = struct IndexEntry;
+
+			/** Sections of the binary manifest index */
+			enum class IndexSection
+			{
+				Entries,
+				Sorted,
+				Tombstones,
+				Keys
+			};
+
+			/**
+			 * @brief
+			 * Locate a section of the binary manifest index.
+			 *
+			 * @param[in] section
+			 *	The section to locate.
+			 * @param[in] entryCount
+			 *	Number of entries in the index.
+			 *
+			 * @return
+			 *	Offset of section from the start of the index.
+			 */
+			static uint64_t
+			index_offset(
+			    IndexSection section,
+			    uint64_t entryCount);
+
+			/** Identifies a binary manifest index */
+			static constexpr char INDEX_MAGIC[8] = {'B', 'E',
+			    'A', 'R', 'C', 'I', 'D', 'X'};
+			/** Current version of the binary manifest index */
+			static const uint32_t INDEX_VERSION = 3;
+			/** Written in host order to detect foreign indexes */
+			static const uint32_t INDEX_BYTE_ORDER = 0x01020304;
+
+			/**
+			 * Records read with one read() may be separated by
+			 * up to this many unrequested bytes.
+			 */
+			static const uint64_t READ_COALESCE_GAP = 4 * 1024;
+			/** Largest single read() combining several records */
+			static const uint64_t READ_COALESCE_MAX =
+			    16 * 1024 * 1024;
+
+			/**
+			 * Alignment of the position, size, and memory of
+			 * reads made by scan(), sufficient for direct I/O.
+			 */
+			static const uint64_t SCAN_ALIGNMENT = 4 * 1024;
+
+			/**
+			 * Offsets in the manifest hold a segment number above
+			 * this many bits of position within the segment.
+			 */
+			static const unsigned int SEGMENT_SHIFT = 40;
+
+			/** An archive segment read from, but not appended to */
+			struct Segment
+			{
+				/** Read-only mapping, if mapped */
+				const uint8_t *map{nullptr};
+				/** Size of the mapping at map */
+				uint64_t mapSize{0};
+				/** Stream reading the segment, if opened */
+				std::unique_ptr<std::ifstream> fp{};
+			};
 
 			/** Manifest file handle */
 			mutable std::fstream _manifestfp;
-			/** Archive file handle */
+			/** Handle of the archive segment appended to */
 			mutable std::fstream _archivefp;
+
+			/** Number of the segment behind _archivefp */
+			uint64_t _activeSegment{0};
+			/**
+			 * Segments read other than through _archivefp.
+			 * Read-only stores map every segment.
+			 */
+			mutable std::map<uint64_t, Segment> _segments{};
+			/** Size at which a new segment is begun, 0 if never */
+			uint64_t _segmentSize{0};
+
+			/** Records and manifest entries written together */
+			struct WriteBatch
+			{
+				/** Archive segment the data is appended to */
+				std::string archiveName{};
+				/** Position of data within that segment */
+				uint64_t position{0};
+				/** Record data, contiguous in the segment */
+				std::vector<uint8_t> data{};
+				/** Manifest file */
+				std::string manifestName{};
+				/** Manifest lines, written after data */
+				std::string manifest{};
+			};
+			using WriteBatch = struct WriteBatch;
+
+			/**
+			 * Batches that may be waiting to be written at once,
+			 * each of up to 1 / WRITE_BEHIND_BATCHES of the
+			 * write-behind size.
+			 */
+			static const uint64_t WRITE_BEHIND_BATCHES = 4;
+
+			/** Bytes buffered by write-behind, 0 if disabled */
+			uint64_t _writeBehindSize{0};
+			/** Batch being filled by the caller's thread */
+			mutable WriteBatch _writeBatch{};
+			/** Offset following the last data not yet written */
+			mutable std::optional<long> _stagedEnd{};
+			/** Writes batches while write-behind is enabled */
+			std::thread _writer{};
+			/** Protects the members below */
+			mutable std::mutex _writeMutex{};
+			/** Signaled when a batch is queued or _writer stops */
+			mutable std::condition_variable _writeQueued{};
+			/** Signaled when a batch has been written */
+			mutable std::condition_variable _writeDone{};
+			/** Batches waiting for _writer */
+			mutable std::deque<WriteBatch> _writeQueue{};
+			/** Bytes in _writeQueue and being written */
+			mutable uint64_t _writeQueuedBytes{0};
+			/** Whether _writer is writing a batch */
+			mutable bool _writing{false};
+			/** Whether _writer has been asked to stop */
+			bool _writerStop{false};
+			/**
+			 * First error from _writer, rethrown to callers.
+			 * Kept for the life of this object, so that the count
+			 * is never committed once records have been lost.
+			 */
+			mutable std::exception_ptr _writeError{};
+
+			/** Whether compact() is part way through a pass */
+			bool _compacting{false};
+			/** Segments being emptied by the current pass */
+			std::deque<uint64_t> _compactSegments{};
+			/** First segment with moved records not yet synced */
+			uint64_t _compactTarget{0};
+			/** Records to move out of _compactSegments.front() */
+			std::vector<std::pair<std::string, ManifestEntry>>
+			    _compactEntries{};
+			/** Position of the next record to move */
+			size_t _compactNext{0};
+			/** Keys removed since the current pass began */
+			std::set<std::string> _compactRemoved{};
+
+			/**
+			 * Mapping of the binary manifest index, when used in
+			 * place of _entries by a read-only store.
+			 */
+			const uint8_t *_index{nullptr};
+			/** Size of the mapping at _index */
+			uint64_t _indexSize{0};
+			/** Position of iterator when sequencing _index */
+			uint64_t _indexCursor{0};
+			/** Whether the index on disk lags _entries */
+			mutable bool _indexStale{false};
 	
 			/*
 			 * Offsets and sizes of data chunks within the archive.
@@ -259,6 +552,488 @@ namespace BiometricEvaluation {
 			void
 			close_streams();
 	
+			/**
+			 * @brief
+			 * Map the binary manifest index, if it covers the
+			 * entire manifest.
+			 *
+			 * @details
+			 * The index is only trusted when the size,
+			 * modification time, and inode of the manifest
+			 * match those recorded by write_index(), so a
+			 * manifest rewritten at the same length is
+			 * detected.
+			 *
+			 * @return
+			 *	true if the index was mapped, false if it is
+			 *	missing, stale, or malformed.
+			 */
+			bool
+			map_index();
+
+			/**
+			 * @brief
+			 * Release the mapping created by map_index().
+			 */
+			void
+			unmap_index();
+
+			/**
+			 * @brief
+			 * Populate the manifest from the mapped index.
+			 */
+			void
+			load_index();
+
+			/**
+			 * @brief
+			 * Write the binary manifest index for _entries.
+			 *
+			 * @throw Error::StrategyError
+			 *	Problem with storage system
+			 */
+			void
+			write_index()
+			    const;
+
+			/**
+			 * @brief
+			 * Find a key's position in the mapped index.
+			 *
+			 * @param[in] key
+			 *	The key to look for.
+			 * @param[out] position
+			 *	The position of key in sequence order.
+			 *
+			 * @return
+			 *	true if key is in the index (even if
+			 *	removed), otherwise false.
+			 */
+			bool
+			index_find(
+			    const std::string &key,
+			    uint64_t &position)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the entry at a position in the mapped index.
+			 *
+			 * @param[in] position
+			 *	Position of the entry in sequence order.
+			 *
+			 * @return
+			 *	The entry, with the offset set to
+			 *	OFFSET_RECORD_REMOVED if it was removed.
+			 */
+			ManifestEntry
+			index_entry(
+			    uint64_t position)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the key at a position in the mapped index.
+			 *
+			 * @param[in] position
+			 *	Position of the entry in sequence order.
+			 *
+			 * @return
+			 *	The key.
+			 */
+			std::string
+			index_key(
+			    uint64_t position)
+			    const;
+
+			/**
+			 * @brief
+			 * Find the current entry for a key that has not
+			 * been removed.
+			 *
+			 * @param[in] key
+			 *	Key to find.
+			 *
+			 * @return
+			 *	The entry for key.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	key was never inserted or was removed.
+			 * @throw Error::StrategyError
+			 *	key is not a valid key.
+			 */
+			ManifestEntry
+			live_entry(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain every record that has not been removed.
+			 *
+			 * @return
+			 *	Keys and entries, in sequence order.
+			 */
+			std::vector<std::pair<std::string, ManifestEntry>>
+			live_entries()
+			    const;
+
+			/**
+			 * @brief
+			 * Count the records that have not been removed.
+			 *
+			 * @return
+			 *	Number of records in the manifest.
+			 */
+			uint64_t
+			count_live_entries()
+			    const;
+
+			/**
+			 * @brief
+			 * Find the current entry for a key, from either the
+			 * mapped index or _entries.
+			 *
+			 * @param[in] key
+			 *	The key to look for.
+			 * @param[out] entry
+			 *	The entry for key.
+			 *
+			 * @return
+			 *	true if key has an entry (even if removed),
+			 *	otherwise false.
+			 */
+			bool
+			find_entry(
+			    const std::string &key,
+			    ManifestEntry &entry)
+			    const;
+
+			/**
+			 * @brief
+			 * Map every archive segment into memory.
+			 * @details
+			 * Only done for stores opened read-only, so that
+			 * records remain readable after compact() in another
+			 * process deletes their segment. Segments that cannot
+			 * be mapped are read through a stream instead.
+			 */
+			void
+			map_archive();
+
+			/**
+			 * @brief
+			 * Release the mappings and streams of _segments.
+			 */
+			void
+			unmap_archive();
+
+			/**
+			 * @brief
+			 * Obtain the path to an archive segment.
+			 *
+			 * @param[in] segment
+			 *	Segment number. Segment 0 is ARCHIVE_FILE_NAME.
+			 *
+			 * @return
+			 *	Path to the segment.
+			 */
+			std::string
+			segment_name(
+			    uint64_t segment)
+			    const;
+
+			/**
+			 * @brief
+			 * Find the archive segments present on disk.
+			 *
+			 * @return
+			 *	Segment numbers, in ascending order.
+			 *
+			 * @throw Error::StrategyError
+			 *	The store directory could not be read.
+			 */
+			std::vector<uint64_t>
+			find_segments()
+			    const;
+
+			/** @return Segment holding the data at offset. */
+			static uint64_t
+			offset_segment(
+			    long offset);
+
+			/** @return Position of offset within its segment. */
+			static uint64_t
+			offset_position(
+			    long offset);
+
+			/**
+			 * @brief
+			 * Locate record data within a mapped segment.
+			 *
+			 * @param[in] entry
+			 *	Location of the data.
+			 *
+			 * @return
+			 *	Pointer to the data, or nullptr if its segment
+			 *	is not mapped.
+			 *
+			 * @throw Error::StrategyError
+			 *	The segment is truncated.
+			 */
+			const uint8_t *
+			mapped_data(
+			    const ManifestEntry &entry)
+			    const;
+
+			/**
+			 * @brief
+			 * Copy record data out of the archive.
+			 *
+			 * @param[in] offset
+			 *	Offset of the data.
+			 * @param[in] size
+			 *	Number of bytes to copy.
+			 * @param[out] data
+			 *	Buffer of at least size bytes.
+			 *
+			 * @throw Error::StrategyError
+			 *	The data could not be read.
+			 */
+			void
+			read_data(
+			    long offset,
+			    uint64_t size,
+			    uint8_t *data)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the position in the active segment at which
+			 * data will be appended.
+			 * @details
+			 * A new segment is begun first when size bytes would
+			 * take the active segment past _segmentSize.
+			 *
+			 * @param[in] size
+			 *	Number of bytes about to be appended.
+			 *
+			 * @return
+			 *	Offset at which the data will be appended.
+			 *
+			 * @throw Error::StrategyError
+			 *	The archive could not be opened or positioned.
+			 */
+			long
+			append_position(
+			    uint64_t size);
+
+			/**
+			 * @brief
+			 * Visit the records of one archive segment for scan().
+			 *
+			 * @param[in] entries
+			 *	Records, in archive order.
+			 * @param[in] first
+			 *	Position in entries of the segment's first
+			 *	record.
+			 * @param[in] last
+			 *	Position in entries after the segment's last
+			 *	record.
+			 * @param[in] chunkSize
+			 *	Bytes read at a time, a multiple of
+			 *	SCAN_ALIGNMENT.
+			 * @param[in] visitor
+			 *	Called with the key and data of each record.
+			 *
+			 * @throw Error::StrategyError
+			 *	The segment could not be read or is truncated.
+			 */
+			void
+			scan_segment(
+			    const std::vector<std::pair<std::string,
+			    ManifestEntry>> &entries,
+			    size_t first,
+			    size_t last,
+			    uint64_t chunkSize,
+			    const std::function<void(const std::string &,
+			    const RecordStore::RecordView &)> &visitor)
+			    const;
+
+			/**
+			 * @brief
+			 * Append record data to the active segment, at the
+			 * position given by append_position().
+			 *
+			 * @param[in] data
+			 *	Data to append.
+			 * @param[in] size
+			 *	Size of data.
+			 *
+			 * @return
+			 *	Offset of the data.
+			 *
+			 * @throw Error::StrategyError
+			 *	The data could not be written.
+			 */
+			long
+			append_data(
+			    const void *data,
+			    uint64_t size);
+
+			/**
+			 * @brief
+			 * Determine whether data must begin a new segment.
+			 *
+			 * @param[in] position
+			 *	Position in the active segment at which the
+			 *	data would be appended.
+			 * @param[in] size
+			 *	Number of bytes to append.
+			 *
+			 * @return
+			 *	true if a new segment must be begun.
+			 */
+			bool
+			needs_roll(
+			    uint64_t position,
+			    uint64_t size)
+			    const;
+
+			/**
+			 * @brief
+			 * Copy record data into the write-behind batch.
+			 *
+			 * @param[in] data
+			 *	Data to append.
+			 * @param[in] size
+			 *	Size of data.
+			 *
+			 * @return
+			 *	Offset the data will be written at.
+			 *
+			 * @throw Error::StrategyError
+			 *	The archive could not be positioned, or an
+			 *	earlier batch could not be written.
+			 */
+			long
+			stage_data(
+			    const void *data,
+			    uint64_t size);
+
+			/**
+			 * @brief
+			 * Queue the write-behind batch for the writer.
+			 * @details
+			 * Waits while the queue holds the write-behind size.
+			 *
+			 * @throw Error::StrategyError
+			 *	An earlier batch could not be written.
+			 */
+			void
+			submit_batch()
+			    const;
+
+			/**
+			 * @brief
+			 * Throw the error, if any, that stopped write-behind.
+			 *
+			 * @throw Error::StrategyError
+			 *	A batch could not be written.
+			 */
+			void
+			check_write_error()
+			    const;
+
+			/**
+			 * @brief
+			 * Wait until everything buffered by write-behind has
+			 * been written.
+			 * @details
+			 * Does nothing if write-behind is disabled.
+			 *
+			 * @throw Error::StrategyError
+			 *	A batch could not be written.
+			 */
+			void
+			drain_writes()
+			    const;
+
+			/**
+			 * @brief
+			 * Write queued batches until asked to stop.
+			 * @details
+			 * Runs on _writer.
+			 */
+			void
+			write_behind();
+
+			/**
+			 * @brief
+			 * Stop and join _writer, once drained.
+			 */
+			void
+			stop_write_behind();
+
+			/**
+			 * @brief
+			 * Write a batch's data, then its manifest lines.
+			 *
+			 * @param[in] batch
+			 *	The batch to write.
+			 *
+			 * @throw Error::StrategyError
+			 *	The batch could not be written.
+			 */
+			static void
+			write_batch(
+			    const WriteBatch &batch);
+
+			/**
+			 * @brief
+			 * Begin appending to a new, empty segment.
+			 *
+			 * @throw Error::StrategyError
+			 *	The segment could not be created.
+			 */
+			void
+			roll_segment();
+
+			/**
+			 * @brief
+			 * Replace the manifest with one that has a single
+			 * line per record.
+			 * @details
+			 * The new manifest is synchronized to stable storage
+			 * and renamed over the old one, so that readers, and
+			 * the store after a crash, find one or the other in
+			 * full.
+			 *
+			 * @param[in] entries
+			 *	Every entry to keep, in order.
+			 *
+			 * @throw Error::StrategyError
+			 *	The manifest could not be replaced.
+			 */
+			void
+			rewrite_manifest(
+			    const std::vector<std::pair<std::string,
+			    ManifestEntry>> &entries);
+
+			/**
+			 * @brief
+			 * Finish a compaction pass once every old segment
+			 * has been emptied and deleted.
+			 * @details
+			 * The manifest is rewritten and the index written
+			 * to match, both on stable storage.
+			 *
+			 * @throw Error::StrategyError
+			 *	The manifest or index could not be replaced.
+			 */
+			void
+			finish_compaction();
+
 			/**
 			 * @brief
 			 * Use the most efficient method for inserting an item
@@ -312,6 +1087,27 @@ namespace BiometricEvaluation {
 			i_sequence(
 			    bool returnData,
 			    int cursor); 
+
+			/**
+			 * Implementation of i_sequence() for stores searching
+			 * the mapped index.
+			 * @param[in] returnData
+			 * 	Whether to return the data with the key.
+			 * @param[in] cursor
+			 *	The location within the sequence of the
+			 *	key/data pair to return.
+			 * @return
+			 *	The record that is next in sequence.
+			 * @throw Error::ObjectDoesNotExist
+			 *	End of sequencing.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			RecordStore::Record
+			i_sequence_index(
+			    bool returnData,
+			    int cursor);
 		};
 	}
 }
@@ -74,6 +74,13 @@ BiometricEvaluation::IO::CompressedRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::setCommitPolicy(
+    const CommitPolicy &policy)
+{
+	this->pimpl->setCommitPolicy(policy);
+}
+
 void
 BiometricEvaluation::IO::CompressedRecordStore::insert( 
     const std::string &key,
@@ -163,3 +170,24 @@ BiometricEvaluation::IO::CompressedRecordStore::changeDescription(
 	return (this->pimpl->changeDescription(description));
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::setDictionary(
+    const Memory::uint8Array &dictionary)
+{
+	this->pimpl->setDictionary(dictionary);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::CompressedRecordStore::getDictionary()
+    const
+{
+	return (this->pimpl->getDictionary());
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::trainDictionary(
+    const std::vector<Memory::uint8Array> &samples,
+    uint64_t maxSize)
+{
+	this->pimpl->trainDictionary(samples, maxSize);
+}
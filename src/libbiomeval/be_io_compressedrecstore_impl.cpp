@@ -8,13 +8,17 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
 
+#include <zlib.h>
+
 #include "be_io_compressedrecstore_impl.h"
 #include <be_memory_autoarrayutility.h>
 #include <be_io_properties.h>
+#include <be_io_utility.h>
 
 namespace BE = BiometricEvaluation;
 
@@ -23,24 +27,71 @@ using namespace BE::Framework::Enumeration;
 const std::string BACKING_STORE{"theBackingStore"};
 const std::string COMPRESSOR_TYPE_KEY{"Compressor_Type"};
 const std::string METADATA_SUFFIX{"_md"};
+const std::string DICTIONARY_FILE{"dictionary"};
+const std::string FORMAT_VERSION_KEY{"Format_Version"};
+
+/** Uncompressed sizes are kept in a second, metadata, RecordStore */
+const int64_t FORMAT_VERSION_METADATA_STORE = 1;
+/** Records begin with a header holding the uncompressed size */
+const int64_t FORMAT_VERSION_RECORD_HEADER = 2;
+
+/*
+ * Record header, all little-endian:
+ *	uint8_t   header version
+ *	uint8_t   Compressor::Kind
+ *	uint16_t  reserved (0)
+ *	uint32_t  CRC-32 of the compressed data that follows
+ *	uint64_t  uncompressed size
+ */
+const uint8_t RECORD_HEADER_VERSION = 1;
+const uint64_t RECORD_HEADER_SIZE = 16;
+
+static uint32_t
+checksum(
+    const uint8_t *const data,
+    uint64_t size)
+{
+	return (static_cast<uint32_t>(crc32_z(crc32_z(0, Z_NULL, 0), data,
+	    size)));
+}
+
+static void
+writeLittleEndian(
+    uint8_t *const buf,
+    uint64_t value,
+    uint8_t size)
+{
+	for (uint8_t i = 0; i < size; i++)
+		buf[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint64_t
+readLittleEndian(
+    const uint8_t *const buf,
+    uint8_t size)
+{
+	uint64_t value = 0;
+	for (uint8_t i = 0; i < size; i++)
+		value |= static_cast<uint64_t>(buf[i]) << (8 * i);
+	return (value);
+}
 
 BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
     const std::string &pathname,
     const std::string &description,
     const RecordStore::Kind &recordStoreType,
     const std::string &compressorType) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::Compressed)
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Compressed),
+    _formatVersion{FORMAT_VERSION_RECORD_HEADER}
 {
 	std::string rsPath = pathname + '/' +  BACKING_STORE;
 	this->_rs = IO::RecordStore::createRecordStore(rsPath, description,
 	    recordStoreType);
-	rsPath = rsPath + METADATA_SUFFIX;
-	this->_mdrs = IO::RecordStore::createRecordStore(rsPath, description,
-	    recordStoreType);
 	try {
-		this->_compressor = 
-		    IO::Compressor::createCompressor(
-		        to_enum<IO::Compressor::Kind>(compressorType));
+		this->_compressorKind = to_enum<IO::Compressor::Kind>(
+		    compressorType);
+		this->_compressor = IO::Compressor::createCompressor(
+		    this->_compressorKind);
 	} catch (const Error::ObjectDoesNotExist&) {
 		throw Error::StrategyError(compressorType + " is not a valid "
 		    "compressor type");
@@ -49,6 +100,7 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
 	/* Store compressor type */
 	std::shared_ptr<IO::Properties> props = this->getProperties();
 	props->setProperty(COMPRESSOR_TYPE_KEY, compressorType);
+	props->setPropertyFromInteger(FORMAT_VERSION_KEY, this->_formatVersion);
 	this->setProperties(props);
 }
 
@@ -57,14 +109,13 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
     const std::string &description,
     const RecordStore::Kind &recordStoreType,
     const Compressor::Kind &compressorType) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::Compressed)
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Compressed),
+    _compressorKind{compressorType},
+    _formatVersion{FORMAT_VERSION_RECORD_HEADER}
 {
 	std::string rsPath = pathname + '/' +  BACKING_STORE;
 	this->_rs = IO::RecordStore::createRecordStore(rsPath, description,
 	     recordStoreType);
-	rsPath = rsPath + METADATA_SUFFIX;
-	this->_mdrs = IO::RecordStore::createRecordStore(rsPath, description,
-	    recordStoreType);
 	this->_compressor = IO::Compressor::createCompressor(compressorType);
 
 	/* Store compressor type */
@@ -75,6 +126,7 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
 	} catch (const Error::ObjectDoesNotExist&) {
 		throw Error::StrategyError("Invalid compression type");
 	}
+	props->setPropertyFromInteger(FORMAT_VERSION_KEY, this->_formatVersion);
 	this->setProperties(props);	
 }
 
@@ -83,27 +135,68 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
     IO::Mode mode) :
     RecordStore::Impl(pathname, mode)
 {    
-	std::string rsPath = pathname + '/' +  BACKING_STORE;
-	this->_rs = RecordStore::openRecordStore(rsPath, mode);
-	rsPath = rsPath + METADATA_SUFFIX;
-	this->_mdrs = RecordStore::openRecordStore(rsPath, mode);
 	std::shared_ptr<IO::Properties> props = this->getProperties();
 	std::string compressorType = props->getProperty(COMPRESSOR_TYPE_KEY);
+
+	/* Stores that predate the format version keep sizes in _mdrs */
+	try {
+		this->_formatVersion = props->getPropertyAsInteger(
+		    FORMAT_VERSION_KEY);
+	} catch (const Error::ObjectDoesNotExist&) {
+		this->_formatVersion = FORMAT_VERSION_METADATA_STORE;
+	}
+	if ((this->_formatVersion != FORMAT_VERSION_METADATA_STORE) &&
+	    (this->_formatVersion != FORMAT_VERSION_RECORD_HEADER))
+		throw Error::StrategyError("Unsupported format version " +
+		    std::to_string(this->_formatVersion));
+
+	std::string rsPath = pathname + '/' +  BACKING_STORE;
+	this->_rs = RecordStore::openRecordStore(rsPath, mode);
+	if (this->_formatVersion == FORMAT_VERSION_METADATA_STORE) {
+		rsPath = rsPath + METADATA_SUFFIX;
+		this->_mdrs = RecordStore::openRecordStore(rsPath, mode);
+	}
 	
 	/* Parse compressor type */
 	try {
-		this->_compressor =
-			IO::Compressor::createCompressor(to_enum<Compressor::Kind>(
-			compressorType));
+		this->_compressorKind = to_enum<Compressor::Kind>(
+		    compressorType);
+		this->_compressor = IO::Compressor::createCompressor(
+		    this->_compressorKind);
 	} catch (const BE::Error::Exception& e) {
 		throw Error::StrategyError(compressorType + " is not a valid "
 		    "compressor type: " + e.whatString());
 	}
+
+	/* Records were compressed with this dictionary, if present */
+	const std::string dictionaryPath = this->canonicalName(
+	    DICTIONARY_FILE);
+	if (IO::Utility::fileExists(dictionaryPath)) {
+		try {
+			this->_compressor->setDictionary(
+			    IO::Utility::readFile(dictionaryPath));
+		} catch (const BE::Error::Exception &e) {
+			throw Error::StrategyError("Could not load dictionary: " +
+			    e.whatString());
+		}
+	}
+
+	/* Every record is one record of the backing store */
+	if (this->isCountStale())
+		this->recoverCount(this->_rs->getCount());
 }
 
 BiometricEvaluation::IO::CompressedRecordStore::Impl::~Impl()
 {
+	if (this->getMode() == Mode::ReadOnly)
+		return;
 
+	try {
+		this->flushChanges();
+		this->commitOnClose();
+	} catch (const Error::Exception &) {
+		/* The count is recovered when next opened */
+	}
 }
 
 void
@@ -117,6 +210,24 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::insert(
 		
 	Memory::uint8Array compressedData = _compressor->compress(
 	    static_cast<const uint8_t *const>(data), size);
+	this->beginChange();
+	if (this->_formatVersion == FORMAT_VERSION_RECORD_HEADER) {
+		Memory::uint8Array record(RECORD_HEADER_SIZE +
+		    compressedData.size());
+		record[0] = RECORD_HEADER_VERSION;
+		record[1] = static_cast<uint8_t>(this->_compressorKind);
+		writeLittleEndian(&record[2], 0, 2);
+		writeLittleEndian(&record[4], checksum(compressedData,
+		    compressedData.size()), 4);
+		writeLittleEndian(&record[8], size, 8);
+		if (compressedData.size() != 0)
+			std::memcpy(&record[RECORD_HEADER_SIZE],
+			    compressedData, compressedData.size());
+		_rs->insert(key, record);
+
+		RecordStore::Impl::insert(key, data, size);
+		return;
+	}
 	_rs->insert(key, compressedData);
 
 	std::ostringstream sizeStr;
@@ -133,6 +244,10 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::length(
     const std::string &key)
     const
 {
+	if (this->_formatVersion == FORMAT_VERSION_RECORD_HEADER)
+		return (this->readRecordHeader(_rs->readPrefix(key,
+		    RECORD_HEADER_SIZE)));
+
 	Memory::uint8Array buf = _mdrs->read(key);
 	return (static_cast<uint64_t>(atoll(
 	    Memory::AutoArrayUtility::getString(buf, buf.size()).c_str())));
@@ -143,6 +258,9 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::read(
     const std::string &key)
     const
 {
+	if (this->_formatVersion == FORMAT_VERSION_RECORD_HEADER)
+		return (this->decompressRecord(_rs->read(key)));
+
 	Memory::uint8Array compressedData = _rs->read(key);
 	
 	Memory::uint8Array decompressedData = _compressor->decompress(
@@ -150,12 +268,53 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::read(
 	return (decompressedData);
 }
 
+uint64_t
+BiometricEvaluation::IO::CompressedRecordStore::Impl::readRecordHeader(
+    const Memory::uint8Array &record)
+    const
+{
+	if ((record.size() < RECORD_HEADER_SIZE) ||
+	    (record[0] != RECORD_HEADER_VERSION))
+		throw Error::StrategyError("Invalid record header");
+	if (record[1] != static_cast<uint8_t>(this->_compressorKind))
+		throw Error::StrategyError("Record was compressed with a "
+		    "different compressor");
+
+	return (readLittleEndian(&record[8], 8));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::CompressedRecordStore::Impl::decompressRecord(
+    const Memory::uint8Array &record)
+    const
+{
+	const uint64_t size = this->readRecordHeader(record);
+	const uint8_t *const compressedData = &record[RECORD_HEADER_SIZE];
+	const uint64_t compressedDataSize = record.size() - RECORD_HEADER_SIZE;
+	if (checksum(compressedData, compressedDataSize) !=
+	    readLittleEndian(&record[4], 4))
+		throw Error::StrategyError("Record checksum mismatch");
+
+	Memory::uint8Array decompressedData(size);
+	_compressor->decompress(compressedData, compressedDataSize,
+	    decompressedData, size);
+	return (decompressedData);
+}
+
 BiometricEvaluation::IO::RecordStore::Record
 BiometricEvaluation::IO::CompressedRecordStore::Impl::i_sequence(
     bool returnData,
     int cursor)
 {
 	BE::IO::RecordStore::Record record;
+	if ((returnData == true) &&
+	    (this->_formatVersion == FORMAT_VERSION_RECORD_HEADER)) {
+		/* Headers make the stored record self-describing */
+		record = _rs->sequence(cursor);
+		record.data = this->decompressRecord(record.data);
+		return (record);
+	}
+
 	/* Obtain the next key, but not data, since it is compressed */
 	record.key = _rs->sequenceKey(cursor);
 	
@@ -187,8 +346,10 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::remove(
 	if (this->getMode() == Mode::ReadOnly)
 		throw Error::StrategyError(RSREADONLYERROR);
 		
+	this->beginChange();
 	_rs->remove(key);
-	_mdrs->remove(key);
+	if (_mdrs != nullptr)
+		_mdrs->remove(key);
 	RecordStore::Impl::remove(key);
 }
 
@@ -200,10 +361,31 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::sync()
 		return;
 		
 	_rs->sync();
-	_mdrs->sync();
+	if (_mdrs != nullptr)
+		_mdrs->sync();
 	RecordStore::Impl::sync();
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::setCommitPolicy(
+    const RecordStore::CommitPolicy &policy)
+{
+	_rs->setCommitPolicy(policy);
+	if (_mdrs != nullptr)
+		_mdrs->setCommitPolicy(policy);
+	RecordStore::Impl::setCommitPolicy(policy);
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::flushChanges()
+    const
+{
+	/* The count is only current once the backing stores' counts are */
+	_rs->sync();
+	if (_mdrs != nullptr)
+		_mdrs->sync();
+}
+
 void
 BiometricEvaluation::IO::CompressedRecordStore::Impl::move(
     const std::string &pathname)
@@ -218,8 +400,11 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::move(
 
 	std::string rsPath = pathname + '/' +  BACKING_STORE;
 	_rs = RecordStore::Impl::openRecordStore(rsPath, IO::Mode::ReadWrite);
-	rsPath = rsPath + METADATA_SUFFIX;
-	_mdrs = RecordStore::Impl::openRecordStore(rsPath, IO::Mode::ReadWrite);
+	if (this->_formatVersion == FORMAT_VERSION_METADATA_STORE) {
+		rsPath = rsPath + METADATA_SUFFIX;
+		_mdrs = RecordStore::Impl::openRecordStore(rsPath,
+		    IO::Mode::ReadWrite);
+	}
 }
 
 void
@@ -233,7 +418,8 @@ uint64_t
 BiometricEvaluation::IO::CompressedRecordStore::Impl::getSpaceUsed()
     const
 {
-	return (_rs->getSpaceUsed() + _mdrs->getSpaceUsed() + 
+	return (_rs->getSpaceUsed() +
+	    (_mdrs != nullptr ? _mdrs->getSpaceUsed() : 0) +
 	    RecordStore::Impl::getSpaceUsed());
 }
 
@@ -246,6 +432,51 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::flush(
 		throw Error::StrategyError(RSREADONLYERROR);
 		
 	_rs->flush(key);
-	_mdrs->flush(key);
+	if (_mdrs != nullptr)
+		_mdrs->flush(key);
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::setDictionary(
+    const Memory::uint8Array &dictionary)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+	if (this->getCount() != 0)
+		throw Error::StrategyError("Dictionary can only be set on an "
+		    "empty RecordStore");
+
+	this->_compressor->setDictionary(dictionary);
+
+	const std::string dictionaryPath = this->canonicalName(
+	    DICTIONARY_FILE);
+	if (dictionary.size() == 0) {
+		if (IO::Utility::fileExists(dictionaryPath) &&
+		    (std::remove(dictionaryPath.c_str()) != 0))
+			throw Error::StrategyError("Could not remove " +
+			    dictionaryPath);
+		return;
+	}
+	try {
+		IO::Utility::writeFile(dictionary, dictionaryPath);
+	} catch (const BE::Error::Exception &e) {
+		throw Error::StrategyError("Could not save dictionary: " +
+		    e.whatString());
+	}
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::CompressedRecordStore::Impl::getDictionary()
+    const
+{
+	return (this->_compressor->getDictionary());
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::trainDictionary(
+    const std::vector<Memory::uint8Array> &samples,
+    uint64_t maxSize)
+{
+	this->setDictionary(this->_compressor->trainDictionary(samples,
+	    maxSize));
+}
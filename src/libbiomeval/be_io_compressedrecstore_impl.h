@@ -107,6 +107,10 @@ namespace BiometricEvaluation
 			void
 			sync() const;
 
+			void
+			setCommitPolicy(
+			    const RecordStore::CommitPolicy &policy);
+
 			void
 			insert(
 			    const std::string &key,
@@ -145,6 +149,19 @@ namespace BiometricEvaluation
 			move(
 			    const std::string &pathname);
 
+			void
+			setDictionary(
+			    const Memory::uint8Array &dictionary);
+
+			Memory::uint8Array
+			getDictionary()
+			    const;
+
+			void
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxSize);
+
 			/**
 			 * @brief
 			 * Copy constructor (disabled).
@@ -176,15 +193,65 @@ namespace BiometricEvaluation
 			operator=(
 			    const CompressedRecordStore &rhs) = delete;
 
+		protected:
+			void flushChanges() const override;
+
 		private:
 			/** Underlying RecordStore */
 			std::shared_ptr<IO::RecordStore> _rs;
 			
-			/** Metadata RecordStore */
+			/**
+			 * Metadata RecordStore, holding uncompressed sizes
+			 * (only for stores that predate record headers).
+			 */
 			std::shared_ptr<IO::RecordStore> _mdrs;
 			
 			/** Underlying Compressor */
 			std::shared_ptr<IO::Compressor> _compressor;
+
+			/** Kind of _compressor */
+			Compressor::Kind _compressorKind{Compressor::Kind::GZIP};
+
+			/** Layout of records in the backing store */
+			int64_t _formatVersion;
+
+			/**
+			 * @brief
+			 * Validate a record's header.
+			 *
+			 * @param[in] record
+			 *	Record, or at least its header, as stored in
+			 *	_rs.
+			 *
+			 * @return
+			 *	Uncompressed size of the record.
+			 *
+			 * @throw Error::StrategyError
+			 *	Header is invalid or names another compressor.
+			 */
+			uint64_t
+			readRecordHeader(
+			    const Memory::uint8Array &record)
+			    const;
+
+			/**
+			 * @brief
+			 * Decompress a record that begins with a header.
+			 *
+			 * @param[in] record
+			 *	Record, as stored in _rs.
+			 *
+			 * @return
+			 *	Uncompressed data.
+			 *
+			 * @throw Error::StrategyError
+			 *	Header or checksum is invalid, or error
+			 *	decompressing.
+			 */
+			Memory::uint8Array
+			decompressRecord(
+			    const Memory::uint8Array &record)
+			    const;
 			
 			/**
 			 * Internal implementation of sequencing through a
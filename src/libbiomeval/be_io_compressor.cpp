@@ -8,15 +8,25 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cstring>
+
 #include <be_framework_enumeration.h>
 #include <be_io_compressor.h>
 
 /* Include children for factory */
 #include <be_io_gzip.h>
+#ifdef BIOMEVAL_WITH_ZSTD
+#include <be_io_zstd.h>
+#endif
+#ifdef BIOMEVAL_WITH_LZ4
+#include <be_io_lz4.h>
+#endif
 
 const std::map<BiometricEvaluation::IO::Compressor::Kind, std::string>
 BE_IO_Compressor_Kind_EnumToStringMap = {
-	{BiometricEvaluation::IO::Compressor::Kind::GZIP, "GZIP"}
+	{BiometricEvaluation::IO::Compressor::Kind::GZIP, "GZIP"},
+	{BiometricEvaluation::IO::Compressor::Kind::ZSTD, "ZSTD"},
+	{BiometricEvaluation::IO::Compressor::Kind::LZ4, "LZ4"}
 };
 
 BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
@@ -76,11 +86,68 @@ BiometricEvaluation::IO::Compressor::createCompressor(
 	switch (compressorKind) {
 	case Kind::GZIP:
 		return (std::shared_ptr<Compressor>(new GZip()));
+	case Kind::ZSTD:
+#ifdef BIOMEVAL_WITH_ZSTD
+		return (std::shared_ptr<Compressor>(new Zstd()));
+#else
+		throw Error::NotImplemented("Zstandard support was not built");
+#endif
+	case Kind::LZ4:
+#ifdef BIOMEVAL_WITH_LZ4
+		return (std::shared_ptr<Compressor>(new LZ4()));
+#else
+		throw Error::NotImplemented("LZ4 support was not built");
+#endif
 	default:
 		throw Error::ObjectDoesNotExist("Invalid compressor type");
 	}
 }
 
+void
+BiometricEvaluation::IO::Compressor::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	const Memory::uint8Array decompressedData = this->decompress(
+	    compressedData, compressedDataSize);
+	if (decompressedData.size() != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed size does not match");
+	if (uncompressedDataSize != 0)
+		std::memcpy(uncompressedData, decompressedData,
+		    uncompressedDataSize);
+}
+
+void
+BiometricEvaluation::IO::Compressor::setDictionary(
+    const Memory::uint8Array &dictionary)
+{
+	(void)dictionary;
+	throw Error::NotImplemented("Compressor does not support "
+	    "dictionaries");
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::getDictionary()
+    const
+{
+	return (Memory::uint8Array());
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::trainDictionary(
+    const std::vector<Memory::uint8Array> &samples,
+    uint64_t maxSize)
+    const
+{
+	(void)samples;
+	(void)maxSize;
+	throw Error::NotImplemented("Compressor does not support "
+	    "dictionaries");
+}
+
 BiometricEvaluation::IO::Compressor::~Compressor()
 {
 
@@ -57,6 +57,13 @@ BiometricEvaluation::IO::DBRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::DBRecordStore::setCommitPolicy(
+    const CommitPolicy &policy)
+{
+	this->pimpl->setCommitPolicy(policy);
+}
+
 void
 BiometricEvaluation::IO::DBRecordStore::insert( 
     const std::string &key,
@@ -81,6 +88,14 @@ BiometricEvaluation::IO::DBRecordStore::read(
 	return (this->pimpl->read(key));
 }
 
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::DBRecordStore::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->read(keys));
+}
+
 uint64_t
 BiometricEvaluation::IO::DBRecordStore::length(
     const std::string &key)
@@ -89,6 +104,14 @@ BiometricEvaluation::IO::DBRecordStore::length(
 	return (this->pimpl->length(key));
 }
 
+std::vector<uint64_t>
+BiometricEvaluation::IO::DBRecordStore::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->length(keys));
+}
+
 void
 BiometricEvaluation::IO::DBRecordStore::flush(
     const std::string &key)
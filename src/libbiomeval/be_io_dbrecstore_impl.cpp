@@ -8,10 +8,13 @@
  * about its quality, reliability, or any other characteristic.
  ******************************************************************************/
 
+#include <algorithm>
 #include <climits>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <numeric>
 #include <sstream>
 #include <iostream>
 
@@ -239,6 +242,20 @@ BiometricEvaluation::IO::DBRecordStore::Impl::Impl(
 		break;
 	}
 
+	/* Every record has one key in the primary database */
+	if (this->isCountStale()) {
+		DB_BTREE_STAT *statistics{nullptr};
+		try {
+			this->_dbP->stat(nullptr, &statistics, 0);
+		} catch (const DbException &e) {
+			throw Error::StrategyError("Could not count records "
+			    "(DB error = " + std::to_string(e.get_errno()) +
+			    " -- " + e.what() + ")");
+		}
+		const uint64_t count = statistics->bt_nkeys;
+		std::free(statistics);
+		this->recoverCount(count);
+	}
 }
 
 BiometricEvaluation::IO::DBRecordStore::Impl::~Impl()
@@ -249,6 +266,7 @@ BiometricEvaluation::IO::DBRecordStore::Impl::~Impl()
 		this->_dbP->close(0);
 	if (this->_dbS != nullptr)
 		this->_dbS->close(0);
+	this->commitOnClose();
 }
 
 void
@@ -348,7 +366,15 @@ BiometricEvaluation::IO::DBRecordStore::Impl::sync()
 	if (getMode() == Mode::ReadOnly)
 		return;
 
+	this->flushChanges();
 	RecordStore::Impl::sync();
+}
+
+void
+BiometricEvaluation::IO::DBRecordStore::Impl::flushChanges()
+    const
+{
+	/* Changes are cached by Berkeley DB until synchronized */
 	int rc = this->_dbP->sync(0);
 	if (rc != 0)
 		throw Error::StrategyError("Could not sync primary DB (" +
@@ -375,6 +401,7 @@ BiometricEvaluation::IO::DBRecordStore::Impl::insert(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	this->beginChange();
 	insertRecordSegments(key, data, size);
 	if (!this->_cursorIsInit) {
 		Dbt dbtkey;
@@ -418,6 +445,7 @@ BiometricEvaluation::IO::DBRecordStore::Impl::remove(
 		throw Error::StrategyError("Invalid key format");
 
 	/* Allow exceptions to float out of this function. */
+	this->beginChange();
 	removeRecordSegments(key);
 
 	/*
@@ -471,6 +499,91 @@ BiometricEvaluation::IO::DBRecordStore::Impl::length(
 	return (readRecordSegments(key, nullptr));
 }
 
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::DBRecordStore::Impl::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	const std::vector<size_t> order = this->keyOrder(keys);
+	std::vector<BE::Memory::uint8Array> records(keys.size());
+
+	/* A private cursor leaves the sequencing cursor untouched */
+	Dbc *dbC{nullptr};
+	try {
+		this->_dbP->cursor(nullptr, &dbC, 0);
+	} catch (const DbException &e) {
+		throw BE::Error::StrategyError("Could not create DB cursor "
+		    "(DB error = " + std::to_string(
+		    e.get_errno()) + " -- " + e.what() + ")");
+	}
+	const std::unique_ptr<Dbc, void(*)(Dbc*)> cursor(dbC,
+	    [](Dbc *c) { c->close(); });
+
+	for (size_t i = 0; i < order.size(); i++) {
+		const std::string &key = keys[order[i]];
+
+		/* Repeated keys are adjacent once ordered */
+		if ((i > 0) && (keys[order[i - 1]] == key)) {
+			records[order[i]] = records[order[i - 1]];
+			continue;
+		}
+
+		Dbt dbtkey((void *)key.data(), key.size());
+		Dbt dbtdata;
+		const int rc = cursor->get(&dbtkey, &dbtdata, DB_SET);
+		switch (rc) {
+		case 0:
+			break;
+		case DB_NOTFOUND:
+			throw Error::ObjectDoesNotExist(key);
+		default:
+			throw Error::StrategyError("Error reading database "
+			    "(" + std::to_string(rc) + ")");
+		}
+
+		/* Only records of a single segment are copied directly */
+		if (dbtdata.get_size() < MAX_REC_SIZE) {
+			records[order[i]].resize(dbtdata.get_size());
+			if (dbtdata.get_size() != 0)
+				std::memcpy(records[order[i]],
+				    dbtdata.get_data(), dbtdata.get_size());
+		} else
+			records[order[i]] = this->read(key);
+	}
+
+	return (records);
+}
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::DBRecordStore::Impl::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	std::vector<uint64_t> lengths(keys.size());
+	for (const auto i : this->keyOrder(keys))
+		lengths[i] = this->readRecordSegments(keys[i], nullptr);
+	return (lengths);
+}
+
+std::vector<size_t>
+BiometricEvaluation::IO::DBRecordStore::Impl::keyOrder(
+    const std::vector<std::string> &keys)
+    const
+{
+	for (const auto &key : keys)
+		if (!validateKeyString(key))
+			throw Error::StrategyError("Invalid key format");
+
+	/* The B-tree uses the default lexical comparison of keys */
+	std::vector<size_t> order(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+	    [&](const size_t lhs, const size_t rhs) {
+		return (keys[lhs] < keys[rhs]);
+	});
+	return (order);
+}
+
 void
 BiometricEvaluation::IO::DBRecordStore::Impl::flush(
     const std::string &key)
@@ -86,6 +86,10 @@ namespace BiometricEvaluation {
 			read(
 			    const std::string &key) const;
 
+			std::vector<Memory::uint8Array>
+			read(
+			    const std::vector<std::string> &keys) const;
+
 			void insert(
 			    const std::string &key,
 			    const void *const data,
@@ -97,6 +101,9 @@ namespace BiometricEvaluation {
 			uint64_t length(
 			    const std::string &key) const;
 
+			std::vector<uint64_t> length(
+			    const std::vector<std::string> &keys) const;
+
 			void flush(
 			    const std::string &key) const;
 
@@ -116,6 +123,9 @@ namespace BiometricEvaluation {
 			Impl&
 			    operator=(const DBRecordStore::Impl&) = delete;
 
+		protected:
+			void flushChanges() const override;
+
 		private:
 			/* The file names of the underlying databases. */
 			std::string _dbnameP;
@@ -174,6 +184,13 @@ namespace BiometricEvaluation {
 
 			void removeRecordSegments(const std::string &key);
 
+			/*
+			 * Order in which to visit keys so that the B-tree
+			 * is traversed in order.
+			 */
+			std::vector<size_t> keyOrder(
+			    const std::vector<std::string> &keys) const;
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
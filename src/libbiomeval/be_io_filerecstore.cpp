@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  ******************************************************************************/
 
+#include <utility>
+
 #include "be_io_filerecstore_impl.h"
 
 namespace BE = BiometricEvaluation;
@@ -32,6 +34,12 @@ BiometricEvaluation::IO::FileRecordStore::FileRecordStore(
 	this->pimpl.reset(new IO::FileRecordStore::Impl(pathname, mode));
 }
 
+BiometricEvaluation::IO::FileRecordStore::FileRecordStore(
+    std::unique_ptr<FileRecordStore::Impl> &&impl) :
+    pimpl(std::move(impl))
+{
+}
+
 BiometricEvaluation::IO::FileRecordStore::~FileRecordStore()
 {
 }
@@ -42,6 +50,25 @@ BiometricEvaluation::IO::FileRecordStore::move(const std::string &pathname)
 	this->pimpl->move(pathname);
 }
 
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::FileRecordStore::openReader()
+    const
+{
+	this->pimpl->sync();
+
+	std::unique_ptr<FileRecordStore::Impl> reader{};
+	try {
+		reader.reset(new IO::FileRecordStore::Impl(
+		    this->pimpl->getPathname(), Mode::ReadOnly));
+	} catch (const Error::ObjectDoesNotExist &e) {
+		throw Error::StrategyError(e.whatString());
+	}
+	reader->setKeyIndex(this->pimpl->getKeyIndex());
+
+	return (std::shared_ptr<RecordStore>(
+	    new FileRecordStore(std::move(reader))));
+}
+
 uint64_t
 BiometricEvaluation::IO::FileRecordStore::getSpaceUsed()
     const
@@ -56,6 +83,27 @@ BiometricEvaluation::IO::FileRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::FileRecordStore::setCommitPolicy(
+    const CommitPolicy &policy)
+{
+	this->pimpl->setCommitPolicy(policy);
+}
+
+void
+BiometricEvaluation::IO::FileRecordStore::setKeyFilter(
+    bool enabled)
+{
+	this->pimpl->setKeyFilter(enabled);
+}
+
+bool
+BiometricEvaluation::IO::FileRecordStore::getKeyFilter()
+    const
+{
+	return (this->pimpl->getKeyFilter());
+}
+
 void
 BiometricEvaluation::IO::FileRecordStore::insert( 
     const std::string &key,
@@ -80,6 +128,15 @@ BiometricEvaluation::IO::FileRecordStore::read(
 	return (this->pimpl->read(key));
 }
 
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::FileRecordStore::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	return (this->pimpl->readPrefix(key, size));
+}
+
 void
 BiometricEvaluation::IO::FileRecordStore::replace(
     const std::string &key,
@@ -10,8 +10,11 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <iterator>
+#include <limits>
 
 #include <be_error.h>
 #include <be_error_exception.h>
@@ -30,6 +33,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
     RecordStore::Impl(pathname, description, RecordStore::Kind::File)
 {
 	_cursorPos = 1;
+	_keyIndex = std::make_shared<KeyIndex>();
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
 	if (mkdir(_theFilesDir.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) != 0)
 		throw Error::StrategyError("Could not create file area "
@@ -43,10 +47,25 @@ BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
 {
 	_cursorPos = 1;
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
+
+	/* Each record is one file */
+	if (this->isCountStale()) {
+		this->refreshKeyIndex();
+		this->recoverCount(this->_keyIndex->keys.size());
+	}
+	this->openKeyFilter();
 }
 
 BiometricEvaluation::IO::FileRecordStore::Impl::~Impl()
 {
+	try {
+		this->saveKeyFilter();
+	} catch (const Error::Exception &) {
+		/* The filter is rebuilt when next opened */
+	}
+
+	/* Each record was written to its own file as it was inserted */
+	this->commitOnClose();
 }
 
 void
@@ -125,14 +144,24 @@ BiometricEvaluation::IO::FileRecordStore::Impl::insert(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
-	if (IO::Utility::fileExists(pathname))
+	if (this->keyMayExist(key) && IO::Utility::fileExists(pathname))
 		throw Error::ObjectExists();
 
+	this->beginChange();
 	try {
 		writeNewRecordFile(pathname, data, size);
 	} catch (const Error::StrategyError&) {
 		throw;
 	}
+	if (this->_keyIndex) {
+		/* Leave the index that readers share unchanged */
+		if (this->_keyIndex.use_count() > 1)
+			this->_keyIndex = std::make_shared<KeyIndex>(
+			    *this->_keyIndex);
+		this->_keyIndex->keys.push_back(key);
+		this->_keyIndex->positions.emplace(key,
+		    this->_keyIndex->keys.size());
+	}
 	RecordStore::Impl::insert(key, data, size);
 }
 
@@ -146,12 +175,19 @@ BiometricEvaluation::IO::FileRecordStore::Impl::remove(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
-	if (!IO::Utility::fileExists(pathname))
+	if (!this->keyMayExist(key) || !IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
 
+	this->beginChange();
 	if (std::remove(pathname.c_str()) != 0)
 		throw Error::StrategyError("Could not remove " + pathname);
 
+	/*
+	 * Positions of the remaining records follow the file area, so
+	 * rebuild the index the next time it is needed.
+	 */
+	this->_keyIndex.reset();
+
 	RecordStore::Impl::remove(key);
 }
 
@@ -159,15 +195,24 @@ BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::IO::FileRecordStore::Impl::read(
     const std::string &key)
     const
+{
+	return (this->readPrefix(key, std::numeric_limits<uint64_t>::max()));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::FileRecordStore::Impl::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
-	if (!IO::Utility::fileExists(pathname))
+	if (!this->keyMayExist(key) || !IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
 
 	/* Allow exceptions to propagate out of here */
-	uint64_t size = IO::Utility::getFileSize(pathname);
+	size = std::min(size, IO::Utility::getFileSize(pathname));
 	std::FILE *fp = std::fopen(pathname.c_str(), "rb");
 	if (fp == nullptr)
 		throw Error::StrategyError("Could not open " + pathname + 
@@ -194,7 +239,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::replace(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
-	if (!IO::Utility::fileExists(pathname))
+	if (!this->keyMayExist(key) || !IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
 
 	try {
@@ -212,7 +257,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::length(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
-	if (!IO::Utility::fileExists(pathname))
+	if (!this->keyMayExist(key) || !IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
 
 	return (IO::Utility::getFileSize(pathname));
@@ -229,7 +274,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::flush(
 		throw Error::StrategyError("Invalid key format");
 
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
-	if (!IO::Utility::fileExists(pathname))
+	if (!this->keyMayExist(key) || !IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
 
 	/*
@@ -248,10 +293,8 @@ BiometricEvaluation::IO::FileRecordStore::Impl::i_sequence(
 		throw Error::StrategyError("Invalid cursor position as "
 		    "argument");
 
-	DIR *dir;
-	dir = opendir(_theFilesDir.c_str());
-	if (dir == nullptr)
-		throw Error::StrategyError("Cannot open store directory");
+	if (!this->_keyIndex)
+		this->refreshKeyIndex();
 
 	/* If the current cursor position is START, then it doesn't matter
 	 * what the client requests; we start at the first record.
@@ -260,80 +303,15 @@ BiometricEvaluation::IO::FileRecordStore::Impl::i_sequence(
 	    (cursor == BE_RECSTORE_SEQ_START))
 		_cursorPos = 1;
 
-	if (_cursorPos > getCount()) { /* Client needs to start over */
-		const std::string errorStr{"No record at position"};
-		if (dir != nullptr) {
-			if (closedir(dir)) {
-				throw Error::StrategyError("Could not close " +
-				    this->_theFilesDir + "(" + 
-				    Error::errorStr() + ") while exiting with "
-				    "error " + errorStr);
-			}
-		}
-
-		throw Error::ObjectDoesNotExist(errorStr);
-	}
-
-	struct dirent *entry;
-	struct stat sb;
-	uint64_t i = 1;
-	std::string cname;
-	while ((entry = readdir(dir)) != nullptr) {
-#ifndef _WIN32
-		if (entry->d_ino == 0)
-			continue;
-#endif
-		cname = _theFilesDir + "/" + entry->d_name;
-		if (stat(cname.c_str(), &sb) != 0) {
-			const std::string errorStr{"Cannot stat store file (" +
-				Error::errorStr() + ")"};
-			if (dir != nullptr) {
-				if (closedir(dir)) {
-					throw Error::StrategyError("Could not "
-					    "close " + this->_theFilesDir + " "
-					    "(" + Error::errorStr() + ") "
-					    "while exiting with error " +
-					    errorStr);
-				}
-			}
-
-			throw BE::Error::StrategyError{errorStr};
-		}
-		if ((S_IFMT & sb.st_mode) == S_IFDIR)	/* skip '.' and '..' */
-			continue;
-		if (i == _cursorPos)
-			break;
-		i++;
-	}	
-	/* Sanity check */
-	if (i > _cursorPos) {
-		const std::string errorStr{"Record cursor position out of "
-		    "sync"};
-		if (dir != nullptr) {
-			if (closedir(dir)) {
-				throw Error::StrategyError("Could not close " +
-				    this->_theFilesDir + " (" + 
-				    Error::errorStr() + ") while exiting with "
-				    "error " + errorStr);
-			}
-		}
-
-		throw Error::StrategyError{errorStr};
-	}
+	/* Client needs to start over */
+	if (_cursorPos > this->_keyIndex->keys.size())
+		throw Error::ObjectDoesNotExist("No record at position");
 
 	BE::IO::RecordStore::Record record;
-	record.key = entry->d_name;
+	record.key = this->_keyIndex->keys[_cursorPos - 1];
 	setCursor(BE_RECSTORE_SEQ_NEXT);
-	_cursorPos = i + 1;
+	_cursorPos++;
 
-	if (dir != nullptr) {
-		if (closedir(dir)) {
-			throw Error::StrategyError("Could not close " + 
-			    _theFilesDir + " (" + Error::errorStr() + 
-			    ")");
-		}
-	}
-	
 	if (returnData)
 		record.data = FileRecordStore::Impl::read(record.key);
 	return (record);
@@ -361,44 +339,32 @@ BiometricEvaluation::IO::FileRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
-	DIR *dir;
-	dir = opendir(_theFilesDir.c_str());
-	if (dir == nullptr)
-		throw Error::StrategyError("Cannot open store directory");
-
-	struct dirent *entry;
-	struct stat sb;
-	int i = 1;
-	std::string cname;
-	while ((entry = readdir(dir)) != nullptr) {
-#ifndef _WIN32
-		if (entry->d_ino == 0)
-			continue;
-#endif
-		cname = _theFilesDir + "/" + entry->d_name;
-		if (stat(cname.c_str(), &sb) != 0)	
-			throw Error::StrategyError("Cannot stat store file (" +
-			    Error::errorStr() + ")");
-		if ((S_IFMT & sb.st_mode) == S_IFDIR)	/* skip '.' and '..' */
-			continue;
-		if (key == entry->d_name) {
-			_cursorPos = i;
-			break;
-		}
-		i++;
-	}
+	if (!this->keyMayExist(key))
+		throw Error::ObjectDoesNotExist(key);
+	if (!this->_keyIndex)
+		this->refreshKeyIndex();
 
-	/* Exited the loop by exhausting the directory */
-	if (entry == nullptr)
+	const auto it = this->_keyIndex->positions.find(key);
+	if (it == this->_keyIndex->positions.cend())
 		throw Error::ObjectDoesNotExist(key);
 
-	if (dir != nullptr) {
-		if (closedir(dir)) {
-			throw Error::StrategyError("Could not close " + 
-			    _theFilesDir + " (" + Error::errorStr() + 
-			    ")");
-		}
-	}
+	_cursorPos = it->second;
+}
+
+std::shared_ptr<BiometricEvaluation::IO::FileRecordStore::Impl::KeyIndex>
+BiometricEvaluation::IO::FileRecordStore::Impl::getKeyIndex()
+    const
+{
+	if (!this->_keyIndex)
+		this->refreshKeyIndex();
+	return (this->_keyIndex);
+}
+
+void
+BiometricEvaluation::IO::FileRecordStore::Impl::setKeyIndex(
+    const std::shared_ptr<KeyIndex> &keyIndex)
+{
+	this->_keyIndex = keyIndex;
 }
 
 /******************************************************************************/
@@ -426,6 +392,62 @@ BiometricEvaluation::IO::FileRecordStore::Impl::writeNewRecordFile(
 		    Error::errorStr() + ")");
 }
 
+void
+BiometricEvaluation::IO::FileRecordStore::Impl::refreshKeyIndex()
+    const
+{
+	DIR *dir;
+	dir = opendir(_theFilesDir.c_str());
+	if (dir == nullptr)
+		throw Error::StrategyError("Cannot open store directory");
+
+	auto keyIndex = std::make_shared<KeyIndex>();
+	std::vector<std::string> &keys = keyIndex->keys;
+	keys.reserve(this->getCount());
+
+	struct dirent *entry;
+	struct stat sb;
+	std::string cname;
+	while ((entry = readdir(dir)) != nullptr) {
+#ifndef _WIN32
+		if (entry->d_ino == 0)
+			continue;
+#endif
+		/* Only stat() when the file system can't tell us the type */
+		if (entry->d_type == DT_UNKNOWN) {
+			cname = _theFilesDir + "/" + entry->d_name;
+			if (stat(cname.c_str(), &sb) != 0) {
+				const std::string errorStr{"Cannot stat store "
+				    "file (" + Error::errorStr() + ")"};
+				if (closedir(dir)) {
+					throw Error::StrategyError("Could not "
+					    "close " + this->_theFilesDir + " "
+					    "(" + Error::errorStr() + ") "
+					    "while exiting with error " +
+					    errorStr);
+				}
+
+				throw Error::StrategyError{errorStr};
+			}
+			if ((S_IFMT & sb.st_mode) == S_IFDIR)
+				continue;
+		} else if (entry->d_type == DT_DIR) {	/* '.' and '..' */
+			continue;
+		}
+		keys.emplace_back(entry->d_name);
+	}
+
+	if (closedir(dir)) {
+		throw Error::StrategyError("Could not close " + 
+		    _theFilesDir + " (" + Error::errorStr() + ")");
+	}
+
+	keyIndex->positions.reserve(keys.size());
+	for (uint64_t i = 0; i < keys.size(); i++)
+		keyIndex->positions.emplace(keys[i], i + 1);
+	this->_keyIndex = std::move(keyIndex);
+}
+
 std::string
 BiometricEvaluation::IO::FileRecordStore::Impl::canonicalName(
     const std::string &name) const
@@ -433,3 +455,21 @@ BiometricEvaluation::IO::FileRecordStore::Impl::canonicalName(
 	return(_theFilesDir + '/' + name);
 }
 
+void
+BiometricEvaluation::IO::FileRecordStore::Impl::visitKeys(
+    const std::function<void(const std::string &)> &visitor)
+    const
+{
+	if (!this->_keyIndex)
+		this->refreshKeyIndex();
+	for (const auto &key : this->_keyIndex->keys)
+		visitor(key);
+}
+
+uint64_t
+BiometricEvaluation::IO::FileRecordStore::Impl::keyFilterStamp()
+    const
+{
+	/* Adding or removing a record file changes the directory */
+	return (RecordStore::Impl::fileStamp(_theFilesDir));
+}
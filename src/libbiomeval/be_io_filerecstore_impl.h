@@ -10,6 +10,11 @@
 #ifndef __BE_FILERECSTORE_IMPL_H__
 #define __BE_FILERECSTORE_IMPL_H__
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "be_io_recordstore_impl.h"
 #include <be_io_filerecstore.h>
 
@@ -87,6 +92,10 @@ namespace BiometricEvaluation {
 			Memory::uint8Array read(
 			    const std::string &key) const;
 
+			Memory::uint8Array readPrefix(
+			    const std::string &key,
+			    uint64_t size) const;
+
 			void replace(
 			    const std::string &key,
 			    const void *const data,
@@ -106,6 +115,50 @@ namespace BiometricEvaluation {
 
 			void move(const std::string &pathname);
 
+			/** Keys of the records in the store */
+			struct KeyIndex
+			{
+				/** Keys, in the order sequence() returns them */
+				std::vector<std::string> keys;
+				/** Position (1-based) of each key in keys */
+				std::unordered_map<std::string, uint64_t>
+				    positions;
+			};
+
+			/**
+			 * @brief
+			 * Obtain the key index, building it if needed.
+			 * @details
+			 * The index is shared, not copied. This object
+			 * copies it before changing it again, so the
+			 * returned index does not change.
+			 *
+			 * @return
+			 *	Keys of the records in the store.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when reading the file area.
+			 */
+			std::shared_ptr<KeyIndex>
+			getKeyIndex()
+			    const;
+
+			/**
+			 * @brief
+			 * Use another object's key index instead of
+			 * reading the file area.
+			 * @details
+			 * Used by read-only handles from openReader(),
+			 * which never change the index.
+			 *
+			 * @param[in] keyIndex
+			 *	Value returned by getKeyIndex() of an object
+			 *	open on the same store.
+			 */
+			void
+			setKeyIndex(
+			    const std::shared_ptr<KeyIndex> &keyIndex);
+
 			/* Prevent copying of FileRecordStore objects */
 			Impl(const FileRecordStore&) = delete;
 			Impl& operator=(const FileRecordStore&) = delete;
@@ -114,6 +167,17 @@ namespace BiometricEvaluation {
 			std::string canonicalName(
 			    const std::string &name) const;
 
+			void
+			visitKeys(
+			    const std::function<void(const std::string &)>
+			    &visitor)
+			    const override;
+
+			/** @return Stamp of the file area directory */
+			uint64_t
+			keyFilterStamp()
+			    const override;
+
 		private:
 			void writeNewRecordFile(
 			    const std::string &name, 
@@ -123,6 +187,31 @@ namespace BiometricEvaluation {
 			uint64_t _cursorPos;
 			std::string _theFilesDir;
 
+			/**
+			 * Keys of the records in the store. Built with a
+			 * single pass over the file area, extended by
+			 * insert(), and dropped by remove(). nullptr when
+			 * it must be rebuilt before use. May be shared
+			 * with readers, so it is copied before insert()
+			 * extends it.
+			 */
+			mutable std::shared_ptr<KeyIndex> _keyIndex;
+
+			/**
+			 * @brief
+			 * Rebuild the key index from the file area.
+			 * @details
+			 * The file area is read once, without stat()ing
+			 * each entry unless the file system does not report
+			 * the entry type.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when reading the file area.
+			 */
+			void
+			refreshKeyIndex()
+			    const;
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
@@ -659,6 +659,51 @@ BiometricEvaluation::IO::GZip::decompress(
 	this->decompress(compressedData, compressedData.size(), outputFile);
 }
 
+void
+BiometricEvaluation::IO::GZip::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	/* zlib counts in 32 bits, so only inflate in one call when it fits */
+	if ((compressedDataSize > UINT32_MAX) ||
+	    (uncompressedDataSize > UINT32_MAX)) {
+		Compressor::decompress(compressedData, compressedDataSize,
+		    uncompressedData, uncompressedDataSize);
+		return;
+	}
+
+	z_stream strm = this->initDecompressionStream();
+	strm.next_in = (uint8_t *)compressedData;
+	strm.avail_in = compressedDataSize;
+
+	/* zlib rejects a NULL output buffer, even when it is not needed */
+	uint8_t empty;
+	strm.next_out = (uncompressedDataSize == 0 ? &empty : uncompressedData);
+	strm.avail_out = uncompressedDataSize;
+
+	const int32_t rv = inflate(&strm, Z_FINISH);
+	inflateEnd(&strm);
+	switch (rv) {
+	case Z_STREAM_END:
+		break;
+	case Z_BUF_ERROR:
+		throw Error::StrategyError("Decompressed size does not match");
+	case Z_NEED_DICT:
+		throw Error::StrategyError("Need dictionary during inflation");
+	case Z_DATA_ERROR:
+		throw Error::StrategyError("Data error during inflation");
+	case Z_MEM_ERROR:
+		throw Error::StrategyError("Memory error during inflation");
+	default:
+		throw Error::StrategyError("Stream error during inflate");
+	}
+	if (strm.avail_out != 0)
+		throw Error::StrategyError("Decompressed size does not match");
+}
+
 z_stream
 BiometricEvaluation::IO::GZip::initDecompressionStream()
     const
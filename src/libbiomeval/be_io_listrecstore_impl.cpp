@@ -9,9 +9,21 @@
  */
 
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif /* _WIN32 */
+
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 
 #include "be_io_listrecstore_impl.h"
+#include "be_utility_impl.h"
 #include <be_error.h>
 #include <be_io_utility.h>
 #include <be_text.h>
@@ -19,16 +31,16 @@
 namespace BE = BiometricEvaluation;
 
 static const std::string KEYLISTFILENAME("KeyList.txt");
+static const std::string KEYLISTINDEXFILENAME("KeyList.idx");
 static const std::string SOURCERECORDSTOREPROPERTY("Source Record Store");
 
+constexpr char BiometricEvaluation::IO::ListRecordStore::Impl::INDEX_MAGIC[];
+
 BiometricEvaluation::IO::ListRecordStore::Impl::Impl(
     const std::string &pathname) :
     RecordStore::Impl(pathname, Mode::ReadOnly)
 {
-	std::string keyListPath = canonicalName(KEYLISTFILENAME);
-	this->_keyListFile.reset(new std::ifstream(keyListPath.c_str()));
-	if (!this->_keyListFile->is_open())
-	    throw Error::StrategyError("Could not open key list file");
+	this->mapKeyList();
 
 	/* Check for the source RS property and open that RS */
 	std::shared_ptr<IO::Properties> props = getProperties();
@@ -51,6 +63,263 @@ BiometricEvaluation::IO::ListRecordStore::Impl::Impl(
 	this->setCursor(BE_RECSTORE_SEQ_START);
 }
 
+BiometricEvaluation::IO::ListRecordStore::Impl::~Impl()
+{
+	this->unmapIndex();
+#ifndef _WIN32
+	if (this->_keyListMapped)
+		munmap(const_cast<char *>(this->_keyList), this->_keyListSize);
+#endif /* _WIN32 */
+	if (!this->_keyListMapped)
+		delete[] this->_keyList;
+}
+
+void
+BiometricEvaluation::IO::ListRecordStore::Impl::mapKeyList()
+{
+	const std::string keyListPath = canonicalName(KEYLISTFILENAME);
+	struct stat sb;
+	if (stat(keyListPath.c_str(), &sb) != 0)
+		throw Error::StrategyError("Could not open key list file");
+	this->_keyListSize = sb.st_size;
+	this->_keyListModified = BE::Impl::modificationTime(sb);
+	if (this->_keyListSize == 0)
+		return;
+
+#ifndef _WIN32
+	int fd = ::open(keyListPath.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw Error::StrategyError("Could not open key list file");
+	void *map = mmap(nullptr, this->_keyListSize, PROT_READ, MAP_SHARED,
+	    fd, 0);
+	::close(fd);
+	if (map != MAP_FAILED) {
+		this->_keyList = static_cast<const char *>(map);
+		this->_keyListMapped = true;
+		return;
+	}
+#endif /* _WIN32 */
+
+	std::ifstream keyListFile(keyListPath, std::ios_base::in |
+	    std::ios_base::binary);
+	char *keyList = new char[this->_keyListSize];
+	keyListFile.read(keyList, this->_keyListSize);
+	if (!keyListFile) {
+		delete[] keyList;
+		throw Error::StrategyError("Could not read key list file");
+	}
+	this->_keyList = keyList;
+}
+
+std::string
+BiometricEvaluation::IO::ListRecordStore::Impl::keyAt(
+    uint64_t offset,
+    uint64_t &next)
+    const
+{
+	const char *start = this->_keyList + offset;
+	const char *newline = static_cast<const char *>(std::memchr(start,
+	    '\n', this->_keyListSize - offset));
+	const char *end = (newline == nullptr ?
+	    this->_keyList + this->_keyListSize : newline);
+	next = (newline == nullptr ?
+	    this->_keyListSize : (newline - this->_keyList) + 1);
+
+	return (Text::trimWhitespace(std::string(start, end)));
+}
+
+bool
+BiometricEvaluation::IO::ListRecordStore::Impl::loadIndex()
+{
+	if (this->_buckets != nullptr)
+		return (true);
+	if (this->_keyListSize >= (uint64_t{1} << INDEX_OFFSET_BITS))
+		return (false);
+
+	if (!this->mapIndex())
+		this->rebuildIndex();
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::ListRecordStore::Impl::rebuildIndex()
+{
+	this->unmapIndex();
+	this->buildIndex();
+	if (this->writeIndex() && this->mapIndex()) {
+		this->_builtBuckets.clear();
+		this->_builtBuckets.shrink_to_fit();
+	} else {
+		this->_buckets = this->_builtBuckets.data();
+		this->_bucketCount = this->_builtBuckets.size();
+	}
+}
+
+bool
+BiometricEvaluation::IO::ListRecordStore::Impl::mapIndex()
+{
+#ifndef _WIN32
+	int fd = ::open(canonicalName(KEYLISTINDEXFILENAME).c_str(),
+	    O_RDONLY);
+	if (fd == -1)
+		return (false);
+	struct stat sb;
+	if ((fstat(fd, &sb) != 0) ||
+	    (static_cast<uint64_t>(sb.st_size) < sizeof(IndexHeader))) {
+		::close(fd);
+		return (false);
+	}
+	void *map = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED)
+		return (false);
+	const uint64_t indexSize = sb.st_size;
+
+	/* Only use an index written by this host for the current key list */
+	const IndexHeader *header = static_cast<const IndexHeader *>(map);
+	if ((std::memcmp(header->magic, INDEX_MAGIC,
+	    sizeof(header->magic)) != 0) ||
+	    (header->version != INDEX_VERSION) ||
+	    (header->byteOrder != INDEX_BYTE_ORDER) ||
+	    (header->keyListSize != this->_keyListSize) ||
+	    (header->keyListModified != this->_keyListModified) ||
+	    (header->bucketCount == 0) ||
+	    ((header->bucketCount & (header->bucketCount - 1)) != 0) ||
+	    (header->bucketCount > (indexSize / sizeof(uint64_t))) ||
+	    (sizeof(IndexHeader) + (header->bucketCount * sizeof(uint64_t))
+	    != indexSize)) {
+		munmap(map, indexSize);
+		return (false);
+	}
+
+	this->_index = static_cast<const uint8_t *>(map);
+	this->_indexSize = indexSize;
+	this->_buckets = reinterpret_cast<const uint64_t *>(this->_index +
+	    sizeof(IndexHeader));
+	this->_bucketCount = header->bucketCount;
+	return (true);
+#else
+	return (false);
+#endif /* _WIN32 */
+}
+
+void
+BiometricEvaluation::IO::ListRecordStore::Impl::unmapIndex()
+{
+#ifndef _WIN32
+	if (this->_index != nullptr)
+		munmap(const_cast<uint8_t *>(this->_index), this->_indexSize);
+#endif /* _WIN32 */
+	this->_index = nullptr;
+	this->_indexSize = 0;
+	this->_buckets = nullptr;
+	this->_bucketCount = 0;
+}
+
+void
+BiometricEvaluation::IO::ListRecordStore::Impl::buildIndex()
+{
+	/* At most half full, so probe sequences stay short */
+	const uint64_t lineCount = std::count(this->_keyList,
+	    this->_keyList + this->_keyListSize, '\n') + 1;
+	uint64_t bucketCount = 16;
+	while (bucketCount < (lineCount * 2))
+		bucketCount *= 2;
+	this->_builtBuckets.assign(bucketCount, 0);
+	this->_buckets = this->_builtBuckets.data();
+	this->_bucketCount = bucketCount;
+
+	const uint64_t offsetMask = (uint64_t{1} << INDEX_OFFSET_BITS) - 1;
+	uint64_t offset = 0, next = 0, found = 0;
+	while (offset < this->_keyListSize) {
+		const std::string key = this->keyAt(offset, next);
+
+		/* Only the first line holding a key is indexed */
+		if (!this->findKey(key, found)) {
+			const uint64_t hash = BE::Impl::fnv1a64(key);
+			uint64_t bucket = hash & (bucketCount - 1);
+			while (this->_builtBuckets[bucket] != 0)
+				bucket = (bucket + 1) & (bucketCount - 1);
+			this->_builtBuckets[bucket] = ((hash >>
+			    INDEX_OFFSET_BITS) << INDEX_OFFSET_BITS) |
+			    ((offset + 1) & offsetMask);
+		}
+		offset = next;
+	}
+}
+
+bool
+BiometricEvaluation::IO::ListRecordStore::Impl::writeIndex()
+    const
+{
+	IndexHeader header{};
+	std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+	header.version = INDEX_VERSION;
+	header.byteOrder = INDEX_BYTE_ORDER;
+	header.keyListSize = this->_keyListSize;
+	header.keyListModified = this->_keyListModified;
+	header.bucketCount = this->_builtBuckets.size();
+	header.keyCount = this->_builtBuckets.size() -
+	    std::count(this->_builtBuckets.begin(),
+	    this->_builtBuckets.end(), 0);
+
+	/*
+	 * Replace the index atomically, so readers never see a partial
+	 * one. The store's directory may not be writable, in which case
+	 * the index is only kept in memory.
+	 */
+	const std::string indexName{canonicalName(KEYLISTINDEXFILENAME)};
+	const std::string tempName{indexName + ".tmp." +
+	    std::to_string(getpid())};
+	std::ofstream indexfp(tempName, std::ios_base::out |
+	    std::ios_base::binary | std::ios_base::trunc);
+	if (!indexfp)
+		return (false);
+	indexfp.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	indexfp.write(reinterpret_cast<const char *>(
+	    this->_builtBuckets.data()),
+	    this->_builtBuckets.size() * sizeof(uint64_t));
+	indexfp.close();
+	if (!indexfp ||
+	    (std::rename(tempName.c_str(), indexName.c_str()) != 0)) {
+		std::remove(tempName.c_str());
+		return (false);
+	}
+	return (true);
+}
+
+bool
+BiometricEvaluation::IO::ListRecordStore::Impl::findKey(
+    const std::string &key,
+    uint64_t &offset)
+{
+	const uint64_t offsetMask = (uint64_t{1} << INDEX_OFFSET_BITS) - 1;
+	const uint64_t hash = BE::Impl::fnv1a64(key);
+	const uint64_t tag = (hash >> INDEX_OFFSET_BITS);
+	uint64_t next;
+	for (uint64_t probe = 0; probe < this->_bucketCount; probe++) {
+		const uint64_t entry = this->_buckets[(hash + probe) &
+		    (this->_bucketCount - 1)];
+		if (entry == 0)
+			return (false);
+		if ((entry >> INDEX_OFFSET_BITS) != tag)
+			continue;
+
+		/* A saved index may have been damaged since it was mapped */
+		const uint64_t entryOffset = entry & offsetMask;
+		if ((entryOffset == 0) || (entryOffset > this->_keyListSize))
+			throw Error::DataError("Key list index offset out of "
+			    "range");
+		if (this->keyAt(entryOffset - 1, next) == key) {
+			offset = entryOffset - 1;
+			return (true);
+		}
+	}
+
+	/* Indexes are built at most half full, so one has an empty bucket */
+	throw Error::DataError("Key list index has no empty bucket");
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::IO::ListRecordStore::Impl::read(
     const std::string &key)
@@ -78,28 +347,16 @@ BiometricEvaluation::IO::ListRecordStore::Impl::i_sequence(
 		    "argument");
 		    
 	if ((this->getCursor() == BE_RECSTORE_SEQ_START) ||
-	    (cursor == BE_RECSTORE_SEQ_START)) {
-		/* Rewind */
-		_keyListFile->clear();
-		_keyListFile->seekg(0);
-		if (!_keyListFile)
-			throw Error::StrategyError("Could not rewind " +
-			    canonicalName(KEYLISTFILENAME));
-		if (!_keyListFile)
-			throw Error::StrategyError("Could not clear EOF on " +
-			    canonicalName(KEYLISTFILENAME));
-	}
+	    (cursor == BE_RECSTORE_SEQ_START))
+		this->_keyListCursor = 0;
 
-	std::string line;
-	std::getline(*this->_keyListFile, line);
-	if (this->_keyListFile->eof())
+	if (this->_keyListCursor >= this->_keyListSize)
 		throw (Error::ObjectDoesNotExist("No record at position"));
 
-	this->setCursor(BE_RECSTORE_SEQ_NEXT);
-
 	/* Read the record from the source store; let exceptions float out */
 	BE::IO::RecordStore::Record record;
-	record.key = Text::trimWhitespace(line);
+	record.key = this->keyAt(this->_keyListCursor, this->_keyListCursor);
+	this->setCursor(BE_RECSTORE_SEQ_NEXT);
 	if (returnData == true)
 		record.data = this->_sourceRecordStore->read(record.key);
 	return (record);
@@ -125,38 +382,52 @@ void
 BiometricEvaluation::IO::ListRecordStore::Impl::setCursorAtKey(
     const std::string &key)
 {
-	this->setCursor(BE_RECSTORE_SEQ_START);
-	
-	/* Sequence until we find the key */
-	std::string sequencedKey;
-	std::string searchKey{Text::trimWhitespace(key)};
-	for (;;) {
+	const std::string searchKey{Text::trimWhitespace(key)};
+	uint64_t offset = 0;
+	if (this->loadIndex()) {
+		bool found;
 		try {
-			sequencedKey = this->sequenceKey();
-			if (sequencedKey == searchKey)
-				break;
-		} catch (const Error::ObjectDoesNotExist&) {
+			found = this->findKey(searchKey, offset);
+		} catch (const Error::DataError &) {
+			/* Replace a damaged index with one built from the list */
+			this->rebuildIndex();
+			found = this->findKey(searchKey, offset);
+		}
+		if (!found)
 			throw Error::ObjectDoesNotExist(key);
+	} else {
+		/* Too large to index; search from the start */
+		uint64_t next = 0;
+		for (;;) {
+			if (offset >= this->_keyListSize)
+				throw Error::ObjectDoesNotExist(key);
+			if (this->keyAt(offset, next) == searchKey)
+				break;
+			offset = next;
 		}
 	}
-	
-	/* Rewind size of one key, adding the stripped newline character */
-	_keyListFile->seekg(-(sequencedKey.size() + 1), std::ios_base::cur);
-	if (!_keyListFile)
-		throw Error::StrategyError("Could not rewind one key in " +
-		    RecordStore::Impl::canonicalName(KEYLISTFILENAME));
+
+	/* The key itself is sequenced next */
+	this->_keyListCursor = offset;
+	this->setCursor(BE_RECSTORE_SEQ_NEXT);
 }
 
 uint64_t
 BiometricEvaluation::IO::ListRecordStore::Impl::getSpaceUsed()
     const
 {
+	uint64_t spaceUsed;
 	try {
-		return (RecordStore::Impl::getSpaceUsed() +
-			BE::IO::Utility::getFileSize(RecordStore::Impl::canonicalName(KEYLISTFILENAME)));
+		spaceUsed = RecordStore::Impl::getSpaceUsed() +
+			BE::IO::Utility::getFileSize(RecordStore::Impl::canonicalName(KEYLISTFILENAME));
 	} catch (const BE::Error::Exception& e) {
 		throw BE::Error::StrategyError("Could not get size of KeyList file: " + e.whatString());
 	}
+
+	const std::string indexName{canonicalName(KEYLISTINDEXFILENAME)};
+	if (BE::IO::Utility::fileExists(indexName))
+		spaceUsed += BE::IO::Utility::getFileSize(indexName);
+	return (spaceUsed);
 }
 
 void
@@ -11,7 +11,9 @@
 #ifndef __BE_IO_LISTRECSTORE_IMPL_H__
 #define __BE_IO_LISTRECSTORE_IMPL_H__
 
-#include <list>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <be_io_listrecstore.h>
 #include "be_io_recordstore_impl.h"
@@ -29,7 +31,7 @@ namespace BiometricEvaluation
 			    const std::string &pathname);
 
 			/** Destructor */
-			~Impl() = default;
+			~Impl();
 
 			/*
 			 * Implementation of the RecordStore interface.
@@ -74,17 +76,182 @@ namespace BiometricEvaluation
 			CRUDMethodCalled() const;
 
 		private:
+			/** Header of the key list index */
+			struct IndexHeader
+			{
+				/** INDEX_MAGIC */
+				char magic[8];
+				/** INDEX_VERSION */
+				uint32_t version;
+				/** INDEX_BYTE_ORDER, as written by the host */
+				uint32_t byteOrder;
+				/** Length of the key list the index covers */
+				uint64_t keyListSize;
+				/** Modification time of that key list, in ns */
+				int64_t keyListModified;
+				/** Number of buckets, a power of two */
+				uint64_t bucketCount;
+				/** Number of distinct keys */
+				uint64_t keyCount;
+			};
+			using IndexHeader = struct IndexHeader;
+
+			/** Identifies a key list index */
+			static constexpr char INDEX_MAGIC[8] = {'B', 'E',
+			    'L', 'S', 'T', 'I', 'D', 'X'};
+			/** Current version of the key list index */
+			static const uint32_t INDEX_VERSION = 1;
+			/** Written in host order to detect foreign indexes */
+			static const uint32_t INDEX_BYTE_ORDER = 0x01020304;
+			/**
+			 * Bits of a bucket holding the key's offset in the
+			 * key list, plus one. The rest hold bits of the
+			 * key's hash, to skip most mismatched keys.
+			 */
+			static const uint32_t INDEX_OFFSET_BITS = 40;
+
+			/** The key list, mapped into memory */
+			const char *_keyList{nullptr};
+			/** Length of _keyList */
+			uint64_t _keyListSize{0};
+			/** Whether _keyList was mapped, or read in */
+			bool _keyListMapped{false};
+			/** Modification time of the key list, in ns */
+			int64_t _keyListModified{0};
+			/** Offset in _keyList of the next key to sequence */
+			uint64_t _keyListCursor{0};
+
 			/**
-			 * Textfile containing a subset of keys from
-			 * the source RecordStore
+			 * Index from key to offset in the key list, as
+			 * described by IndexHeader, or nullptr until needed.
 			 */
-			std::shared_ptr<std::ifstream> _keyListFile;
+			const uint64_t *_buckets{nullptr};
+			/** Number of _buckets */
+			uint64_t _bucketCount{0};
+			/** The mapped index file, if _buckets is within it */
+			const uint8_t *_index{nullptr};
+			/** Length of _index */
+			uint64_t _indexSize{0};
+			/** Index built when it could not be mapped */
+			std::vector<uint64_t> _builtBuckets{};
+
 			/**
 			 * RecordStore containing data referenced by KeyList
 			 * file keys
 			 */
 			std::shared_ptr<IO::RecordStore> _sourceRecordStore;
-			
+
+			/**
+			 * @brief
+			 * Map the key list into memory, or read it if it
+			 * cannot be mapped.
+			 *
+			 * @throw Error::StrategyError
+			 *	The key list could not be opened.
+			 */
+			void
+			mapKeyList();
+
+			/**
+			 * @brief
+			 * Obtain the key on a line of the key list.
+			 *
+			 * @param[in] offset
+			 *	Offset of the start of the line.
+			 * @param[out] next
+			 *	Offset of the start of the following line.
+			 *
+			 * @return
+			 *	The line, with whitespace trimmed.
+			 */
+			std::string
+			keyAt(
+			    uint64_t offset,
+			    uint64_t &next)
+			    const;
+
+			/**
+			 * @brief
+			 * Map the key list index, building and saving it
+			 * first if it is missing or out of date.
+			 * @details
+			 * An index that cannot be saved is kept in memory.
+			 *
+			 * @return
+			 *	true if an index is available, false if the
+			 *	key list is too large to index.
+			 */
+			bool
+			loadIndex();
+
+			/**
+			 * @brief
+			 * Map an existing key list index.
+			 *
+			 * @return
+			 *	true if the index was mapped, false if it is
+			 *	missing or does not describe the key list.
+			 */
+			bool
+			mapIndex();
+
+			/**
+			 * @brief
+			 * Unmap the key list index, if it is mapped, and
+			 * forget any index in use.
+			 */
+			void
+			unmapIndex();
+
+			/**
+			 * @brief
+			 * Build the key list index, replacing any index in
+			 * use, and save and map it if possible.
+			 * @details
+			 * An index that cannot be saved is kept in memory.
+			 */
+			void
+			rebuildIndex();
+
+			/**
+			 * @brief
+			 * Build the key list index in _builtBuckets.
+			 */
+			void
+			buildIndex();
+
+			/**
+			 * @brief
+			 * Save _builtBuckets as the key list index.
+			 *
+			 * @return
+			 *	Whether the index could be saved.
+			 */
+			bool
+			writeIndex()
+			    const;
+
+			/**
+			 * @brief
+			 * Find the first line of the key list holding a key.
+			 *
+			 * @param[in] key
+			 *	Key to find, with whitespace trimmed.
+			 * @param[out] offset
+			 *	Offset of the line holding key.
+			 *
+			 * @return
+			 *	Whether key was found.
+			 *
+			 * @throw Error::DataError
+			 *	The index refers outside the key list or has
+			 *	no empty bucket, so it is damaged.
+			 */
+			bool
+			findKey(
+			    const std::string &key,
+			    uint64_t &offset);
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
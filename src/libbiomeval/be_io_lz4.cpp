@@ -0,0 +1,448 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <lz4.h>
+
+#include <be_io_lz4.h>
+#include <be_io_utility.h>
+
+const std::string BiometricEvaluation::IO::LZ4::ACCELERATION = "Acceleration";
+
+/** Bytes preceding each block, holding the uncompressed size */
+static const uint64_t LZ4_HEADER_SIZE = 4;
+
+/*
+ * Loading a dictionary hashes all of it, so a stream primed with the
+ * dictionary is kept and copied for each compression instead. A
+ * dictionary is never modified once loaded, only replaced, so the mutex
+ * need only be held to take a reference to the current one.
+ */
+class BiometricEvaluation::IO::LZ4::Impl
+{
+public:
+	/** A dictionary and a stream with it loaded */
+	struct Dictionary
+	{
+		/** Last (up to) MAX_DICTIONARY_SIZE bytes of the dictionary */
+		Memory::uint8Array data{};
+		/** Stream with data loaded */
+		LZ4_stream_t primed{};
+	};
+
+	/** @return The dictionary in use, or nullptr if none. */
+	std::shared_ptr<const Dictionary>
+	current()
+	    const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return (this->dictionary);
+	}
+
+	/** Protects dictionary */
+	mutable std::mutex mutex{};
+	/** Dictionary in use, if any */
+	std::shared_ptr<const Dictionary> dictionary{};
+};
+
+BiometricEvaluation::IO::LZ4::LZ4() :
+    BiometricEvaluation::IO::Compressor(),
+    pimpl{new BiometricEvaluation::IO::LZ4::Impl()}
+{
+	this->setOption(ACCELERATION, 1);
+}
+
+BiometricEvaluation::IO::LZ4::~LZ4() = default;
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	if (uncompressedDataSize > LZ4_MAX_INPUT_SIZE)
+		throw Error::StrategyError("Data too large for LZ4");
+	const int acceleration = static_cast<int>(this->getOptionAsInteger(
+	    ACCELERATION));
+
+	const int bound = LZ4_compressBound(static_cast<int>(
+	    uncompressedDataSize));
+	Memory::uint8Array compressedData(LZ4_HEADER_SIZE + bound);
+	for (uint64_t i = 0; i < LZ4_HEADER_SIZE; i++)
+		compressedData[i] = (uncompressedDataSize >> (8 * i)) & 0xFF;
+
+	const char *src = reinterpret_cast<const char *>(uncompressedData);
+	char *dst = reinterpret_cast<char *>(&compressedData[LZ4_HEADER_SIZE]);
+	const auto dictionary = this->pimpl->current();
+	LZ4_stream_t stream;
+	int rv;
+	if (dictionary == nullptr) {
+		rv = LZ4_compress_fast_extState(&stream, src, dst,
+		    static_cast<int>(uncompressedDataSize), bound,
+		    acceleration);
+	} else {
+		std::memcpy(&stream, &dictionary->primed,
+		    sizeof(LZ4_stream_t));
+		rv = LZ4_compress_fast_continue(&stream, src, dst,
+		    static_cast<int>(uncompressedDataSize), bound,
+		    acceleration);
+	}
+	if ((rv <= 0) && (uncompressedDataSize != 0))
+		throw Error::StrategyError("Could not compress with LZ4");
+
+	compressedData.resize(LZ4_HEADER_SIZE + rv);
+	return (compressedData);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::compress(
+    const Memory::uint8Array &uncompressedData)
+    const
+{
+	return (this->compress(uncompressedData, uncompressedData.size()));
+}
+
+void
+BiometricEvaluation::IO::LZ4::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->compress(uncompressedData,
+	    uncompressedDataSize), outputFile);
+}
+
+void
+BiometricEvaluation::IO::LZ4::compress(
+    const Memory::uint8Array &uncompressedData,
+    const std::string &outputFile)
+    const
+{
+	this->compress(uncompressedData, uncompressedData.size(), outputFile);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::compress(
+    const std::string &inputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+
+	return (this->compress(IO::Utility::readFile(inputFile)));
+}
+
+void
+BiometricEvaluation::IO::LZ4::compress(
+    const std::string &inputFile,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->compress(IO::Utility::readFile(
+	    inputFile)), outputFile);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize)
+    const
+{
+	if (compressedDataSize < LZ4_HEADER_SIZE)
+		throw Error::StrategyError("Not LZ4 compressed data");
+	uint64_t uncompressedDataSize = 0;
+	for (uint64_t i = 0; i < LZ4_HEADER_SIZE; i++)
+		uncompressedDataSize |= static_cast<uint64_t>(
+		    compressedData[i]) << (8 * i);
+	if (uncompressedDataSize > LZ4_MAX_INPUT_SIZE)
+		throw Error::StrategyError("Not LZ4 compressed data");
+
+	Memory::uint8Array uncompressedData(uncompressedDataSize);
+	this->decompress(compressedData, compressedDataSize, uncompressedData,
+	    uncompressedDataSize);
+	return (uncompressedData);
+}
+
+void
+BiometricEvaluation::IO::LZ4::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	if ((compressedDataSize < LZ4_HEADER_SIZE) ||
+	    ((compressedDataSize - LZ4_HEADER_SIZE) > INT32_MAX))
+		throw Error::StrategyError("Not LZ4 compressed data");
+	uint64_t headerSize = 0;
+	for (uint64_t i = 0; i < LZ4_HEADER_SIZE; i++)
+		headerSize |= static_cast<uint64_t>(compressedData[i]) <<
+		    (8 * i);
+	if (headerSize != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed size does not match");
+
+	const char *src = reinterpret_cast<const char *>(
+	    compressedData + LZ4_HEADER_SIZE);
+	char *dst = reinterpret_cast<char *>(uncompressedData);
+	const int srcSize = static_cast<int>(compressedDataSize -
+	    LZ4_HEADER_SIZE);
+	const auto dictionary = this->pimpl->current();
+	int rv;
+	if (dictionary == nullptr)
+		rv = LZ4_decompress_safe(src, dst, srcSize,
+		    static_cast<int>(uncompressedDataSize));
+	else
+		rv = LZ4_decompress_safe_usingDict(src, dst, srcSize,
+		    static_cast<int>(uncompressedDataSize),
+		    reinterpret_cast<const char *>(&dictionary->data[0]),
+		    static_cast<int>(dictionary->data.size()));
+	if ((rv < 0) || (static_cast<uint64_t>(rv) != uncompressedDataSize))
+		throw Error::StrategyError("Could not decompress with LZ4");
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::decompress(
+    const Memory::uint8Array &compressedData)
+    const
+{
+	return (this->decompress(compressedData, compressedData.size()));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::decompress(
+    const std::string &input)
+    const
+{
+	if (IO::Utility::fileExists(input) == false)
+		throw Error::ObjectDoesNotExist(input);
+
+	return (this->decompress(IO::Utility::readFile(input)));
+}
+
+void
+BiometricEvaluation::IO::LZ4::decompress(
+    const std::string &inputFile,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->decompress(IO::Utility::readFile(
+	    inputFile)), outputFile);
+}
+
+void
+BiometricEvaluation::IO::LZ4::decompress(
+    const uint8_t *const compressedData,
+    const uint64_t compressedDataSize,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->decompress(compressedData,
+	    compressedDataSize), outputFile);
+}
+
+void
+BiometricEvaluation::IO::LZ4::decompress(
+    const Memory::uint8Array &compressedData,
+    const std::string &outputFile)
+    const
+{
+	this->decompress(compressedData, compressedData.size(), outputFile);
+}
+
+void
+BiometricEvaluation::IO::LZ4::setDictionary(
+    const Memory::uint8Array &dictionary)
+{
+	if (dictionary.size() == 0) {
+		std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+		this->pimpl->dictionary.reset();
+		return;
+	}
+
+	auto loaded = std::make_shared<Impl::Dictionary>();
+	if (dictionary.size() > MAX_DICTIONARY_SIZE) {
+		const uint64_t skip = dictionary.size() - MAX_DICTIONARY_SIZE;
+		loaded->data.copy(&dictionary[skip], MAX_DICTIONARY_SIZE);
+	} else {
+		loaded->data = dictionary;
+	}
+
+	/* primed references data, which now will not move */
+	LZ4_initStream(&loaded->primed, sizeof(LZ4_stream_t));
+	LZ4_loadDict(&loaded->primed, reinterpret_cast<const char *>(
+	    &loaded->data[0]), static_cast<int>(loaded->data.size()));
+
+	std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+	this->pimpl->dictionary = std::move(loaded);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::getDictionary()
+    const
+{
+	const auto dictionary = this->pimpl->current();
+	if (dictionary == nullptr)
+		return (Memory::uint8Array{});
+	return (dictionary->data);
+}
+
+/** Length of the substrings counted when training a dictionary */
+static const uint64_t TRAINING_MATCH_SIZE = 8;
+/** Length of the pieces of samples chosen for a dictionary */
+static const uint64_t TRAINING_SEGMENT_SIZE = 64;
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::trainDictionary(
+    const std::vector<Memory::uint8Array> &samples,
+    uint64_t maxSize)
+    const
+{
+	if (maxSize > MAX_DICTIONARY_SIZE)
+		maxSize = MAX_DICTIONARY_SIZE;
+
+	const auto substring = [&](uint64_t sample, uint64_t offset) {
+		uint64_t value;
+		std::memcpy(&value, &samples[sample][offset], sizeof(value));
+		return (value);
+	};
+	static_assert(sizeof(uint64_t) == TRAINING_MATCH_SIZE,
+	    "Substrings are compared as integers");
+
+	/* Count the samples in which each substring appears */
+	std::unordered_map<uint64_t, uint64_t> frequency{};
+	std::unordered_set<uint64_t> seen{};
+	for (uint64_t i = 0; i < samples.size(); i++) {
+		if (samples[i].size() < TRAINING_MATCH_SIZE)
+			continue;
+		seen.clear();
+		for (uint64_t j = 0; j <= samples[i].size() -
+		    TRAINING_MATCH_SIZE; j++)
+			if (seen.insert(substring(i, j)).second)
+				frequency[substring(i, j)]++;
+	}
+
+	/*
+	 * Score segments by how often their substrings appear in other
+	 * samples, skipping substrings already in the dictionary, so that
+	 * repeated content is only chosen once.
+	 */
+	struct Segment
+	{
+		uint64_t score;
+		uint64_t sample;
+		uint64_t offset;
+		uint64_t length;
+
+		bool
+		operator<(
+		    const Segment &rhs)
+		    const
+		{
+			return (this->score < rhs.score);
+		}
+	};
+	std::unordered_set<uint64_t> chosen{};
+	const auto useful = [&](uint64_t sample, uint64_t offset) {
+		const uint64_t value = substring(sample, offset);
+		const uint64_t count = frequency[value];
+		return (((count > 1) && (chosen.count(value) == 0)) ?
+		    count : 0);
+	};
+	const auto score = [&](const Segment &segment) {
+		uint64_t total = 0;
+		for (uint64_t j = segment.offset; j <= segment.offset +
+		    segment.length - TRAINING_MATCH_SIZE; j++)
+			total += useful(segment.sample, j);
+		return (total);
+	};
+
+	std::priority_queue<Segment> candidates{};
+	for (uint64_t i = 0; i < samples.size(); i++) {
+		for (uint64_t j = 0; (j + TRAINING_MATCH_SIZE) <=
+		    samples[i].size(); j += TRAINING_SEGMENT_SIZE) {
+			Segment segment{0, i, j, std::min(
+			    TRAINING_SEGMENT_SIZE, samples[i].size() - j)};
+			segment.score = score(segment);
+			if (segment.score != 0)
+				candidates.push(segment);
+		}
+	}
+
+	/* Choose the best segments, rescoring as the dictionary grows */
+	std::vector<Segment> selected{};
+	uint64_t size = 0;
+	while (!candidates.empty() &&
+	    ((maxSize - size) >= TRAINING_MATCH_SIZE)) {
+		Segment segment = candidates.top();
+		candidates.pop();
+		const uint64_t current = score(segment);
+		if (current == 0)
+			continue;
+		if (current != segment.score) {
+			segment.score = current;
+			candidates.push(segment);
+			continue;
+		}
+
+		/* Leave out content already chosen at either end */
+		uint64_t last = segment.offset + segment.length -
+		    TRAINING_MATCH_SIZE;
+		while (useful(segment.sample, segment.offset) == 0)
+			segment.offset++;
+		while (useful(segment.sample, last) == 0)
+			last--;
+		segment.length = last + TRAINING_MATCH_SIZE - segment.offset;
+		if ((size + segment.length) > maxSize)
+			continue;
+
+		for (uint64_t j = segment.offset; j <= segment.offset +
+		    segment.length - TRAINING_MATCH_SIZE; j++)
+			chosen.insert(substring(segment.sample, j));
+		selected.push_back(segment);
+		size += segment.length;
+	}
+	if (size == 0)
+		throw Error::StrategyError("Samples share no content for a "
+		    "dictionary");
+
+	/* LZ4 finds matches most cheaply near the end of the dictionary */
+	Memory::uint8Array dictionary(size);
+	uint64_t offset = 0;
+	for (auto it = selected.crbegin(); it != selected.crend(); ++it) {
+		std::memcpy(&dictionary[offset], &samples[it->sample][
+		    it->offset], it->length);
+		offset += it->length;
+	}
+	return (dictionary);
+}
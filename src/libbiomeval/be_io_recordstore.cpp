@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  ******************************************************************************/
 
+#include <cstring>
+
 #include "be_io_recordstore_impl.h"
 #include <be_io_recordstore.h>
 
@@ -25,6 +27,31 @@ BiometricEvaluation::IO::RecordStore::Record::Record(
 {
 }
 
+/*
+ * Constructors for RecordView.
+ */
+BiometricEvaluation::IO::RecordStore::RecordView::RecordView() :
+    data(nullptr), size(0)
+{
+}
+
+BiometricEvaluation::IO::RecordStore::RecordView::RecordView(
+    const uint8_t *data,
+    uint64_t size) :
+    data(data), size(size)
+{
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::RecordStore::RecordView::copy()
+    const
+{
+	Memory::uint8Array owned(this->size);
+	if (this->size != 0)
+		std::memcpy(owned, this->data, this->size);
+	return (owned);
+}
+
 const std::string BiometricEvaluation::IO::RecordStore::INVALIDKEYCHARS(
     "/\\*&");
 
@@ -39,7 +66,8 @@ BE_IO_RecordStore_Kind_EnumToStringMap = {
 	{BiometricEvaluation::IO::RecordStore::Kind::File, "File"},
 	{BiometricEvaluation::IO::RecordStore::Kind::SQLite, "SQLite"},
 	{BiometricEvaluation::IO::RecordStore::Kind::Compressed, "Compressed"},
-	{BiometricEvaluation::IO::RecordStore::Kind::List, "List"}
+	{BiometricEvaluation::IO::RecordStore::Kind::List, "List"},
+	{BiometricEvaluation::IO::RecordStore::Kind::Sharded, "Sharded"}
 };
 BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
     BiometricEvaluation::IO::RecordStore::Kind,
@@ -77,6 +105,42 @@ BiometricEvaluation::IO::RecordStore::replace(
 	this->insert(key, data, size);
 }
 
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStore::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	std::vector<Memory::uint8Array> records{};
+	records.reserve(keys.size());
+	for (const auto &key : keys)
+		records.push_back(this->read(key));
+	return (records);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::RecordStore::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	Memory::uint8Array record = this->read(key);
+	if (record.size() > size)
+		record.resize(size);
+	return (record);
+}
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::RecordStore::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	std::vector<uint64_t> lengths{};
+	lengths.reserve(keys.size());
+	for (const auto &key : keys)
+		lengths.push_back(this->length(key));
+	return (lengths);
+}
+
 bool
 BiometricEvaluation::IO::RecordStore::containsKey(
     const std::string &key) const
@@ -90,6 +154,40 @@ BiometricEvaluation::IO::RecordStore::containsKey(
 	return (true);
 }
 
+void
+BiometricEvaluation::IO::RecordStore::setCommitPolicy(
+    const CommitPolicy &/* policy */)
+{
+	/* No count to commit */
+}
+
+void
+BiometricEvaluation::IO::RecordStore::setKeyFilter(
+    bool /* enabled */)
+{
+	throw Error::NotImplemented("Key filter");
+}
+
+bool
+BiometricEvaluation::IO::RecordStore::getKeyFilter()
+    const
+{
+	return (false);
+}
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::RecordStore::openReader()
+    const
+{
+	this->sync();
+	try {
+		return (IO::RecordStore::Impl::openRecordStore(
+		    this->getPathname(), Mode::ReadOnly));
+	} catch (const Error::ObjectDoesNotExist &e) {
+		throw Error::StrategyError(e.whatString());
+	}
+}
+
 bool
 BiometricEvaluation::IO::RecordStore::isRecordStore(
     const std::string &pathname)
@@ -123,7 +221,7 @@ BiometricEvaluation::IO::RecordStore::removeRecordStore(
 	return (IO::RecordStore::Impl::removeRecordStore(pathname));
 }
 
-void
+BiometricEvaluation::IO::RecordStore::MergeStatistics
 BiometricEvaluation::IO::RecordStore::mergeRecordStores(
     const std::string &mergePathname,
     const std::string &description,
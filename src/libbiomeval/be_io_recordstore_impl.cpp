@@ -9,12 +9,19 @@
  ******************************************************************************/
 
 #include "be_io_recordstore_impl.h"
+#include "be_utility_impl.h"
 
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iterator>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 #include <be_error.h>
@@ -28,6 +35,8 @@
 #include <be_io_filerecstore.h>
 #include <be_io_listrecstore.h>
 #include <be_io_propertiesfile.h>
+#include <be_io_recordstoreprefetcher.h>
+#include <be_io_shardedrecstore.h>
 #include <be_io_sqliterecstore.h>
 #include <be_io_utility.h>
 #include <be_memory_autoarray.h>
@@ -42,9 +51,14 @@ using namespace BE::Framework::Enumeration;
  * The common properties for all RecordStore types.
  */
 const std::string BE::IO::RecordStore::Impl::CONTROLFILENAME(".rscontrol.prop");
+const std::string BE::IO::RecordStore::Impl::KEYFILTERFILENAME(".rskeyfilter");
 static const std::string DESCRIPTIONPROPERTY("Description");
 static const std::string COUNTPROPERTY("Count");
 static const std::string TYPEPROPERTY("Type");
+/** Present while Count may not match the records in the store */
+static const std::string UNCOMMITTEDPROPERTY("Uncommitted Changes");
+/** Present when the store keeps a key filter */
+static const std::string KEYFILTERPROPERTY("Key Filter");
 
 /** Error message when trying to change a core property */
 static const std::string COREPROPERTYERROR("Cannot change core properties");
@@ -127,12 +141,21 @@ BiometricEvaluation::IO::RecordStore::Impl::Impl(
 	} catch (const Error::StrategyError&) {
 		throw;
 	}
+
+	/* Subclasses recover the count from their storage */
+	try {
+		_props->getProperty(UNCOMMITTEDPROPERTY);
+		_countStale = true;
+	} catch (const Error::ObjectDoesNotExist&) {}
 }
 
 /*
- * Destructor for the abstract class; required empty implementaton.
+ * The control file is written when _props is destroyed. It keeps marking
+ * the count stale unless the subclass called commitOnClose().
  */
-BiometricEvaluation::IO::RecordStore::Impl::~Impl() { }
+BiometricEvaluation::IO::RecordStore::Impl::~Impl()
+{
+}
 
 /******************************************************************************/
 /* Common public methods implementations.                                     */
@@ -148,17 +171,171 @@ BiometricEvaluation::IO::RecordStore::Impl::canonicalName(
 void
 BiometricEvaluation::IO::RecordStore::Impl::insert(
     const std::string &key,
-    const void *const data,
-    const uint64_t size)
+    const void *const /* data */,
+    const uint64_t /* size */)
 {
 	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount() + 1);
+	this->keyFilterInsert(key);
+	this->countChange();
 }
 
 void
 BiometricEvaluation::IO::RecordStore::Impl::remove(
-    const std::string &key)
+    const std::string &/* key */)
 {
 	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount() - 1);
+	this->countChange();
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::setCommitPolicy(
+    const RecordStore::CommitPolicy &policy)
+{
+	this->_commitPolicy = policy;
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::setKeyFilter(
+    bool enabled)
+{
+	if (_mode == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+	if (enabled == this->getKeyFilter())
+		return;
+
+	if (enabled) {
+		try {
+			this->buildKeyFilter(2 * this->getCount());
+		} catch (const Error::NotImplemented &e) {
+			throw Error::StrategyError(e.whatString());
+		}
+		_props->setProperty(KEYFILTERPROPERTY, "Yes");
+		try {
+			_props->sync();
+		} catch (const Error::Exception &e) {
+			throw Error::StrategyError(e.whatString());
+		}
+		this->saveKeyFilter();
+	} else {
+		_keyFilter.reset();
+		_keyFilterStale = false;
+		_props->removeProperty(KEYFILTERPROPERTY);
+		try {
+			_props->sync();
+		} catch (const Error::Exception &e) {
+			throw Error::StrategyError(e.whatString());
+		}
+
+		const std::string filterName{
+		    this->canonicalName(KEYFILTERFILENAME)};
+		if (IO::Utility::fileExists(filterName) &&
+		    (std::remove(filterName.c_str()) != 0))
+			throw Error::StrategyError("Could not remove " +
+			    filterName + " (" + Error::errorStr() + ")");
+	}
+}
+
+bool
+BiometricEvaluation::IO::RecordStore::Impl::getKeyFilter()
+    const
+{
+	try {
+		_props->getProperty(KEYFILTERPROPERTY);
+	} catch (const Error::ObjectDoesNotExist&) {
+		return (false);
+	}
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::beginChange()
+{
+	if (_countStale)
+		return;
+
+	/* Written ahead of the change, so a crash can be detected */
+	_props->setProperty(UNCOMMITTEDPROPERTY, "Yes");
+	try {
+		_props->sync();
+	} catch (const Error::Exception &e) {
+		_props->removeProperty(UNCOMMITTEDPROPERTY);
+		throw Error::StrategyError(e.whatString());
+	}
+	_countStale = true;
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::flushChanges()
+    const
+{
+	/* Changes are written as they are made */
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::commitOnClose()
+    noexcept
+{
+	if ((_mode != Mode::ReadWrite) || !_countStale || (_props == nullptr))
+		return;
+
+	try {
+		_props->removeProperty(UNCOMMITTEDPROPERTY);
+	} catch (const Error::Exception &) {
+		/* The count is recovered when next opened */
+	}
+}
+
+bool
+BiometricEvaluation::IO::RecordStore::Impl::isCountStale()
+    const
+{
+	return (_countStale);
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::recoverCount(
+    uint64_t count)
+{
+	if (_mode == Mode::ReadOnly) {
+		_recoveredCount = count;
+		return;
+	}
+
+	_props->setPropertyFromInteger(COUNTPROPERTY, count);
+	this->commitCount();
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::countChange()
+{
+	if (_uncommittedChanges++ == 0)
+		_firstUncommittedChange = std::chrono::steady_clock::now();
+
+	const bool commit = (((_commitPolicy.changes != 0) &&
+	    (_uncommittedChanges >= _commitPolicy.changes)) ||
+	    ((_commitPolicy.delay.count() != 0) &&
+	    ((std::chrono::steady_clock::now() - _firstUncommittedChange) >=
+	    _commitPolicy.delay)));
+	if (!commit)
+		return;
+
+	this->flushChanges();
+	this->commitCount();
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::commitCount()
+    const
+{
+	if (_countStale)
+		_props->removeProperty(UNCOMMITTEDPROPERTY);
+	try {
+		_props->sync();
+	} catch (const Error::Exception &e) {
+		throw Error::StrategyError(e.whatString());
+	}
+	_countStale = false;
+	_uncommittedChanges = 0;
 }
 
 int
@@ -176,11 +353,23 @@ BiometricEvaluation::IO::RecordStore::Impl::setCursor(int cursor)
 uint64_t
 BiometricEvaluation::IO::RecordStore::Impl::getSpaceUsed() const
 {
+	uint64_t total;
 	try {
-		return (BE::IO::Utility::getFileSize(this->_controlFile));
+		total = BE::IO::Utility::getFileSize(this->_controlFile);
 	} catch (const BE::Error::StrategyError& e) {
 		throw Error::StrategyError("Could not get size of control file: " + e.whatString());
 	}
+
+	const std::string filterName{this->canonicalName(KEYFILTERFILENAME)};
+	if (IO::Utility::fileExists(filterName)) {
+		try {
+			total += BE::IO::Utility::getFileSize(filterName);
+		} catch (const BE::Error::Exception &e) {
+			throw Error::StrategyError("Could not get size of "
+			    "key filter: " + e.whatString());
+		}
+	}
+	return (total);
 }
 
 void
@@ -189,16 +378,15 @@ BiometricEvaluation::IO::RecordStore::Impl::sync() const
 	if (_mode == Mode::ReadOnly)
 		return;
 
-	try {
-		_props->sync();
-	} catch (const Error::Exception& e) {
-		throw Error::StrategyError(e.whatString());
-	}
+	this->commitCount();
+	this->saveKeyFilter();
 }
 
 unsigned int
 BiometricEvaluation::IO::RecordStore::Impl::getCount() const
 {
+	if (_recoveredCount)
+		return (*_recoveredCount);
 	return (_props->getPropertyAsInteger(COUNTPROPERTY));
 }
 
@@ -324,6 +512,8 @@ BiometricEvaluation::IO::RecordStore::Impl::openRecordStore(
 		rs = new ArchiveRecordStore(pathname, mode);
 	else if (type == to_string(RecordStore::Kind::Compressed))
 		rs = new CompressedRecordStore(pathname, mode);
+	else if (type == to_string(RecordStore::Kind::Sharded))
+		rs = new ShardedRecordStore(pathname, mode);
 	else if (type == to_string(RecordStore::Kind::List)) {
 		if (mode == IO::Mode::ReadWrite)
 			throw Error::StrategyError("ListRecordStores cannot "
@@ -360,6 +550,11 @@ BiometricEvaluation::IO::RecordStore::Impl::createRecordStore(
 		rs = new CompressedRecordStore(pathname, description,
 		    RecordStore::Kind::Default, IO::Compressor::Kind::GZIP);
 		break;
+	case BE::IO::RecordStore::Kind::Sharded:
+		rs = new ShardedRecordStore(pathname, description,
+		    RecordStore::Kind::Default,
+		    ShardedRecordStore::DEFAULT_SHARD_COUNT);
+		break;
 	case BE::IO::RecordStore::Kind::List:
 		throw Error::StrategyError("ListRecordStores cannot be "
 		    "created with this function");
@@ -372,11 +567,20 @@ BiometricEvaluation::IO::RecordStore::Impl::removeRecordStore(
     const std::string &pathname)
 {
 	/* Confirm that pathname is a RecordStore */
+	std::vector<std::string> shardPathnames{};
 	try {   
-		openRecordStore(pathname);
+		const auto rs = openRecordStore(pathname);
+
+		/* Shards may be kept outside of pathname */
+		const auto sharded =
+		    std::dynamic_pointer_cast<ShardedRecordStore>(rs);
+		if (sharded != nullptr)
+			shardPathnames = sharded->getShardPathnames();
 	} catch (const Error::Exception &) {
 		throw;
 	}
+	for (const auto &shardPathname : shardPathnames)
+		removeRecordStore(shardPathname);
 
 	try {
 		IO::Utility::removeDirectory(pathname);
@@ -387,7 +591,82 @@ BiometricEvaluation::IO::RecordStore::Impl::removeRecordStore(
 	}
 }
 
-void
+namespace
+{
+	/** RecordStores read ahead at once while merging */
+	const size_t MERGE_PREFETCH_STORES = 4;
+	/** Records inserted per batch into a merged SQLiteRecordStore */
+	const size_t MERGE_BATCH_RECORDS = 1024;
+
+	/**
+	 * @brief
+	 * A RecordStore being merged, read ahead once started.
+	 */
+	class MergeSource
+	{
+	public:
+		/**
+		 * @param[in] pathname
+		 *	Path to the RecordStore, opened read-only.
+		 *
+		 * @throw Error::StrategyError
+		 *	The RecordStore could not be opened.
+		 */
+		MergeSource(
+		    const std::string &pathname)
+		{
+			try {
+				_rs = BE::IO::RecordStore::openRecordStore(
+				    pathname, BE::IO::Mode::ReadOnly);
+			} catch (const BE::Error::Exception &e) {
+				throw BE::Error::StrategyError(e.whatString());
+			}
+		}
+
+		/** @return The opened RecordStore. */
+		std::shared_ptr<BE::IO::RecordStore>
+		getRecordStore()
+		    const
+		{
+			return (_rs);
+		}
+
+		/** Begin reading ahead. */
+		void
+		start()
+		{
+			if (_prefetcher == nullptr)
+				_prefetcher = std::make_unique<
+				    BE::IO::RecordStorePrefetcher>(_rs);
+		}
+
+		/**
+		 * @brief
+		 * Obtain the next record.
+		 *
+		 * @param[out] record
+		 *	The next record.
+		 * @return
+		 *	false when all records have been returned.
+		 *
+		 * @throw Error::Exception
+		 *	Error encountered while reading ahead.
+		 */
+		bool
+		next(
+		    BE::IO::RecordStore::Record &record)
+		{
+			this->start();
+			return (_prefetcher->next(record));
+		}
+
+	private:
+		std::shared_ptr<BE::IO::RecordStore> _rs{};
+		std::unique_ptr<BE::IO::RecordStorePrefetcher> _prefetcher{};
+	};
+}
+
+BiometricEvaluation::IO::RecordStore::MergeStatistics
 BiometricEvaluation::IO::RecordStore::Impl::mergeRecordStores(
     const std::string &mergePathname,
     const std::string &description,
@@ -395,6 +674,8 @@ BiometricEvaluation::IO::RecordStore::Impl::mergeRecordStores(
     const std::vector<std::string> &pathnames,
     const std::function<bool()> &interrupt)
 {
+	const auto startTime = std::chrono::steady_clock::now();
+
 	std::shared_ptr<RecordStore> merged_rs;
 	switch (kind) {
 		case BiometricEvaluation::IO::RecordStore::Kind::BerkeleyDB:
@@ -410,30 +691,88 @@ BiometricEvaluation::IO::RecordStore::Impl::mergeRecordStores(
 		case BiometricEvaluation::IO::RecordStore::Kind::List:
 			/* FALLTHROUGH */
 		case BiometricEvaluation::IO::RecordStore::Kind::Compressed:
+			/* FALLTHROUGH */
+		case BiometricEvaluation::IO::RecordStore::Kind::Sharded:
 			throw Error::StrategyError("Invalid RecordStore type");
 	}
+	const auto merged_archive =
+	    std::dynamic_pointer_cast<ArchiveRecordStore>(merged_rs);
+	const auto merged_sqlite =
+	    std::dynamic_pointer_cast<SQLiteRecordStore>(merged_rs);
+
+	RecordStore::MergeStatistics statistics{};
+	std::vector<RecordStore::Record> batch{};
+	const auto insertBatch = [&]() {
+		if (batch.empty())
+			return;
+		merged_sqlite->insertBatch(batch);
+		batch.clear();
+	};
 
-	std::shared_ptr<RecordStore> rs;
-	RecordStore::Record record;
-	for (uint32_t i = 0; i < pathnames.size(); i++) {
-		try {
-			rs = openRecordStore(pathnames[i], Mode::ReadOnly);
-		} catch (const Error::Exception &e) {
-			throw Error::StrategyError(e.whatString());
+	/*
+	 * Sources are opened in order, with the next few reading ahead on
+	 * their own threads while the current source is inserted.
+	 */
+	std::deque<std::unique_ptr<MergeSource>> sources{};
+	size_t nextSource = 0;
+	bool interrupted = false;
+	while (!interrupted && ((nextSource < pathnames.size()) ||
+	    !sources.empty())) {
+		while ((nextSource < pathnames.size()) &&
+		    (sources.size() < MERGE_PREFETCH_STORES)) {
+			sources.push_back(std::make_unique<MergeSource>(
+			    pathnames[nextSource++]));
+
+			/* Stores appended wholesale need no reading ahead */
+			const auto archive = std::dynamic_pointer_cast<
+			    ArchiveRecordStore>(
+			    sources.back()->getRecordStore());
+			if ((merged_archive == nullptr) ||
+			    (archive == nullptr) || archive->needsVacuum())
+				sources.back()->start();
 		}
-	
-		while (true) {
-			try {
-				if (interrupt()) {
-					break;
-				}
-				record = rs->sequence();
+		const std::unique_ptr<MergeSource> source =
+		    std::move(sources.front());
+		sources.pop_front();
+
+		if (interrupt()) {
+			interrupted = true;
+			break;
+		}
+
+		const auto archive = std::dynamic_pointer_cast<
+		    ArchiveRecordStore>(source->getRecordStore());
+		if ((merged_archive != nullptr) && (archive != nullptr) &&
+		    !archive->needsVacuum()) {
+			statistics.bytes += merged_archive->appendRecordStore(
+			    *archive);
+			statistics.records += archive->getCount();
+			continue;
+		}
+
+		RecordStore::Record record;
+		while (source->next(record)) {
+			statistics.records++;
+			statistics.bytes += record.data.size();
+			if (merged_sqlite != nullptr) {
+				batch.push_back(std::move(record));
+				if (batch.size() >= MERGE_BATCH_RECORDS)
+					insertBatch();
+			} else
 				merged_rs->insert(record.key, record.data);
-			} catch (const Error::ObjectDoesNotExist&) {
+
+			if (interrupt()) {
+				interrupted = true;
 				break;
 			}
 		}
 	}
+	if (merged_sqlite != nullptr)
+		insertBatch();
+
+	statistics.seconds = std::chrono::duration<double>(
+	    std::chrono::steady_clock::now() - startTime).count();
+	return (statistics);
 }
 /******************************************************************************/
 /* Common protected method implementations.                                   */
@@ -477,6 +816,117 @@ BiometricEvaluation::IO::RecordStore::Impl::genKeySegName(
 	return (keyseg.str());
 }
 
+void
+BiometricEvaluation::IO::RecordStore::Impl::openKeyFilter()
+{
+	if (!this->getKeyFilter())
+		return;
+
+	if (this->loadKeyFilter())
+		return;
+	try {
+		this->buildKeyFilter(2 * this->getCount());
+	} catch (const Error::NotImplemented &e) {
+		throw Error::StrategyError(e.whatString());
+	}
+}
+
+bool
+BiometricEvaluation::IO::RecordStore::Impl::keyMayExist(
+    const std::string &key)
+    const
+{
+	return ((_keyFilter == nullptr) || _keyFilter->mayContain(key));
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::keyFilterInsert(
+    const std::string &key)
+{
+	if (_keyFilter == nullptr)
+		return;
+
+	/* The store already holds key, so a rebuild includes it */
+	if (_keyFilter->getSize() >= _keyFilter->getCapacity())
+		this->buildKeyFilter(2 * _keyFilter->getCapacity());
+	else
+		_keyFilter->insert(key);
+	_keyFilterStale = true;
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::saveKeyFilter()
+    const
+{
+	if ((_keyFilter == nullptr) || (_mode == Mode::ReadOnly))
+		return;
+	const uint64_t stamp = this->keyFilterStamp();
+	if (!_keyFilterStale && (stamp == _keyFilterStamp))
+		return;
+
+	const std::vector<uint64_t> &bits = _keyFilter->getBits();
+	KeyFilterHeader header{};
+	std::copy(std::begin(KEYFILTER_MAGIC), std::end(KEYFILTER_MAGIC),
+	    header.magic);
+	header.version = KEYFILTER_VERSION;
+	header.byteOrder = KEYFILTER_BYTE_ORDER;
+	header.stamp = stamp;
+	header.count = this->getCount();
+	header.capacity = _keyFilter->getCapacity();
+	header.size = _keyFilter->getSize();
+	header.hashCount = _keyFilter->getHashCount();
+	header.wordCount = bits.size();
+
+	/* Replace the saved filter whole, so it is never seen half-written */
+	const std::string filterName{this->canonicalName(KEYFILTERFILENAME)};
+	const std::string tempName{filterName + ".tmp"};
+	std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(bits.data()),
+	    bits.size() * sizeof(uint64_t));
+	file.close();
+	if (!file) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not write " + tempName);
+	}
+	if (std::rename(tempName.c_str(), filterName.c_str()) != 0)
+		throw Error::StrategyError("Could not rename " + tempName +
+		    " (" + Error::errorStr() + ")");
+
+	_keyFilterStale = false;
+	_keyFilterStamp = stamp;
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::visitKeys(
+    const std::function<void(const std::string &)> &/* visitor */)
+    const
+{
+	throw Error::NotImplemented("Key filter");
+}
+
+uint64_t
+BiometricEvaluation::IO::RecordStore::Impl::keyFilterStamp()
+    const
+{
+	throw Error::NotImplemented("Key filter");
+}
+
+uint64_t
+BiometricEvaluation::IO::RecordStore::Impl::fileStamp(
+    const std::string &pathname)
+{
+	struct stat sb;
+	if (stat(pathname.c_str(), &sb) != 0)
+		throw Error::StrategyError("Could not stat " + pathname +
+		    " (" + Error::errorStr() + ")");
+
+	const uint64_t mtime = static_cast<uint64_t>(
+	    BE::Impl::modificationTime(sb));
+	return (mtime ^ (static_cast<uint64_t>(sb.st_size) << 32) ^
+	    (static_cast<uint64_t>(sb.st_size) >> 32));
+}
+
 std::shared_ptr<BiometricEvaluation::IO::Properties>
 BiometricEvaluation::IO::RecordStore::Impl::getProperties() const
 {
@@ -540,7 +990,9 @@ BiometricEvaluation::IO::RecordStore::Impl::isKeyCoreProperty(
 	return (
 	    (key == DESCRIPTIONPROPERTY) ||
 	    (key == COUNTPROPERTY) ||
-	    (key == TYPEPROPERTY));
+	    (key == TYPEPROPERTY) ||
+	    (key == UNCOMMITTEDPROPERTY) ||
+	    (key == KEYFILTERPROPERTY));
 }
 
 void
@@ -571,3 +1023,62 @@ BiometricEvaluation::IO::RecordStore::Impl::openControlFile()
 	}
 }
 
+bool
+BiometricEvaluation::IO::RecordStore::Impl::loadKeyFilter()
+{
+	const std::string filterName{this->canonicalName(KEYFILTERFILENAME)};
+	std::ifstream file(filterName, std::ios::binary);
+	if (!file)
+		return (false);
+
+	KeyFilterHeader header{};
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!file ||
+	    !std::equal(std::begin(KEYFILTER_MAGIC), std::end(KEYFILTER_MAGIC),
+	    header.magic) ||
+	    (header.version != KEYFILTER_VERSION) ||
+	    (header.byteOrder != KEYFILTER_BYTE_ORDER) ||
+	    (header.hashCount == 0) ||
+	    (header.hashCount > std::numeric_limits<uint32_t>::max()) ||
+	    (header.wordCount == 0) ||
+	    (header.wordCount > (IO::Utility::getFileSize(filterName) /
+	    sizeof(uint64_t))))
+		return (false);
+
+	/* A filter saved before the storage last changed may miss keys */
+	try {
+		if ((header.count != this->getCount()) ||
+		    (header.stamp != this->keyFilterStamp()))
+			return (false);
+	} catch (const Error::NotImplemented &) {
+		return (false);
+	}
+
+	std::vector<uint64_t> bits(header.wordCount);
+	file.read(reinterpret_cast<char *>(bits.data()),
+	    bits.size() * sizeof(uint64_t));
+	if (!file)
+		return (false);
+
+	_keyFilter = std::make_unique<Memory::BloomFilter>(header.capacity,
+	    header.size, static_cast<uint32_t>(header.hashCount),
+	    std::move(bits));
+	_keyFilterStale = false;
+	_keyFilterStamp = header.stamp;
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::buildKeyFilter(
+    uint64_t capacity)
+{
+	if (capacity < KEYFILTER_MIN_CAPACITY)
+		capacity = KEYFILTER_MIN_CAPACITY;
+	auto filter = std::make_unique<Memory::BloomFilter>(capacity);
+	this->visitKeys([&](const std::string &key) {
+		filter->insert(key);
+	});
+
+	_keyFilter = std::move(filter);
+	_keyFilterStale = true;
+}
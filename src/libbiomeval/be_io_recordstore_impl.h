@@ -10,12 +10,16 @@
 #ifndef __BE_IO_RECORDSTORE_IMPL_H__
 #define __BE_IO_RECORDSTORE_IMPL_H__
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <be_io_propertiesfile.h>
 #include <be_io_recordstore.h>
+#include <be_memory_bloomfilter.h>
 
 /*
  * This file contains the class declaration for the RecordStore base class
@@ -28,8 +32,10 @@ namespace BiometricEvaluation {
 		public:
 			/** The name of the control file, a properties list */
                         static const std::string CONTROLFILENAME;
+			/** The name of the persisted key filter */
+			static const std::string KEYFILTERFILENAME;
 
-			~Impl();
+			virtual ~Impl();
 			
 			/**
 			 * Obtain a textual description of the RecordStore.
@@ -100,6 +106,10 @@ namespace BiometricEvaluation {
 			/**
 			 * Synchronize the entire record store to persistent
 			 * storage.
+			 * @details
+			 * Changes to the count of records are committed to
+			 * the control file. Subclasses synchronize their
+			 * own storage before calling this method.
 			 *
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
@@ -107,6 +117,45 @@ namespace BiometricEvaluation {
 			 */
 			void sync() const;
 
+			/**
+			 * @brief
+			 * Set when changes to the count of records are
+			 * committed to the control file.
+			 *
+			 * @param[in] policy
+			 *	The commit policy.
+			 */
+			void
+			setCommitPolicy(
+			    const RecordStore::CommitPolicy &policy);
+
+			/**
+			 * @brief
+			 * Enable or disable the key filter.
+			 * @details
+			 * The setting is kept in the control file. Only
+			 * subclasses that implement visitKeys() and
+			 * keyFilterStamp() may enable the filter.
+			 *
+			 * @param[in] enabled
+			 *	Whether to keep a key filter.
+			 *
+			 * @throw Error::StrategyError
+			 *	The store was opened read-only, or the filter
+			 *	could not be built or removed.
+			 */
+			void
+			setKeyFilter(
+			    bool enabled);
+
+			/**
+			 * @return
+			 *	Whether the store keeps a key filter.
+			 */
+			bool
+			getKeyFilter()
+			    const;
+
 			/**
 			 * Insert a record into the store.
 			 *
@@ -254,13 +303,17 @@ namespace BiometricEvaluation {
 			 *	A function to be called during long operations
 			 *	to determine whether to interrupt and return.
 			 *
+			 * @return
+			 *	The amount of data merged, and the time taken.
+			 *
 			 * @throw Error::ObjectExists
-			 *	A RecordStore at mergePathname already exists.
+			 *	A RecordStore at mergePathname already exists,
+			 *	or a key appears in more than one RecordStore.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
 			 *	storage system.
 			 */
-			static void mergeRecordStores(
+			static RecordStore::MergeStatistics mergeRecordStores(
 			    const std::string &mergePathname,
 			    const std::string &description,
 			    const IO::RecordStore::Kind &kind,
@@ -379,8 +432,257 @@ namespace BiometricEvaluation {
 			std::shared_ptr<IO::Properties>
 			getProperties()
 			    const;
-			
+
+			/**
+			 * @brief
+			 * Note that the backing storage is about to change
+			 * the count of records.
+			 * @details
+			 * Subclasses call this method before modifying their
+			 * storage for insert() or remove(). The first change
+			 * after a commit marks the control file, so that the
+			 * count is recovered if the process ends before the
+			 * change is committed.
+			 *
+			 * @throw Error::StrategyError
+			 *	The control file could not be written.
+			 */
+			void
+			beginChange();
+
+			/**
+			 * @brief
+			 * Make changes to the backing storage visible to
+			 * other processes, so that the count of records may
+			 * be committed.
+			 * @details
+			 * Called when the commit policy commits changes.
+			 * Subclasses that buffer changes in this process
+			 * override this method. Unlike sync(), data need
+			 * not be forced to persistent storage.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual void
+			flushChanges()
+			    const;
+
+			/**
+			 * @brief
+			 * Note that every change has reached the backing
+			 * storage as the store is closed.
+			 * @details
+			 * Subclasses call this method from their destructors
+			 * once their storage has been flushed and closed, so
+			 * that the count written to the control file is
+			 * marked current. If it is not called, the count is
+			 * recovered from the backing storage when the store
+			 * is next opened.
+			 */
+			void
+			commitOnClose()
+			    noexcept;
+
+			/**
+			 * @return
+			 *	Whether the count of records in the control
+			 *	file may not match the backing storage,
+			 *	because changes were not committed.
+			 */
+			bool
+			isCountStale()
+			    const;
+
+			/**
+			 * @brief
+			 * Replace a stale count of records with one obtained
+			 * from the backing storage.
+			 * @details
+			 * Subclasses call this method when opening a store
+			 * for which isCountStale() is true. The control file
+			 * is rewritten, unless the store is read-only, in
+			 * which case the count is only kept by this object.
+			 *
+			 * @param[in] count
+			 *	Number of records in the backing storage.
+			 *
+			 * @throw Error::StrategyError
+			 *	The control file could not be written.
+			 */
+			void
+			recoverCount(
+			    uint64_t count);
+
+			/**
+			 * @brief
+			 * Load or build the key filter, if enabled.
+			 * @details
+			 * Subclasses call this method when opening a store,
+			 * once visitKeys() and keyFilterStamp() may be
+			 * used. A saved filter is only loaded if it was
+			 * saved with the current stamp and count.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			void
+			openKeyFilter();
+
+			/**
+			 * @brief
+			 * Check the key filter for a key.
+			 *
+			 * @param[in] key
+			 *	The key to look for.
+			 *
+			 * @return
+			 *	false if key is certainly not in the store,
+			 *	true if it may be or there is no key filter.
+			 */
+			bool
+			keyMayExist(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Add a key to the key filter, if enabled.
+			 * @details
+			 * Called by insert(). Subclasses that add records
+			 * without calling insert() call this method once
+			 * each record has been added to their storage. The
+			 * filter is rebuilt at twice the size when it
+			 * becomes full.
+			 *
+			 * @param[in] key
+			 *	The key inserted.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when rebuilding the filter.
+			 */
+			void
+			keyFilterInsert(
+			    const std::string &key);
+
+			/**
+			 * @brief
+			 * Save the key filter if it or keyFilterStamp() has
+			 * changed since it was loaded or saved.
+			 * @details
+			 * Called by sync(). Subclasses also call this method
+			 * from their destructor.
+			 *
+			 * @throw Error::StrategyError
+			 *	The filter could not be written.
+			 */
+			void
+			saveKeyFilter()
+			    const;
+
+			/**
+			 * @brief
+			 * Pass every key in the store to a function.
+			 * @details
+			 * Used to build the key filter. The default
+			 * implementation throws.
+			 *
+			 * @param[in] visitor
+			 *	Function called with each key.
+			 *
+			 * @throw Error::NotImplemented
+			 *	The kind of store does not support a key
+			 *	filter.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual void
+			visitKeys(
+			    const std::function<void(const std::string &)>
+			    &visitor)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a value that changes whenever the keys in
+			 * the backing storage change.
+			 * @details
+			 * Saved with the key filter, so that a saved filter
+			 * is not used once the storage has been changed
+			 * without it. The default implementation throws.
+			 *
+			 * @return
+			 *	Value identifying the current set of keys.
+			 *
+			 * @throw Error::NotImplemented
+			 *	The kind of store does not support a key
+			 *	filter.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual uint64_t
+			keyFilterStamp()
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a stamp for a file or directory.
+			 * @details
+			 * Combines the modification time and size, for use
+			 * by keyFilterStamp().
+			 *
+			 * @param[in] pathname
+			 *	Path to the file or directory.
+			 *
+			 * @return
+			 *	Value that changes when pathname is modified.
+			 *
+			 * @throw Error::StrategyError
+			 *	pathname could not be stat()ed.
+			 */
+			static uint64_t
+			fileStamp(
+			    const std::string &pathname);
+
 		private:
+			/** Header of the persisted key filter */
+			struct KeyFilterHeader
+			{
+				/** KEYFILTER_MAGIC */
+				char magic[8];
+				/** KEYFILTER_VERSION */
+				uint32_t version;
+				/** KEYFILTER_BYTE_ORDER, as written by the host */
+				uint32_t byteOrder;
+				/** keyFilterStamp() when saved */
+				uint64_t stamp;
+				/** Count of records when saved */
+				uint64_t count;
+				/** BloomFilter::getCapacity() */
+				uint64_t capacity;
+				/** BloomFilter::getSize() */
+				uint64_t size;
+				/** BloomFilter::getHashCount() */
+				uint64_t hashCount;
+				/** Number of 64-bit words of bits that follow */
+				uint64_t wordCount;
+			};
+			using KeyFilterHeader = struct KeyFilterHeader;
+
+			/** Identifies a persisted key filter */
+			static constexpr char KEYFILTER_MAGIC[8] = {'B', 'E',
+			    'K', 'E', 'Y', 'F', 'L', 'T'};
+			/** Current version of the persisted key filter */
+			static const uint32_t KEYFILTER_VERSION = 1;
+			/** Written in host order to detect foreign filters */
+			static const uint32_t KEYFILTER_BYTE_ORDER = 0x01020304;
+			/** Smallest capacity of a key filter */
+			static const uint64_t KEYFILTER_MIN_CAPACITY = 1024;
+
 			/** Properties of the RecordStore */
 			std::shared_ptr<IO::PropertiesFile> _props;
 			
@@ -403,6 +705,74 @@ namespace BiometricEvaluation {
 			 * Mode in which the RecordStore was opened.
 			 */
 			BiometricEvaluation::IO::Mode _mode;
+
+			/** When changes to the count are committed */
+			RecordStore::CommitPolicy _commitPolicy{};
+			/** Whether the control file marks the count stale */
+			mutable bool _countStale{false};
+			/** Changes to the count not yet committed */
+			mutable uint64_t _uncommittedChanges{0};
+			/** Time of the oldest uncommitted change */
+			mutable std::chrono::steady_clock::time_point
+			    _firstUncommittedChange{};
+			/** Count recovered for a read-only store */
+			std::optional<uint64_t> _recoveredCount{};
+
+			/** Filter of the keys in the store, if enabled */
+			std::unique_ptr<Memory::BloomFilter> _keyFilter{};
+			/** Whether _keyFilter differs from the saved filter */
+			mutable bool _keyFilterStale{false};
+			/** keyFilterStamp() when the filter was last saved */
+			mutable uint64_t _keyFilterStamp{0};
+
+			/**
+			 * @brief
+			 * Read the saved key filter.
+			 *
+			 * @return
+			 *	true if the saved filter was loaded, false
+			 *	if it is missing, malformed, or out of date.
+			 */
+			bool
+			loadKeyFilter();
+
+			/**
+			 * @brief
+			 * Build the key filter from visitKeys().
+			 *
+			 * @param[in] capacity
+			 *	Minimum capacity of the filter.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			void
+			buildKeyFilter(
+			    uint64_t capacity);
+
+			/**
+			 * @brief
+			 * Count a change to the number of records, and
+			 * commit changes when the commit policy says to.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when committing.
+			 */
+			void
+			countChange();
+
+			/**
+			 * @brief
+			 * Write the count of records to the control file
+			 * and mark it current.
+			 *
+			 * @throw Error::StrategyError
+			 *	The control file could not be written.
+			 */
+			void
+			commitCount()
+			    const;
 			
 			/**
 			 * @brief
@@ -0,0 +1,97 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <be_io_recordstoreprefetcher.h>
+
+#include "be_io_recordstoreprefetcher_impl.h"
+
+BiometricEvaluation::IO::RecordStorePrefetcher::RecordStorePrefetcher(
+    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &recordStore,
+    uint64_t depth,
+    uint64_t bytes) :
+    pimpl{new BiometricEvaluation::IO::RecordStorePrefetcher::Impl(
+    recordStore, depth, bytes)}
+{
+
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::~RecordStorePrefetcher() =
+    default;
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::RecordStorePrefetcher::getRecordStore()
+    const
+{
+	return (this->pimpl->getRecordStore());
+}
+
+bool
+BiometricEvaluation::IO::RecordStorePrefetcher::next(
+    BiometricEvaluation::IO::RecordStore::Record &record)
+{
+	return (this->pimpl->next(record));
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::iterator
+BiometricEvaluation::IO::RecordStorePrefetcher::begin()
+{
+	return (Iterator(this));
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::iterator
+BiometricEvaluation::IO::RecordStorePrefetcher::end()
+{
+	return (Iterator());
+}
+
+/******************************************************************************/
+/* RecordStorePrefetcher::Iterator                                            */
+/******************************************************************************/
+
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::Iterator(
+    BiometricEvaluation::IO::RecordStorePrefetcher *prefetcher) :
+    _prefetcher{prefetcher}
+{
+	++(*this);
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::reference
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::operator*()
+{
+	return (this->_currentRecord);
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::pointer
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::operator->()
+{
+	return (&(this->_currentRecord));
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator&
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::operator++()
+{
+	if (this->_prefetcher == nullptr)
+		return (*this);
+
+	if (!this->_prefetcher->next(this->_currentRecord)) {
+		this->_prefetcher = nullptr;
+		this->_currentRecord = RecordStore::Record();
+	}
+	return (*this);
+}
+
+bool
+BiometricEvaluation::IO::RecordStorePrefetcher::Iterator::operator==(
+    const BiometricEvaluation::IO::RecordStorePrefetcher::Iterator &rhs)
+    const
+{
+	return ((this->_prefetcher == rhs._prefetcher) &&
+	    (this->_currentRecord.key == rhs._currentRecord.key));
+}
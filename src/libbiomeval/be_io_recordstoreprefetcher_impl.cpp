@@ -0,0 +1,201 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include "be_io_recordstoreprefetcher_impl.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <limits>
+#include <system_error>
+
+#include <be_error_exception.h>
+
+#if defined(POSIX_FADV_WILLNEED)
+/**
+ * @brief
+ * Ask the operating system to read part of an archive segment.
+ *
+ * @param[in] range
+ *	Segment, offset, and length to read. Does nothing if the
+ *	length is 0.
+ */
+static void
+adviseWillNeed(
+    const BiometricEvaluation::IO::ArchiveRecordStore::Extent &range)
+{
+	if (range.size == 0)
+		return;
+
+	/* Advice is only a hint, so failure is not an error */
+	const int fd = ::open(range.file.c_str(), O_RDONLY);
+	if (fd == -1)
+		return;
+	(void)::posix_fadvise(fd, static_cast<off_t>(range.offset),
+	    static_cast<off_t>(range.size), POSIX_FADV_WILLNEED);
+	::close(fd);
+}
+#endif
+
+BiometricEvaluation::IO::RecordStorePrefetcher::Impl::Impl(
+    const std::shared_ptr<RecordStore> &recordStore,
+    uint64_t depth,
+    uint64_t bytes) :
+    _rs{recordStore},
+    _depth{depth},
+    _bytes{bytes}
+{
+	if (_rs == nullptr)
+		throw Error::ParameterError("RecordStore is nullptr");
+	if ((_depth == 0) || (_bytes == 0))
+		throw Error::ParameterError("Prefetch depth and bytes must "
+		    "be greater than 0");
+
+#if defined(POSIX_FADV_WILLNEED)
+	/*
+	 * An ArchiveRecordStore can say where the records it sequences
+	 * next are stored, so the kernel can be told to page them in
+	 * ahead of the background thread.
+	 */
+	_archive = std::dynamic_pointer_cast<ArchiveRecordStore>(_rs);
+#endif
+
+	try {
+		_thread = std::thread(&RecordStorePrefetcher::Impl::run, this);
+	} catch (const std::system_error &e) {
+		throw Error::StrategyError("Could not start prefetching (" +
+		    std::string(e.what()) + ")");
+	}
+}
+
+BiometricEvaluation::IO::RecordStorePrefetcher::Impl::~Impl()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_cancelled = true;
+	}
+	_notFull.notify_all();
+	if (_thread.joinable())
+		_thread.join();
+}
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::RecordStorePrefetcher::Impl::getRecordStore()
+    const
+{
+	return (_rs);
+}
+
+bool
+BiometricEvaluation::IO::RecordStorePrefetcher::Impl::next(
+    RecordStore::Record &record)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_notEmpty.wait(lock, [&]() {
+		return (!_queue.empty() || _done);
+	});
+	if (_queue.empty()) {
+		if (_error)
+			std::rethrow_exception(_error);
+		return (false);
+	}
+
+	record = std::move(_queue.front());
+	_queue.pop_front();
+	_queuedBytes -= record.data.size();
+	lock.unlock();
+	_notFull.notify_one();
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::RecordStorePrefetcher::Impl::run()
+{
+	try {
+		RecordStore::Record record;
+		uint64_t position = 0;
+		int cursor = RecordStore::BE_RECSTORE_SEQ_START;
+		while (true) {
+			this->advise(position);
+			try {
+				record = _rs->sequence(cursor);
+			} catch (const Error::ObjectDoesNotExist &) {
+				break;
+			}
+			cursor = RecordStore::BE_RECSTORE_SEQ_NEXT;
+			position += record.data.size();
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_notFull.wait(lock, [&]() {
+				return (_cancelled || _queue.empty() ||
+				    ((_queue.size() < _depth) &&
+				    (_queuedBytes + record.data.size() <=
+				    _bytes)));
+			});
+			if (_cancelled)
+				break;
+			_queuedBytes += record.data.size();
+			_queue.push_back(std::move(record));
+			lock.unlock();
+			_notEmpty.notify_one();
+		}
+	} catch (...) {
+		/* Rethrown by next() on the consuming thread */
+		std::lock_guard<std::mutex> lock(_mutex);
+		_error = std::current_exception();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_done = true;
+	}
+	_notEmpty.notify_all();
+}
+
+void
+BiometricEvaluation::IO::RecordStorePrefetcher::Impl::advise(
+    uint64_t position)
+{
+#if defined(POSIX_FADV_WILLNEED)
+	if (_archive == nullptr)
+		return;
+
+	/* Keep between one and two queues' worth of records advised */
+	if ((position + _bytes) <= _advisedThrough)
+		return;
+	const auto extents = _archive->getSequenceExtents(2 * _bytes);
+
+	/* Skip records advised before, and merge adjacent ones */
+	uint64_t through = position;
+	ArchiveRecordStore::Extent range{};
+	for (const auto &extent : extents) {
+		through += extent.size;
+		if (through <= _advisedThrough)
+			continue;
+		if ((extent.file == range.file) &&
+		    (extent.offset == (range.offset + range.size))) {
+			range.size += extent.size;
+			continue;
+		}
+		adviseWillNeed(range);
+		range = extent;
+	}
+	adviseWillNeed(range);
+
+	/* Once the last record is advised, there is nothing more to do */
+	if ((through - position) < (2 * _bytes))
+		_advisedThrough = std::numeric_limits<uint64_t>::max();
+	else
+		_advisedThrough = through;
+#else
+	(void)position;
+#endif
+}
@@ -0,0 +1,110 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef BE_IO_RECORDSTOREPREFETCHER_IMPL_H_
+#define BE_IO_RECORDSTOREPREFETCHER_IMPL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <be_io_archiverecstore.h>
+#include <be_io_recordstoreprefetcher.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/** Implementation of RecordStorePrefetcher. */
+		class RecordStorePrefetcher::Impl
+		{
+		public:
+			/** @see RecordStorePrefetcher::RecordStorePrefetcher */
+			Impl(
+			    const std::shared_ptr<RecordStore> &recordStore,
+			    uint64_t depth,
+			    uint64_t bytes);
+
+			/** Stop and join the background thread. */
+			~Impl();
+
+			/** @see RecordStorePrefetcher::getRecordStore */
+			std::shared_ptr<RecordStore>
+			getRecordStore()
+			    const;
+
+			/** @see RecordStorePrefetcher::next */
+			bool
+			next(
+			    RecordStore::Record &record);
+
+		private:
+			/**
+			 * @brief
+			 * Sequence the RecordStore into the queue.
+			 * @details
+			 * Runs on _thread until the RecordStore is exhausted,
+			 * an exception is thrown, or the Impl is destroyed.
+			 */
+			void
+			run();
+
+			/**
+			 * @brief
+			 * Ask the operating system to read the records
+			 * sequenced next ahead of the background thread.
+			 *
+			 * @param[in] position
+			 *	Bytes of record data sequenced so far.
+			 *
+			 * @note
+			 * Does nothing when the RecordStore cannot locate
+			 * its upcoming records, or advice is not supported.
+			 */
+			void
+			advise(
+			    uint64_t position);
+
+			/** RecordStore being sequenced */
+			std::shared_ptr<RecordStore> _rs;
+			/** Maximum number of records queued */
+			const uint64_t _depth;
+			/** Maximum bytes of record data queued */
+			const uint64_t _bytes;
+
+			/** _rs, if it can locate its upcoming records */
+			std::shared_ptr<ArchiveRecordStore> _archive{};
+			/** Bytes of record data advised through */
+			uint64_t _advisedThrough{0};
+
+			std::thread _thread{};
+			std::mutex _mutex{};
+			/** Signaled when a record is queued or run() ends */
+			std::condition_variable _notEmpty{};
+			/** Signaled when a record is dequeued or cancelled */
+			std::condition_variable _notFull{};
+			std::deque<RecordStore::Record> _queue{};
+			/** Bytes of record data in _queue */
+			uint64_t _queuedBytes{0};
+			/** run() has finished */
+			bool _done{false};
+			/** Destructor has asked run() to finish */
+			bool _cancelled{false};
+			/** Exception thrown from run(), rethrown by next() */
+			std::exception_ptr _error{};
+		};
+	}
+}
+
+#endif /* BE_IO_RECORDSTOREPREFETCHER_IMPL_H_ */
@@ -105,6 +105,28 @@ BiometricEvaluation::IO::RecordStoreUnion::length(
 	return (this->pimpl->length(key));
 }
 
+std::pair<const std::string, BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStoreUnion::readFirst(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->readFirst(key));
+}
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::setLookupThreads(
+    uint32_t threadCount)
+{
+	this->pimpl->setLookupThreads(threadCount);
+}
+
+uint32_t
+BiometricEvaluation::IO::RecordStoreUnion::getLookupThreads()
+    const
+{
+	return (this->pimpl->getLookupThreads());
+}
+
 void
 BiometricEvaluation::IO::RecordStoreUnion::setImpl(
     const std::shared_ptr<RecordStoreUnion::Impl> &pimpl)
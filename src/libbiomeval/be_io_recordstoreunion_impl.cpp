@@ -8,12 +8,161 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <system_error>
+#include <thread>
+
 #include <be_io_recordstore.h>
 
 #include "be_io_recordstoreunion_impl.h"
 
 namespace BE = BiometricEvaluation;
 
+/*
+ * Lookups block on I/O, not CPU, so threads are only a way to wait on
+ * several RecordStores at once. They are kept for reuse between lookups
+ * and shared between unions requesting the same number of threads.
+ */
+class BiometricEvaluation::IO::RecordStoreUnion::Impl::ThreadPool
+{
+public:
+	ThreadPool(
+	    uint32_t threadCount)
+	{
+		try {
+			for (uint32_t i = 0; i < threadCount; i++)
+				_threads.emplace_back(&ThreadPool::run, this);
+		} catch (const std::system_error &e) {
+			this->stop();
+			throw BE::Error::StrategyError("Could not start lookup "
+			    "threads (" + std::string(e.what()) + ")");
+		}
+	}
+
+	~ThreadPool()
+	{
+		this->stop();
+	}
+
+	uint32_t
+	size()
+	    const
+	{
+		return (static_cast<uint32_t>(_threads.size()));
+	}
+
+	void
+	submit(
+	    std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_tasks.push_back(std::move(task));
+		}
+		_taskAvailable.notify_one();
+	}
+
+	/**
+	 * @return
+	 * Pool with threadCount threads, shared with other callers
+	 * while any of them hold it.
+	 */
+	static std::shared_ptr<ThreadPool>
+	get(
+	    uint32_t threadCount)
+	{
+		static std::mutex poolsMutex;
+		static std::map<uint32_t, std::weak_ptr<ThreadPool>> pools;
+
+		std::lock_guard<std::mutex> lock(poolsMutex);
+		auto pool = pools[threadCount].lock();
+		if (pool == nullptr) {
+			pool = std::make_shared<ThreadPool>(threadCount);
+			pools[threadCount] = pool;
+		}
+		return (pool);
+	}
+
+private:
+	void
+	run()
+	{
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_taskAvailable.wait(lock, [&]() {
+					return (_stopping || !_tasks.empty());
+				});
+				if (_tasks.empty())
+					return;
+				task = std::move(_tasks.front());
+				_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	/* Outstanding tasks are run before threads exit */
+	void
+	stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_taskAvailable.notify_all();
+		for (auto &thread : _threads)
+			if (thread.joinable())
+				thread.join();
+	}
+
+	std::vector<std::thread> _threads{};
+	std::mutex _mutex{};
+	std::condition_variable _taskAvailable{};
+	std::deque<std::function<void()>> _tasks{};
+	bool _stopping{false};
+};
+
+namespace
+{
+	/** Results of one lookup, shared with the tasks performing it */
+	template<typename T>
+	struct LookupState
+	{
+		LookupState(
+		    size_t count) :
+		    remaining{count},
+		    results(count),
+		    found(count, false),
+		    errors(count)
+		{
+
+		}
+
+		std::mutex mutex{};
+		std::condition_variable finished{};
+		/** Tasks that have not yet finished */
+		size_t remaining;
+		/** Tasks that have started and not yet finished */
+		size_t running{0};
+		/** Set when tasks not yet started should do nothing */
+		bool cancelled{false};
+		/** Whether any task found the key */
+		bool hit{false};
+		/** Index of the first task to find the key */
+		size_t firstHit{0};
+
+		/* Indexed the same as Impl::_members */
+		std::vector<T> results;
+		std::vector<bool> found;
+		std::vector<std::string> errors;
+		std::exception_ptr exception{};
+	};
+}
+
 BiometricEvaluation::IO::RecordStoreUnion::Impl::Impl(
     const std::map<const std::string, const std::string> &recordStores) :
     _recordStores(initRecordStoreMap(recordStores))
@@ -94,6 +243,17 @@ BiometricEvaluation::IO::RecordStoreUnion::Impl::verifyRecordStoreNames(
 			throw BE::Error::ObjectDoesNotExist(dataPair.first);
 }
 
+std::vector<BiometricEvaluation::IO::RecordStoreUnion::Impl::Member>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::initMembers()
+    const
+{
+	std::vector<Member> members;
+	for (const auto &rsPair : this->_recordStores)
+		members.push_back({rsPair.first, rsPair.second,
+		    std::make_shared<std::mutex>()});
+	return (members);
+}
+
 std::shared_ptr<BiometricEvaluation::IO::RecordStore>
 BiometricEvaluation::IO::RecordStoreUnion::Impl::getRecordStore(
     const std::string &name)
@@ -120,29 +280,119 @@ BiometricEvaluation::IO::RecordStoreUnion::Impl::getNames()
  * Operations.
  */
 
-std::map<const std::string, BiometricEvaluation::Memory::uint8Array>
-BiometricEvaluation::IO::RecordStoreUnion::Impl::read(
-    const std::string &key)
+template<typename T>
+std::map<const std::string, T>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::lookup(
+    const std::string &key,
+    const std::function<T(RecordStore&, const std::string&)> &operation,
+    bool firstHit)
     const
 {
-	std::string exceptions;
-	std::map<const std::string,
-	    BiometricEvaluation::Memory::uint8Array> ret;
+	const auto state = std::make_shared<LookupState<T>>(
+	    this->_members.size());
 
-	for (const auto &rsPair : this->_recordStores) {
+	/* Look up key in one RecordStore, recording the result in state */
+	const auto task = [state, key, operation](
+	    const size_t index,
+	    const Member &member) {
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (state->cancelled) {
+				if (--state->remaining == 0)
+					state->finished.notify_all();
+				return;
+			}
+			state->running++;
+		}
+
+		T result{};
+		bool found = false;
+		std::string error;
+		std::exception_ptr exception;
 		try {
-			ret.emplace(std::make_pair(rsPair.first,
-			    rsPair.second->read(key)));
+			std::lock_guard<std::mutex> lock(*member.mutex);
+			result = operation(*member.recordStore, key);
+			found = true;
 		} catch (const BE::Error::ObjectDoesNotExist&) {
 			/* Swallow */
 		} catch (const BE::Error::Exception &e) {
-			if (!exceptions.empty())
-				exceptions += '\n';
-			exceptions += e.whatString() + " (" + rsPair.first +
-			    ')';
+			error = e.whatString() + " (" + member.name + ')';
+		} catch (...) {
+			exception = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (found) {
+			state->results[index] = std::move(result);
+			state->found[index] = true;
+			if (!state->hit)
+				state->firstHit = index;
+			state->hit = true;
+		}
+		state->errors[index] = std::move(error);
+		if ((exception != nullptr) && (state->exception == nullptr))
+			state->exception = exception;
+		state->running--;
+		if ((--state->remaining == 0) || found ||
+		    (state->cancelled && (state->running == 0)))
+			state->finished.notify_all();
+	};
+
+	if (this->_pool == nullptr) {
+		for (size_t i = 0; i < this->_members.size(); i++) {
+			task(i, this->_members[i]);
+			if (firstHit && state->hit) {
+				state->cancelled = true;
+				break;
+			}
+		}
+	} else {
+		for (size_t i = 0; i < this->_members.size(); i++) {
+			const Member member = this->_members[i];
+			this->_pool->submit([task, i, member]() {
+				task(i, member);
+			});
 		}
+
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->finished.wait(lock, [&]() {
+			return ((state->remaining == 0) ||
+			    (firstHit && state->hit));
+		});
+
+		/*
+		 * Cancel tasks that have not started, and wait for the rest,
+		 * so member RecordStores are idle once the lookup returns.
+		 */
+		state->cancelled = true;
+		state->finished.wait(lock, [&]() {
+			return (state->running == 0);
+		});
 	}
 
+	/* Merge results in name order */
+	std::lock_guard<std::mutex> lock(state->mutex);
+	if (state->exception != nullptr)
+		std::rethrow_exception(state->exception);
+	std::map<const std::string, T> ret;
+	if (firstHit && state->hit) {
+		ret.emplace(this->_members[state->firstHit].name,
+		    std::move(state->results[state->firstHit]));
+		return (ret);
+	}
+	for (size_t i = 0; i < this->_members.size(); i++)
+		if (state->found[i])
+			ret.emplace(this->_members[i].name,
+			    std::move(state->results[i]));
+
+	std::string exceptions;
+	for (const auto &error : state->errors) {
+		if (error.empty())
+			continue;
+		if (!exceptions.empty())
+			exceptions += '\n';
+		exceptions += error;
+	}
 	if (!exceptions.empty())
 		throw BE::Error::StrategyError(exceptions);
 	if (ret.size() == 0)
@@ -151,33 +401,55 @@ BiometricEvaluation::IO::RecordStoreUnion::Impl::read(
 	return (ret);
 }
 
+std::map<const std::string, BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::read(
+    const std::string &key)
+    const
+{
+	return (this->lookup<Memory::uint8Array>(key,
+	    [](RecordStore &rs, const std::string &k) {
+		return (rs.read(k));
+	    }, false));
+}
+
 std::map<const std::string, uint64_t>
 BiometricEvaluation::IO::RecordStoreUnion::Impl::length(
     const std::string &key)
     const
 {
-	std::string exceptions;
-	std::map<const std::string, uint64_t> ret;
-
-	for (const auto &rsPair : this->_recordStores) {
-		try {
-			ret.emplace(std::make_pair(rsPair.first,
-			    rsPair.second->length(key)));
-		} catch (const BE::Error::ObjectDoesNotExist&) {
-			/* Swallow */
-		} catch (const BE::Error::Exception &e) {
-			if (!exceptions.empty())
-				exceptions += '\n';
-			exceptions += e.whatString() + " (" + rsPair.first +
-			    ')';
-		}
-	}
+	return (this->lookup<uint64_t>(key,
+	    [](RecordStore &rs, const std::string &k) {
+		return (rs.length(k));
+	    }, false));
+}
 
-	if (!exceptions.empty())
-		throw BE::Error::StrategyError(exceptions);
-	if (ret.size() == 0)
-		throw BE::Error::ObjectDoesNotExist(key);
+std::pair<const std::string, BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::readFirst(
+    const std::string &key)
+    const
+{
+	auto ret = this->lookup<Memory::uint8Array>(key,
+	    [](RecordStore &rs, const std::string &k) {
+		return (rs.read(k));
+	    }, true);
+	return (std::move(*ret.begin()));
+}
 
-	return (ret);
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::setLookupThreads(
+    uint32_t threadCount)
+{
+	if (threadCount == 0)
+		this->_pool.reset();
+	else
+		this->_pool = ThreadPool::get(threadCount);
 }
 
+uint32_t
+BiometricEvaluation::IO::RecordStoreUnion::Impl::getLookupThreads()
+    const
+{
+	if (this->_pool == nullptr)
+		return (0);
+	return (this->_pool->size());
+}
@@ -15,6 +15,7 @@
 
 
 #include <functional>
+#include <mutex>
 
 namespace BiometricEvaluation
 {
@@ -205,10 +206,110 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    const;
 
+			/**
+			 * @brief
+			 * Read a key from whichever member RecordStore
+			 * produces it first.
+			 *
+			 * @param key
+			 * The key to read.
+			 *
+			 * @return
+			 * Pair of RecordStore name and the data read from
+			 * said RecordStore.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * key does not exist in any member RecordStores.
+			 * @throw Error::StrategyError
+			 * key was not found, and a member RecordStore
+			 * threw an exception other than ObjectDoesNotExist.
+			 */
+			std::pair<const std::string,
+			BiometricEvaluation::Memory::uint8Array>
+			readFirst(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Look up keys in member RecordStores concurrently.
+			 *
+			 * @param threadCount
+			 * Number of threads in the pool, or 0 for serial
+			 * lookups.
+			 *
+			 * @throw Error::StrategyError
+			 * Could not start threads.
+			 */
+			void
+			setLookupThreads(
+			    uint32_t threadCount);
+
+			/**
+			 * @return
+			 * Number of threads used to look up keys
+			 * concurrently, or 0 if lookups are serial.
+			 */
+			uint32_t
+			getLookupThreads()
+			    const;
+
 			/** Default destructor */
 			~Impl() = default;
 
 		private:
+			/** Pool of threads shared between unions */
+			class ThreadPool;
+
+			/**
+			 * @brief
+			 * A member RecordStore.
+			 * @details
+			 * Lookups abandoned by readFirst() may still be
+			 * running when the next lookup starts, so access
+			 * to each RecordStore is serialized.
+			 */
+			struct Member
+			{
+				/** Name provided during construction */
+				std::string name;
+				/** Open RecordStore */
+				std::shared_ptr<BiometricEvaluation::IO::
+				    RecordStore> recordStore;
+				/** Serializes access to recordStore */
+				std::shared_ptr<std::mutex> mutex;
+			};
+
+			/**
+			 * @brief
+			 * Perform an operation on every member RecordStore.
+			 *
+			 * @param key
+			 * Key passed to operation.
+			 * @param operation
+			 * Operation to perform on each RecordStore.
+			 * @param firstHit
+			 * Stop after the first successful operation.
+			 *
+			 * @return
+			 * Map of RecordStore name to result of operation,
+			 * for RecordStores that contain key.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * key does not exist in any member RecordStores.
+			 * @throw Error::StrategyError
+			 * Exceptions propagated from RecordStore, with the
+			 * exception of ObjectDoesNotExist.
+			 */
+			template<typename T>
+			std::map<const std::string, T>
+			lookup(
+			    const std::string &key,
+			    const std::function<T(RecordStore&,
+			    const std::string&)> &operation,
+			    bool firstHit)
+			    const;
+
 			/**
 			 * @brief
 			 * Check that RecordStore names passed to a method
@@ -245,10 +346,27 @@ namespace BiometricEvaluation
 			    &recordStores)
 			    const;
 
+			/**
+			 * @brief
+			 * Const-initialization of _members.
+			 *
+			 * @return
+			 * Value to be applied to _members.
+			 */
+			std::vector<Member>
+			initMembers()
+			    const;
+
 			/** Mapping of name to open RecordStores */
 			const std::map<const std::string, const std::shared_ptr<
 			    BiometricEvaluation::IO::RecordStore>>
 			    _recordStores;
+
+			/** _recordStores, in name order, with locks */
+			const std::vector<Member> _members{initMembers()};
+
+			/** Threads for concurrent lookups (nullptr if serial) */
+			std::shared_ptr<ThreadPool> _pool{};
 		};
 	}
 }
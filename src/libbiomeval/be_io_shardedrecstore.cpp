@@ -0,0 +1,219 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include "be_io_shardedrecstore_impl.h"
+
+namespace BE = BiometricEvaluation;
+
+BiometricEvaluation::IO::ShardedRecordStore::ShardedRecordStore(
+    const std::string &pathname,
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    uint32_t shardCount)
+{
+	/*
+	 * Exceptions float out.
+	 */
+	this->pimpl.reset(new IO::ShardedRecordStore::Impl(
+	    pathname, description, shardKind, shardCount));
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::ShardedRecordStore(
+    const std::string &pathname,
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    const std::vector<std::string> &shardPathnames)
+{
+	/*
+	 * Exceptions float out.
+	 */
+	this->pimpl.reset(new IO::ShardedRecordStore::Impl(
+	    pathname, description, shardKind, shardPathnames));
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::ShardedRecordStore(
+    const std::string &pathname,
+    IO::Mode mode)
+{
+	/*
+	 * Exceptions float out.
+	 */
+	this->pimpl.reset(new IO::ShardedRecordStore::Impl(
+	    pathname, mode));
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::~ShardedRecordStore()
+{
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::move(
+    const std::string &pathname)
+{
+	this->pimpl->move(pathname);
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::getSpaceUsed()
+    const
+{
+	return (this->pimpl->getSpaceUsed());
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::sync()
+    const
+{
+	this->pimpl->sync();
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::setCommitPolicy(
+    const CommitPolicy &policy)
+{
+	this->pimpl->setCommitPolicy(policy);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::insert(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	this->pimpl->insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::replace(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	this->pimpl->replace(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::remove(
+    const std::string &key)
+{
+	this->pimpl->remove(key);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ShardedRecordStore::read(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->read(key));
+}
+
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::ShardedRecordStore::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->read(keys));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ShardedRecordStore::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	return (this->pimpl->readPrefix(key, size));
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::length(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->length(key));
+}
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::ShardedRecordStore::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->length(keys));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::flush(
+    const std::string &key)
+    const
+{
+	this->pimpl->flush(key);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ShardedRecordStore::sequence(
+    int cursor)
+{
+	return (this->pimpl->sequence(cursor));
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::sequenceKey(
+    int cursor)
+{
+	return (this->pimpl->sequenceKey(cursor));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::setCursorAtKey(
+    const std::string &key)
+{
+	this->pimpl->setCursorAtKey(key);
+}
+
+unsigned int
+BiometricEvaluation::IO::ShardedRecordStore::getCount()
+    const
+{
+	return (this->pimpl->getCount());
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::getPathname()
+    const
+{
+	return (this->pimpl->getPathname());
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::getDescription()
+    const
+{
+	return (this->pimpl->getDescription());
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::changeDescription(
+    const std::string &description)
+{
+	this->pimpl->changeDescription(description);
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::getShardCount()
+    const
+{
+	return (this->pimpl->getShardCount());
+}
+
+std::vector<std::string>
+BiometricEvaluation::IO::ShardedRecordStore::getShardPathnames()
+    const
+{
+	return (this->pimpl->getShardPathnames());
+}
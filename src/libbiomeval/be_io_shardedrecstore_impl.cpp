@@ -0,0 +1,575 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <future>
+
+#include "be_io_shardedrecstore_impl.h"
+#include "be_utility_impl.h"
+#include <be_framework_enumeration.h>
+#include <be_io_properties.h>
+#include <be_io_utility.h>
+
+namespace BE = BiometricEvaluation;
+
+using namespace BE::Framework::Enumeration;
+
+const std::string SHARD_COUNT_KEY{"Shard_Count"};
+const std::string SHARD_KIND_KEY{"Shard_Kind"};
+/** Followed by the shard number */
+const std::string SHARD_PATHNAME_KEY_PREFIX{"Shard_"};
+/** Followed by the shard number */
+const std::string SHARD_DIRECTORY_PREFIX{"shard"};
+
+/**
+ * @brief
+ * Call a function once for each of count items, concurrently.
+ * @details
+ * The calling thread handles the first item. Once every call has
+ * returned, the first exception thrown, if any, is rethrown.
+ */
+template<typename Function>
+static void
+forEachConcurrently(
+    uint32_t count,
+    const Function &function)
+{
+	std::vector<std::future<void>> results{};
+	results.reserve(count);
+	for (uint32_t i = 1; i < count; i++)
+		results.push_back(std::async(std::launch::async, function, i));
+
+	std::exception_ptr error{};
+	try {
+		if (count > 0)
+			function(0);
+	} catch (...) {
+		error = std::current_exception();
+	}
+	for (auto &result : results) {
+		try {
+			result.get();
+		} catch (...) {
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::Impl(
+    const std::string &pathname,
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    uint32_t shardCount) :
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Sharded)
+{
+	std::vector<std::string> shardPathnames{};
+	shardPathnames.reserve(shardCount);
+	for (uint32_t i = 0; i < shardCount; i++)
+		shardPathnames.push_back(SHARD_DIRECTORY_PREFIX +
+		    std::to_string(i));
+
+	this->createShards(description, shardKind, shardPathnames);
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::Impl(
+    const std::string &pathname,
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    const std::vector<std::string> &shardPathnames) :
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Sharded)
+{
+	/* Relative paths would resolve against the store once opened */
+	std::vector<std::string> absolutePathnames{};
+	absolutePathnames.reserve(shardPathnames.size());
+	try {
+		for (const auto &shardPathname : shardPathnames)
+			absolutePathnames.push_back(std::filesystem::absolute(
+			    shardPathname).lexically_normal().string());
+	} catch (const std::filesystem::filesystem_error &e) {
+		IO::Utility::removeDirectory(pathname);
+		throw Error::StrategyError(e.what());
+	}
+
+	this->createShards(description, shardKind, absolutePathnames);
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::Impl(
+    const std::string &pathname,
+    IO::Mode mode) :
+    RecordStore::Impl(pathname, mode)
+{
+	this->openShards(mode);
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::~Impl()
+{
+	/* Stop reading ahead before closing shards */
+	this->_prefetchers.clear();
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::createShards(
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    const std::vector<std::string> &shardPathnames)
+{
+	/* Leave nothing behind if the store cannot be completed */
+	std::vector<std::string> created{};
+	try {
+		if (shardPathnames.empty())
+			throw Error::ParameterError("No shards");
+		if ((shardKind == RecordStore::Kind::List) ||
+		    (shardKind == RecordStore::Kind::Sharded))
+			throw Error::ParameterError(to_string(shardKind) +
+			    " RecordStores cannot be shards");
+
+		this->_shardKind = shardKind;
+		for (const auto &shardPathname : shardPathnames) {
+			const std::string resolved = this->resolveShardPathname(
+			    shardPathname);
+			Shard shard{shardPathname,
+			    RecordStore::createRecordStore(resolved,
+			    description, shardKind),
+			    std::make_shared<std::mutex>()};
+			created.push_back(resolved);
+			this->_shards.push_back(shard);
+		}
+
+		std::shared_ptr<IO::Properties> props = this->getProperties();
+		props->setPropertyFromInteger(SHARD_COUNT_KEY,
+		    this->_shards.size());
+		props->setProperty(SHARD_KIND_KEY, to_string(shardKind));
+		for (size_t i = 0; i < this->_shards.size(); i++)
+			props->setProperty(SHARD_PATHNAME_KEY_PREFIX +
+			    std::to_string(i), this->_shards[i].pathname);
+		this->setProperties(props);
+		RecordStore::Impl::sync();
+	} catch (const Error::Exception&) {
+		this->_shards.clear();
+		for (const auto &resolved : created) {
+			try {
+				IO::Utility::removeDirectory(resolved);
+			} catch (const Error::Exception&) {}
+		}
+		try {
+			IO::Utility::removeDirectory(this->getPathname());
+		} catch (const Error::Exception&) {}
+		throw;
+	}
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::openShards(
+    IO::Mode mode)
+{
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	std::vector<std::string> shardPathnames{};
+	try {
+		const int64_t shardCount = props->getPropertyAsInteger(
+		    SHARD_COUNT_KEY);
+		if ((shardCount <= 0) || (shardCount > UINT32_MAX))
+			throw Error::StrategyError("Invalid shard count");
+		this->_shardKind = to_enum<RecordStore::Kind>(
+		    props->getProperty(SHARD_KIND_KEY));
+		for (int64_t i = 0; i < shardCount; i++)
+			shardPathnames.push_back(props->getProperty(
+			    SHARD_PATHNAME_KEY_PREFIX + std::to_string(i)));
+	} catch (const Error::Exception &e) {
+		throw Error::StrategyError("Invalid shard properties: " +
+		    e.whatString());
+	}
+
+	for (const auto &shardPathname : shardPathnames) {
+		const std::string resolved = this->resolveShardPathname(
+		    shardPathname);
+		std::shared_ptr<RecordStore> rs{};
+		try {
+			rs = RecordStore::openRecordStore(resolved, mode);
+		} catch (const Error::Exception &e) {
+			throw Error::StrategyError("Could not open shard " +
+			    resolved + ": " + e.whatString());
+		}
+		this->_shards.push_back({shardPathname, rs,
+		    std::make_shared<std::mutex>()});
+	}
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::Impl::resolveShardPathname(
+    const std::string &shard)
+    const
+{
+	if (!shard.empty() && (shard[0] == '/'))
+		return (shard);
+	return (this->canonicalName(shard));
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardIndex(
+    const std::string &key)
+    const
+{
+	return (static_cast<uint32_t>(BE::Impl::fnv1a64(key) % this->_shards.size()));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::insert(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	shard.recordStore->insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::replace(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	shard.recordStore->replace(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::remove(
+    const std::string &key)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	shard.recordStore->remove(key);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ShardedRecordStore::Impl::read(
+    const std::string &key)
+    const
+{
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	return (shard.recordStore->read(key));
+}
+
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::ShardedRecordStore::Impl::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	/* Position within keys of the keys kept in each shard */
+	std::vector<std::vector<size_t>> positions(this->_shards.size());
+	for (size_t i = 0; i < keys.size(); i++)
+		positions[this->getShardIndex(keys[i])].push_back(i);
+	std::vector<uint32_t> used{};
+	for (uint32_t i = 0; i < positions.size(); i++)
+		if (!positions[i].empty())
+			used.push_back(i);
+
+	std::vector<Memory::uint8Array> records(keys.size());
+	forEachConcurrently(used.size(), [&](uint32_t u) {
+		const std::vector<size_t> &shardPositions = positions[used[u]];
+		std::vector<std::string> shardKeys{};
+		shardKeys.reserve(shardPositions.size());
+		for (const auto position : shardPositions)
+			shardKeys.push_back(keys[position]);
+
+		const Shard &shard = this->_shards[used[u]];
+		std::vector<Memory::uint8Array> shardRecords{};
+		{
+			std::lock_guard<std::mutex> lock(*shard.mutex);
+			shardRecords = shard.recordStore->read(shardKeys);
+		}
+		for (size_t i = 0; i < shardPositions.size(); i++)
+			records[shardPositions[i]] = std::move(shardRecords[i]);
+	});
+	return (records);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ShardedRecordStore::Impl::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	return (shard.recordStore->readPrefix(key, size));
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::length(
+    const std::string &key)
+    const
+{
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	return (shard.recordStore->length(key));
+}
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::ShardedRecordStore::Impl::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	std::vector<std::vector<size_t>> positions(this->_shards.size());
+	for (size_t i = 0; i < keys.size(); i++)
+		positions[this->getShardIndex(keys[i])].push_back(i);
+	std::vector<uint32_t> used{};
+	for (uint32_t i = 0; i < positions.size(); i++)
+		if (!positions[i].empty())
+			used.push_back(i);
+
+	std::vector<uint64_t> lengths(keys.size());
+	forEachConcurrently(used.size(), [&](uint32_t u) {
+		const std::vector<size_t> &shardPositions = positions[used[u]];
+		std::vector<std::string> shardKeys{};
+		shardKeys.reserve(shardPositions.size());
+		for (const auto position : shardPositions)
+			shardKeys.push_back(keys[position]);
+
+		const Shard &shard = this->_shards[used[u]];
+		std::vector<uint64_t> shardLengths{};
+		{
+			std::lock_guard<std::mutex> lock(*shard.mutex);
+			shardLengths = shard.recordStore->length(shardKeys);
+		}
+		for (size_t i = 0; i < shardPositions.size(); i++)
+			lengths[shardPositions[i]] = shardLengths[i];
+	});
+	return (lengths);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::flush(
+    const std::string &key)
+    const
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	const Shard &shard = this->_shards[this->getShardIndex(key)];
+	std::lock_guard<std::mutex> lock(*shard.mutex);
+	shard.recordStore->flush(key);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::sync()
+    const
+{
+	if (this->getMode() == Mode::ReadOnly)
+		return;
+
+	forEachConcurrently(this->_shards.size(), [&](uint32_t i) {
+		std::lock_guard<std::mutex> lock(*this->_shards[i].mutex);
+		this->_shards[i].recordStore->sync();
+	});
+	RecordStore::Impl::sync();
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::setCommitPolicy(
+    const RecordStore::CommitPolicy &policy)
+{
+	/* Each shard keeps its own count */
+	for (const auto &shard : this->_shards) {
+		std::lock_guard<std::mutex> lock(*shard.mutex);
+		shard.recordStore->setCommitPolicy(policy);
+	}
+}
+
+unsigned int
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getCount()
+    const
+{
+	unsigned int count = 0;
+	for (const auto &shard : this->_shards) {
+		std::lock_guard<std::mutex> lock(*shard.mutex);
+		count += shard.recordStore->getCount();
+	}
+	return (count);
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getSpaceUsed()
+    const
+{
+	uint64_t spaceUsed = RecordStore::Impl::getSpaceUsed();
+	for (const auto &shard : this->_shards) {
+		std::lock_guard<std::mutex> lock(*shard.mutex);
+		spaceUsed += shard.recordStore->getSpaceUsed();
+	}
+	return (spaceUsed);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ShardedRecordStore::Impl::i_sequence(
+    bool returnData,
+    int cursor)
+{
+	if ((cursor != BE_RECSTORE_SEQ_START) &&
+	    (cursor != BE_RECSTORE_SEQ_NEXT))
+		throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
+
+	if ((cursor == BE_RECSTORE_SEQ_START) ||
+	    (this->getCursor() == BE_RECSTORE_SEQ_START)) {
+		this->_prefetchers.clear();
+		this->_sequenceShard = 0;
+		this->_shardCursor = BE_RECSTORE_SEQ_START;
+
+		/*
+		 * Read every shard ahead at once, within the memory a
+		 * single RecordStorePrefetcher would use.
+		 */
+		if (returnData) {
+			const uint64_t shardCount = this->_shards.size();
+			const uint64_t depth = std::max<uint64_t>(1,
+			    RecordStorePrefetcher::DEFAULT_DEPTH / shardCount);
+			const uint64_t bytes = std::max<uint64_t>(1,
+			    RecordStorePrefetcher::DEFAULT_BYTES / shardCount);
+			for (const auto &shard : this->_shards) {
+				std::shared_ptr<RecordStore> reader{};
+				{
+					std::lock_guard<std::mutex> lock(
+					    *shard.mutex);
+					reader = shard.recordStore->openReader();
+				}
+				this->_prefetchers.push_back(std::make_unique<
+				    RecordStorePrefetcher>(reader, depth,
+				    bytes));
+			}
+		}
+	}
+	this->setCursor(BE_RECSTORE_SEQ_NEXT);
+
+	RecordStore::Record record{};
+	while (this->_sequenceShard < this->_shards.size()) {
+		if (!this->_prefetchers.empty()) {
+			auto &prefetcher =
+			    this->_prefetchers[this->_sequenceShard];
+			if (prefetcher->next(record)) {
+				if (!returnData)
+					record.data.resize(0);
+				return (record);
+			}
+			prefetcher.reset();
+		} else {
+			const Shard &shard =
+			    this->_shards[this->_sequenceShard];
+			const int shardCursor = this->_shardCursor;
+			this->_shardCursor = BE_RECSTORE_SEQ_NEXT;
+			try {
+				std::lock_guard<std::mutex> lock(*shard.mutex);
+				if (returnData)
+					return (shard.recordStore->sequence(
+					    shardCursor));
+				record.key = shard.recordStore->sequenceKey(
+				    shardCursor);
+				return (record);
+			} catch (const Error::ObjectDoesNotExist&) {}
+		}
+
+		this->_sequenceShard++;
+		this->_shardCursor = BE_RECSTORE_SEQ_START;
+	}
+	this->_prefetchers.clear();
+	throw Error::ObjectDoesNotExist("No record at position");
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ShardedRecordStore::Impl::sequence(
+    int cursor)
+{
+	return (i_sequence(true, cursor));
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::Impl::sequenceKey(
+    int cursor)
+{
+	return (i_sequence(false, cursor).key);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::setCursorAtKey(
+    const std::string &key)
+{
+	const uint32_t index = this->getShardIndex(key);
+	{
+		const Shard &shard = this->_shards[index];
+		std::lock_guard<std::mutex> lock(*shard.mutex);
+		shard.recordStore->setCursorAtKey(key);
+	}
+
+	/* Continue from key itself, in the remainder of its shard */
+	this->_prefetchers.clear();
+	this->_sequenceShard = index;
+	this->_shardCursor = BE_RECSTORE_SEQ_NEXT;
+	this->setCursor(BE_RECSTORE_SEQ_NEXT);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::move(
+    const std::string &pathname)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	if (IO::Utility::fileExists(pathname))
+		throw Error::ObjectExists(pathname);
+
+	/* Shards within the store's directory are renamed with it */
+	this->sync();
+	this->_prefetchers.clear();
+	this->_shards.clear();
+	this->setCursor(BE_RECSTORE_SEQ_START);
+	try {
+		RecordStore::Impl::move(pathname);
+	} catch (const Error::Exception&) {
+		this->openShards(IO::Mode::ReadWrite);
+		throw;
+	}
+	this->openShards(IO::Mode::ReadWrite);
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardCount()
+    const
+{
+	return (static_cast<uint32_t>(this->_shards.size()));
+}
+
+std::vector<std::string>
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardPathnames()
+    const
+{
+	std::vector<std::string> shardPathnames{};
+	shardPathnames.reserve(this->_shards.size());
+	for (const auto &shard : this->_shards)
+		shardPathnames.push_back(this->resolveShardPathname(
+		    shard.pathname));
+	return (shardPathnames);
+}
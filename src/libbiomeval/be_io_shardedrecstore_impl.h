@@ -0,0 +1,353 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_SHARDEDRECSTORE_IMPL_H__
+#define __BE_IO_SHARDEDRECSTORE_IMPL_H__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <be_io_recordstoreprefetcher.h>
+#include <be_io_shardedrecstore.h>
+#include "be_io_recordstore_impl.h"
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * Implementation of ShardedRecordStore.
+		 */
+		class ShardedRecordStore::Impl : public RecordStore::Impl
+		{
+		public:
+			/**
+			 * Create a new ShardedRecordStore whose shards are
+			 * kept within its own directory, read/write mode.
+			 *
+			 * @param[in] pathname
+			 * 	The directory where the store is to be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardCount
+			 *	The number of shards.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	The store already exists.
+			 * @throw Error::ParameterError
+			 *	shardCount is 0, or shardKind cannot be
+			 *	used as a shard.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			Impl(
+			    const std::string &pathname,
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    uint32_t shardCount);
+
+			/**
+			 * Create a new ShardedRecordStore with shards at
+			 * the given locations, read/write mode.
+			 *
+			 * @param[in] pathname
+			 * 	The directory where the store is to be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardPathnames
+			 *	The directory where each shard is to be
+			 *	created.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	The store or one of the shards already exists.
+			 * @throw Error::ParameterError
+			 *	shardPathnames is empty, or shardKind cannot
+			 *	be used as a shard.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			Impl(
+			    const std::string &pathname,
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    const std::vector<std::string> &shardPathnames);
+
+			/**
+			 * Open an existing ShardedRecordStore.
+			 *
+			 * @param[in] pathname
+			 *	The path name of the store.
+			 * @param[in] mode
+			 *	Open mode, read-only or read-write.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	The store does not exist.
+			 * @throw Error::StrategyError
+			 *	A shard could not be opened, or an error
+			 *	occurred when accessing the underlying file
+			 *	system.
+			 */
+			Impl(
+			    const std::string &pathname,
+			    IO::Mode mode = IO::Mode::ReadOnly);
+
+			/*
+			 * Destructor.
+			 */
+			~Impl();
+
+			uint64_t
+			getSpaceUsed() const;
+
+			void
+			sync() const;
+
+			void
+			setCommitPolicy(
+			    const RecordStore::CommitPolicy &policy);
+
+			unsigned int
+			getCount() const;
+
+			void
+			insert(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size);
+
+			void
+			replace(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size);
+
+			void
+			remove(
+			    const std::string &key);
+
+			Memory::uint8Array
+			read(
+			    const std::string &key) const;
+
+			std::vector<Memory::uint8Array>
+			read(
+			    const std::vector<std::string> &keys) const;
+
+			Memory::uint8Array
+			readPrefix(
+			    const std::string &key,
+			    uint64_t size) const;
+
+			uint64_t
+			length(
+			    const std::string &key) const;
+
+			std::vector<uint64_t>
+			length(
+			    const std::vector<std::string> &keys) const;
+
+			void
+			flush(
+			    const std::string &key) const;
+
+			RecordStore::Record
+			sequence(
+			    int cursor = BE_RECSTORE_SEQ_NEXT);
+
+			std::string
+			sequenceKey(
+			    int cursor = BE_RECSTORE_SEQ_NEXT);
+
+			void
+			setCursorAtKey(
+			    const std::string &key);
+
+			void
+			move(
+			    const std::string &pathname);
+
+			uint32_t
+			getShardCount()
+			    const;
+
+			std::vector<std::string>
+			getShardPathnames()
+			    const;
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because this object could represent a
+			 * file on disk.
+			 *
+			 * @param rhs
+			 *	ShardedRecordStore object to copy.
+			 */
+			Impl(
+			    const ShardedRecordStore &rhs) = delete;
+
+			/**
+			 * @brief
+			 * Assignment operator (disabled).
+			 * @details
+			 * Disabled because this object could represent a
+			 * file on disk.
+			 *
+			 * @param rhs
+			 *	ShardedRecordStore object to assign.
+			 *
+			 * @return
+			 * 	ShardedRecordStore object, now containing
+			 *	the contents of rhs.
+			 */
+			Impl&
+			operator=(
+			    const ShardedRecordStore &rhs) = delete;
+
+		private:
+			/** A RecordStore holding some of the records */
+			struct Shard
+			{
+				/** Path name, relative to the store if
+				    kept within it */
+				std::string pathname;
+				/** The shard itself */
+				std::shared_ptr<RecordStore> recordStore;
+				/** Serializes access to recordStore */
+				std::shared_ptr<std::mutex> mutex;
+			};
+
+			/** Shards, in the order keys are hashed to */
+			std::vector<Shard> _shards{};
+
+			/** Kind of RecordStore of every shard */
+			RecordStore::Kind _shardKind{RecordStore::Kind::Default};
+
+			/** Shard currently being sequenced */
+			uint32_t _sequenceShard{0};
+
+			/** Cursor to pass to the shard being sequenced */
+			int _shardCursor{BE_RECSTORE_SEQ_START};
+
+			/**
+			 * Read-ahead of each shard, when sequencing with
+			 * data from the start, or empty.
+			 */
+			std::vector<std::unique_ptr<RecordStorePrefetcher>>
+			    _prefetchers{};
+
+			/**
+			 * @brief
+			 * Create the shards of a new store.
+			 *
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardPathnames
+			 *	Path name of each shard, relative to the
+			 *	store if kept within it.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	One of the shards already exists.
+			 * @throw Error::ParameterError
+			 *	shardPathnames is empty, or shardKind cannot
+			 *	be used as a shard.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			void
+			createShards(
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    const std::vector<std::string> &shardPathnames);
+
+			/**
+			 * @brief
+			 * Open the shards named in the control file.
+			 *
+			 * @param[in] mode
+			 *	Open mode, read-only or read-write.
+			 *
+			 * @throw Error::StrategyError
+			 *	Shard properties are missing or invalid, or
+			 *	a shard could not be opened.
+			 */
+			void
+			openShards(
+			    IO::Mode mode);
+
+			/**
+			 * @brief
+			 * Obtain the full path name of a shard.
+			 *
+			 * @param[in] shard
+			 *	Shard's path name, as stored.
+			 *
+			 * @return
+			 *	shard, or shard within the store's directory
+			 *	if shard is relative.
+			 */
+			std::string
+			resolveShardPathname(
+			    const std::string &shard)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the shard holding a key.
+			 *
+			 * @param[in] key
+			 *	Record key.
+			 *
+			 * @return
+			 *	Index of the shard key is hashed to.
+			 */
+			uint32_t
+			getShardIndex(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * Internal implementation of sequencing through a
+			 * store, returning the key, and optionally, the
+			 * data.
+			 * @param[in] returnData
+			 * 	Whether to return the data with the key.
+			 * @param[in] cursor
+			 *	The location within the sequence of the
+			 *	key/data pair to return.
+			 * @return
+			 *	The record that is next in sequence.
+			 * @throw Error::ObjectDoesNotExist
+			 *	End of sequencing.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			RecordStore::Record
+			i_sequence(
+			    bool returnData,
+			    int cursor);
+		};
+	}
+}
+#endif	/* __BE_IO_SHARDEDRECSTORE_IMPL_H__ */
@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <utility>
+
 #include "be_io_sqliterecstore_impl.h"
 
 namespace BE = BiometricEvaluation;
@@ -33,6 +35,12 @@ BiometricEvaluation::IO::SQLiteRecordStore::SQLiteRecordStore(
 	this->pimpl.reset(new IO::SQLiteRecordStore::Impl(pathname, mode));
 }
 
+BiometricEvaluation::IO::SQLiteRecordStore::SQLiteRecordStore(
+    std::unique_ptr<SQLiteRecordStore::Impl> &&impl) :
+    pimpl(std::move(impl))
+{
+}
+
 BiometricEvaluation::IO::SQLiteRecordStore::~SQLiteRecordStore()
 {
 }
@@ -50,6 +58,24 @@ BiometricEvaluation::IO::SQLiteRecordStore::getSpaceUsed()
 	return (this->pimpl->getSpaceUsed());
 }
 
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::SQLiteRecordStore::openReader()
+    const
+{
+	this->pimpl->sync();
+
+	std::unique_ptr<SQLiteRecordStore::Impl> reader{};
+	try {
+		reader.reset(new IO::SQLiteRecordStore::Impl(
+		    this->pimpl->getPathname(), Mode::ReadOnly, true));
+	} catch (const Error::ObjectDoesNotExist &e) {
+		throw Error::StrategyError(e.whatString());
+	}
+
+	return (std::shared_ptr<RecordStore>(
+	    new SQLiteRecordStore(std::move(reader))));
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::sync()
     const
@@ -57,6 +83,13 @@ BiometricEvaluation::IO::SQLiteRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::SQLiteRecordStore::setCommitPolicy(
+    const CommitPolicy &policy)
+{
+	this->pimpl->setCommitPolicy(policy);
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::insert( 
     const std::string &key,
@@ -66,6 +99,20 @@ BiometricEvaluation::IO::SQLiteRecordStore::insert(
 	this->pimpl->insert(key, data, size);
 }
 
+void
+BiometricEvaluation::IO::SQLiteRecordStore::insertBatch(
+    const std::vector<RecordStore::Record> &records)
+{
+	this->pimpl->insertBatch(records);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::setJournalProfile(
+    JournalProfile profile)
+{
+	this->pimpl->setJournalProfile(profile);
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::remove( 
     const std::string &key)
@@ -81,6 +128,23 @@ BiometricEvaluation::IO::SQLiteRecordStore::read(
 	return (this->pimpl->read(key));
 }
 
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::SQLiteRecordStore::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->read(keys));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::SQLiteRecordStore::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	return (this->pimpl->readPrefix(key, size));
+}
+
 uint64_t
 BiometricEvaluation::IO::SQLiteRecordStore::length(
     const std::string &key)
@@ -89,6 +153,14 @@ BiometricEvaluation::IO::SQLiteRecordStore::length(
 	return (this->pimpl->length(key));
 }
 
+std::vector<uint64_t>
+BiometricEvaluation::IO::SQLiteRecordStore::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	return (this->pimpl->length(keys));
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::flush(
     const std::string &key)
@@ -8,7 +8,9 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 #include "be_io_sqliterecstore_impl.h"
@@ -64,7 +66,11 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
     _db(nullptr),
     _dbname(""),
     _sequencer(nullptr),
-    _sequenceEnd(false)
+    _sequenceEnd(false),
+    _insertPrimary(nullptr),
+    _insertSubordinate(nullptr),
+    _locatePrimary(nullptr),
+    _readPrimaryRange(nullptr)
 {
 #ifdef	SQLITE_V2_SUPPORT
 	sqlite3_initialize();
@@ -91,12 +97,17 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
     const std::string &pathname,
-    IO::Mode mode) :
+    IO::Mode mode,
+    bool sharedCache) :
     RecordStore::Impl(pathname, mode),
     _db(nullptr),
     _dbname(""),
     _sequencer(nullptr),
-    _sequenceEnd(false)
+    _sequenceEnd(false),
+    _insertPrimary(nullptr),
+    _insertSubordinate(nullptr),
+    _locatePrimary(nullptr),
+    _readPrimaryRange(nullptr)
 {
 #ifdef	SQLITE_V2_SUPPORT
 	sqlite3_initialize();
@@ -112,6 +123,10 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 		/* TODO: SQLITE_OPEN_PRIVATECACHE */
 		rv = sqlite3_open_v2(_dbname.c_str(), &_db, 
 		    SQLITE_OPEN_READWRITE | SQLITE_OPEN_FULLMUTEX, nullptr);
+	else if (sharedCache)
+		rv = sqlite3_open_v2(_dbname.c_str(), &_db,
+		    SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX |
+		    SQLITE_OPEN_SHAREDCACHE, nullptr);
 	else
 		/* TODO: SQLITE_OPEN_PRIVATECACHE */
 		rv = sqlite3_open_v2(_dbname.c_str(), &_db, 
@@ -126,11 +141,15 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 		throw Error::StrategyError("sqlite3: Invalid schema");
 		
 	_cursorRow = 0;
+
+	if (this->isCountStale())
+		this->recoverCount(this->countRecords());
 }
 
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::~Impl()
 {
 	this->cleanup();
+	this->commitOnClose();
 		
 	/* NOT THREAD SAFE! */
 //	sqlite3_shutdown();
@@ -200,38 +219,69 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	
-	/* Warn if key is already in database */
-	try {
-		this->length(key);
-		throw Error::ObjectExists(key);
-	} catch (const Error::ObjectDoesNotExist&) {}
+	this->beginChange();
+	this->insertSegments(key, data, size);
 	
+	/* Propagate to parent class */
+	RecordStore::Impl::insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::insertBatch(
+    const std::vector<RecordStore::Record> &records)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+	for (const auto &record : records)
+		if (!validateKeyString(record.key))
+			throw Error::StrategyError("Invalid key format");
+
+	this->beginChange();
+	this->execute("BEGIN IMMEDIATE TRANSACTION");
+	try {
+		for (const auto &record : records)
+			this->insertSegments(record.key, record.data,
+			    record.data.size());
+		this->execute("COMMIT TRANSACTION");
+	} catch (const Error::Exception &) {
+		try {
+			this->execute("ROLLBACK TRANSACTION");
+		} catch (const Error::Exception &) {
+			/* Report the original failure */
+		}
+		throw;
+	}
+
+	/* Count records only once they are committed */
+	for (const auto &record : records)
+		RecordStore::Impl::insert(record.key, record.data,
+		    record.data.size());
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::insertSegments(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	/*
+	 * A duplicate key violates the primary table's UNIQUE constraint,
+	 * so no separate existence query is needed.
+	 */
 	sqlite3_stmt *statement = nullptr;
-	std::string activeTable = PRIMARY_KV_TABLE;
 	uint64_t segnum = 0;
 	uint64_t remSize = size, bindSize = 0;
-	uint8_t *bindData = (uint8_t *)data;
+	const uint8_t *bindData = static_cast<const uint8_t *>(data);
 	while ((remSize > 0) ||
 	    ((remSize == 0) && (segnum < KEY_SEGMENT_START))) {
-		std::string sqlCommand = "INSERT INTO " + activeTable + " " + 
-		    "VALUES ('" + genKeySegName(key, segnum) +
-		    "', $value)";
-	
-		/* Prepare the statement */
-#ifdef	SQLITE_V2_SUPPORT
-		int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#else
-		int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#endif
-		if (rv != SQLITE_OK) {
-			sqlite3_finalize(statement);
-			sqliteError(rv);
-		}
-		if (statement == nullptr)
-			throw Error::StrategyError("SQLite: Could not allocate "
-			    "statement");
+		if (segnum == 0)
+			statement = this->cachedStatement(_insertPrimary,
+			    "INSERT INTO " + PRIMARY_KV_TABLE + " VALUES "
+			    "($key, $value)");
+		else
+			statement = this->cachedStatement(_insertSubordinate,
+			    "INSERT INTO " + SUBORDINATE_KV_TABLE + " VALUES "
+			    "($key, $value)");
 	
 		/* Bind data to the statement, segmenting if necessary */
 		if (remSize < MAX_REC_SIZE) {
@@ -241,24 +291,26 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 			bindSize = MAX_REC_SIZE;
 			remSize -= MAX_REC_SIZE;
 		}
-		rv = sqlite3_bind_blob(statement,
-		    sqlite3_bind_parameter_index(statement, "$value"),
-		    bindData, bindSize, SQLITE_STATIC);
+		const std::string segKey = genKeySegName(key, segnum);
+		int32_t rv = sqlite3_bind_text(statement,
+		    sqlite3_bind_parameter_index(statement, "$key"),
+		    segKey.c_str(), segKey.length(), SQLITE_STATIC);
+		if (rv == SQLITE_OK)
+			rv = sqlite3_bind_blob(statement,
+			    sqlite3_bind_parameter_index(statement, "$value"),
+			    bindData, bindSize, SQLITE_STATIC);
 		if (rv != SQLITE_OK) {
-			sqlite3_finalize(statement);
+			sqlite3_reset(statement);
 			sqliteError(rv);
 		}
 			
-		/* Execute the statement */
+		/* Execute the statement, leaving it ready for reuse */
 		rv = sqlite3_step(statement);
-		if (rv != SQLITE_DONE) {
-			sqlite3_finalize(statement);
-			sqliteError(rv);
-		}
-			
-		/* Free the statement */
-		rv = sqlite3_finalize(statement);
-		if (rv != SQLITE_OK)
+		sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
+		if ((rv == SQLITE_CONSTRAINT) && (segnum == 0))
+			throw Error::ObjectExists(key);
+		if (rv != SQLITE_DONE)
 			sqliteError(rv);
 			
 		/* Increment data position and segment */
@@ -266,16 +318,94 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 		switch (segnum) {
 		case 0:
 			segnum = KEY_SEGMENT_START;
-			activeTable = SUBORDINATE_KV_TABLE;
 			break;
 		default:
 			segnum++;
 			break;
 		}
 	}
-	
-	/* Propagate to parent class */
-	RecordStore::Impl::insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::setJournalProfile(
+    JournalProfile profile)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+
+	switch (profile) {
+	case JournalProfile::Default:
+		this->execute("PRAGMA journal_mode = DELETE");
+		this->execute("PRAGMA synchronous = FULL");
+		break;
+	case JournalProfile::WriteAheadLog:
+		this->execute("PRAGMA journal_mode = WAL");
+		this->execute("PRAGMA synchronous = NORMAL");
+		break;
+	}
+}
+
+sqlite3_stmt *
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::cachedStatement(
+    sqlite3_stmt *&statement,
+    const std::string &sqlCommand)
+    const
+{
+	if (statement != nullptr)
+		return (statement);
+
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#else
+	int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#endif
+	if (rv != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		statement = nullptr;
+		sqliteError(rv);
+	}
+	if (statement == nullptr)
+		throw Error::StrategyError("SQLite: Could not allocate "
+		    "statement");
+
+	return (statement);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::execute(
+    const std::string &sqlCommand)
+{
+	sqlite3_stmt *statement = nullptr;
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#else
+	int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#endif
+	if (rv != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		sqliteError(rv);
+	}
+	if (statement == nullptr)
+		throw Error::StrategyError("SQLite: Could not allocate "
+		    "statement");
+
+	/* Execute the statement (PRAGMAs may return a row) */
+	do {
+		rv = sqlite3_step(statement);
+	} while (rv == SQLITE_ROW);
+	if (rv != SQLITE_DONE) {
+		sqlite3_finalize(statement);
+		sqliteError(rv);
+	}
+
+	/* Free the statement */
+	rv = sqlite3_finalize(statement);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
 }
 
 void
@@ -287,6 +417,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::remove(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	this->beginChange();
 	sqlite3_stmt *statement;
 	std::string activeTable = PRIMARY_KV_TABLE;
 	int64_t segnum = 0;
@@ -362,6 +493,117 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::read(
 	return(data);
 }
 
+std::vector<BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::read(
+    const std::vector<std::string> &keys)
+    const
+{
+	const auto locations = this->locatePrimarySegments(keys);
+	std::vector<Memory::uint8Array> records(keys.size());
+
+	/*
+	 * Read records held in a single row in rowid order, so that
+	 * table pages are visited in the order they are stored. Records
+	 * split across the subordinate table are read individually.
+	 */
+	std::vector<size_t> order{};
+	order.reserve(keys.size());
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (locations[i].second == MAX_REC_SIZE)
+			records[i] = this->read(keys[i]);
+		else
+			order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(),
+	    [&](const size_t lhs, const size_t rhs) {
+		return (locations[lhs].first < locations[rhs].first);
+	});
+
+	sqlite3_stmt *statement = this->cachedStatement(_readPrimaryRange,
+	    "SELECT rowid, " + VALUE_COL + " FROM " + PRIMARY_KV_TABLE +
+	    " WHERE rowid BETWEEN $first AND $last ORDER BY rowid");
+	size_t first = 0;
+	while (first < order.size()) {
+		/* Runs of consecutive rows are read with one query */
+		size_t last = first + 1;
+		while ((last < order.size()) &&
+		    (locations[order[last]].first <=
+		    (locations[order[last - 1]].first + 1)))
+			last++;
+
+		int32_t rv = sqlite3_bind_int64(statement,
+		    sqlite3_bind_parameter_index(statement, "$first"),
+		    locations[order[first]].first);
+		if (rv == SQLITE_OK)
+			rv = sqlite3_bind_int64(statement,
+			    sqlite3_bind_parameter_index(statement, "$last"),
+			    locations[order[last - 1]].first);
+		if (rv != SQLITE_OK) {
+			sqlite3_reset(statement);
+			sqliteError(rv);
+		}
+
+		size_t next = first;
+		while ((rv = sqlite3_step(statement)) == SQLITE_ROW) {
+			const int64_t rowid = sqlite3_column_int64(
+			    statement, 0);
+			const uint64_t size = sqlite3_column_bytes(
+			    statement, 1);
+			const void *value = sqlite3_column_blob(statement, 1);
+			for (; (next < last) &&
+			    (locations[order[next]].first == rowid); next++) {
+				records[order[next]].resize(size);
+				if (size != 0)
+					std::memcpy(records[order[next]],
+					    value, size);
+			}
+		}
+		sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
+		if (rv != SQLITE_DONE)
+			sqliteError(rv);
+
+		/* Records removed since they were located */
+		if (next != last)
+			throw Error::ObjectDoesNotExist(keys[order[next]]);
+
+		first = last;
+	}
+
+	return (records);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::readPrefix(
+    const std::string &key,
+    uint64_t size)
+    const
+{
+	const auto location = this->locatePrimarySegments({key}).front();
+
+	/* Only the primary segment is read incrementally */
+	if ((location.second == MAX_REC_SIZE) && (size > MAX_REC_SIZE)) {
+		Memory::uint8Array data = this->read(key);
+		if (data.size() > size)
+			data.resize(size);
+		return (data);
+	}
+
+	Memory::uint8Array data(std::min(size, location.second));
+	if (data.size() == 0)
+		return (data);
+	sqlite3_blob *blob{nullptr};
+	int32_t rv = sqlite3_blob_open(_db, "main", PRIMARY_KV_TABLE.c_str(),
+	    VALUE_COL.c_str(), location.first, 0, &blob);
+	if (rv == SQLITE_OK)
+		rv = sqlite3_blob_read(blob, data, static_cast<int>(
+		    data.size()), 0);
+	sqlite3_blob_close(blob);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
+	return (data);
+}
+
 uint64_t
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::length(
     const std::string &key)
@@ -369,6 +611,63 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::length(
 {
 	return (this->readSegments(key, nullptr));
 }
+
+std::vector<uint64_t>
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::length(
+    const std::vector<std::string> &keys)
+    const
+{
+	const auto locations = this->locatePrimarySegments(keys);
+
+	std::vector<uint64_t> lengths{};
+	lengths.reserve(keys.size());
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (locations[i].second == MAX_REC_SIZE)
+			lengths.push_back(this->length(keys[i]));
+		else
+			lengths.push_back(locations[i].second);
+	}
+	return (lengths);
+}
+
+std::vector<std::pair<int64_t, uint64_t>>
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::locatePrimarySegments(
+    const std::vector<std::string> &keys)
+    const
+{
+	sqlite3_stmt *statement = this->cachedStatement(_locatePrimary,
+	    "SELECT rowid, length(" + VALUE_COL + ") FROM " +
+	    PRIMARY_KV_TABLE + " WHERE " + KEY_COL + " = $key");
+
+	std::vector<std::pair<int64_t, uint64_t>> locations{};
+	locations.reserve(keys.size());
+	for (const auto &key : keys) {
+		if (!validateKeyString(key))
+			throw Error::StrategyError("Invalid key format");
+
+		int32_t rv = sqlite3_bind_text(statement,
+		    sqlite3_bind_parameter_index(statement, "$key"),
+		    key.c_str(), key.length(), SQLITE_STATIC);
+		if (rv != SQLITE_OK) {
+			sqlite3_reset(statement);
+			sqliteError(rv);
+		}
+
+		rv = sqlite3_step(statement);
+		if (rv == SQLITE_ROW)
+			locations.emplace_back(
+			    sqlite3_column_int64(statement, 0),
+			    sqlite3_column_int64(statement, 1));
+		sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
+		if (rv == SQLITE_DONE)
+			throw Error::ObjectDoesNotExist(key);
+		if (rv != SQLITE_ROW)
+			sqliteError(rv);
+	}
+
+	return (locations);
+}
     
 uint64_t
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
@@ -655,6 +954,28 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::cleanup()
 		    "sequencer");
 	_sequenceEnd = false;
 	_sequencer = nullptr;
+
+	/* Finalize cached statements */
+	rv = sqlite3_finalize(_insertPrimary);
+	_insertPrimary = nullptr;
+	if (rv != SQLITE_OK)
+		throw Error::StrategyError("SQLite: Could not finalize "
+		    "insert statement");
+	rv = sqlite3_finalize(_insertSubordinate);
+	_insertSubordinate = nullptr;
+	if (rv != SQLITE_OK)
+		throw Error::StrategyError("SQLite: Could not finalize "
+		    "insert statement");
+	rv = sqlite3_finalize(_locatePrimary);
+	_locatePrimary = nullptr;
+	if (rv != SQLITE_OK)
+		throw Error::StrategyError("SQLite: Could not finalize "
+		    "select statement");
+	rv = sqlite3_finalize(_readPrimaryRange);
+	_readPrimaryRange = nullptr;
+	if (rv != SQLITE_OK)
+		throw Error::StrategyError("SQLite: Could not finalize "
+		    "select statement");
 	
 	/* Close DB */
 	rv = sqlite3_close(_db);
@@ -761,6 +1082,39 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::validateKeyValueTable(
 	return (valid);
 }
 
+uint64_t
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::countRecords()
+    const
+{
+	sqlite3_stmt *statement = nullptr;
+	const std::string sqlCommand = "SELECT COUNT(*) FROM " +
+	    PRIMARY_KV_TABLE;
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#else
+	int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#endif
+	if ((rv != SQLITE_OK) || (statement == nullptr)) {
+		sqlite3_finalize(statement);
+		sqliteError(rv);
+	}
+
+	rv = sqlite3_step(statement);
+	if (rv != SQLITE_ROW) {
+		sqlite3_finalize(statement);
+		sqliteError(rv);
+	}
+	const uint64_t count = sqlite3_column_int64(statement, 0);
+
+	rv = sqlite3_finalize(statement);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
+
+	return (count);
+}
+
 std::string
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::getDBFilename() const
 {
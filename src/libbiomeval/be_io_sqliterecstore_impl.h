@@ -11,6 +11,9 @@
 #ifndef __BE_IO_SQLITERECORDSTORE_IMPL_H__
 #define __BE_IO_SQLITERECORDSTORE_IMPL_H__
 
+#include <utility>
+#include <vector>
+
 #include <sqlite3.h>
 
 #include "be_io_recordstore_impl.h"
@@ -32,9 +35,20 @@ namespace BiometricEvaluation
 			    const std::string &pathname,
 			    const std::string &description);
 
+			/**
+			 * @param[in] pathname
+			 *	The path name of the store.
+			 * @param[in] mode
+			 *	Open mode, read-only or read-write.
+			 * @param[in] sharedCache
+			 *	Whether to share a page cache with other
+			 *	connections to the database that also share
+			 *	one. Only used for read-only handles.
+			 */
 			Impl(
 			    const std::string &pathname,
-			    IO::Mode mode = Mode::ReadOnly);
+			    IO::Mode mode = Mode::ReadOnly,
+			    bool sharedCache = false);
 
 			void
 			move(const std::string &pathname);
@@ -48,14 +62,33 @@ namespace BiometricEvaluation
 			    const void *const data,
 			    const uint64_t size);
 
+			void
+			insertBatch(
+			    const std::vector<RecordStore::Record> &records);
+
+			void
+			setJournalProfile(
+			    JournalProfile profile);
+
 			void 
 			remove(const std::string &key);
 	
 			Memory::uint8Array
 			read(const std::string &key) const;
 
+			std::vector<Memory::uint8Array>
+			read(const std::vector<std::string> &keys) const;
+
+			Memory::uint8Array
+			readPrefix(
+			    const std::string &key,
+			    uint64_t size) const;
+
 			uint64_t
 			length(const std::string &key) const;
+
+			std::vector<uint64_t>
+			length(const std::vector<std::string> &keys) const;
 			    
 			void
 			flush(const std::string &key) const;
@@ -148,6 +181,20 @@ namespace BiometricEvaluation
 			bool
 			validateSchema();
 
+			/**
+			 * @brief
+			 * Count the records in the database.
+			 *
+			 * @return
+			 *	Number of rows in the primary table.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error executing SQL.
+			 */
+			uint64_t
+			countRecords()
+			    const;
+
 			/**
 			 * @brief
 			 * Select a row from the RecordStore.
@@ -171,11 +218,92 @@ namespace BiometricEvaluation
 			    const std::string &key,
 			    void * const data) const;
 
+			/**
+			 * @brief
+			 * Find the primary row of several records.
+			 *
+			 * @param keys
+			 *	Keys of the records.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	A key does not exist in RecordStore.
+			 * @throw Error::StrategyError
+			 *	Invalid key format, or error executing SQL
+			 *	commands.
+			 *
+			 * @return
+			 *	rowid and length of the primary segment of each
+			 *	record, in the same order as keys.
+			 */
+			std::vector<std::pair<int64_t, uint64_t>>
+			locatePrimarySegments(
+			    const std::vector<std::string> &keys) const;
+
+			/**
+			 * @brief
+			 * Insert the rows for a record, without updating
+			 * the record count.
+			 *
+			 * @param key
+			 *	Key of the record.
+			 * @param data
+			 *	The record's data.
+			 * @param size
+			 *	The size of data.
+			 *
+			 * @throw Error::ObjectExists
+			 *	Key already exists in RecordStore.
+			 * @throw Error::StrategyError
+			 *	Error executing SQL commands.
+			 */
+			void
+			insertSegments(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Obtain a cached statement, preparing it on first use.
+			 *
+			 * @param statement
+			 *	Cache for the statement.
+			 * @param sqlCommand
+			 *	SQL to prepare.
+			 *
+			 * @return
+			 *	The prepared statement, reset and ready for
+			 *	binding.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error compiling SQL.
+			 */
+			sqlite3_stmt *
+			cachedStatement(
+			    sqlite3_stmt *&statement,
+			    const std::string &sqlCommand) const;
+
+			/**
+			 * @brief
+			 * Execute SQL that takes no parameters, ignoring any
+			 * rows returned.
+			 *
+			 * @param sqlCommand
+			 *	SQL to execute.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error executing SQL commands.
+			 */
+			void
+			execute(
+			    const std::string &sqlCommand);
+
 			/**
 			 * @brief
 			 * Perform SQLite cleanup routines.
 			 * @details
 			 * - Finalize the sequencer statement
+			 * - Finalize the cached statements
 			 * - Close the SQLite database handle
 			 *
 			 * @throw Error::StrategyError
@@ -195,6 +323,14 @@ namespace BiometricEvaluation
 			bool _sequenceEnd;
 			/** Row for key in setCursorForKey() */
 			uint64_t _cursorRow;
+			/** Cached INSERT into the primary table */
+			sqlite3_stmt *_insertPrimary;
+			/** Cached INSERT into the subordinate table */
+			sqlite3_stmt *_insertSubordinate;
+			/** Cached rowid and length lookup by key */
+			mutable sqlite3_stmt *_locatePrimary;
+			/** Cached SELECT of a range of primary rows */
+			mutable sqlite3_stmt *_readPrimaryRange;
 			
 			/** Name given to the primate SQLite table */
 			static const std::string PRIMARY_KV_TABLE;
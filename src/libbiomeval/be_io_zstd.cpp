@@ -0,0 +1,382 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstring>
+#include <mutex>
+
+#include <zstd.h>
+#include <zdict.h>
+
+#include <be_io_zstd.h>
+#include <be_io_utility.h>
+
+const std::string
+    BiometricEvaluation::IO::Zstd::COMPRESSION_LEVEL = "CompressionLevel";
+
+/*
+ * Contexts are expensive to create relative to compressing a small record,
+ * so they are made once and reused under a lock, since the Compressor
+ * interface is const.
+ */
+class BiometricEvaluation::IO::Zstd::Impl
+{
+public:
+	Impl() :
+	    cctx{ZSTD_createCCtx()},
+	    dctx{ZSTD_createDCtx()}
+	{
+		if ((cctx == nullptr) || (dctx == nullptr)) {
+			ZSTD_freeCCtx(cctx);
+			ZSTD_freeDCtx(dctx);
+			throw Error::MemoryError("Could not allocate Zstandard "
+			    "contexts");
+		}
+	}
+
+	~Impl()
+	{
+		ZSTD_freeCDict(cdict);
+		ZSTD_freeDDict(ddict);
+		ZSTD_freeCCtx(cctx);
+		ZSTD_freeDCtx(dctx);
+	}
+
+	std::mutex mutex{};
+	ZSTD_CCtx *cctx{nullptr};
+	ZSTD_DCtx *dctx{nullptr};
+
+	/** Raw dictionary, as passed to setDictionary() */
+	Memory::uint8Array dictionary{};
+	/** Digested dictionary for compression, built lazily */
+	ZSTD_CDict *cdict{nullptr};
+	/** Compression level cdict was built with */
+	int cdictLevel{0};
+	/** Digested dictionary for decompression */
+	ZSTD_DDict *ddict{nullptr};
+};
+
+BiometricEvaluation::IO::Zstd::Zstd() :
+    BiometricEvaluation::IO::Compressor(),
+    pimpl{new BiometricEvaluation::IO::Zstd::Impl()}
+{
+	this->setOption(COMPRESSION_LEVEL, ZSTD_CLEVEL_DEFAULT);
+}
+
+BiometricEvaluation::IO::Zstd::~Zstd() = default;
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	const int level = static_cast<int>(this->getOptionAsInteger(
+	    COMPRESSION_LEVEL));
+	Memory::uint8Array compressedData(ZSTD_compressBound(
+	    uncompressedDataSize));
+
+	std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+	size_t rv;
+	if (this->pimpl->dictionary.size() == 0) {
+		rv = ZSTD_compressCCtx(this->pimpl->cctx, compressedData,
+		    compressedData.size(), uncompressedData,
+		    uncompressedDataSize, level);
+	} else {
+		if ((this->pimpl->cdict == nullptr) ||
+		    (this->pimpl->cdictLevel != level)) {
+			ZSTD_freeCDict(this->pimpl->cdict);
+			this->pimpl->cdict = ZSTD_createCDict(
+			    this->pimpl->dictionary,
+			    this->pimpl->dictionary.size(), level);
+			if (this->pimpl->cdict == nullptr)
+				throw Error::StrategyError("Could not load "
+				    "dictionary for compression");
+			this->pimpl->cdictLevel = level;
+		}
+		rv = ZSTD_compress_usingCDict(this->pimpl->cctx,
+		    compressedData, compressedData.size(), uncompressedData,
+		    uncompressedDataSize, this->pimpl->cdict);
+	}
+	if (ZSTD_isError(rv))
+		throw Error::StrategyError(ZSTD_getErrorName(rv));
+
+	compressedData.resize(rv);
+	return (compressedData);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::compress(
+    const Memory::uint8Array &uncompressedData)
+    const
+{
+	return (this->compress(uncompressedData, uncompressedData.size()));
+}
+
+void
+BiometricEvaluation::IO::Zstd::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->compress(uncompressedData,
+	    uncompressedDataSize), outputFile);
+}
+
+void
+BiometricEvaluation::IO::Zstd::compress(
+    const Memory::uint8Array &uncompressedData,
+    const std::string &outputFile)
+    const
+{
+	this->compress(uncompressedData, uncompressedData.size(), outputFile);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::compress(
+    const std::string &inputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+
+	return (this->compress(IO::Utility::readFile(inputFile)));
+}
+
+void
+BiometricEvaluation::IO::Zstd::compress(
+    const std::string &inputFile,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->compress(IO::Utility::readFile(
+	    inputFile)), outputFile);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize)
+    const
+{
+	const unsigned long long contentSize = ZSTD_getFrameContentSize(
+	    compressedData, compressedDataSize);
+	if (contentSize == ZSTD_CONTENTSIZE_ERROR)
+		throw Error::StrategyError("Not Zstandard compressed data");
+
+	std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+
+	/* Frames written by compress() always record their size */
+	if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN) {
+		Memory::uint8Array uncompressedData(contentSize);
+		size_t rv;
+		if (this->pimpl->ddict == nullptr)
+			rv = ZSTD_decompressDCtx(this->pimpl->dctx,
+			    uncompressedData, uncompressedData.size(),
+			    compressedData, compressedDataSize);
+		else
+			rv = ZSTD_decompress_usingDDict(this->pimpl->dctx,
+			    uncompressedData, uncompressedData.size(),
+			    compressedData, compressedDataSize,
+			    this->pimpl->ddict);
+		if (ZSTD_isError(rv))
+			throw Error::StrategyError(ZSTD_getErrorName(rv));
+		uncompressedData.resize(rv);
+		return (uncompressedData);
+	}
+
+	/* Streamed frames (e.g., from the zstd utility) */
+	ZSTD_DCtx_reset(this->pimpl->dctx, ZSTD_reset_session_only);
+	if (this->pimpl->ddict != nullptr)
+		ZSTD_DCtx_refDDict(this->pimpl->dctx, this->pimpl->ddict);
+	const size_t chunk = ZSTD_DStreamOutSize();
+	Memory::uint8Array uncompressedData(chunk);
+	uint64_t totalDecompressedBytes = 0;
+	ZSTD_inBuffer in{compressedData, compressedDataSize, 0};
+	while (true) {
+		if ((uncompressedData.size() - totalDecompressedBytes) < chunk)
+			uncompressedData.resize(uncompressedData.size() * 2);
+		ZSTD_outBuffer out{uncompressedData + totalDecompressedBytes,
+		    uncompressedData.size() - totalDecompressedBytes, 0};
+		const size_t rv = ZSTD_decompressStream(this->pimpl->dctx,
+		    &out, &in);
+		totalDecompressedBytes += out.pos;
+		if (rv == 0)
+			break;
+
+		/* Input exhausted with room to spare means a partial frame */
+		if (ZSTD_isError(rv) || ((in.pos == in.size) &&
+		    (out.pos < out.size))) {
+			ZSTD_DCtx_reset(this->pimpl->dctx,
+			    ZSTD_reset_session_and_parameters);
+			if (ZSTD_isError(rv))
+				throw Error::StrategyError(
+				    ZSTD_getErrorName(rv));
+			throw Error::StrategyError("Compressed data is "
+			    "truncated");
+		}
+	}
+	ZSTD_DCtx_reset(this->pimpl->dctx, ZSTD_reset_session_and_parameters);
+
+	uncompressedData.resize(totalDecompressedBytes);
+	return (uncompressedData);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::decompress(
+    const Memory::uint8Array &compressedData)
+    const
+{
+	return (this->decompress(compressedData, compressedData.size()));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::decompress(
+    const std::string &input)
+    const
+{
+	if (IO::Utility::fileExists(input) == false)
+		throw Error::ObjectDoesNotExist(input);
+
+	return (this->decompress(IO::Utility::readFile(input)));
+}
+
+void
+BiometricEvaluation::IO::Zstd::decompress(
+    const std::string &inputFile,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->decompress(IO::Utility::readFile(
+	    inputFile)), outputFile);
+}
+
+void
+BiometricEvaluation::IO::Zstd::decompress(
+    const uint8_t *const compressedData,
+    const uint64_t compressedDataSize,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	IO::Utility::writeFile(this->decompress(compressedData,
+	    compressedDataSize), outputFile);
+}
+
+void
+BiometricEvaluation::IO::Zstd::decompress(
+    const Memory::uint8Array &compressedData,
+    const std::string &outputFile)
+    const
+{
+	this->decompress(compressedData, compressedData.size(), outputFile);
+}
+
+void
+BiometricEvaluation::IO::Zstd::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+	size_t rv;
+	if (this->pimpl->ddict == nullptr)
+		rv = ZSTD_decompressDCtx(this->pimpl->dctx, uncompressedData,
+		    uncompressedDataSize, compressedData, compressedDataSize);
+	else
+		rv = ZSTD_decompress_usingDDict(this->pimpl->dctx,
+		    uncompressedData, uncompressedDataSize, compressedData,
+		    compressedDataSize, this->pimpl->ddict);
+	if (ZSTD_isError(rv))
+		throw Error::StrategyError(ZSTD_getErrorName(rv));
+	if (rv != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed size does not match");
+}
+
+void
+BiometricEvaluation::IO::Zstd::setDictionary(
+    const Memory::uint8Array &dictionary)
+{
+	ZSTD_DDict *ddict = nullptr;
+	if (dictionary.size() != 0) {
+		ddict = ZSTD_createDDict(dictionary, dictionary.size());
+		if (ddict == nullptr)
+			throw Error::StrategyError("Could not load dictionary "
+			    "for decompression");
+	}
+
+	std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+	ZSTD_freeDDict(this->pimpl->ddict);
+	this->pimpl->ddict = ddict;
+	ZSTD_freeCDict(this->pimpl->cdict);
+	this->pimpl->cdict = nullptr;
+	this->pimpl->dictionary = dictionary;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::getDictionary()
+    const
+{
+	std::lock_guard<std::mutex> lock(this->pimpl->mutex);
+	return (this->pimpl->dictionary);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::trainDictionary(
+    const std::vector<Memory::uint8Array> &samples,
+    uint64_t maxSize)
+    const
+{
+	if (samples.empty())
+		throw Error::StrategyError("No samples to train dictionary");
+
+	/* ZDICT wants the samples concatenated */
+	uint64_t totalSize = 0;
+	for (const auto &sample : samples)
+		totalSize += sample.size();
+	Memory::uint8Array sampleBuffer(totalSize);
+	std::vector<size_t> sampleSizes;
+	sampleSizes.reserve(samples.size());
+	uint64_t offset = 0;
+	for (const auto &sample : samples) {
+		if (sample.size() != 0)
+			std::memcpy(sampleBuffer + offset, sample,
+			    sample.size());
+		offset += sample.size();
+		sampleSizes.push_back(sample.size());
+	}
+
+	Memory::uint8Array dictionary(maxSize);
+	const size_t rv = ZDICT_trainFromBuffer(dictionary, dictionary.size(),
+	    sampleBuffer, sampleSizes.data(),
+	    static_cast<unsigned>(sampleSizes.size()));
+	if (ZDICT_isError(rv))
+		throw Error::StrategyError(ZDICT_getErrorName(rv));
+
+	dictionary.resize(rv);
+	return (dictionary);
+}
@@ -0,0 +1,143 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <be_error_exception.h>
+#include <be_memory_bloomfilter.h>
+
+#include "be_utility_impl.h"
+
+/** Final mixing of a 64-bit hash (splitmix64) */
+static uint64_t
+mix(
+    uint64_t h)
+{
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111eb;
+	h ^= h >> 31;
+	return (h);
+}
+
+BiometricEvaluation::Memory::BloomFilter::BloomFilter(
+    uint64_t capacity,
+    double falsePositiveRate) :
+    _capacity(capacity),
+    _size(0)
+{
+	if (capacity == 0)
+		throw Error::ParameterError("Capacity must be nonzero");
+	if (!(falsePositiveRate > 0) || !(falsePositiveRate < 1))
+		throw Error::ParameterError("False positive rate must be "
+		    "between 0 and 1");
+
+	/* Optimal size is -n ln(p) / ln(2)^2 bits, with m/n ln(2) hashes */
+	const double ln2 = std::log(2.0);
+	const double bitCount = std::ceil(-static_cast<double>(capacity) *
+	    std::log(falsePositiveRate) / (ln2 * ln2));
+	_bits.resize(static_cast<uint64_t>((bitCount + 63) / 64), 0);
+	_hashCount = static_cast<uint32_t>(std::max(1.0, std::round(
+	    (bitCount / capacity) * ln2)));
+}
+
+BiometricEvaluation::Memory::BloomFilter::BloomFilter(
+    uint64_t capacity,
+    uint64_t size,
+    uint32_t hashCount,
+    std::vector<uint64_t> bits) :
+    _capacity(capacity),
+    _size(size),
+    _hashCount(hashCount),
+    _bits(std::move(bits))
+{
+	if (_hashCount == 0)
+		throw Error::ParameterError("Hash count must be nonzero");
+	if (_bits.empty())
+		throw Error::ParameterError("Bits must not be empty");
+}
+
+void
+BiometricEvaluation::Memory::BloomFilter::insert(
+    std::string_view key)
+{
+	uint64_t h1, h2;
+	hash(key, h1, h2);
+
+	const uint64_t bitCount = _bits.size() * 64;
+	for (uint32_t i = 0; i < _hashCount; i++) {
+		const uint64_t bit = (h1 + (i * h2)) % bitCount;
+		_bits[bit / 64] |= (uint64_t{1} << (bit % 64));
+	}
+	_size++;
+}
+
+bool
+BiometricEvaluation::Memory::BloomFilter::mayContain(
+    std::string_view key)
+    const
+{
+	uint64_t h1, h2;
+	hash(key, h1, h2);
+
+	const uint64_t bitCount = _bits.size() * 64;
+	for (uint32_t i = 0; i < _hashCount; i++) {
+		const uint64_t bit = (h1 + (i * h2)) % bitCount;
+		if ((_bits[bit / 64] & (uint64_t{1} << (bit % 64))) == 0)
+			return (false);
+	}
+	return (true);
+}
+
+uint64_t
+BiometricEvaluation::Memory::BloomFilter::getCapacity()
+    const
+{
+	return (_capacity);
+}
+
+uint64_t
+BiometricEvaluation::Memory::BloomFilter::getSize()
+    const
+{
+	return (_size);
+}
+
+uint32_t
+BiometricEvaluation::Memory::BloomFilter::getHashCount()
+    const
+{
+	return (_hashCount);
+}
+
+const std::vector<uint64_t> &
+BiometricEvaluation::Memory::BloomFilter::getBits()
+    const
+{
+	return (_bits);
+}
+
+/*
+ * A 64-bit FNV-1a hash of the key, mixed to spread its bits, gives the
+ * first hash; mixing it again gives the second. The remaining hashes are
+ * h1 + i * h2 (Kirsch and Mitzenmacher).
+ */
+void
+BiometricEvaluation::Memory::BloomFilter::hash(
+    std::string_view key,
+    uint64_t &h1,
+    uint64_t &h2)
+{
+	h1 = mix(BiometricEvaluation::Impl::fnv1a64(key));
+	h2 = mix(h1 ^ 0x9e3779b97f4a7c15) | 1;
+}
@@ -56,6 +56,15 @@ BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
     BiometricEvaluation::MPI::MessageTag,
     BE_MPI_MessageTag_EnumToStringMap);
 
+const std::map<BiometricEvaluation::MPI::ChunkPolicy, std::string>
+BE_MPI_ChunkPolicy_EnumToStringMap = {
+	{BiometricEvaluation::MPI::ChunkPolicy::Static, "Static"},
+	{BiometricEvaluation::MPI::ChunkPolicy::Guided, "Guided"}
+};
+BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
+    BiometricEvaluation::MPI::ChunkPolicy,
+    BE_MPI_ChunkPolicy_EnumToStringMap);
+
 std::string
 BiometricEvaluation::MPI::generateUniqueID()
 {
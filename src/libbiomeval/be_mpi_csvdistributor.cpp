@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <utility>
+
 #include <be_mpi_csvdistributor.h>
 
 namespace BE = BiometricEvaluation;
@@ -37,17 +39,15 @@ BiometricEvaluation::MPI::CSVDistributor::~CSVDistributor()
 }
 
 /*
- * Add a string key to the given buffer, preceded by the length of the
- * key. The key is written as characters, without the nul terminator.
- * The index out parameter is updated to the location of where the
- * next write can take place.
+ * Append a line to the given buffer, preceded by the line number and the
+ * length of the line. The line is written as characters, without the nul
+ * terminator.
  */
 static void
 fillBufferWithTokens(
     BE::Memory::uint8Array &buf,
     uint64_t lineNum,
-    const std::string &line,
-    BE::Memory::uint8Array::size_type &index)
+    const std::string &line)
 {
 #if 0
 	/* TODO: Ideally, send the tokenized string */
@@ -67,23 +67,14 @@ fillBufferWithTokens(
 #endif
 
 	uint64_t lineLength = line.length();
-	uint64_t neededSpace = index +		/* buffer space in use */
-	    sizeof(uint64_t) + lineLength +	/* space for line, length */
-	    sizeof(uint64_t);			/* and lineNum            */
-	buf.resize(neededSpace);
-
-	/* Write the lineNum, line length, value size, line if non-zero size */
-	uint64_t *pInt64 = (uint64_t *)&buf[index];
-	*pInt64 = (uint64_t)lineNum;
-	index += sizeof(uint64_t);
-	
-	pInt64 = (uint64_t *)&buf[index];
-	*pInt64 = (uint64_t)lineLength;
-	index += sizeof(uint64_t);
-	if (lineLength != 0) {
-		std::memcpy((char *)&buf[index], line.data(), lineLength);
-		index += lineLength;
-	}
+
+	/* Write the lineNum, line length, and line */
+	buf.append(reinterpret_cast<const uint8_t *>(&lineNum),
+	    sizeof(uint64_t));
+	buf.append(reinterpret_cast<const uint8_t *>(&lineLength),
+	    sizeof(uint64_t));
+	buf.append(reinterpret_cast<const uint8_t *>(line.data()),
+	    lineLength);
 }
 
 void
@@ -101,40 +92,38 @@ BiometricEvaluation::MPI::CSVDistributor::createWorkPackage(
 	 */
 	if (this->_resources->getNumRemainingLines() == 0) {
 		workPackage.setNumElements(0);
-		workPackage.setData(packageData);
+		workPackage.setData(std::move(packageData));
 		return;
 	}
 
 	/*
-	 * Distribute a work package based on the chunk size given
-	 * in the resources object. If a failure occurs reading a key,
-	 * continue onto the next key. It is possible to send an empty
-	 * work package due to sequential failures.
+	 * Distribute a work package based on the chunk size and chunk
+	 * policy given in the resources object. If a failure occurs
+	 * reading a key, continue onto the next key. It is possible to
+	 * send an empty work package due to sequential failures.
 	 */
-	uint64_t lineCount;
-	if (this->_resources->getNumRemainingLines() >
-	    this->_resources->getChunkSize())
-		lineCount = this->_resources->getChunkSize();
-	else
-		lineCount = this->_resources->getNumRemainingLines();
+	const uint64_t lineCount = this->_resources->getNextChunkSize(
+	    this->_resources->getChunkSize(),
+	    this->_resources->getNumRemainingLines());
 
 	/*
 	 * The value array must be 0-sized to start, and will stay that way
 	 * if values are not to be sent.
 	 */
-	BE::Memory::uint8Array::size_type index = 0;
 	uint64_t realLineCount = 0;
 
 	/*
 	 * Pull lines from the file and combine a chunk of them into a
-	 * single work package.
+	 * single work package. Lines are appended, so the starting
+	 * allocation is reused.
 	 */
+	packageData.resize(0);
 	std::pair<uint64_t, std::string> lineData;
 	for (uint64_t n = 0; n < lineCount; n++) {
 		try {
 			lineData = this->_resources->readLine();
 			fillBufferWithTokens(packageData, lineData.first,
-			    lineData.second, index);
+			    lineData.second);
 		} catch (const BE::Error::Exception &e) {
 			log->writeDebug("Caught " + e.whatString());
 			continue;
@@ -147,7 +136,7 @@ BiometricEvaluation::MPI::CSVDistributor::createWorkPackage(
 	 */
 	this->_distributedLineCount += realLineCount;
 	workPackage.setNumElements(realLineCount);
-	workPackage.setData(packageData);
+	workPackage.setData(std::move(packageData));
 }
 
 void
@@ -8,9 +8,14 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <list>
 #include <set>
 #include <string>
 #include <sstream>
+#include <utility>
 
 #include <mpi.h>
 #include <unistd.h>
@@ -26,6 +31,7 @@
 #include <be_mpi_runtime.h>
 #include <be_mpi_workpackage.h>
 #include <be_memory_autoarray.h>
+#include <be_time_timer.h>
 
 namespace BE = BiometricEvaluation;
 using namespace BE::Framework::Enumeration;
@@ -37,6 +43,71 @@ BiometricEvaluation::MPI::Distributor::CHECKPOINTREASON = "Reason";
 const std::string
 BiometricEvaluation::MPI::Distributor::CHECKPOINTPID = "PID";
 
+/*
+ * Local helper functions.
+ */
+
+/*
+ * The data of a work package being sent to a Task-N. The buffer must
+ * remain untouched until the send request completes.
+ */
+struct PackageSend
+{
+	BE::Memory::uint8Array data;
+	::MPI::Request request;
+};
+
+/*
+ * Send a work package to a task. The header carrying the data size and
+ * number of elements is sent first so the task can receive the data
+ * directly into a buffer of the right size. The data itself is sent
+ * without blocking, from the work package's own buffer, which is moved
+ * into the list of outstanding sends. Returns the size of the data.
+ */
+static uint64_t
+sendWorkPackage(
+    BE::MPI::WorkPackage &workPackage,
+    int MPITask,
+    std::list<PackageSend> &sends)
+{
+	PackageSend send;
+	send.data = workPackage.releaseData();
+	BE::MPI::WorkPackageHeader header;
+	header.size = send.data.size();
+	header.numElements = workPackage.getNumElements();
+	::MPI::COMM_WORLD.Send(
+	    (void *)&header, 2, MPI_UINT64_T, MPITask,
+	    to_int_type(BE::MPI::MessageTag::Data));
+
+	int size = static_cast<int>(header.size);
+	send.request = ::MPI::COMM_WORLD.Isend(
+	    (void *)send.data, size, MPI_CHAR, MPITask,
+	    to_int_type(BE::MPI::MessageTag::Data));
+	sends.push_back(std::move(send));
+
+	return (header.size);
+}
+
+/*
+ * Release the buffers of completed sends, optionally waiting for
+ * all outstanding sends to complete.
+ */
+static void
+completeWorkPackageSends(
+    std::list<PackageSend> &sends,
+    bool wait)
+{
+	for (auto it = sends.begin(); it != sends.end(); ) {
+		if (wait)
+			it->request.Wait();
+		else if (!it->request.Test()) {
+			++it;
+			continue;
+		}
+		it = sends.erase(it);
+	}
+}
+
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
@@ -150,33 +221,6 @@ BiometricEvaluation::MPI::Distributor::start()
 	this->shutdown();
 }
 
-void
-BiometricEvaluation::MPI::Distributor::sendWorkPackage(
-    BE::MPI::WorkPackage &workPackage, int MPITask)
-{
-	/*
-	 * Send three pieces of information:
-	 * The raw data and length, in the first message;
-	 * The number of elements in the second message.
-	 */
-	BE::Memory::uint8Array data(0);
-	workPackage.getData(data);
-	int size = static_cast<int>(data.size());
-	::MPI::COMM_WORLD.Send(
-	    (void *)data, size, MPI_CHAR, MPITask,
-	    to_int_type(BE::MPI::MessageTag::Data));
-
-	uint64_t numElements = workPackage.getNumElements();
-	::MPI::COMM_WORLD.Send(
-	    (void *)&numElements, 1, MPI_UINT64_T,
-	    MPITask, to_int_type(BE::MPI::MessageTag::Data));
-
-	BE::IO::Logsheet *log = this->_logsheet.get();
-	std::ostringstream sstr;
-	sstr << "Sent package of size " << size << " to Task-" << MPITask;
-	MPI::logMessage(*log, sstr.str());
-}
-
 void
 BiometricEvaluation::MPI::Distributor::distributeWork()
 {
@@ -189,6 +233,44 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 	int numRequests;
 	BE::IO::Logsheet *log = this->_logsheet.get();
 
+	/*
+	 * With a pipeline, work packages are created ahead of the
+	 * requests for them while there are no requests to service.
+	 * Packages created but not yet sent are not covered by a
+	 * checkpoint, so there is no lookahead when checkpointing.
+	 */
+	std::deque<MPI::WorkPackage> prebuilt;
+	std::size_t lookahead = 0;
+	if (this->_resources->getPipelineDepth() > 1) {
+		if (BE::MPI::checkpointEnable)
+			MPI::logMessage(*log, "Checkpointing: No work package "
+			    "lookahead");
+		else
+			lookahead = this->_resources->getPipelineDepth();
+	}
+	bool haveWork = true;
+	auto nextWorkPackage = [&](MPI::WorkPackage &wp) -> bool {
+		if (!prebuilt.empty()) {
+			wp = std::move(prebuilt.front());
+			prebuilt.pop_front();
+			return (true);
+		}
+		if (!haveWork)
+			return (false);
+		this->createWorkPackage(wp);
+		return (wp.getNumElements() != 0);
+	};
+	std::list<PackageSend> sends;
+
+	/*
+	 * Latency, in microseconds, from receiving a request for a work
+	 * package until the package is on its way.
+	 */
+	uint64_t numServiced = 0;
+	std::uintmax_t totalLatency = 0, maxLatency = 0;
+	const std::string units{
+	    BE::Time::Timer::units<std::chrono::microseconds>()};
+
 	/*
  	 * Perform a non-blocking receive from all child tasks.
  	 * This loop creates the initial set of receive requests,
@@ -207,9 +289,8 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 	 * While there is work to be distributed, check for Exit conditions,
 	 * gather up all work package requests fairly, dispatch work, etc.
 	 */
-	bool haveWork = true;
 	MPI::taskcmd_t taskCmd;
-	while (haveWork) {
+	while (haveWork || !prebuilt.empty()) {
 
 		/*
 		 * Check for exit signal conditions. The action
@@ -232,6 +313,22 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		 */
 		numRequests = ::MPI::Request::Testsome(
 		    numTasks, requests.get(), indices.get(), MPIstatus.get());
+
+		/*
+		 * Use the time without requests to fill the pipeline
+		 * and to release the buffers of completed sends.
+		 */
+		if (numRequests == 0) {
+			if (haveWork && (prebuilt.size() < lookahead)) {
+				this->createWorkPackage(workPackage);
+				if (workPackage.getNumElements() == 0)
+					haveWork = false;
+				else
+					prebuilt.push_back(
+					    std::move(workPackage));
+			}
+			completeWorkPackageSends(sends, false);
+		}
 		for (int r = 0; r < numRequests; r++) {
 			int task = MPIstatus[r].Get_source();
 			/*
@@ -258,8 +355,8 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			}
 			*log << "OK from Task-" << task;
 			MPI::logEntry(*log);
-
-			this->createWorkPackage(workPackage);
+			BE::Time::Timer serviceTimer;
+			serviceTimer.start();
 
 			/*
 			 * If we are out of work, or in a shutdown
@@ -267,7 +364,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			 * reply. We need to do this so the
 			 * communication send/recv pairs stay in sync.
 			 */
-			if ((workPackage.getNumElements() == 0) ||
+			if ((nextWorkPackage(workPackage) == false) ||
 			   (BiometricEvaluation::MPI::Exit ||
 			    BiometricEvaluation::MPI::QuickExit ||
 			    BiometricEvaluation::MPI::TermExit)) {
@@ -276,6 +373,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 				    (void *)&taskCmd, 1, MPI_INT32_T, task,
 				    to_int_type(MPI::MessageTag::Control));
 				haveWork = false;
+				prebuilt.clear();
 				continue;
 			}
 			/*
@@ -286,7 +384,17 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			::MPI::COMM_WORLD.Send((void *)&taskCmd, 1, MPI_INT32_T,
 			    task, to_int_type(MPI::MessageTag::Control));
 
-			sendWorkPackage(workPackage, task);
+			const uint64_t size = sendWorkPackage(
+			    workPackage, task, sends);
+			serviceTimer.stop();
+			const auto latency = serviceTimer.elapsed<
+			    std::chrono::microseconds>();
+			*log << "Sent package of size " << size << " to Task-" <<
+			    task << " in " << latency << units;
+			MPI::logEntry(*log);
+			numServiced++;
+			totalLatency += latency;
+			maxLatency = std::max(maxLatency, latency);
 
 			/*
 			 * Repost the non-blocking receive
@@ -299,6 +407,12 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		if (this->_activeMpiTasks.empty())
 			break;
 	}
+	if (numServiced > 0) {
+		*log << "Sent " << numServiced << " work packages, latency "
+		    "mean " << (totalLatency / numServiced) << units <<
+		    ", max " << maxLatency << units;
+		MPI::logEntry(*log);
+	}
 
 	/*
 	 * Save the checkpoint when desired, on the forced, clean shutdown.
@@ -366,6 +480,12 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		numRequests = ::MPI::Request::Testsome(
 		    numTasks, requests.get(), indices.get(), MPIstatus.get());
 	}
+
+	/*
+	 * Every Task-N given a work package has posted the receive for
+	 * its data, so the outstanding sends will complete.
+	 */
+	completeWorkPackageSends(sends, true);
 }
 
 void
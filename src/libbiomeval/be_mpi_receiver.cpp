@@ -7,17 +7,21 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <set>
 #include <sstream>
+#include <utility>
 #include <mpi.h>
 #include <signal.h>
-#include <time.h>
 
 #include <be_memory_autoarrayutility.h>
 #include <be_mpi.h>
 #include <be_mpi_exception.h>
 #include <be_mpi_receiver.h>
 #include <be_mpi_runtime.h>
+#include <be_time_timer.h>
 
 namespace BE = BiometricEvaluation;
 using namespace BE::Framework::Enumeration;
@@ -66,6 +70,42 @@ static void statusToMessage(
 	    std::to_string(to_int_type(taskStatus)));
 }
 
+/*
+ * A work package whose data is being received from Task-0. The buffer
+ * must remain untouched until the receive request completes.
+ */
+struct PendingPackage
+{
+	BE::Memory::uint8Array data;
+	uint64_t numElements;
+	::MPI::Request request;
+	/* Time from the request to Task-0 until the data arrived */
+	BE::Time::Timer receiveTimer;
+};
+
+/*
+ * Receive the header of a work package from Task-0 and post the
+ * receive of its data directly into a buffer of the announced size.
+ */
+static PendingPackage
+receiveWorkPackage(
+    const BE::Time::Timer &receiveTimer)
+{
+	BE::MPI::WorkPackageHeader header;
+	::MPI::COMM_WORLD.Recv(
+	    (void *)&header, 2, MPI_UINT64_T, 0,
+	    to_int_type(BE::MPI::MessageTag::Data));
+
+	PendingPackage package;
+	package.receiveTimer = receiveTimer;
+	package.data.resize(header.size);
+	package.numElements = header.numElements;
+	package.request = ::MPI::COMM_WORLD.Irecv(
+	    (void *)package.data, static_cast<int>(header.size), MPI_CHAR,
+	    0, to_int_type(BE::MPI::MessageTag::Data));
+	return (package);
+}
+
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
@@ -320,18 +360,14 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 		}
 
 		/*
- 		 * If no worker is ready, pause for a bit, then go back
- 		 * to the top of the loop and start over.
+ 		 * Wait a bit for a worker to become ready, returning as
+ 		 * soon as one is. If none is, go back to the top of the
+ 		 * loop and start over.
  		 */
-		bool msgAvail =
-		    this->_processManager.getNextMessage(worker, message, 0);
-		if (!msgAvail) {
-			struct timespec ts;
-			ts.tv_sec = 0;
-			ts.tv_nsec = 100000000L;	/* 100 milliseconds */
-			nanosleep(&ts, NULL);
+		bool msgAvail = this->_processManager.getNextMessage(
+		    worker, message, std::chrono::milliseconds(100));
+		if (!msgAvail)
 			continue;
-		}
 
 		/*
 		 * Once a worker is ready, we're dedicated to sending off
@@ -371,7 +407,7 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 	message.resize(sizeof(wpCount));
 	std::memcpy(&message[0], &wpCount, sizeof(wpCount));
 	worker->sendMessageToWorker(message);
-	workPackage.getData(wpData);
+	wpData = workPackage.releaseData();
 	worker->sendMessageToWorker(wpData);
 	*log << "Sent work package of size " << wpData.size() << " to worker";
 	MPI::logEntry(*log);
@@ -380,14 +416,81 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 BiometricEvaluation::MPI::TaskStatus
 BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 {
-	BE::Memory::uint8Array workPackageRaw(0);
-
-	::MPI::Status MPIstatus;
 	BE::MPI::taskstat_t taskStatus;
 	BE::MPI::taskcmd_t taskCommand;
 	MPI::TaskStatus status = MPI::TaskStatus::OK;
 	BE::IO::Logsheet *log = this->_logsheet.get();
 
+	/*
+	 * Work packages requested from Task-0 but not yet handed to a
+	 * worker. With a pipeline depth greater than one, the next
+	 * packages are requested, and their data received, while the
+	 * current package waits for a worker.
+	 */
+	std::deque<PendingPackage> pending;
+	const std::size_t pipelineDepth = this->_resources->getPipelineDepth();
+
+	/*
+	 * Latency, in microseconds, from requesting a work package from
+	 * Task-0 until a worker accepts it.
+	 */
+	uint64_t numDelivered = 0;
+	std::uintmax_t totalLatency = 0, maxLatency = 0;
+	const std::string units{
+	    BE::Time::Timer::units<std::chrono::microseconds>()};
+	BE::Time::Timer receiveTimer;
+
+	/*
+	 * Hand the oldest pending package to a worker. Returns false
+	 * when no more packages should be requested.
+	 */
+	auto dispatchWorkPackage = [&]() -> bool {
+		PendingPackage package = std::move(pending.front());
+		pending.pop_front();
+		package.request.Wait();
+		package.receiveTimer.stop();
+		try {
+			MPI::WorkPackage workPackage(std::move(package.data));
+			workPackage.setNumElements(package.numElements);
+			BE::Time::Timer deliverTimer;
+			deliverTimer.start();
+			this->sendWorkPackage(workPackage);
+			deliverTimer.stop();
+
+			const auto received = package.receiveTimer.elapsed<
+			    std::chrono::microseconds>();
+			const auto latency = received + deliverTimer.elapsed<
+			    std::chrono::microseconds>();
+			*log << "Work package latency " << latency << units <<
+			    " (received in " << received << units << ")";
+			MPI::logEntry(*log);
+			numDelivered++;
+			totalLatency += latency;
+			maxLatency = std::max(maxLatency, latency);
+		} catch (const MPI::TerminateJob &e) {
+			MPI::logMessage(*log,
+			    "Package processor requested job termination " +
+			    e.whatString());
+			taskStatus = to_int_type(
+			    MPI::TaskStatus::RequestJobTermination);
+			::MPI::COMM_WORLD.Send(
+			    (void *)&taskStatus, 1, MPI_INT32_T, 0,
+			     to_int_type(MPI::MessageTag::Control));
+			status = MPI::TaskStatus::RequestJobTermination;
+		} catch (const Error::Exception &e) {
+			MPI::logMessage(*log,
+			    "Failure to process work package: "
+			    + e.whatString());
+			taskStatus = to_int_type(MPI::TaskStatus::Failed);
+			::MPI::COMM_WORLD.Send(
+			    (void *)&taskStatus, 1, MPI_INT32_T, 0,
+			     to_int_type(MPI::MessageTag::Control));
+			status = MPI::TaskStatus::Failed;
+			return (false);
+		}
+		return (true);
+	};
+
 	while (true) {
 
 		/*
@@ -397,6 +500,8 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 		 */
 		if (MPI::Exit) {
 			MPI::logMessage(*log, "Exit signal");
+			while (!pending.empty() && dispatchWorkPackage())
+				;
 			taskStatus = to_int_type(MPI::TaskStatus::Exit);
 			::MPI::COMM_WORLD.Send(
 			    (void *)&taskStatus, 1, MPI_INT32_T,
@@ -425,73 +530,64 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 			break;
 		}
 
-		MPI::logMessage(*log, "Asking for work package");
-		taskStatus = to_int_type(MPI::TaskStatus::OK);
-		::MPI::COMM_WORLD.Sendrecv(
-		    (void *)&taskStatus, 1, MPI_INT32_T, 0,
-		    to_int_type(MPI::MessageTag::Control), &taskCommand, 1,
-		    MPI_INT32_T, 0, to_int_type(MPI::MessageTag::Control));
-
-		const BE::MPI::TaskCommand  taskCommandE =
-		    to_enum<TaskCommand>(taskCommand);
-		MPI::logMessage(*log, to_string(taskCommandE) + " command");
-		if (taskCommandE == MPI::TaskCommand::Ignore) {
-			continue;
-		}
-		if (taskCommandE == MPI::TaskCommand::Exit) {
-			break;
-		}		
-		if (taskCommandE == MPI::TaskCommand::QuickExit) {
-			this->_processManager.broadcastSignal(SIGINT);
-			break;
-		}		
-		if (taskCommandE == MPI::TaskCommand::TermExit) {
-			this->_processManager.broadcastSignal(SIGKILL);
-			break;
-		}		
-		/*
-		 * Receive three pieces of information:
-		 * The raw data and length in the first message;
-		 * The number of elements in the second message.
-		 */
-		::MPI::COMM_WORLD.Probe(0, to_int_type(MPI::MessageTag::Data),
-		    MPIstatus);
-		uint64_t length = MPIstatus.Get_count(MPI_CHAR);
-		workPackageRaw.resize(length);
-		::MPI::COMM_WORLD.Recv(
-		    (void *)&workPackageRaw[0], length, MPI_CHAR, 0,
-		    to_int_type(MPI::MessageTag::Data));
-		workPackageRaw.resize(length);
-
-		uint64_t numElements;
-		::MPI::COMM_WORLD.Recv(
-		    (void *)&numElements, 1, MPI_UINT64_T, 0,
-		    to_int_type(MPI::MessageTag::Data));
-		try {
-			MPI::WorkPackage workPackage(workPackageRaw);
-			workPackage.setNumElements(numElements);
-			this->sendWorkPackage(workPackage);
-		} catch (const MPI::TerminateJob &e) {
-			MPI::logMessage(*log,
-			    "Package processor requested job termination " +
-			    e.whatString());
-			taskStatus = to_int_type(
-			    MPI::TaskStatus::RequestJobTermination);
-			::MPI::COMM_WORLD.Send(
-			    (void *)&taskStatus, 1, MPI_INT32_T, 0,
-			     to_int_type(MPI::MessageTag::Control));
-			status = MPI::TaskStatus::RequestJobTermination;
-		} catch (const Error::Exception &e) {
-			MPI::logMessage(*log,
-			    "Failure to process work package: "
-			    + e.whatString());
-			taskStatus = to_int_type(MPI::TaskStatus::Failed);
-			::MPI::COMM_WORLD.Send(
+		if (pending.size() < pipelineDepth) {
+			MPI::logMessage(*log, "Asking for work package");
+			receiveTimer.start();
+			taskStatus = to_int_type(MPI::TaskStatus::OK);
+			::MPI::COMM_WORLD.Sendrecv(
 			    (void *)&taskStatus, 1, MPI_INT32_T, 0,
-			     to_int_type(MPI::MessageTag::Control));
-			status = MPI::TaskStatus::Failed;
-			break;
+			    to_int_type(MPI::MessageTag::Control),
+			    &taskCommand, 1, MPI_INT32_T, 0,
+			    to_int_type(MPI::MessageTag::Control));
+
+			const BE::MPI::TaskCommand  taskCommandE =
+			    to_enum<TaskCommand>(taskCommand);
+			MPI::logMessage(*log, to_string(taskCommandE) +
+			    " command");
+			if (taskCommandE == MPI::TaskCommand::Exit) {
+				while (!pending.empty() &&
+				    dispatchWorkPackage())
+					;
+				break;
+			}
+			if (taskCommandE == MPI::TaskCommand::QuickExit) {
+				this->_processManager.broadcastSignal(SIGINT);
+				break;
+			}
+			if (taskCommandE == MPI::TaskCommand::TermExit) {
+				this->_processManager.broadcastSignal(SIGKILL);
+				break;
+			}
+			if (taskCommandE != MPI::TaskCommand::Continue)
+				receiveTimer.stop();
+			if (taskCommandE == MPI::TaskCommand::Continue) {
+				pending.push_back(
+				    receiveWorkPackage(receiveTimer));
+				receiveTimer = BE::Time::Timer();
+
+				/* Fill the pipeline before dispatching */
+				if (pending.size() < pipelineDepth)
+					continue;
+			}
 		}
+		if (pending.empty())
+			continue;
+		if (dispatchWorkPackage() == false)
+			break;
+	}
+
+	/*
+	 * Packages not handed to a worker are dropped, but their data
+	 * must finish arriving before the buffers are released.
+	 */
+	for (auto &package : pending)
+		package.request.Wait();
+
+	if (numDelivered > 0) {
+		*log << "Delivered " << numDelivered << " work packages, "
+		    "latency mean " << (totalLatency / numDelivered) << units <<
+		    ", max " << maxLatency << units;
+		MPI::logEntry(*log);
 	}
 	return (status);
 }
@@ -501,6 +597,8 @@ BiometricEvaluation::MPI::Receiver::startWorkers()
 {
 	std::shared_ptr<Process::WorkerController> wc;
 	BE::IO::Logsheet *log = this->_logsheet.get();
+	this->_processManager.setSharedMemorySize(
+	    this->_resources->getWorkerMessageBufferSize());
 	for (int w = 0; w < this->_resources->getWorkersPerNode(); w++) {
 		std::shared_ptr<PackageWorker> pw(new PackageWorker(
 		    this->_workPackageProcessor,
@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <utility>
+
 #include <be_mpi_recordstoredistributor.h>
 
 namespace BE = BiometricEvaluation;
@@ -59,38 +61,26 @@ BiometricEvaluation::MPI::RecordStoreDistributor::~RecordStoreDistributor()
 }
 
 /*
- * Add a string key to the given buffer, preceded by the length of the
- * key. The key is written as characters, without the nul terminator.
- * The index out parameter is updated to the location of where the
- * next write can take place.
+ * Append a string key to the given buffer, preceded by the length of the
+ * key and the size of the value, then the value itself. The key is written
+ * as characters, without the nul terminator.
  */
 static void
 fillBufferWithKeyAndValue(
     BE::Memory::uint8Array &buf,
     const std::string &key,
-    BE::Memory::uint8Array &value,
-    BE::Memory::uint8Array::size_type &index)
+    const BE::Memory::uint8Array &value)
 {
 	uint32_t keyLength = key.length();
 	uint64_t valueSize =  value.size();
-	uint64_t neededSpace = index		/* buffer space in use */
-	    + sizeof(uint32_t) + keyLength	/* space for key and length */
-	    + sizeof(uint64_t) + valueSize;	/* for value and size */
-	buf.resize(neededSpace);
-
-	/* Write the key length, value size, key, value if non-zero size */
-	uint32_t *pInt32 = (uint32_t *)&buf[index];
-	*pInt32 = (uint32_t)keyLength;
-	index += sizeof(uint32_t);
-	uint64_t *pInt64 = (uint64_t *)&buf[index];
-	*pInt64 = (uint64_t)valueSize;
-	index += sizeof(uint64_t);
-	std::memcpy((char *)&buf[index], key.data(), keyLength);
-	index += keyLength;
-	if (valueSize != 0) {
-		std::memcpy((void *)&buf[index], &value[0], valueSize);
-		index += valueSize;
-	}
+
+	/* Write the key length, value size, key, and value */
+	buf.append(reinterpret_cast<const uint8_t *>(&keyLength),
+	    sizeof(uint32_t));
+	buf.append(reinterpret_cast<const uint8_t *>(&valueSize),
+	    sizeof(uint64_t));
+	buf.append(reinterpret_cast<const uint8_t *>(key.data()), keyLength);
+	buf.append(value, valueSize);
 }
 
 void
@@ -108,23 +98,19 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 	 */
 	if (this->_recordsRemaining == 0) {
 		workPackage.setNumElements(0);
-		workPackage.setData(packageData);
+		workPackage.setData(std::move(packageData));
 		return;
 	}
 
 	/*
-	 * Distribute a work package based on the chunk size given
-	 * in the resources object. If a failure occurs reading a key,
-	 * continue onto the next key. It is possible to send an empty
-	 * work package due to sequential failures.
+	 * Distribute a work package based on the chunk size and chunk
+	 * policy given in the resources object. If a failure occurs
+	 * reading a key, continue onto the next key. It is possible to
+	 * send an empty work package due to sequential failures.
 	 */
-	uint64_t keyCount;
-	if (this->_recordsRemaining > this->_resources->getChunkSize()) {
-		keyCount = this->_resources->getChunkSize();
-	} else {
-		keyCount = this->_recordsRemaining;
-	}
-	
+	const uint64_t keyCount = this->_resources->getNextChunkSize(
+	    this->_resources->getChunkSize(), this->_recordsRemaining);
+
 	this->_recordsRemaining -= keyCount;
 
 	/*
@@ -132,15 +118,16 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 	 * if values are not to be sent.
 	 */
 	BE::IO::RecordStore::Record record;
-	BE::Memory::uint8Array::size_type index = 0;
 	uint64_t realKeyCount = 0;
 	std::shared_ptr<IO::RecordStore> recordStore =
 	    this->_resources->getRecordStore();
 
 	/*
 	 * Pull keys, and possibly values, from the RecordStore and
-	 * combine a chunk of them into a single work package.
+	 * combine a chunk of them into a single work package. Records
+	 * are appended, so the starting allocation is reused.
 	 */
+	packageData.resize(0);
 	for (uint64_t n = 0; n < keyCount; n++) {
 		try {
 			if (this->_includeValues)
@@ -153,7 +140,7 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 			this->_lastDistributedKey = record.key;
 
 			fillBufferWithKeyAndValue(packageData, record.key,
-			    record.data, index);
+			    record.data);
 		} catch (const Error::Exception &e) {
 			log->writeDebug("Caught " + e.whatString());
 			continue;
@@ -164,7 +151,7 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 	 * NOTE: At this point it is possible to have no keys in the package.
 	 */
 	workPackage.setNumElements(realKeyCount);
-	workPackage.setData(packageData);
+	workPackage.setData(std::move(packageData));
 }
 
 void
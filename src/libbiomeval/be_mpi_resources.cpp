@@ -12,6 +12,7 @@
 #include <unistd.h>
 
 #include <mpi.h>
+#include <algorithm>
 #include <sstream>
 
 #include <be_mpi.h>
@@ -24,6 +25,7 @@
 #include <be_text.h>
 
 namespace BE = BiometricEvaluation;
+using namespace BE::Framework::Enumeration;
 
 /*
  * The common properties for MPI Resources.
@@ -40,6 +42,16 @@ const std::string
 BiometricEvaluation::MPI::Resources::LOGSHEETURLPROPERTY("Logsheet URL");
 const std::string
 BiometricEvaluation::MPI::Resources::CHECKPOINTPATHPROPERTY("Checkpoint Path");
+const std::string
+BiometricEvaluation::MPI::Resources::PIPELINEDEPTHPROPERTY("Pipeline Depth");
+const std::string
+BiometricEvaluation::MPI::Resources::WORKERMESSAGEBUFFERSIZEPROPERTY(
+    "Worker Message Buffer Size");
+const std::string
+BiometricEvaluation::MPI::Resources::CHUNKPOLICYPROPERTY("Chunk Policy");
+const std::string
+BiometricEvaluation::MPI::Resources::MINIMUMCHUNKSIZEPROPERTY(
+    "Minimum Chunk Size");
 
 /******************************************************************************/
 /* Class method definitions.                                                  */
@@ -106,6 +118,56 @@ BiometricEvaluation::MPI::Resources::Resources(
 			this->_checkpointPath = "";
 		}
 	}
+	try {
+		this->_pipelineDepth = props->getPropertyAsInteger(
+		    MPI::Resources::PIPELINEDEPTHPROPERTY);
+	} catch (const Error::ObjectDoesNotExist &) {
+		this->_pipelineDepth = MPI::Resources::DEFAULT_PIPELINE_DEPTH;
+	}
+	if (this->_pipelineDepth < 1)
+		throw Error::ParameterError(
+		    MPI::Resources::PIPELINEDEPTHPROPERTY + " must be positive");
+	int64_t bufferSize = 0;
+	try {
+		bufferSize = props->getPropertyAsInteger(
+		    MPI::Resources::WORKERMESSAGEBUFFERSIZEPROPERTY);
+	} catch (const Error::ObjectDoesNotExist &) {
+		bufferSize = 0;
+	}
+	if (bufferSize < 0)
+		throw Error::ParameterError(
+		    MPI::Resources::WORKERMESSAGEBUFFERSIZEPROPERTY +
+		    " must not be negative");
+	this->_workerMessageBufferSize = static_cast<uint64_t>(bufferSize);
+
+	this->_chunkPolicy = MPI::ChunkPolicy::Static;
+	std::string chunkPolicy{};
+	try {
+		chunkPolicy = props->getProperty(
+		    MPI::Resources::CHUNKPOLICYPROPERTY);
+	} catch (const Error::ObjectDoesNotExist &) {}
+	if (!chunkPolicy.empty()) {
+		try {
+			this->_chunkPolicy = to_enum<MPI::ChunkPolicy>(
+			    chunkPolicy);
+		} catch (const Error::ObjectDoesNotExist &) {
+			throw Error::ParameterError("Invalid " +
+			    MPI::Resources::CHUNKPOLICYPROPERTY + ": " +
+			    chunkPolicy);
+		}
+	}
+	int64_t minimumChunkSize = 1;
+	try {
+		minimumChunkSize = props->getPropertyAsInteger(
+		    MPI::Resources::MINIMUMCHUNKSIZEPROPERTY);
+	} catch (const Error::ObjectDoesNotExist &) {
+		minimumChunkSize = 1;
+	}
+	if (minimumChunkSize < 1)
+		throw Error::ParameterError(
+		    MPI::Resources::MINIMUMCHUNKSIZEPROPERTY +
+		    " must be positive");
+	this->_minimumChunkSize = static_cast<uint64_t>(minimumChunkSize);
 }
 
 std::vector<std::string>
@@ -122,6 +184,10 @@ BiometricEvaluation::MPI::Resources::getOptionalProperties()
 	std::vector<std::string> props;
 	props.push_back(MPI::Resources::LOGSHEETURLPROPERTY);
 	props.push_back(MPI::Resources::CHECKPOINTPATHPROPERTY);
+	props.push_back(MPI::Resources::PIPELINEDEPTHPROPERTY);
+	props.push_back(MPI::Resources::WORKERMESSAGEBUFFERSIZEPROPERTY);
+	props.push_back(MPI::Resources::CHUNKPOLICYPROPERTY);
+	props.push_back(MPI::Resources::MINIMUMCHUNKSIZEPROPERTY);
 	return (props);
 }
 
@@ -144,6 +210,48 @@ BiometricEvaluation::MPI::Resources::getCheckpointPath() const
 	return (this->_checkpointPath);
 }
 
+int
+BiometricEvaluation::MPI::Resources::getPipelineDepth() const
+{
+	return (this->_pipelineDepth);
+}
+
+uint64_t
+BiometricEvaluation::MPI::Resources::getWorkerMessageBufferSize() const
+{
+	return (this->_workerMessageBufferSize);
+}
+
+BiometricEvaluation::MPI::ChunkPolicy
+BiometricEvaluation::MPI::Resources::getChunkPolicy() const
+{
+	return (this->_chunkPolicy);
+}
+
+uint64_t
+BiometricEvaluation::MPI::Resources::getMinimumChunkSize() const
+{
+	return (this->_minimumChunkSize);
+}
+
+uint64_t
+BiometricEvaluation::MPI::Resources::getNextChunkSize(
+    uint64_t chunkSize,
+    uint64_t remaining) const
+{
+	uint64_t count = chunkSize;
+	if (this->_chunkPolicy == MPI::ChunkPolicy::Guided) {
+		/* Rank 0 is the Distributor, and has no workers */
+		const uint64_t numWorkers = std::max<int64_t>(1,
+		    static_cast<int64_t>(this->_numTasks - 1) *
+		    this->_workersPerNode);
+		count = (remaining + numWorkers - 1) / numWorkers;
+		count = std::max(count, this->_minimumChunkSize);
+		count = std::min(count, chunkSize);
+	}
+	return (std::min(count, remaining));
+}
+
 std::string
 BiometricEvaluation::MPI::Resources::getPropertiesFileName() const
 {
@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <utility>
+
 #include <be_mpi_workpackage.h>
 
 using namespace BiometricEvaluation;
@@ -25,6 +27,12 @@ BiometricEvaluation::MPI::WorkPackage::WorkPackage(
 	this->_data = data;
 }
 
+BiometricEvaluation::MPI::WorkPackage::WorkPackage(
+    Memory::uint8Array &&data) :
+    _data(std::move(data))
+{
+}
+
 /******************************************************************************/
 /* Object method definitions.                                                 */
 /******************************************************************************/
@@ -45,6 +53,19 @@ BiometricEvaluation::MPI::WorkPackage::setData(const Memory::uint8Array &data)
 	this->_data = data;
 }
 
+void
+BiometricEvaluation::MPI::WorkPackage::setData(Memory::uint8Array &&data)
+{
+	this->_data = std::move(data);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::MPI::WorkPackage::releaseData()
+{
+	Memory::uint8Array data(std::move(this->_data));
+	return (data);
+}
+
 uint64_t
 BiometricEvaluation::MPI::WorkPackage::getSize() const
 {
@@ -31,7 +31,8 @@ std::list<BiometricEvaluation::Process::ForkManager*>
 BiometricEvaluation::Process::ForkManager::ForkManager() :
     _exitCallback(nullptr),
     _parent(false),
-    _wcStatus()
+    _wcStatus(),
+    _sharedMemorySize(0)
 {
 	BiometricEvaluation::Process::ForkManager::FORKMANAGERS.push_back(this);
 }
@@ -122,6 +123,7 @@ BiometricEvaluation::Process::ForkManager::startWorkers(
 	for (uint32_t i = 0; i < getTotalWorkers(); i++) {
 		std::shared_ptr<ForkWorkerController> fwc =
 		    std::static_pointer_cast<ForkWorkerController>(_workers[i]);
+		fwc->_sharedMemorySize = this->_sharedMemorySize;
 		fwc->start(communicate);
 		_wcStatus[fwc].pid = fwc->getPID();
 		_wcStatus[fwc].isWorking = true;
@@ -163,6 +165,7 @@ BiometricEvaluation::Process::ForkManager::startWorker(
 
 	std::shared_ptr<ForkWorkerController> fwc =
 	    std::static_pointer_cast<ForkWorkerController>(*it);
+	fwc->_sharedMemorySize = this->_sharedMemorySize;
 	fwc->start(communicate);
 	
 	/* In the child case, start() will eventually exit the child */
@@ -195,7 +198,7 @@ BiometricEvaluation::Process::ForkWorkerController::start(
 	this->reset();
 
 	if (communicate)
-		getWorker()->_initCommunication();
+		getWorker()->_initCommunication(this->_sharedMemorySize);
 	int32_t pid = fork();
 	
 	switch (pid) {
@@ -260,6 +263,20 @@ BiometricEvaluation::Process::ForkManager::stopWorker(
 	std::static_pointer_cast<ForkWorkerController>(*it)->stop();
 }
 
+void
+BiometricEvaluation::Process::ForkManager::setSharedMemorySize(
+    uint64_t size)
+{
+	this->_sharedMemorySize = size;
+}
+
+uint64_t
+BiometricEvaluation::Process::ForkManager::getSharedMemorySize()
+    const
+{
+	return (this->_sharedMemorySize);
+}
+
 void
 BiometricEvaluation::Process::ForkManager::broadcastSignal(int signo)
 {
@@ -479,7 +496,8 @@ std::shared_ptr<BiometricEvaluation::Process::Worker>
 BiometricEvaluation::Process::ForkWorkerController::ForkWorkerController(
     std::shared_ptr<Worker> worker) :
     WorkerController(worker),
-    _pid(0)
+    _pid(0),
+    _sharedMemorySize(0)
 {
 
 }
@@ -86,6 +86,17 @@ BiometricEvaluation::Process::Manager::waitForMessage(
     int *nextFD,
     int numSeconds)
     const
+{
+	return (this->waitForMessage(sender, nextFD,
+	    std::chrono::seconds(numSeconds)));
+}
+
+bool
+BiometricEvaluation::Process::Manager::waitForMessage(
+    std::shared_ptr<WorkerController> &sender,
+    int *nextFD,
+    const std::chrono::microseconds &waitTime)
+    const
 {
 	bool result = false;
 	fd_set set;
@@ -96,9 +107,9 @@ BiometricEvaluation::Process::Manager::waitForMessage(
 	std::map<std::shared_ptr<WorkerController>, int> fds;
 	
 	struct timeval timeout, *timeoutptr = nullptr;
-	if (numSeconds >= 0) {
-		timeout.tv_sec = numSeconds;
-		timeout.tv_usec = 0;
+	if (waitTime.count() >= 0) {
+		timeout.tv_sec = waitTime.count() / 1000000;
+		timeout.tv_usec = waitTime.count() % 1000000;
 		timeoutptr = &timeout;
 	}
 	
@@ -179,6 +190,17 @@ BiometricEvaluation::Process::Manager::getNextMessage(
     Memory::uint8Array &message,
     int timeout)
     const
+{
+	return (this->getNextMessage(sender, message,
+	    std::chrono::seconds(timeout)));
+}
+
+bool
+BiometricEvaluation::Process::Manager::getNextMessage(
+    std::shared_ptr<WorkerController> &sender,
+    Memory::uint8Array &message,
+    const std::chrono::microseconds &timeout)
+    const
 {
 	int fd = 0;
 	if (this->waitForMessage(sender, &fd, timeout) == false)
@@ -8,20 +8,51 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <sys/mman.h>
 #include <sys/select.h>
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstring>
+#include <new>
 
 #include <be_error.h>
 #include <be_io_utility.h>
 #include <be_process_worker.h>
 
+/*
+ * The control block at the start of the shared memory message buffer,
+ * followed by the ring of message data. The Manager is the only writer
+ * of head and the Worker the only writer of tail; both count octets
+ * ever written and read, so the ring is empty when they are equal.
+ */
+struct BiometricEvaluation::Process::Worker::MessageRing
+{
+	alignas(64) std::atomic<uint64_t> head;
+	alignas(64) std::atomic<uint64_t> tail;
+
+	uint8_t *
+	data()
+	{
+		return (reinterpret_cast<uint8_t *>(this + 1));
+	}
+};
+
+/*
+ * Set in the length written to the pipe when the message contents are
+ * in the shared memory message buffer instead of following in the pipe.
+ */
+static const uint64_t SHAREDMEMORYMESSAGE = UINT64_C(1) << 63;
+
 BiometricEvaluation::Process::Worker::Worker() :
     _stopRequested(false),
     _parameters(ParameterList()),
-    _communicationEnabled(false)
+    _communicationEnabled(false),
+    _messageRing(nullptr),
+    _messageRingSize(0)
 {
 }
 
@@ -181,8 +212,63 @@ BiometricEvaluation::Process::Worker::receiveMessageFromManager(
 
 	uint64_t length;
 	IO::Utility::readPipe(&length, sizeof(length), _pipeToChild[0]);
+	if ((length & SHAREDMEMORYMESSAGE) == 0) {
+		message.resize(length);
+		IO::Utility::readPipe(message, _pipeToChild[0]);
+		return;
+	}
+
+	/* Contents are in the ring, possibly wrapping around its end */
+	length &= ~SHAREDMEMORYMESSAGE;
 	message.resize(length);
-	IO::Utility::readPipe(message, _pipeToChild[0]);
+	const uint64_t tail = _messageRing->tail.load(
+	    std::memory_order_relaxed);
+	_messageRing->head.load(std::memory_order_acquire);
+	const uint64_t offset = tail % _messageRingSize;
+	const uint64_t first = std::min(length, _messageRingSize - offset);
+	std::memcpy(message, _messageRing->data() + offset, first);
+	std::memcpy(message + first, _messageRing->data(), length - first);
+	_messageRing->tail.store(tail + length, std::memory_order_release);
+}
+
+void
+BiometricEvaluation::Process::Worker::_sendMessageToWorker(
+    const Memory::uint8Array &message)
+{
+	const int pipeFD = this->getSendingPipe();
+	uint64_t length = message.size();
+
+	/*
+	 * Messages that don't fit in the free space of the ring are
+	 * sent through the pipe instead of waiting for the Worker to
+	 * make room, so a Manager never blocks on a busy Worker.
+	 * All exceptions float out.
+	 */
+	if ((_messageRing != nullptr) && (length != 0)) {
+		const uint64_t head = _messageRing->head.load(
+		    std::memory_order_relaxed);
+		const uint64_t tail = _messageRing->tail.load(
+		    std::memory_order_acquire);
+		if ((_messageRingSize - (head - tail)) >= length) {
+			const uint64_t offset = head % _messageRingSize;
+			const uint64_t first = std::min(length,
+			    _messageRingSize - offset);
+			std::memcpy(_messageRing->data() + offset, message,
+			    first);
+			std::memcpy(_messageRing->data(), message + first,
+			    length - first);
+			_messageRing->head.store(head + length,
+			    std::memory_order_release);
+
+			length |= SHAREDMEMORYMESSAGE;
+			IO::Utility::writePipe(&length, sizeof(length), pipeFD);
+			return;
+		}
+	}
+
+	/* Send the message length, then the message contents. */
+	IO::Utility::writePipe(&length, sizeof(length), pipeFD);
+	IO::Utility::writePipe(message, pipeFD);
 }
 
 int
@@ -210,7 +296,8 @@ BiometricEvaluation::Process::Worker::getReceivingPipe()
 }
 
 void
-BiometricEvaluation::Process::Worker::_initCommunication()
+BiometricEvaluation::Process::Worker::_initCommunication(
+    uint64_t sharedMemorySize)
 {
 	if (_communicationEnabled == false) {
 		if (pipe(_pipeToChild) != 0)
@@ -223,6 +310,31 @@ BiometricEvaluation::Process::Worker::_initCommunication()
 			throw Error::StrategyError("Could not create receive "
 			    "pipe ( " + Error::errorStr() + ")");
 		}
+
+		/*
+		 * An anonymous shared mapping is inherited by the Worker
+		 * when forked, so no name is needed to attach to it.
+		 */
+		if (sharedMemorySize != 0) {
+			void *ring = mmap(nullptr,
+			    sizeof(MessageRing) + sharedMemorySize,
+			    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			    -1, 0);
+			if (ring == MAP_FAILED) {
+				close(_pipeToChild[0]);
+				close(_pipeToChild[1]);
+				close(_pipeFromChild[0]);
+				close(_pipeFromChild[1]);
+
+				throw Error::StrategyError("Could not create "
+				    "message buffer (" + Error::errorStr() +
+				    ")");
+			}
+			_messageRing = new (ring) MessageRing();
+			_messageRing->head.store(0);
+			_messageRing->tail.store(0);
+			_messageRingSize = sharedMemorySize;
+		}
 			    
 		_communicationEnabled = true;
 	}
@@ -256,4 +368,6 @@ BiometricEvaluation::Process::Worker::~Worker()
 		close(_pipeToChild[0]);
 		close(_pipeToChild[1]);
 	}
+	if (_messageRing != nullptr)
+		munmap(_messageRing, sizeof(MessageRing) + _messageRingSize);
 }
@@ -0,0 +1,83 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_UTILITY_IMPL_H__
+#define __BE_UTILITY_IMPL_H__
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <string_view>
+
+/*
+ * Helpers shared by the library's implementation files. This header is
+ * not installed.
+ */
+namespace BiometricEvaluation
+{
+	namespace Impl
+	{
+		/**
+		 * @brief
+		 * 64-bit FNV-1a hash of a string.
+		 * @details
+		 * Sharded and List RecordStores save this hash on disk,
+		 * so it must not depend on the platform or the standard
+		 * library.
+		 *
+		 * @param[in] key
+		 *	String to hash.
+		 *
+		 * @return
+		 *	Hash of key.
+		 */
+		inline uint64_t
+		fnv1a64(
+		    std::string_view key)
+		{
+			uint64_t hash = 0xCBF29CE484222325ULL;
+			for (const char c : key) {
+				hash ^= static_cast<uint8_t>(c);
+				hash *= 0x100000001B3ULL;
+			}
+			return (hash);
+		}
+
+		/**
+		 * @brief
+		 * Modification time of a file.
+		 *
+		 * @param[in] sb
+		 *	stat() of the file.
+		 *
+		 * @return
+		 *	Modification time, in ns since the epoch. Whole
+		 *	seconds on platforms without finer times.
+		 */
+		inline int64_t
+		modificationTime(
+		    const struct stat &sb)
+		{
+#if defined __APPLE__
+			return ((static_cast<int64_t>(
+			    sb.st_mtimespec.tv_sec) * 1000000000) +
+			    sb.st_mtimespec.tv_nsec);
+#elif defined _WIN32
+			return (static_cast<int64_t>(sb.st_mtime) * 1000000000);
+#else
+			return ((static_cast<int64_t>(
+			    sb.st_mtim.tv_sec) * 1000000000) +
+			    sb.st_mtim.tv_nsec);
+#endif
+		}
+	}
+}
+
+#endif /* __BE_UTILITY_IMPL_H__ */
@@ -8,14 +8,26 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <be_io_propertiesfile.h>
+#include <be_io_recordstoreprefetcher.h>
 #include <be_io_utility.h>
 #include <be_memory_autoarrayutility.h>
 
@@ -51,6 +63,11 @@
 #define TESTDEFINED
 #endif
 
+#ifdef SHARDEDRECORDSTORETEST
+#include <be_io_shardedrecstore.h>
+#define TESTDEFINED
+#endif
+
 #ifdef TESTDEFINED
 namespace BE = BiometricEvaluation;
 #endif
@@ -164,8 +181,12 @@ testMerge()
 	path.push_back(merge_rs_fn[1]);
 	path.push_back(merge_rs_fn[2]);
 
-	EXPECT_NO_THROW(BE::IO::RecordStore::mergeRecordStores(merged_rs_fn,
-	    "A merge of 3 RS", merged_type, path));
+	BE::IO::RecordStore::MergeStatistics statistics{};
+	EXPECT_NO_THROW(statistics = BE::IO::RecordStore::mergeRecordStores(
+	    merged_rs_fn, "A merge of 3 RS", merged_type, path));
+	EXPECT_EQ(num_rs * 3, statistics.records);
+	EXPECT_EQ(num_rs * 3 * 2, statistics.bytes);
+	EXPECT_GE(statistics.seconds, 0);
 #ifdef ARCHIVERECORDSTORETEST
 	merged_rs = new BE::IO::ArchiveRecordStore(merged_rs_fn);
 #elif defined DBRECORDSTORETEST
@@ -181,6 +202,17 @@ testMerge()
 	EXPECT_NE(nullptr, merged_rs);
 	ASSERT_EQ((num_rs * 3), merged_rs->getCount());
 
+	/* Every record arrives intact */
+	std::vector<std::string> keys{};
+	for (const auto &record : *merged_rs) {
+		EXPECT_EQ(record.key, to_string(record.data));
+		keys.push_back(record.key);
+	}
+	std::sort(keys.begin(), keys.end());
+	ASSERT_EQ(num_rs * 3, keys.size());
+	for (size_t i = 0; i < keys.size(); i++)
+		EXPECT_EQ(std::to_string(i), keys[i]);
+
 	/* Clean up */
 	if (merged_rs != nullptr) {
 		delete merged_rs; 
@@ -197,47 +229,60 @@ testMerge()
 }
 #endif
 
-class NewRecordStore : public ::testing::Test {
-protected:
-	NewRecordStore()
-	{
-		std::string desc = "RW Test Dir";
 #if defined FILERECORDSTORETEST
-		EXPECT_NO_THROW(_rs.reset(
-		    new BE::IO::FileRecordStore(rsname, desc)));
+using TestRecordStore = BE::IO::FileRecordStore;
 #elif defined DBRECORDSTORETEST
-		EXPECT_NO_THROW(_rs.reset(
-		    new BE::IO::DBRecordStore(rsname, desc)));
+using TestRecordStore = BE::IO::DBRecordStore;
 #elif defined ARCHIVERECORDSTORETEST
-		EXPECT_NO_THROW(_rs.reset(
-		    new BE::IO::ArchiveRecordStore(rsname, desc)));
+using TestRecordStore = BE::IO::ArchiveRecordStore;
 #elif defined SQLITERECORDSTORETEST
-		EXPECT_NO_THROW(_rs.reset(
-		    new BE::IO::SQLiteRecordStore(rsname, desc)));
+using TestRecordStore = BE::IO::SQLiteRecordStore;
 #elif defined COMPRESSEDRECORDSTORETEST
-		EXPECT_NO_THROW(_rs.reset(
-		    new BE::IO::CompressedRecordStore(rsname, desc,
-	    	    BE::IO::RecordStore::Kind::BerkeleyDB, "GZIP")));
+using TestRecordStore = BE::IO::CompressedRecordStore;
+#elif defined SHARDEDRECORDSTORETEST
+using TestRecordStore = BE::IO::ShardedRecordStore;
+#endif
+
+/**
+ * @brief
+ * Create a RecordStore of the kind under test.
+ *
+ * @param[in] pathname
+ *	Where to create the RecordStore.
+ * @param[in] description
+ *	Description of the RecordStore.
+ *
+ * @return
+ *	The new RecordStore.
+ */
+static std::shared_ptr<TestRecordStore>
+createTestRecordStore(
+    const std::string &pathname,
+    const std::string &description)
+{
+#if defined COMPRESSEDRECORDSTORETEST
+	return (std::make_shared<TestRecordStore>(pathname, description,
+	    BE::IO::RecordStore::Kind::BerkeleyDB, "GZIP"));
+#elif defined SHARDEDRECORDSTORETEST
+	return (std::make_shared<TestRecordStore>(pathname, description,
+	    BE::IO::RecordStore::Kind::SQLite, 4));
 #else
-		EXPECT_NO_THROW(_rs.reset(nullptr));
+	return (std::make_shared<TestRecordStore>(pathname, description));
 #endif
-		
+}
+
+class NewRecordStore : public ::testing::Test {
+protected:
+	NewRecordStore()
+	{
+		EXPECT_NO_THROW(_rs = createTestRecordStore(rsname,
+		    "RW Test Dir"));
 		EXPECT_NE(_rs.get(), nullptr);
 	}
 
 	virtual ~NewRecordStore() {}
 
-#if defined FILERECORDSTORETEST
-	std::shared_ptr<BE::IO::FileRecordStore> _rs;
-#elif defined DBRECORDSTORETEST
-	std::shared_ptr<BE::IO::DBRecordStore> _rs;
-#elif defined ARCHIVERECORDSTORETEST
-	std::shared_ptr<BE::IO::ArchiveRecordStore> _rs;
-#elif defined SQLITERECORDSTORETEST
-	std::shared_ptr<BE::IO::SQLiteRecordStore> _rs;
-#elif defined COMPRESSEDRECORDSTORETEST
-	std::shared_ptr<BE::IO::CompressedRecordStore> _rs;
-#endif
+	std::shared_ptr<TestRecordStore> _rs;
 };
 
 /*
@@ -288,6 +333,341 @@ TEST_F(NewRecordStore, CRUD)
 	    BE::Error::ObjectDoesNotExist);
 }
 
+TEST(RecordStore, openReader)
+{
+	const std::string readername{rsname + "_reader"};
+	const std::string desc{"openReader"};
+	std::shared_ptr<BE::IO::RecordStore> rs{};
+	ASSERT_NO_THROW(rs = createTestRecordStore(readername, desc));
+
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	for (int i = 0; i < SEQUENCECOUNT; i++)
+		rs->insert("key" + std::to_string(i), wdata.c_str(), i);
+
+	/* Each reader sequences on its own cursor, in its own thread */
+	static const int READERCOUNT = 4;
+	std::vector<std::shared_ptr<BE::IO::RecordStore>> readers{};
+	for (int i = 0; i < READERCOUNT; i++)
+		ASSERT_NO_THROW(readers.push_back(rs->openReader()));
+
+	std::vector<int> counts(READERCOUNT, 0);
+	std::vector<int> failures(READERCOUNT, 0);
+	std::vector<std::thread> threads{};
+	for (int i = 0; i < READERCOUNT; i++) {
+		threads.emplace_back([&, i]() {
+			for (const auto &record : *readers[i]) {
+				const std::string key = record.key;
+				if (record.data.size() !=
+				    std::stoul(key.substr(3)))
+					failures[i]++;
+				counts[i]++;
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+
+	for (int i = 0; i < READERCOUNT; i++) {
+		EXPECT_EQ(SEQUENCECOUNT, counts[i]);
+		EXPECT_EQ(0, failures[i]);
+	}
+
+	EXPECT_THROW(readers.front()->insert("new", wdata.c_str(), 1),
+	    BE::Error::StrategyError);
+	EXPECT_EQ(wdata.substr(0, 5), to_string(readers.back()->read("key5")));
+
+	/* Changes made after opening readers are seen by later readers */
+	ASSERT_NO_THROW(rs->insert("new", wdata.c_str(), 1));
+	ASSERT_NO_THROW(rs->remove("key0"));
+	EXPECT_NO_THROW(rs->setCursorAtKey("new"));
+	std::shared_ptr<BE::IO::RecordStore> reader{};
+	ASSERT_NO_THROW(reader = rs->openReader());
+	int count = 0;
+	for (const auto &record : *reader) {
+		EXPECT_NE("key0", record.key);
+		count++;
+	}
+	EXPECT_EQ(SEQUENCECOUNT, count);
+	EXPECT_NO_THROW(reader->setCursorAtKey("new"));
+	EXPECT_THROW(reader->setCursorAtKey("key0"),
+	    BE::Error::ObjectDoesNotExist);
+	EXPECT_EQ(wdata.substr(0, 5), to_string(readers.front()->read("key5")));
+
+	reader.reset();
+	readers.clear();
+	rs.reset();
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(readername));
+}
+
+TEST(RecordStore, multipleRead)
+{
+	const std::string multiname{rsname + "_multi"};
+	const std::string desc{"multipleRead"};
+	std::shared_ptr<BE::IO::RecordStore> rs{};
+	ASSERT_NO_THROW(rs = createTestRecordStore(multiname, desc));
+
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	for (int i = 0; i < SEQUENCECOUNT; i++)
+		rs->insert("key" + std::to_string(i), wdata.c_str(), i);
+	rs->remove("key4");
+
+	/* Out of storage order, with a repeated key */
+	const std::vector<std::string> keys{"key7", "key0", "key9", "key2",
+	    "key7", "key3", "key1"};
+	const auto check = [&](const std::shared_ptr<BE::IO::RecordStore>
+	    &store) {
+		std::vector<BE::Memory::uint8Array> records{};
+		ASSERT_NO_THROW(records = store->read(keys));
+		ASSERT_EQ(keys.size(), records.size());
+		std::vector<uint64_t> lengths{};
+		ASSERT_NO_THROW(lengths = store->length(keys));
+		ASSERT_EQ(keys.size(), lengths.size());
+		for (size_t i = 0; i < keys.size(); i++) {
+			const uint64_t size = std::stoul(keys[i].substr(3));
+			EXPECT_EQ(wdata.substr(0, size), to_string(records[i]));
+			EXPECT_EQ(size, lengths[i]);
+		}
+
+		EXPECT_TRUE(store->read(std::vector<std::string>{}).empty());
+		EXPECT_THROW(store->read(std::vector<std::string>{
+		    "key1", "key4"}),
+		    BE::Error::ObjectDoesNotExist);
+		EXPECT_THROW(store->length(std::vector<std::string>{
+		    "key1", "missing"}),
+		    BE::Error::ObjectDoesNotExist);
+
+		/* Prefixes stop at the end of the record */
+		EXPECT_EQ(wdata.substr(0, 3), to_string(store->readPrefix(
+		    "key7", 3)));
+		EXPECT_EQ(wdata.substr(0, 7), to_string(store->readPrefix(
+		    "key7", 100)));
+		EXPECT_EQ(0, store->readPrefix("key0", 4).size());
+		EXPECT_EQ(0, store->readPrefix("key9", 0).size());
+		EXPECT_THROW(store->readPrefix("key4", 4),
+		    BE::Error::ObjectDoesNotExist);
+	};
+	check(rs);
+	check(rs->openReader());
+
+	rs.reset();
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(multiname));
+}
+
+TEST(RecordStore, commitPolicy)
+{
+	const std::string commitname{rsname + "_commit"};
+	const std::string desc{"commitPolicy"};
+	std::shared_ptr<BE::IO::RecordStore> rs{};
+	ASSERT_NO_THROW(rs = createTestRecordStore(commitname, desc));
+
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	BE::IO::RecordStore::CommitPolicy policy{};
+	policy.changes = 4;
+	rs->setCommitPolicy(policy);
+
+	/* The control file notes changes until they are committed */
+	const auto uncommitted = [&]() {
+		BE::IO::PropertiesFile props(commitname + "/.rscontrol.prop",
+		    BE::IO::Mode::ReadOnly);
+		try {
+			props.getProperty("Uncommitted Changes");
+		} catch (const BE::Error::ObjectDoesNotExist&) {
+			return (false);
+		}
+		return (true);
+	};
+	for (int i = 0; i < 3; i++)
+		rs->insert("key" + std::to_string(i), wdata.c_str(), i);
+#if !defined(SHARDEDRECORDSTORETEST)
+	EXPECT_TRUE(uncommitted());
+#endif
+	rs->insert("key3", wdata.c_str(), 3);
+	EXPECT_FALSE(uncommitted());
+	rs->insert("key4", wdata.c_str(), 4);
+	rs->sync();
+	EXPECT_FALSE(uncommitted());
+	EXPECT_EQ(5, rs->getCount());
+
+	/* The delay is only checked when the next change is made */
+	BE::IO::RecordStore::CommitPolicy delayPolicy{};
+	delayPolicy.delay = std::chrono::milliseconds(50);
+	rs->setCommitPolicy(delayPolicy);
+	rs->insert("delayed", wdata.c_str(), 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+#if !defined(SHARDEDRECORDSTORETEST)
+	EXPECT_TRUE(uncommitted());
+#endif
+	rs->remove("delayed");
+	EXPECT_FALSE(uncommitted());
+	EXPECT_EQ(5, rs->getCount());
+	rs.reset();
+
+	/* A process that ends before committing leaves the count stale */
+	const pid_t pid = fork();
+	ASSERT_NE(-1, pid);
+	if (pid == 0) {
+		try {
+			auto child = BE::IO::RecordStore::openRecordStore(
+			    commitname, BE::IO::Mode::ReadWrite);
+			child->setCommitPolicy(policy);
+			for (int i = 5; i < 11; i++)
+				child->insert("key" + std::to_string(i),
+				    wdata.c_str(), i);
+			child->remove("key0");
+
+			/* Exit without destroying child, as if crashing */
+			_exit(child->getCount() == 10 ? EXIT_SUCCESS :
+			    EXIT_FAILURE);
+		} catch (const BE::Error::Exception&) {}
+		_exit(EXIT_FAILURE);
+	}
+	int status{};
+	ASSERT_EQ(pid, waitpid(pid, &status, 0));
+	ASSERT_TRUE(WIFEXITED(status));
+	EXPECT_EQ(EXIT_SUCCESS, WEXITSTATUS(status));
+
+	/*
+	 * Uncommitted changes may be lost with the process, but the count
+	 * is recovered from the records that were written.
+	 */
+	const auto sequenced = [](BE::IO::RecordStore &store) {
+		unsigned int count{0};
+		for (auto it = store.begin(); it != store.end(); ++it)
+			count++;
+		return (count);
+	};
+	auto reader = BE::IO::RecordStore::openRecordStore(commitname);
+	EXPECT_EQ(sequenced(*reader), reader->getCount());
+	reader.reset();
+
+	rs = BE::IO::RecordStore::openRecordStore(commitname,
+	    BE::IO::Mode::ReadWrite);
+	EXPECT_FALSE(uncommitted());
+	const unsigned int count = rs->getCount();
+	EXPECT_EQ(sequenced(*rs), count);
+	rs->insert("key11", wdata.c_str(), 11);
+	EXPECT_EQ(count + 1, rs->getCount());
+	rs.reset();
+	EXPECT_FALSE(uncommitted());
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(commitname));
+}
+
+#if defined FILERECORDSTORETEST || defined ARCHIVERECORDSTORETEST
+TEST(RecordStore, keyFilter)
+{
+	const std::string filtername{rsname + "_filter"};
+	const std::string filterfile{filtername + "/.rskeyfilter"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	std::shared_ptr<BE::IO::RecordStore> rs{};
+	ASSERT_NO_THROW(rs = createTestRecordStore(filtername, "keyFilter"));
+	EXPECT_FALSE(rs->getKeyFilter());
+
+	/* Records inserted before the filter is enabled are included */
+	for (int i = 0; i < 100; i++)
+		rs->insert("key" + std::to_string(i), wdata.c_str(), i % 26);
+	ASSERT_NO_THROW(rs->setKeyFilter(true));
+	EXPECT_TRUE(rs->getKeyFilter());
+	EXPECT_TRUE(BE::IO::Utility::fileExists(filterfile));
+
+	/* Inserting past the filter's capacity rebuilds it */
+	for (int i = 100; i < 2100; i++)
+		rs->insert("key" + std::to_string(i), wdata.c_str(), i % 26);
+	for (int i = 0; i < 2100; i++)
+		EXPECT_TRUE(rs->containsKey("key" + std::to_string(i)));
+	EXPECT_FALSE(rs->containsKey("missing"));
+	EXPECT_THROW(rs->read("missing"), BE::Error::ObjectDoesNotExist);
+	EXPECT_THROW(rs->length("missing"), BE::Error::ObjectDoesNotExist);
+	EXPECT_THROW(rs->remove("missing"), BE::Error::ObjectDoesNotExist);
+	EXPECT_THROW(rs->insert("key0", wdata.c_str(), 1),
+	    BE::Error::ObjectExists);
+
+	rs->remove("key0");
+	EXPECT_FALSE(rs->containsKey("key0"));
+	EXPECT_NO_THROW(rs->insert("key0", wdata.c_str(), 1));
+	rs.reset();
+
+	/* The saved filter is used when reopening */
+	auto reader = BE::IO::RecordStore::openRecordStore(filtername);
+	EXPECT_TRUE(reader->getKeyFilter());
+	for (int i = 0; i < 2100; i++)
+		EXPECT_TRUE(reader->containsKey("key" + std::to_string(i)));
+	EXPECT_FALSE(reader->containsKey("missing"));
+	EXPECT_THROW(reader->setKeyFilter(false), BE::Error::StrategyError);
+	reader.reset();
+
+	/* A filter saved before the store last changed is not used */
+	rs = BE::IO::RecordStore::openRecordStore(filtername,
+	    BE::IO::Mode::ReadWrite);
+	const BE::Memory::uint8Array saved = BE::IO::Utility::readFile(
+	    filterfile);
+	rs->insert("late", wdata.c_str(), 4);
+	rs.reset();
+	BE::IO::Utility::writeFile(saved, filterfile,
+	    std::ios_base::binary | std::ios_base::trunc);
+	reader = BE::IO::RecordStore::openRecordStore(filtername);
+	EXPECT_TRUE(reader->containsKey("late"));
+	reader.reset();
+
+	rs = BE::IO::RecordStore::openRecordStore(filtername,
+	    BE::IO::Mode::ReadWrite);
+	ASSERT_NO_THROW(rs->setKeyFilter(false));
+	EXPECT_FALSE(rs->getKeyFilter());
+	EXPECT_FALSE(BE::IO::Utility::fileExists(filterfile));
+	EXPECT_TRUE(rs->containsKey("late"));
+	rs.reset();
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(filtername));
+}
+#endif
+
+TEST(RecordStorePrefetcher, sequence)
+{
+	const std::string prefetchname{rsname + "_prefetch"};
+	const std::string desc{"RecordStorePrefetcher"};
+	std::shared_ptr<BE::IO::RecordStore> rs{};
+	ASSERT_NO_THROW(rs = createTestRecordStore(prefetchname, desc));
+
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	for (int i = 0; i < SEQUENCECOUNT; i++)
+		rs->insert("key" + std::to_string(i), wdata.c_str(), i);
+
+	EXPECT_THROW(BE::IO::RecordStorePrefetcher(nullptr),
+	    BE::Error::ParameterError);
+	EXPECT_THROW(BE::IO::RecordStorePrefetcher(rs, 0),
+	    BE::Error::ParameterError);
+
+	/* Limits smaller than the store (and than some records) */
+	std::vector<std::string> keys{};
+	{
+		BE::IO::RecordStorePrefetcher prefetcher(rs->openReader(),
+		    3, 16);
+		for (const auto &record : prefetcher) {
+			keys.push_back(record.key);
+			EXPECT_EQ(wdata.substr(0, std::stoul(
+			    record.key.substr(3))), to_string(record.data));
+		}
+		EXPECT_TRUE(prefetcher.begin() == prefetcher.end());
+	}
+	std::vector<std::string> expectedKeys{};
+	for (const auto &record : *rs)
+		expectedKeys.push_back(record.key);
+	/* Not all RecordStores sequence in the same order per handle */
+	std::sort(keys.begin(), keys.end());
+	std::sort(expectedKeys.begin(), expectedKeys.end());
+	EXPECT_EQ(expectedKeys, keys);
+
+	/* Destroying before all records are consumed must not hang */
+	{
+		BE::IO::RecordStorePrefetcher prefetcher(rs->openReader(), 1);
+		BE::IO::RecordStore::Record record;
+		EXPECT_TRUE(prefetcher.next(record));
+	}
+
+	rs.reset();
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(prefetchname));
+}
+
 TEST_F(ExistingRecordStore, sequence)
 {
 	/* Insert some data */
@@ -452,8 +832,836 @@ TEST(ArchiveRecordStore, vacuum)
 	EXPECT_GE(startingSpace, rs->getSpaceUsed());
 	delete rs;
 }
+
+TEST(ArchiveRecordStore, readView)
+{
+	const std::string viewname{rsname + "_view"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	{
+		BE::IO::ArchiveRecordStore rs(viewname, "readView");
+		rs.insert("empty", nullptr, 0);
+		rs.insert("alpha", wdata.c_str(), wdata.length());
+		rs.insert("removed", wdata.c_str(), wdata.length());
+		rs.remove("removed");
+
+		/* Writable stores are never mapped */
+		EXPECT_THROW(rs.readView("alpha"), BE::Error::StrategyError);
+	}
+
+	{
+		BE::IO::ArchiveRecordStore rs(viewname, BE::IO::Mode::ReadOnly);
+		BE::IO::RecordStore::RecordView view{};
+		ASSERT_NO_THROW(view = rs.readView("alpha"));
+		ASSERT_EQ(wdata.length(), view.size);
+		EXPECT_EQ(wdata, std::string(reinterpret_cast<const char *>(
+		    view.data), view.size));
+		EXPECT_EQ(to_string(view.copy()), wdata);
+		EXPECT_EQ(to_string(rs.read("alpha")), wdata);
+
+		EXPECT_NO_THROW(view = rs.readView("empty"));
+		EXPECT_EQ(0, view.size);
+		EXPECT_EQ(0, rs.read("empty").size());
+
+		EXPECT_THROW(rs.readView("removed"),
+		    BE::Error::ObjectDoesNotExist);
+		EXPECT_THROW(rs.readView("missing"),
+		    BE::Error::ObjectDoesNotExist);
+	}
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(viewname));
+}
+
+TEST(ArchiveRecordStore, manifestIndex)
+{
+	const std::string indexname{rsname + "_index"};
+	const std::string indexPath{indexname + "/" +
+	    BE::IO::ArchiveRecordStore::MANIFEST_INDEX_FILE_NAME};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	{
+		BE::IO::ArchiveRecordStore rs(indexname, "manifestIndex");
+		for (int i = 0; i < SEQUENCECOUNT; i++)
+			rs.insert("key" + std::to_string(i), wdata.c_str(), i);
+		rs.remove("key0");
+		rs.remove("key4");
+	}
+	ASSERT_TRUE(BE::IO::Utility::fileExists(indexPath));
+
+	/* Keys are found by searching the index, in insertion order */
+	const auto checkStore = [&](const std::string &extraKey) {
+		BE::IO::ArchiveRecordStore rs(indexname, BE::IO::Mode::ReadOnly);
+		EXPECT_TRUE(rs.needsVacuum());
+		EXPECT_THROW(rs.read("key0"), BE::Error::ObjectDoesNotExist);
+		EXPECT_THROW(rs.length("key4"), BE::Error::ObjectDoesNotExist);
+		EXPECT_THROW(rs.read("key"), BE::Error::ObjectDoesNotExist);
+		EXPECT_EQ(7, rs.length("key7"));
+		EXPECT_EQ(wdata.substr(0, 9), to_string(rs.read("key9")));
+
+		std::vector<std::string> keys{};
+		for (const auto &record : rs)
+			keys.push_back(record.key);
+		std::vector<std::string> expected{"key1", "key2", "key3",
+		    "key5", "key6", "key7", "key8", "key9"};
+		if (!extraKey.empty())
+			expected.push_back(extraKey);
+		EXPECT_EQ(expected, keys);
+
+		EXPECT_NO_THROW(rs.setCursorAtKey("key6"));
+		EXPECT_EQ("key6", rs.sequenceKey());
+		EXPECT_EQ("key7", rs.sequenceKey());
+		EXPECT_THROW(rs.setCursorAtKey("key4"),
+		    BE::Error::ObjectDoesNotExist);
+	};
+	checkStore("");
+
+	/* A manifest written past the index falls back to parsing */
+	{
+		std::ofstream manifest(indexname + "/" +
+		    BE::IO::ArchiveRecordStore::MANIFEST_FILE_NAME,
+		    std::ios_base::app);
+		manifest << "key10 1 0\n";
+	}
+	checkStore("key10");
+
+	/* A writable store upgrades a missing index */
+	EXPECT_EQ(0, std::remove(indexPath.c_str()));
+	checkStore("key10");
+	EXPECT_FALSE(BE::IO::Utility::fileExists(indexPath));
+	{
+		BE::IO::ArchiveRecordStore rs(indexname,
+		    BE::IO::Mode::ReadWrite);
+	}
+	EXPECT_TRUE(BE::IO::Utility::fileExists(indexPath));
+	checkStore("key10");
+
+	/* A manifest rewritten at the same length is not served by the index */
+	const std::string manifestPath{indexname + "/" +
+	    BE::IO::ArchiveRecordStore::MANIFEST_FILE_NAME};
+	const auto renameKey = [&](const std::string &from,
+	    const std::string &to, bool inPlace) {
+		std::string contents;
+		{
+			std::ifstream manifest(manifestPath);
+			contents.assign(std::istreambuf_iterator<char>(
+			    manifest), std::istreambuf_iterator<char>());
+		}
+		const auto pos = contents.find(from + " ");
+		ASSERT_NE(std::string::npos, pos);
+		contents.replace(pos, from.length(), to);
+
+		/* Step past the granularity of modification times */
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		const std::string path{inPlace ? manifestPath :
+		    manifestPath + ".new"};
+		{
+			std::ofstream manifest(path);
+			manifest << contents;
+		}
+		if (!inPlace)
+			ASSERT_EQ(0, std::rename(path.c_str(),
+			    manifestPath.c_str()));
+	};
+	const auto checkRenamed = [&](const std::string &from,
+	    const std::string &to) {
+		BE::IO::ArchiveRecordStore rs(indexname, BE::IO::Mode::ReadOnly);
+		EXPECT_THROW(rs.read(from), BE::Error::ObjectDoesNotExist);
+		EXPECT_EQ(wdata.substr(0, 9), to_string(rs.read(to)));
+	};
+	const uint64_t manifestSize = BE::IO::Utility::getFileSize(
+	    manifestPath);
+	renameKey("key9", "keyZ", true);
+	EXPECT_EQ(manifestSize, BE::IO::Utility::getFileSize(manifestPath));
+	checkRenamed("key9", "keyZ");
+	renameKey("keyZ", "keyY", false);
+	EXPECT_EQ(manifestSize, BE::IO::Utility::getFileSize(manifestPath));
+	checkRenamed("keyZ", "keyY");
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(indexname));
+}
+
+TEST(ArchiveRecordStore, compact)
+{
+	const std::string compactname{rsname + "_compact"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	const auto value = [&](int i) {
+		return (wdata.substr(i % wdata.length()) + std::to_string(i));
+	};
+	{
+		BE::IO::ArchiveRecordStore rs(compactname, "compact");
+		EXPECT_EQ(0, rs.getSegmentSize());
+		rs.setSegmentSize(256);
+		EXPECT_EQ(256, rs.getSegmentSize());
+		for (int i = 0; i < 100; i++)
+			rs.insert("key" + std::to_string(i), value(i).c_str(),
+			    value(i).length());
+		for (int i = 0; i < 100; i += 3)
+			rs.remove("key" + std::to_string(i));
+		for (int i = 1; i < 100; i += 3)
+			rs.replace("key" + std::to_string(i),
+			    value(i + 1).c_str(), value(i + 1).length());
+		EXPECT_TRUE(rs.needsVacuum());
+		EXPECT_NE(rs.getArchiveName(), compactname + "/" +
+		    BE::IO::ArchiveRecordStore::ARCHIVE_FILE_NAME);
+	}
+	const auto check = [&](const BE::IO::RecordStore &rs) {
+		EXPECT_EQ(66, rs.getCount());
+		for (int i = 0; i < 100; i++) {
+			const std::string key{"key" + std::to_string(i)};
+			if ((i % 3) == 0)
+				EXPECT_THROW(rs.read(key),
+				    BE::Error::ObjectDoesNotExist);
+			else
+				EXPECT_EQ(value((i % 3) == 1 ? i + 1 : i),
+				    to_string(rs.read(key)));
+		}
+	};
+
+	{
+		/* Readers opened before compaction keep working */
+		BE::IO::ArchiveRecordStore reader(compactname,
+		    BE::IO::Mode::ReadOnly);
+		BE::IO::ArchiveRecordStore rs(compactname,
+		    BE::IO::Mode::ReadWrite);
+		EXPECT_EQ(256, rs.getSegmentSize());
+		const uint64_t startingSpace = rs.getSpaceUsed();
+
+		/* Sequencing continues across a pass */
+		EXPECT_EQ("key1", rs.sequenceKey());
+		unsigned int calls{0};
+		while (!rs.compact(64)) {
+			calls++;
+			check(rs);
+		}
+		EXPECT_GT(calls, 3);
+		EXPECT_EQ("key2", rs.sequenceKey());
+		EXPECT_FALSE(rs.needsVacuum());
+		EXPECT_TRUE(rs.compact());
+		EXPECT_GT(startingSpace, rs.getSpaceUsed());
+		check(rs);
+		check(reader);
+	}
+
+	{
+		BE::IO::ArchiveRecordStore rs(compactname,
+		    BE::IO::Mode::ReadOnly);
+		EXPECT_FALSE(rs.needsVacuum());
+		check(rs);
+		std::vector<std::string> keys{};
+		for (const auto &record : rs)
+			keys.push_back(record.key);
+		EXPECT_EQ(66, keys.size());
+	}
+
+	/* Removals during a pass leave the store needing another */
+	{
+		BE::IO::ArchiveRecordStore rs(compactname,
+		    BE::IO::Mode::ReadWrite);
+		rs.remove("key5");
+		EXPECT_FALSE(rs.compact(1));
+		rs.insert("extra", wdata.c_str(), wdata.length());
+		rs.remove("extra");
+		while (!rs.compact(64));
+		EXPECT_TRUE(rs.needsVacuum());
+		EXPECT_EQ(65, rs.getCount());
+	}
+	EXPECT_TRUE(BE::IO::ArchiveRecordStore::needsVacuum(compactname));
+	{
+		BE::IO::ArchiveRecordStore rs(compactname,
+		    BE::IO::Mode::ReadWrite);
+		while (!rs.compact());
+		EXPECT_FALSE(rs.needsVacuum());
+	}
+	EXPECT_FALSE(BE::IO::ArchiveRecordStore::needsVacuum(compactname));
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(compactname));
+}
+
+TEST(ArchiveRecordStore, writeBehind)
+{
+	const std::string wbname{rsname + "_writebehind"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	const auto value = [&](int i) {
+		return (wdata.substr(i % wdata.length()) + std::to_string(i));
+	};
+	{
+		BE::IO::ArchiveRecordStore rs(wbname, "writeBehind");
+		EXPECT_EQ(0, rs.getWriteBehind());
+		rs.setSegmentSize(1024);
+
+		/* A small buffer makes inserts wait on the writer */
+		rs.setWriteBehind(256);
+		EXPECT_EQ(256, rs.getWriteBehind());
+		for (int i = 0; i < 500; i++) {
+			rs.insert("key" + std::to_string(i), value(i).c_str(),
+			    value(i).length());
+
+			/* Records not yet written can be read */
+			if ((i % 50) == 0)
+				EXPECT_EQ(value(i), to_string(rs.read(
+				    "key" + std::to_string(i))));
+		}
+		for (int i = 0; i < 500; i += 5)
+			rs.remove("key" + std::to_string(i));
+		EXPECT_EQ(400, rs.getCount());
+		EXPECT_THROW(rs.insert("key1", wdata.c_str(), 1),
+		    BE::Error::ObjectExists);
+
+		/* Readers opened after sync() see every record */
+		rs.sync();
+		BE::IO::ArchiveRecordStore reader(wbname,
+		    BE::IO::Mode::ReadOnly);
+		EXPECT_EQ(400, reader.getCount());
+		EXPECT_EQ(value(499), to_string(reader.read("key499")));
+
+		rs.setWriteBehind(0);
+		EXPECT_EQ(0, rs.getWriteBehind());
+		rs.insert("last", wdata.c_str(), wdata.length());
+	}
+
+	BE::IO::ArchiveRecordStore rs(wbname, BE::IO::Mode::ReadOnly);
+	EXPECT_EQ(401, rs.getCount());
+	for (int i = 0; i < 500; i++) {
+		const std::string key{"key" + std::to_string(i)};
+		if ((i % 5) == 0)
+			EXPECT_THROW(rs.read(key),
+			    BE::Error::ObjectDoesNotExist);
+		else
+			EXPECT_EQ(value(i), to_string(rs.read(key)));
+	}
+	EXPECT_EQ(wdata, to_string(rs.read("last")));
+	EXPECT_THROW(rs.setWriteBehind(), BE::Error::StrategyError);
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(wbname));
+}
+
+TEST(ArchiveRecordStore, writeBehindFailure)
+{
+	const std::string failname{rsname + "_writefail"};
+	const std::string archive{failname + '/' +
+	    BE::IO::ArchiveRecordStore::ARCHIVE_FILE_NAME};
+	const std::string saved{archive + ".saved"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	{
+		BE::IO::ArchiveRecordStore rs(failname, "writeBehindFailure");
+		for (int i = 0; i < 10; i++)
+			rs.insert("key" + std::to_string(i), wdata.c_str(),
+			    i + 1);
+		rs.sync();
+
+		/* The writer cannot open a directory in place of the archive */
+		rs.setWriteBehind(1024 * 1024);
+		ASSERT_EQ(0, std::rename(archive.c_str(), saved.c_str()));
+		ASSERT_EQ(0, mkdir(archive.c_str(), S_IRWXU));
+		for (int i = 10; i < 15; i++)
+			rs.insert("key" + std::to_string(i), wdata.c_str(),
+			    i + 1);
+		EXPECT_EQ(15, rs.getCount());
+
+		/* The error is reported, and the store changes no further */
+		EXPECT_THROW(rs.sync(), BE::Error::StrategyError);
+		EXPECT_THROW(rs.sync(), BE::Error::StrategyError);
+		EXPECT_THROW(rs.insert("key15", wdata.c_str(), 1),
+		    BE::Error::StrategyError);
+		EXPECT_THROW(rs.remove("key0"), BE::Error::StrategyError);
+		EXPECT_THROW(rs.setWriteBehind(0), BE::Error::StrategyError);
+		EXPECT_EQ(15, rs.getCount());
+	}
+	ASSERT_EQ(0, rmdir(archive.c_str()));
+	ASSERT_EQ(0, std::rename(saved.c_str(), archive.c_str()));
+
+	/* The count is recovered from the records that were written */
+	{
+		BE::IO::ArchiveRecordStore rs(failname, BE::IO::Mode::ReadWrite);
+		EXPECT_EQ(10, rs.getCount());
+		EXPECT_EQ(wdata.substr(0, 10), to_string(rs.read("key9")));
+		EXPECT_THROW(rs.read("key10"), BE::Error::ObjectDoesNotExist);
+		rs.insert("key10", wdata.c_str(), 11);
+		EXPECT_EQ(11, rs.getCount());
+	}
+	BE::IO::ArchiveRecordStore rs(failname, BE::IO::Mode::ReadOnly);
+	EXPECT_EQ(11, rs.getCount());
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(failname));
+}
+
+TEST(ArchiveRecordStore, scan)
+{
+	const std::string scanname{rsname + "_scan"};
+	const auto value = [](int i) {
+		/* Every tenth record is larger than a scan chunk */
+		return (std::string(((i % 10) == 0) ? 10000 : (i % 100),
+		    'a' + (i % 26)) + std::to_string(i));
+	};
+
+	BE::IO::ArchiveRecordStore rs(scanname, "scan");
+	rs.setSegmentSize(64 * 1024);
+	for (int i = 0; i < 300; i++) {
+		if (i == 150)
+			rs.insert("empty", nullptr, 0);
+		rs.insert("key" + std::to_string(i), value(i).c_str(),
+		    value(i).length());
+	}
+	for (int i = 0; i < 300; i += 7)
+		rs.remove("key" + std::to_string(i));
+	rs.replace("key1", "replaced", 8);
+	EXPECT_THROW(rs.scan([](const std::string &,
+	    const BE::IO::RecordStore::RecordView &) {}, 0),
+	    BE::Error::StrategyError);
+
+	/* Records still buffered by the stream are scanned */
+	const auto check = [&](const BE::IO::ArchiveRecordStore &store,
+	    uint64_t chunkSize) {
+		std::vector<std::string> keys{};
+		const uint64_t count = store.scan(
+		    [&](const std::string &key,
+		    const BE::IO::RecordStore::RecordView &record) {
+			keys.push_back(key);
+			EXPECT_EQ(to_string(store.read(key)),
+			    std::string(reinterpret_cast<const char *>(
+			    record.data), record.size));
+		}, chunkSize);
+		EXPECT_EQ(store.getCount(), count);
+		EXPECT_EQ(count, keys.size());
+
+		/* Archive order, so the replaced record is last */
+		EXPECT_EQ("key2", keys.front());
+		EXPECT_EQ("key1", keys.back());
+		std::sort(keys.begin(), keys.end());
+		EXPECT_EQ(keys.end(), std::unique(keys.begin(), keys.end()));
+	};
+	check(rs, 1);
+	check(rs, BE::IO::ArchiveRecordStore::DEFAULT_SCAN_CHUNK_SIZE);
+
+	/* The visitor's exceptions end the scan */
+	uint64_t visited{0};
+	EXPECT_THROW(rs.scan([&](const std::string &,
+	    const BE::IO::RecordStore::RecordView &) {
+		if (++visited == 5)
+			throw BE::Error::ObjectDoesNotExist();
+	}), BE::Error::ObjectDoesNotExist);
+	EXPECT_EQ(5, visited);
+
+	rs.sync();
+	BE::IO::ArchiveRecordStore reader(scanname, BE::IO::Mode::ReadOnly);
+	check(reader, 64 * 1024);
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(scanname));
+}
+
+TEST(ArchiveRecordStore, sequenceExtents)
+{
+	const std::string extentsname{rsname + "_extents"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	{
+		BE::IO::ArchiveRecordStore rs(extentsname, "extents");
+		rs.setSegmentSize(256);
+		for (int i = 0; i < 60; i++) {
+			if (i == 30)
+				rs.insert("empty", nullptr, 0);
+			rs.insert("key" + std::to_string(i), wdata.c_str(),
+			    1 + (i % wdata.length()));
+		}
+		for (int i = 0; i < 60; i += 4)
+			rs.remove("key" + std::to_string(i));
+		rs.replace("key1", "replaced", 8);
+		while (!rs.compact(64));
+	}
+
+	/* Each extent holds the data of the record sequenced next */
+	const auto check = [&](BE::IO::ArchiveRecordStore &rs) {
+		const auto extents = rs.getSequenceExtents(
+		    std::numeric_limits<uint64_t>::max());
+		EXPECT_EQ(rs.getCount() - 1, extents.size());
+		EXPECT_TRUE(std::any_of(extents.cbegin(), extents.cend(),
+		    [&](const BE::IO::ArchiveRecordStore::Extent &e) {
+			return (e.file != extents.front().file);
+		    }));
+		auto extent = extents.cbegin();
+		for (const auto &record : rs) {
+			if (record.data.size() == 0)
+				continue;
+			ASSERT_NE(extents.cend(), extent);
+			EXPECT_EQ(record.data.size(), extent->size);
+			std::ifstream segment(extent->file,
+			    std::ios_base::in | std::ios_base::binary);
+			segment.seekg(extent->offset);
+			std::string data(extent->size, '\0');
+			segment.read(&data[0], data.size());
+			EXPECT_TRUE(segment.good());
+			EXPECT_EQ(to_string(record.data), data);
+			extent++;
+		}
+
+		/* Located from the cursor, without moving it */
+		rs.sequenceKey(BE::IO::RecordStore::BE_RECSTORE_SEQ_START);
+		rs.sequenceKey();
+		const auto next = rs.getSequenceExtents(1);
+		ASSERT_EQ(1, next.size());
+		EXPECT_EQ(extents[2].file, next[0].file);
+		EXPECT_EQ(extents[2].offset, next[0].offset);
+		EXPECT_EQ(rs.read(rs.sequenceKey()).size(), next[0].size);
+	};
+	{
+		BE::IO::ArchiveRecordStore rs(extentsname,
+		    BE::IO::Mode::ReadWrite);
+		check(rs);
+	}
+	{
+		BE::IO::ArchiveRecordStore rs(extentsname,
+		    BE::IO::Mode::ReadOnly);
+		check(rs);
+	}
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(extentsname));
+}
 #endif /* ARCHIVERECORDSTORETEST */
 
+#ifdef SQLITERECORDSTORETEST
+TEST(SQLiteRecordStore, insertBatch)
+{
+	const std::string batchname{rsname + "_batch"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	{
+		BE::IO::SQLiteRecordStore rs(batchname, "insertBatch");
+		EXPECT_NO_THROW(rs.setJournalProfile(BE::IO::SQLiteRecordStore::
+		    JournalProfile::WriteAheadLog));
+
+		std::vector<BE::IO::RecordStore::Record> records{};
+		for (int i = 0; i < SEQUENCECOUNT; i++) {
+			BE::Memory::uint8Array data(i);
+			data.copy(reinterpret_cast<const uint8_t *>(
+			    wdata.c_str()), i);
+			records.emplace_back("key" + std::to_string(i), data);
+		}
+		ASSERT_NO_THROW(rs.insertBatch(records));
+		EXPECT_EQ(SEQUENCECOUNT, rs.getCount());
+		EXPECT_EQ(wdata.substr(0, 7), to_string(rs.read("key7")));
+		EXPECT_EQ(0, rs.length("key0"));
+
+		/* A failed batch leaves no trace */
+		std::vector<BE::IO::RecordStore::Record> duplicate{
+		    records.front(), records.back()};
+		duplicate.front().key = "new";
+		EXPECT_THROW(rs.insertBatch(duplicate), BE::Error::ObjectExists);
+		EXPECT_EQ(SEQUENCECOUNT, rs.getCount());
+		EXPECT_FALSE(rs.containsKey("new"));
+
+		/* Single inserts still detect duplicates */
+		EXPECT_THROW(rs.insert("key3", wdata.c_str(), 3),
+		    BE::Error::ObjectExists);
+		EXPECT_NO_THROW(rs.insert("new", wdata.c_str(), 3));
+		EXPECT_EQ(SEQUENCECOUNT + 1, rs.getCount());
+
+		EXPECT_NO_THROW(rs.setJournalProfile(BE::IO::SQLiteRecordStore::
+		    JournalProfile::Default));
+	}
+
+	{
+		BE::IO::SQLiteRecordStore rs(batchname, BE::IO::Mode::ReadOnly);
+		EXPECT_EQ(SEQUENCECOUNT + 1, rs.getCount());
+		EXPECT_EQ(wdata.substr(0, 9), to_string(rs.read("key9")));
+		EXPECT_THROW(rs.insertBatch({}), BE::Error::StrategyError);
+	}
+
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(batchname));
+}
+#endif /* SQLITERECORDSTORETEST */
+
+#ifdef COMPRESSEDRECORDSTORETEST
+TEST(CompressedRecordStore, dictionary)
+{
+	const std::string dictname{rsname + "_dict"};
+	const std::string wdata{"<template format=\"ISO\" minutiae=\""};
+
+	std::vector<BE::Memory::uint8Array> samples{};
+	for (int i = 0; i < 1000; i++) {
+		const std::string sample{wdata + std::to_string(i * 7) +
+		    "\" quality=\"" + std::to_string(i % 100) +
+		    "\"/>"};
+		samples.emplace_back(sample.size());
+		samples.back().copy(reinterpret_cast<const uint8_t *>(
+		    sample.c_str()), sample.size());
+	}
+
+	for (const auto kind : {BE::IO::Compressor::Kind::ZSTD,
+	    BE::IO::Compressor::Kind::LZ4}) {
+		SCOPED_TRACE(BE::Framework::Enumeration::to_string(kind));
+		std::shared_ptr<BE::IO::CompressedRecordStore> rs;
+		try {
+			rs.reset(new BE::IO::CompressedRecordStore(dictname,
+			    "dictionary", BE::IO::RecordStore::Kind::SQLite,
+			    kind));
+		} catch (const BE::Error::NotImplemented &) {
+			BE::IO::RecordStore::removeRecordStore(dictname);
+			continue;
+		}
+		EXPECT_EQ(0, rs->getDictionary().size());
+		ASSERT_NO_THROW(rs->trainDictionary(samples, 4096));
+		EXPECT_NE(0, rs->getDictionary().size());
+		EXPECT_LE(rs->getDictionary().size(), 4096);
+		if (kind == BE::IO::Compressor::Kind::LZ4) {
+			/* Content common to every sample is included once */
+			const auto dictionary = to_string(
+			    rs->getDictionary());
+			EXPECT_NE(std::string::npos, dictionary.find(wdata));
+			EXPECT_EQ(dictionary.find(wdata),
+			    dictionary.rfind(wdata));
+
+			auto lz4 = BE::IO::Compressor::createCompressor(kind);
+			const auto plain = lz4->compress(samples[500]);
+			lz4->setDictionary(rs->getDictionary());
+			EXPECT_LT(lz4->compress(samples[500]).size(),
+			    plain.size());
+			EXPECT_EQ(to_string(samples[500]), to_string(
+			    lz4->decompress(lz4->compress(samples[500]))));
+		}
+
+		for (int i = 0; i < 10; i++)
+			ASSERT_NO_THROW(rs->insert("key" + std::to_string(i),
+			    samples[i]));
+		EXPECT_EQ(to_string(samples[3]), to_string(rs->read("key3")));
+		EXPECT_EQ(samples[3].size(), rs->length("key3"));
+
+		/* Changing dictionaries would orphan existing records */
+		EXPECT_THROW(rs->setDictionary({}), BE::Error::StrategyError);
+
+		/* Dictionary is reloaded on open */
+		const auto dictionary = rs->getDictionary();
+		rs.reset();
+		BE::IO::CompressedRecordStore ro(dictname,
+		    BE::IO::Mode::ReadOnly);
+		EXPECT_EQ(dictionary, ro.getDictionary());
+		EXPECT_EQ(to_string(samples[9]), to_string(ro.read("key9")));
+
+		EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(
+		    dictname));
+	}
+
+	/* Not every compressor supports dictionaries */
+	{
+		BE::IO::CompressedRecordStore gzip(dictname, "dictionary",
+		    BE::IO::RecordStore::Kind::SQLite,
+		    BE::IO::Compressor::Kind::GZIP);
+		EXPECT_THROW(gzip.trainDictionary(samples),
+		    BE::Error::NotImplemented);
+		EXPECT_EQ(0, gzip.getDictionary().size());
+	}
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(dictname));
+}
+
+TEST(CompressedRecordStore, recordHeader)
+{
+	const std::string layoutname{rsname + "_layout"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+
+	/* New stores keep the uncompressed size with each record */
+	{
+		BE::IO::CompressedRecordStore rs(layoutname, "recordHeader",
+		    BE::IO::RecordStore::Kind::SQLite,
+		    BE::IO::Compressor::Kind::GZIP);
+		rs.insert("key", wdata.c_str(), wdata.length());
+		rs.insert("empty", wdata.c_str(), 0);
+		EXPECT_EQ(wdata.length(), rs.length("key"));
+		EXPECT_EQ(0, rs.length("empty"));
+		EXPECT_EQ(wdata, to_string(rs.read("key")));
+		EXPECT_EQ(0, rs.read("empty").size());
+	}
+	EXPECT_FALSE(BE::IO::Utility::fileExists(layoutname +
+	    "/theBackingStore_md"));
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(layoutname));
+
+	/* Stores that keep sizes in a second RecordStore are still read */
+	{
+		BE::IO::CompressedRecordStore rs(layoutname, "recordHeader",
+		    BE::IO::RecordStore::Kind::SQLite,
+		    BE::IO::Compressor::Kind::GZIP);
+	}
+	{
+		BE::IO::PropertiesFile props(layoutname + "/.rscontrol.prop",
+		    BE::IO::Mode::ReadWrite);
+		props.removeProperty("Format_Version");
+		props.setPropertyFromInteger("Count", 1);
+		props.sync();
+	}
+	{
+		auto gzip = BE::IO::Compressor::createCompressor(
+		    BE::IO::Compressor::Kind::GZIP);
+		auto data = BE::IO::RecordStore::openRecordStore(
+		    layoutname + "/theBackingStore", BE::IO::Mode::ReadWrite);
+		data->insert("key", gzip->compress(reinterpret_cast<
+		    const uint8_t *>(wdata.c_str()), wdata.length()));
+		auto md = BE::IO::RecordStore::createRecordStore(
+		    layoutname + "/theBackingStore_md", "",
+		    BE::IO::RecordStore::Kind::SQLite);
+		const std::string size{std::to_string(wdata.length())};
+		md->insert("key", size.c_str(), size.length());
+	}
+	{
+		BE::IO::CompressedRecordStore rs(layoutname,
+		    BE::IO::Mode::ReadWrite);
+		EXPECT_EQ(wdata.length(), rs.length("key"));
+		EXPECT_EQ(wdata, to_string(rs.read("key")));
+		EXPECT_NO_THROW(rs.insert("key2", wdata.c_str(), 5));
+		EXPECT_EQ(5, rs.length("key2"));
+		EXPECT_EQ(wdata.substr(0, 5), to_string(rs.read("key2")));
+		EXPECT_NO_THROW(rs.remove("key"));
+		EXPECT_EQ(1, rs.getCount());
+	}
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(layoutname));
+}
+#endif /* COMPRESSEDRECORDSTORETEST */
+
+#ifdef SHARDEDRECORDSTORETEST
+TEST(ShardedRecordStore, shards)
+{
+	const std::string shardedname{rsname + "_sharded"};
+	const std::string movedname{shardedname + "_moved"};
+	const std::vector<std::string> shardnames{rsname + "_shard0",
+	    rsname + "_shard1", rsname + "_shard2"};
+	const std::string wdata{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+	const int threadCount = 4;
+	const int keysPerThread = 25;
+	const auto keyName = [](int thread, int i) {
+		return ("t" + std::to_string(thread) + "k" + std::to_string(i));
+	};
+
+	EXPECT_THROW(BE::IO::ShardedRecordStore(shardedname, "Sharded",
+	    BE::IO::RecordStore::Kind::SQLite, 0), BE::Error::ParameterError);
+	EXPECT_THROW(BE::IO::ShardedRecordStore(shardedname, "Sharded",
+	    BE::IO::RecordStore::Kind::List, 2), BE::Error::ParameterError);
+	EXPECT_FALSE(BE::IO::Utility::fileExists(shardedname));
+
+	std::vector<std::string> shardPathnames{};
+	{
+		BE::IO::ShardedRecordStore rs(shardedname, "Sharded",
+		    BE::IO::RecordStore::Kind::SQLite, shardnames);
+		ASSERT_EQ(shardnames.size(), rs.getShardCount());
+		shardPathnames = rs.getShardPathnames();
+		ASSERT_EQ(shardnames.size(), shardPathnames.size());
+		for (size_t i = 0; i < shardnames.size(); i++) {
+			EXPECT_EQ('/', shardPathnames[i][0]);
+			EXPECT_TRUE(BE::IO::Utility::fileExists(
+			    shardPathnames[i]));
+		}
+
+		/* Insert from several threads at once */
+		std::vector<std::thread> threads{};
+		for (int t = 0; t < threadCount; t++)
+			threads.emplace_back([&, t]() {
+				for (int i = 0; i < keysPerThread; i++)
+					EXPECT_NO_THROW(rs.insert(keyName(t, i),
+					    wdata.c_str(), i));
+			});
+		for (auto &thread : threads)
+			thread.join();
+		EXPECT_EQ(threadCount * keysPerThread, rs.getCount());
+		EXPECT_THROW(rs.insert(keyName(0, 0), wdata.c_str(), 1),
+		    BE::Error::ObjectExists);
+		EXPECT_NO_THROW(rs.sync());
+
+		/* Records are spread over the shards, and counted from them */
+		unsigned int count = 0;
+		uint64_t spaceUsed = 0;
+		for (const auto &shardPathname : shardPathnames) {
+			const auto shard = BE::IO::RecordStore::openRecordStore(
+			    shardPathname);
+			EXPECT_GT(shard->getCount(), 0);
+			count += shard->getCount();
+			spaceUsed += shard->getSpaceUsed();
+		}
+		EXPECT_EQ(rs.getCount(), count);
+		EXPECT_GT(rs.getSpaceUsed(), spaceUsed);
+	}
+
+	auto rs = BE::IO::RecordStore::openRecordStore(shardedname,
+	    BE::IO::Mode::ReadWrite);
+	ASSERT_NE(nullptr, std::dynamic_pointer_cast<BE::IO::ShardedRecordStore>(
+	    rs));
+	EXPECT_EQ(threadCount * keysPerThread, rs->getCount());
+
+	/* Every record is sequenced once, with or without data */
+	std::vector<std::string> keys{};
+	for (const auto &record : *rs) {
+		const uint64_t size = std::stoul(record.key.substr(
+		    record.key.find('k') + 1));
+		EXPECT_EQ(wdata.substr(0, size), to_string(record.data));
+		keys.push_back(record.key);
+	}
+	std::vector<std::string> expectedKeys{};
+	for (int t = 0; t < threadCount; t++)
+		for (int i = 0; i < keysPerThread; i++)
+			expectedKeys.push_back(keyName(t, i));
+	std::sort(keys.begin(), keys.end());
+	std::sort(expectedKeys.begin(), expectedKeys.end());
+	EXPECT_EQ(expectedKeys, keys);
+
+	keys.clear();
+	try {
+		keys.push_back(rs->sequenceKey(
+		    BE::IO::RecordStore::BE_RECSTORE_SEQ_START));
+		for (;;)
+			keys.push_back(rs->sequenceKey());
+	} catch (const BE::Error::ObjectDoesNotExist&) {}
+	std::sort(keys.begin(), keys.end());
+	EXPECT_EQ(expectedKeys, keys);
+
+	/* Sequencing continues from the cursor's key */
+	EXPECT_THROW(rs->setCursorAtKey("missing"),
+	    BE::Error::ObjectDoesNotExist);
+	EXPECT_NO_THROW(rs->setCursorAtKey(keyName(2, 7)));
+	BE::IO::RecordStore::Record record{};
+	EXPECT_NO_THROW(record = rs->sequence());
+	EXPECT_EQ(keyName(2, 7), record.key);
+	EXPECT_EQ(wdata.substr(0, 7), to_string(record.data));
+	size_t remaining = 0;
+	try {
+		for (;;) {
+			rs->sequence();
+			remaining++;
+		}
+	} catch (const BE::Error::ObjectDoesNotExist&) {}
+	EXPECT_LT(remaining, expectedKeys.size());
+
+	/* Several keys at once */
+	std::vector<BE::Memory::uint8Array> records{};
+	ASSERT_NO_THROW(records = rs->read(std::vector<std::string>{
+	    keyName(0, 1), keyName(3, 20), keyName(0, 1)}));
+	ASSERT_EQ(3, records.size());
+	EXPECT_EQ(wdata.substr(0, 1), to_string(records[0]));
+	EXPECT_EQ(wdata.substr(0, 20), to_string(records[1]));
+	EXPECT_EQ(wdata.substr(0, 1), to_string(records[2]));
+	EXPECT_THROW(rs->read(std::vector<std::string>{keyName(0, 1),
+	    "missing"}), BE::Error::ObjectDoesNotExist);
+
+	EXPECT_NO_THROW(rs->replace(keyName(0, 1), wdata.c_str(), 5));
+	EXPECT_EQ(5, rs->length(keyName(0, 1)));
+	EXPECT_NO_THROW(rs->remove(keyName(1, 1)));
+	EXPECT_FALSE(rs->containsKey(keyName(1, 1)));
+	EXPECT_EQ(threadCount * keysPerThread - 1, rs->getCount());
+
+	/* Shards elsewhere stay in place when moved, and are removed */
+	EXPECT_NO_THROW(rs->move(movedname));
+	EXPECT_EQ(threadCount * keysPerThread - 1, rs->getCount());
+	EXPECT_EQ(wdata.substr(0, 20), to_string(rs->read(keyName(3, 20))));
+	rs.reset();
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(movedname));
+	for (const auto &shardPathname : shardPathnames)
+		EXPECT_FALSE(BE::IO::Utility::fileExists(shardPathname));
+
+	/* Shards within the store move with it */
+	{
+		BE::IO::ShardedRecordStore inner(shardedname, "Sharded",
+		    BE::IO::RecordStore::Kind::SQLite, 2);
+		EXPECT_NO_THROW(inner.insert(keyName(0, 3), wdata.c_str(), 3));
+		EXPECT_NO_THROW(inner.move(movedname));
+		EXPECT_EQ(0, inner.getShardPathnames()[0].find(movedname));
+		EXPECT_EQ(wdata.substr(0, 3), to_string(inner.read(
+		    keyName(0, 3))));
+	}
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(movedname));
+	EXPECT_FALSE(BE::IO::Utility::fileExists(movedname));
+}
+#endif /* SHARDEDRECORDSTORETEST */
+
 int
 main(
     int argc,
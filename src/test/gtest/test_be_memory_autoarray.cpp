@@ -9,12 +9,15 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <string>
 #include <vector>
 
 #include <be_error_exception.h>
 #include <be_memory_autoarray.h>
 #include <be_memory_autoarrayiterator.h>
+#include <be_time_timer.h>
 
 #include <gtest/gtest.h>
 
@@ -175,3 +178,95 @@ TEST(AutoArray, Assignment)
 	EXPECT_EQ(a1[25], a3[25]);
 }
 
+
+TEST(AutoArray, Append)
+{
+	BE::Memory::AutoArray<std::string> aa;
+	EXPECT_EQ(aa.capacity(), 0);
+
+	aa.reserve(10);
+	EXPECT_EQ(aa.size(), 0);
+	EXPECT_EQ(aa.capacity(), 10);
+	aa.reserve(5);
+	EXPECT_EQ(aa.capacity(), 10);
+
+	const std::string letters[] = {"A", "B", "C"};
+	for (uint8_t i = 0; i < 8; i++)
+		aa.append(letters, 3);
+	EXPECT_EQ(aa.size(), 24);
+	EXPECT_GE(aa.capacity(), 24);
+	for (uint8_t i = 0; i < 24; i++)
+		EXPECT_EQ(aa[i], letters[i % 3]);
+
+	/* Shrinking keeps the storage for later appends */
+	const auto capacity = aa.capacity();
+	aa.resize(1);
+	aa.append(letters, 0);
+	aa.append(&letters[2], 1);
+	EXPECT_EQ(aa.size(), 2);
+	EXPECT_EQ(aa.capacity(), capacity);
+	EXPECT_EQ(aa[0], "A");
+	EXPECT_EQ(aa[1], "C");
+
+	/* Copies have only the storage they need */
+	const BE::Memory::AutoArray<std::string> copy(aa);
+	EXPECT_EQ(copy.capacity(), 2);
+}
+
+/*
+ * Build a 16 MB package from 10000 records by appending, as the MPI
+ * distributors do. Resizing to fit each record instead copies the package
+ * for every record, so only the start of the package is built that way.
+ */
+TEST(AutoArray, AppendPackage)
+{
+	const uint64_t recordCount{10000};
+	const uint64_t resizedRecordCount{500};
+	BE::Memory::uint8Array record((16 * 1024 * 1024) / recordCount);
+	for (uint64_t i = 0; i < record.size(); i++)
+		record[i] = i;
+
+	BE::Time::Timer resizeTimer, appendTimer;
+	BE::Memory::uint8Array resized(16384), appended(16384);
+	uint64_t resizedCount{0}, appendedCount{0};
+
+	resizeTimer.start();
+	resized.resize(0);
+	for (uint64_t i = 0; i < resizedRecordCount; i++) {
+		const auto index = resized.size();
+		const auto capacity = resized.capacity();
+		resized.resize(index + record.size());
+		std::copy(record.cbegin(), record.cend(), &resized[index]);
+		if (resized.capacity() != capacity)
+			resizedCount++;
+	}
+	resizeTimer.stop();
+
+	appendTimer.start();
+	appended.resize(0);
+	for (uint64_t i = 0; i < recordCount; i++) {
+		const auto capacity = appended.capacity();
+		appended.append(record, record.size());
+		if (appended.capacity() != capacity)
+			appendedCount++;
+	}
+	appendTimer.stop();
+
+	EXPECT_EQ(appended.size(), recordCount * record.size());
+	EXPECT_TRUE(std::equal(resized.cbegin(), resized.cend(),
+	    appended.cbegin()));
+	EXPECT_TRUE(std::equal(record.cbegin(), record.cend(),
+	    appended.cend() - record.size()));
+
+	/* Reallocations are logarithmic in the size of the package */
+	EXPECT_LE(appendedCount, 11);
+	EXPECT_GT(resizedCount, resizedRecordCount / 2);
+
+	std::cout << "\tresize(), " << resizedRecordCount << " records: " <<
+	    resizedCount << " reallocations, " <<
+	    resizeTimer.elapsedStr<std::chrono::microseconds>(true) <<
+	    "\n\tappend(), " << recordCount << " records: " <<
+	    appendedCount << " reallocations, " <<
+	    appendTimer.elapsedStr<std::chrono::microseconds>(true) <<
+	    std::endl;
+}
@@ -0,0 +1,75 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <be_error_exception.h>
+#include <be_memory_bloomfilter.h>
+
+namespace BE = BiometricEvaluation;
+
+static const uint64_t capacity = 10000;
+
+TEST(BloomFilter, Construction)
+{
+	EXPECT_THROW(BE::Memory::BloomFilter(0), BE::Error::ParameterError);
+	EXPECT_THROW(BE::Memory::BloomFilter(capacity, 0),
+	    BE::Error::ParameterError);
+	EXPECT_THROW(BE::Memory::BloomFilter(capacity, 1),
+	    BE::Error::ParameterError);
+
+	BE::Memory::BloomFilter filter(capacity);
+	EXPECT_EQ(capacity, filter.getCapacity());
+	EXPECT_EQ(0, filter.getSize());
+	EXPECT_LT(0, filter.getHashCount());
+	EXPECT_FALSE(filter.getBits().empty());
+}
+
+TEST(BloomFilter, Membership)
+{
+	BE::Memory::BloomFilter filter(capacity);
+	for (uint64_t i = 0; i < capacity; i++)
+		filter.insert("key" + std::to_string(i));
+	EXPECT_EQ(capacity, filter.getSize());
+
+	/* No false negatives */
+	for (uint64_t i = 0; i < capacity; i++)
+		EXPECT_TRUE(filter.mayContain("key" + std::to_string(i)));
+
+	/* False positives near the rate the filter was sized for */
+	uint64_t falsePositives{0};
+	for (uint64_t i = capacity; i < (2 * capacity); i++)
+		if (filter.mayContain("key" + std::to_string(i)))
+			falsePositives++;
+	EXPECT_GT(capacity *
+	    (3 * BE::Memory::BloomFilter::DEFAULT_FALSE_POSITIVE_RATE),
+	    falsePositives);
+}
+
+TEST(BloomFilter, Restore)
+{
+	BE::Memory::BloomFilter filter(capacity);
+	for (uint64_t i = 0; i < 100; i++)
+		filter.insert("key" + std::to_string(i));
+
+	BE::Memory::BloomFilter restored(filter.getCapacity(),
+	    filter.getSize(), filter.getHashCount(), filter.getBits());
+	EXPECT_EQ(filter.getSize(), restored.getSize());
+	for (uint64_t i = 0; i < 100; i++)
+		EXPECT_TRUE(restored.mayContain("key" + std::to_string(i)));
+
+	EXPECT_THROW(BE::Memory::BloomFilter(capacity, 0, 0, filter.getBits()),
+	    BE::Error::ParameterError);
+	EXPECT_THROW(BE::Memory::BloomFilter(capacity, 0, 1, {}),
+	    BE::Error::ParameterError);
+}
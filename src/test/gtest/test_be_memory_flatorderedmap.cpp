@@ -0,0 +1,139 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include <be_memory_flatorderedmap.h>
+
+namespace BE = BiometricEvaluation;
+
+TEST(FlatOrderedMap, push_back)
+{
+	auto fmap = BE::Memory::FlatOrderedMap<std::string, uint64_t>();
+	EXPECT_TRUE(fmap.empty());
+	EXPECT_TRUE(fmap.push_back(std::make_pair("One", 1)));
+	EXPECT_TRUE(fmap.push_back(std::make_pair("Two", 2)));
+	EXPECT_TRUE(fmap.push_back(std::make_pair("Three", 3)));
+	EXPECT_FALSE(fmap.push_back(std::make_pair("Two", 22)));
+
+	EXPECT_EQ(fmap.size(), 3);
+	EXPECT_EQ(fmap["One"], 1);
+	EXPECT_EQ(fmap["Two"], 2);
+	EXPECT_EQ(fmap["Three"], 3);
+}
+
+TEST(FlatOrderedMap, ordering)
+{
+	auto fmap = BE::Memory::FlatOrderedMap<char, char>();
+	for (const char c : std::string("zabwq"))
+		fmap[c] = c;
+	fmap['a'] = 'A';
+
+	std::string combined{}, values{};
+	for (auto it = fmap.cbegin(); it != fmap.cend(); ++it) {
+		combined += it->first;
+		values += it->second;
+	}
+	EXPECT_EQ("zabwq", combined);
+	EXPECT_EQ("zAbwq", values);
+
+	combined.clear();
+	for (auto it = fmap.end(); it != fmap.begin(); )
+		combined += (--it)->first;
+	EXPECT_EQ("qwbaz", combined);
+}
+
+TEST(FlatOrderedMap, find)
+{
+	auto fmap = BE::Memory::FlatOrderedMap<std::string, uint64_t>();
+	for (uint64_t i = 0; i < 1000; i++)
+		fmap[std::to_string(i)] = i;
+	EXPECT_EQ(fmap.size(), 1000);
+
+	/* Heterogeneous lookup */
+	const std::string_view key{"500"};
+	const auto it = fmap.find(key);
+	ASSERT_NE(it, fmap.end());
+	EXPECT_EQ(it->second, 500);
+	EXPECT_TRUE(fmap.keyExists("999"));
+	EXPECT_FALSE(fmap.keyExists(std::string_view("1000")));
+	EXPECT_EQ(fmap.find("1000"), fmap.cend());
+
+	/* Values are modified in place through iterators */
+	it->second = 5000;
+	EXPECT_EQ(fmap["500"], 5000);
+
+	/* Iterators remain valid as elements are added */
+	const auto first = fmap.cbegin();
+	for (uint64_t i = 1000; i < 5000; i++)
+		fmap[std::to_string(i)] = i;
+	EXPECT_EQ(first->first, "0");
+	EXPECT_EQ(it->first, "500");
+
+	const auto &cmap = fmap;
+	for (uint64_t i = 0; i < 5000; i++) {
+		const auto found = cmap.find(std::to_string(i));
+		ASSERT_NE(found, cmap.end());
+		EXPECT_EQ(found->second, (i == 500 ? 5000 : i));
+	}
+}
+
+TEST(FlatOrderedMap, erase)
+{
+	auto fmap = BE::Memory::FlatOrderedMap<std::string, uint64_t>();
+	for (uint64_t i = 0; i < 100; i++)
+		fmap[std::to_string(i)] = i;
+
+	EXPECT_EQ(fmap.erase("1000"), 0);
+	for (uint64_t i = 0; i < 100; i += 2)
+		EXPECT_EQ(fmap.erase(std::to_string(i)), 1);
+	auto next = fmap.erase(fmap.find("51"));
+	EXPECT_EQ(next->first, "53");
+	EXPECT_EQ(fmap.size(), 49);
+
+	uint64_t expected = 1;
+	for (const auto &element : fmap) {
+		if (expected == 51)
+			expected += 2;
+		EXPECT_EQ(element.second, expected);
+		EXPECT_EQ(fmap.find(element.first)->second, expected);
+		expected += 2;
+	}
+	EXPECT_FALSE(fmap.keyExists("50"));
+	EXPECT_FALSE(fmap.keyExists("51"));
+
+	/* Erased keys are added at the end */
+	fmap["50"] = 50;
+	EXPECT_EQ((--fmap.end())->first, "50");
+
+	fmap.clear();
+	EXPECT_EQ(fmap.size(), 0);
+	EXPECT_EQ(fmap.begin(), fmap.end());
+	EXPECT_FALSE(fmap.keyExists("1"));
+	fmap["1"] = 1;
+	EXPECT_EQ(fmap.size(), 1);
+}
+
+TEST(FlatOrderedMap, reserve)
+{
+	auto fmap = BE::Memory::FlatOrderedMap<uint64_t, uint64_t>();
+	fmap.reserve(10000);
+	for (uint64_t i = 0; i < 10000; i++)
+		EXPECT_TRUE(fmap.insert(std::make_pair(i * 64, i)).second);
+	for (uint64_t i = 0; i < 10000; i++)
+		EXPECT_EQ(fmap.find(i * 64)->second, i);
+
+	EXPECT_THROW(fmap.reserve(UINT64_C(1) << 33), std::length_error);
+}
@@ -12,6 +12,7 @@
 
 #ifdef FORK
 #include <csignal>
+#include <cstring>
 #endif
 
 #include <be_io_recordstore.h>
@@ -179,6 +180,37 @@ public:
 };
 
 #ifdef FORK
+/**
+ * @brief
+ * Worker to test messages passed through shared memory.
+ * @details
+ * Replies to each message with the sum of its octets, until receiving
+ * an empty message.
+ */
+class SumWorker : public BE::Process::Worker
+{
+public:
+	int32_t
+	workerMain()
+	{
+		BE::Memory::uint8Array message;
+		while (this->waitForMessage()) {
+			this->receiveMessageFromManager(message);
+			if (message.size() == 0)
+				break;
+
+			uint64_t sum = 0;
+			for (const auto &c : message)
+				sum += c;
+			message.resize(sizeof(sum));
+			std::memcpy(message, &sum, sizeof(sum));
+			this->sendMessageToManager(message);
+		}
+
+		return (0);
+	}
+};
+
 static bool signalHandled = false;
 static void
 signalHandler(
@@ -400,6 +432,65 @@ TEST(ProcessManager, ManagerWorker)
 }
 
 #ifdef FORK
+TEST(ProcessManager, SharedMemory)
+{
+	std::unique_ptr<BE::Process::ForkManager> manager(
+	    new BE::Process::ForkManager());
+	EXPECT_EQ(0, manager->getSharedMemorySize());
+	manager->setSharedMemorySize(1024);
+	EXPECT_EQ(1024, manager->getSharedMemorySize());
+
+	auto worker = manager->addWorker(
+	    std::shared_ptr<SumWorker>(new SumWorker()));
+	manager->startWorkers(false, true);
+
+	const auto fill = [](BE::Memory::uint8Array &message, uint64_t size) {
+		uint64_t sum = 0;
+		message.resize(size);
+		for (uint64_t i = 0; i < size; i++) {
+			message[i] = static_cast<uint8_t>((i * 7) + size);
+			sum += message[i];
+		}
+		return (sum);
+	};
+
+	/*
+	 * Sizes that wrap around the end of the buffer, that fill it
+	 * exactly, and that do not fit and are sent through the pipe.
+	 */
+	BE::Memory::uint8Array message;
+	std::shared_ptr<BE::Process::WorkerController> sender;
+	for (const uint64_t size : {100, 1000, 700, 1024, 5000, 1, 999}) {
+		const uint64_t expected = fill(message, size);
+		worker->sendMessageToWorker(message);
+
+		ASSERT_TRUE(manager->getNextMessage(sender, message,
+		    std::chrono::seconds(10)));
+		uint64_t sum;
+		std::memcpy(&sum, message, sizeof(sum));
+		EXPECT_EQ(expected, sum);
+	}
+
+	/* Several messages queued in the buffer at once */
+	uint64_t expected[3];
+	for (auto &e : expected) {
+		e = fill(message, 300 + (&e - expected));
+		worker->sendMessageToWorker(message);
+	}
+	for (const auto &e : expected) {
+		ASSERT_TRUE(manager->getNextMessage(sender, message, 10));
+		uint64_t sum;
+		std::memcpy(&sum, message, sizeof(sum));
+		EXPECT_EQ(e, sum);
+	}
+
+	message.resize(0);
+	worker->sendMessageToWorker(message);
+	manager->waitForWorkerExit();
+	EXPECT_EQ(1, manager->getNumCompletedWorkers());
+	EXPECT_EQ(0, worker->getExitStatus());
+}
+
 TEST(ProcessManager, Signals)
 {
 	std::unique_ptr<BE::Process::ForkManager> manager(
@@ -15,6 +15,13 @@ CHKPATH=/tmp
 # Create the properties file for this run
 #
 # Logsheet URL is used by the framework for logging and is optional.
+# Pipeline Depth is used by the framework to request work packages ahead
+# of the workers and is optional.
+# Worker Message Buffer Size is used by the framework to pass work packages
+# to workers through shared memory and is optional.
+# Chunk Policy and Minimum Chunk Size are used by the framework to size
+# work packages and are optional; with the Guided policy, Chunk Size is
+# the largest package.
 # Record Logsheet URL is defined and used by the application and is
 # optional in the test_be_rs_mpi program.
 #
@@ -103,10 +110,14 @@ time mpirun -x LD_LIBRARY_PATH -x DYLD_LIBRARY_PATH -mca btl tcp,self --hostfile
 #
 cat > $PROPS << EOF
 Input CSV = $INPUTCSV
-Chunk Size = 1
+Chunk Size = 4
+Chunk Policy = Guided
+Minimum Chunk Size = 1
 Read Entire File = YES
 Randomize Lines = YES
 Workers Per Node = 2
+Pipeline Depth = 2
+Worker Message Buffer Size = 1048576
 Logsheet URL = file://mpi.log
 Record Logsheet URL = file://csv.log
 #Logsheet URL = syslog://linc01b:2514
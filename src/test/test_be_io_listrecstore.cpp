@@ -1,4 +1,5 @@
 
+#include <fstream>
 #include <iostream>
 
 #include <be_io_listrecstore.h>
@@ -119,6 +120,88 @@ int main(
 		return (8);
 	}
 
+	/*
+	 * Set cursor at a key not in the list, then at the first key,
+	 * both found through the key list index.
+	 */
+	cout << "Set cursor at nonexistent key... ";
+	try {
+		rs->setCursorAtKey("nonexistent");
+		cout << "FAIL." << endl;
+		return (8);
+	} catch (const Error::ObjectDoesNotExist &e) {
+		cout << "SUCCESS: " << e.what() << endl;
+	} catch (const Error::Exception &e) {
+		cout << "FAIL: " << e.what() << endl;
+		return (8);
+	}
+
+	cout << "Set cursor at first key, then sequence (" << numRecords <<
+	    ")... ";
+	counter = 0;
+	try {
+		rs->setCursorAtKey("B001.AN2");
+		for (;;) {
+			key = rs->sequenceKey();
+			counter++;
+		}
+	} catch (const Error::ObjectDoesNotExist&) {
+	} catch (const Error::Exception &e) {
+		cout << "FAIL: " << e.what() << endl;
+		return (8);
+	}
+	if (counter == numRecords)
+		cout << "SUCCESS" << endl;
+	else {
+		cout << "FAIL" << endl;
+		return (8);
+	}
+
+	/*
+	 * Fill the buckets of the saved key list index with 0xFF, keeping
+	 * its header, so every bucket is in use and points past the key
+	 * list. Lookups must rebuild the index rather than follow it.
+	 */
+	cout << "Set cursor through a damaged key list index... ";
+	const string indexName{"test_data/listRecordStore/KeyList.idx"};
+	fstream indexFile(indexName, ios_base::in | ios_base::out |
+	    ios_base::binary);
+	if (!indexFile) {
+		cout << "SKIPPED: index was not saved" << endl;
+	} else {
+		/* Size of the index header */
+		static const streamoff INDEXHEADERSIZE = 48;
+		indexFile.seekg(0, ios_base::end);
+		const string damage(indexFile.tellg() - INDEXHEADERSIZE,
+		    '\xFF');
+		indexFile.seekp(INDEXHEADERSIZE);
+		indexFile.write(damage.data(), damage.size());
+		indexFile.close();
+		try {
+			rs = IO::RecordStore::openRecordStore(
+			    "test_data/listRecordStore", IO::Mode::ReadOnly);
+			rs->setCursorAtKey("B004.AN2");
+			key = rs->sequenceKey();
+		} catch (const Error::Exception &e) {
+			cout << "FAIL: " << e.what() << endl;
+			return (8);
+		}
+		if (key != "B004.AN2") {
+			cout << "FAIL" << endl;
+			return (8);
+		}
+		try {
+			rs->setCursorAtKey("nonexistent");
+			cout << "FAIL." << endl;
+			return (8);
+		} catch (const Error::ObjectDoesNotExist &) {
+			cout << "SUCCESS" << endl;
+		} catch (const Error::Exception &e) {
+			cout << "FAIL: " << e.what() << endl;
+			return (8);
+		}
+	}
+
 	/*
 	 * Try the imvalid methods of a ListRecordStore
 	 */
@@ -47,6 +47,9 @@ using namespace std;
 
 //const int RECCOUNT = 1099997;		/* A prime number of records */
 const int RECCOUNT = 110503;		/* A prime number of records */
+static int recCount = RECCOUNT;		/* Overridden by argv[1] */
+static uint64_t timeCap = 0;		/* Seconds, 0 for none, argv[2] */
+const int SEEKCOUNT = 1000;		/* Keys found by setCursorAtKey() */
 const int RECSIZE = 1153;		/* of prime number size each */
 //const int RECSIZE = 13859;		/* of prime number size each */
 const int KEYNAMESIZE = 32;
@@ -64,8 +67,8 @@ static int insertMany(IO::RecordStore *rs)
 	string theKey;
 	totalTime = 0;
 	Memory::uint8Array theData(RECSIZE);
-	cout << "Creating " << RECCOUNT << " records of size " << RECSIZE << "." << endl;
-	for (int i = 0; i < RECCOUNT; i++) {
+	cout << "Creating " << recCount << " records of size " << RECSIZE << "." << endl;
+	for (int i = 0; i < recCount; i++) {
 		snprintf(keyName, KEYNAMESIZE, "key%u", i);
 		theKey = keyName;
 		gettimeofday(&starttm, nullptr);
@@ -86,14 +89,122 @@ static int insertMany(IO::RecordStore *rs)
 	return (0);
 }
 
+/*
+ * Whether a timed loop that started at starttm has run past timeCap.
+ */
+static bool pastTimeCap()
+{
+	if (timeCap == 0)
+		return (false);
+	gettimeofday(&endtm, nullptr);
+	return (static_cast<uint64_t>(TIMEINTERVAL(starttm, endtm)) >=
+	    (timeCap * 1000000));
+}
+
+/*
+ * Sequence through the entire RecordStore, with or without the record data,
+ * checking that every record is visited exactly once. A pass that runs
+ * past the time cap is stopped, and the number of records reached is
+ * reported.
+ */
+static int sequenceAll(IO::RecordStore *rs, bool withData)
+{
+	int count = 0;
+	bool capped = false;
+	int cursor = IO::RecordStore::BE_RECSTORE_SEQ_START;
+	gettimeofday(&starttm, nullptr);
+	while (true) {
+		try {
+			if (withData)
+				(void)rs->sequence(cursor);
+			else
+				(void)rs->sequenceKey(cursor);
+		} catch (const Error::ObjectDoesNotExist& e) {
+			break;
+		} catch (const Error::StrategyError& e) {
+			cout << "Could not sequence record " << count << ": " <<
+			    e.what() << "." << endl;
+			return (-1);
+		}
+		cursor = IO::RecordStore::BE_RECSTORE_SEQ_NEXT;
+		count++;
+		if (pastTimeCap()) {
+			cout << (withData ? "Sequence" : "Sequence key") <<
+			    " stopped at time cap after " << count << " of " <<
+			    recCount << " records" << endl;
+			capped = true;
+			break;
+		}
+	}
+	gettimeofday(&endtm, nullptr);
+	totalTime = TIMEINTERVAL(starttm, endtm);
+	if ((count != recCount) && !capped) {
+		cout << "Whoops! Sequenced " << count << " records, expected " <<
+		    recCount << "." << endl;
+		return (-1);
+	}
+	cout << (withData ? "Sequence" : "Sequence key") << " lapsed time: " <<
+	    totalTime << endl;
+	return (0);
+}
+
+/*
+ * Position the cursor at random keys, checking that sequencing continues
+ * from each one.
+ */
+static int seekMany(IO::RecordStore *rs)
+{
+	int count = 0;
+	gettimeofday(&starttm, nullptr);
+	for (; count < SEEKCOUNT; count++) {
+		snprintf(keyName, KEYNAMESIZE, "key%u",
+		    (unsigned int)(rand() % recCount));
+		try {
+			rs->setCursorAtKey(keyName);
+			if (rs->sequenceKey() != keyName) {
+				cout << "Whoops! Cursor not at " << keyName <<
+				    "." << endl;
+				return (-1);
+			}
+		} catch (const Error::Exception& e) {
+			cout << "Could not find " << keyName << ": " <<
+			    e.what() << "." << endl;
+			return (-1);
+		}
+		if (pastTimeCap()) {
+			cout << "Set cursor stopped at time cap after " <<
+			    count + 1 << " of " << SEEKCOUNT << " keys" << endl;
+			break;
+		}
+	}
+	gettimeofday(&endtm, nullptr);
+	totalTime = TIMEINTERVAL(starttm, endtm);
+	cout << "Set cursor lapsed time: " << totalTime << endl;
+	return (0);
+}
+
 /*
  * Test the read and write operations of a RecordStore, hopefully stressing
  * it enough to gain confidence in its operation. This program should be
  * able to test any implementation of the abstract RecordStore by creating
  * an object of the appropriate implementation class.
+ *
+ * The number of records may be given as the first argument, e.g. 1000000,
+ * to measure how the store scales. A time cap in seconds may follow, after
+ * which sequencing and cursor tests stop and report how far they reached.
  */
 int main (int argc, char* argv[]) {
 
+	if (argc > 1)
+		recCount = atoi(argv[1]);
+	if (argc > 2)
+		timeCap = strtoull(argv[2], nullptr, 10);
+	if (recCount <= 0) {
+		cout << "Usage: " << argv[0] << " [record count "
+		    "[time cap in seconds]]" << endl;
+		return (EXIT_FAILURE);
+	}
+
 	/*
 	 * Other types of RecordStore objects can be created here and
 	 * accessed via the RecordStore interface.
@@ -205,9 +316,9 @@ int main (int argc, char* argv[]) {
 	Memory::uint8Array theData(RECSIZE);
 	srand(endtm.tv_sec);
 	totalTime = 0;
-	for (int i = 0; i < RECCOUNT; i++) {
+	for (int i = 0; i < recCount; i++) {
 		snprintf(keyName, KEYNAMESIZE, "key%u", 
-		    (unsigned int)(rand() % RECCOUNT));
+		    (unsigned int)(rand() % recCount));
 		theKey = keyName;
 		gettimeofday(&starttm, nullptr);
 		try {
@@ -227,7 +338,7 @@ int main (int argc, char* argv[]) {
 
 	/* Sequential read test */
 	totalTime = 0;
-	for (int i = 0; i < RECCOUNT; i++) {
+	for (int i = 0; i < recCount; i++) {
 		snprintf(keyName, KEYNAMESIZE, "key%u", i);
 		theKey = keyName;
 		gettimeofday(&starttm, nullptr);
@@ -247,11 +358,19 @@ int main (int argc, char* argv[]) {
 	}
 	cout << "Sequential read lapsed time: " << totalTime << endl;
 
+	/* Sequence test, keys only and with data */
+	if (sequenceAll(rs, false) != 0)
+		return (EXIT_FAILURE);
+	if (sequenceAll(rs, true) != 0)
+		return (EXIT_FAILURE);
+	if (seekMany(rs) != 0)
+		return (EXIT_FAILURE);
+
 	/* Random read test */
 	totalTime = 0;
-	for (int i = 0; i < RECCOUNT; i++) {
+	for (int i = 0; i < recCount; i++) {
 		snprintf(keyName, KEYNAMESIZE, "key%u", 
-		    (unsigned int)(rand() % RECCOUNT));
+		    (unsigned int)(rand() % recCount));
 		theKey = keyName;
 		gettimeofday(&starttm, nullptr);
 		try {
@@ -281,7 +400,7 @@ int main (int argc, char* argv[]) {
 	cout << "Space used after first insert is " << startStoreSize << endl;
 
 	totalTime = 0;
-	for (int i = 0; i < RECCOUNT; i++) {
+	for (int i = 0; i < recCount; i++) {
 		snprintf(keyName, KEYNAMESIZE, "key%u", i);
 		theKey = keyName;
 		gettimeofday(&starttm, nullptr);
@@ -100,6 +100,34 @@ doTest(
 		throw BE::Error::StrategyError(RS2 + " length was incorrect");
 	}
 	std::cout << "PASS" << std::endl;
+
+	std::cout << "Testing readFirst()...";
+	const auto first = rsUnion.readFirst(NAME_KEY);
+	if (to_string(first.second) != first.first) {
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Value for " + NAME_KEY + " "
+		    "in " + first.first + " was not " + first.first);
+	}
+	try {
+		rsUnion.readFirst("nonexistent");
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Read nonexistent key");
+	} catch (const BE::Error::ObjectDoesNotExist&) {
+		/* Expected */
+	}
+
+	/* No lookup may still be using a member once readFirst() returns */
+	for (const auto &name : rsUnion.getNames()) {
+		rsUnion.readFirst(NAME_KEY);
+		const auto rs = rsUnion.getRecordStore(name);
+		if (rs->sequenceKey(BE::IO::RecordStore::BE_RECSTORE_SEQ_START)
+		    != NAME_KEY) {
+			std::cout << "FAIL" << std::endl;
+			throw BE::Error::StrategyError("Could not sequence " +
+			    name + " after readFirst()");
+		}
+	}
+	std::cout << "PASS" << std::endl;
 }
 
 static void
@@ -142,6 +170,11 @@ main(
 			{RS2, BE::IO::RecordStore::openRecordStore(RS2)}});
 
 		doTest(*rsUnion.get());
+
+		std::cout << std::endl << "With concurrent lookups:" <<
+		    std::endl;
+		rsUnion->setLookupThreads(2);
+		doTest(*rsUnion.get());
 	} catch (const BE::Error::Exception &e) {
 		std::cout << e.whatString() << std::endl;
 		rv = EXIT_FAILURE;